@@ -1,3 +1,3 @@
 #!/bin/bash
 
-lcm-logger -c "MBOT_ODOMETRY|MBOT_ENCODERS|MBOT_IMU|LIDAR_CHANNEL|SLAM_POSE|TRUE_POSE" "$1"
+lcm-logger -c "MBOT_ODOMETRY|MBOT_ENCODERS|MBOT_IMU|LIDAR_CHANNEL|LIDAR_COMPACT|SLAM_POSE|TRUE_POSE" "$1"
@@ -19,6 +19,10 @@
 #include <unistd.h>
 
 
+// Time to wait for the planning_server to answer a right-click before planning the path in botgui instead
+const int64_t kPlanReplyTimeoutUs = 500000;
+
+
 void clear_traces_pressed(GtkWidget* button, gpointer gui);
 void reset_state_pressed(GtkWidget* button, gpointer gui);
 
@@ -30,10 +34,16 @@ BotGui::BotGui(lcm::LCM* lcmInstance, int argc, char** argv, int widthInPixels,
 , haveTruePose_(false)
 , shouldResetStateLabels_(false)
 , shouldClearTraces_(false)
+, pendingPlanRequestId_(-1)
+, shouldStopFallback_(false)
 , nextColorIndex_(0)
 , lcmInstance_(lcmInstance)
 {
     assert(lcmInstance_);
+
+    // Like the planning_server, right-clicks are unrelated to each other, so don't reject goals near the previous one
+    planner_.setNumFrontiers(1);
+    fallbackThread_ = std::thread(&BotGui::runFallbackPlanner, this);
     
     odometry_.x = odometry_.y = odometry_.theta = 0.0;
     slamPose_.x = slamPose_.y = slamPose_.theta = 0.0;
@@ -56,6 +66,21 @@ BotGui::BotGui(lcm::LCM* lcmInstance, int argc, char** argv, int widthInPixels,
 }
 
 
+BotGui::~BotGui(void)
+{
+    {
+        std::lock_guard<std::mutex> autoLock(fallbackLock_);
+        shouldStopFallback_ = true;
+    }
+    fallbackCondition_.notify_all();
+
+    if(fallbackThread_.joinable())
+    {
+        fallbackThread_.join();
+    }
+}
+
+
 void BotGui::clearAllTraces(void)
 {
     shouldClearTraces_ = true;
@@ -112,23 +137,27 @@ int BotGui::onMouseEvent(vx_layer_t* layer,
         path.path.push_back(target);
         lcmInstance_->publish(CONTROLLER_PATH_CHANNEL, &path);
     }
-    // If an Right-click, send a target to the A* planner
+    // If an Right-click, ask the planning_server for a path to the target. The path is sent to the controller when the
+    // reply arrives -- see handlePlanReply. If the server doesn't answer in time, the path is planned here instead --
+    // see planPathIfServerSilent.
     else if((event->button_mask & VX_BUTTON3_MASK)) // && (event->modifiers == 0)
     {
-        std::cout << "Planning path to " << worldPoint << "...";
-        int64_t startTime = utime_now();
-        pose_xyt_t target;
-        target.x = worldPoint.x;
-        target.y = worldPoint.y;
-        target.theta = 0.0f;
-        
-        MotionPlanner planner;
-        planner.setMap(map_);
-        robot_path_t plannedPath = planner.planPath(slamPose_, target);
-        distances_ = planner.obstacleDistances();
-        lcmInstance_->publish(CONTROLLER_PATH_CHANNEL, &plannedPath);
-        
-        std::cout << "completed in " << ((utime_now() - startTime) / 1000) << "ms\n";
+        std::cout << "Requesting path to " << worldPoint << "...\n";
+        plan_request_t request;
+        request.utime = utime_now();
+        request.request_id = request.utime;
+        request.start = slamPose_;
+        request.goal.utime = request.utime;
+        request.goal.x = worldPoint.x;
+        request.goal.y = worldPoint.y;
+        request.goal.theta = 0.0f;
+
+        {
+            std::lock_guard<std::mutex> autoLock(vxLock_);
+            pendingPlanRequest_ = request;
+            pendingPlanRequestId_ = request.request_id;
+        }
+        lcmInstance_->publish(PLAN_REQUEST_CHANNEL, &request);
     }
     
     
@@ -204,12 +233,15 @@ void BotGui::onDisplayStart(vx_display_t* display)
     lcmInstance_->subscribe(".*_POSE", &BotGui::handlePose, this);  // NOTE: Subscribe to ALL _POSE channels!
     lcmInstance_->subscribe(".*ODOMETRY", &BotGui::handleOdometry, this); // NOTE: Subscribe to all channels with odometry in the name
     lcmInstance_->subscribe(EXPLORATION_STATUS_CHANNEL, &BotGui::handleExplorationStatus, this);
+    lcmInstance_->subscribe(PLAN_REPLY_CHANNEL, &BotGui::handlePlanReply, this);
 }
 
 
 void BotGui::render(void)
 {
     std::lock_guard<std::mutex> autoLock(vxLock_);
+
+    planPathIfServerSilent();
     
     // Draw the occupancy grid if requested
     vx_buffer_t* mapBuf = vx_world_get_buffer(world_, "map");
@@ -224,10 +256,6 @@ void BotGui::render(void)
     vx_buffer_t* distBuf = vx_world_get_buffer(world_, "distances");
     if(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(showDistancesCheck_)))
     {
-        MotionPlanner planner;
-        planner.setMap(map_);
-        distances_ = planner.obstacleDistances();
-
         MotionPlannerParams params;
         draw_distance_grid(distances_,  params.robotRadius, distBuf);
     }
@@ -309,6 +337,10 @@ void BotGui::handleOccupancyGrid(const lcm::ReceiveBuffer* rbuf,
     std::lock_guard<std::mutex> autoLock(vxLock_);
     map_.fromLCM(*map);
     frontiers_ = find_map_frontiers(map_, slamPose_);
+
+    // Keep the distances for drawing the configuration space up to date here, rather than in render, so the GUI thread
+    // doesn't wait on them. Only the distances around the changed cells need to be updated.
+    distances_.updateDistances(map_);
 }
 
 
@@ -372,6 +404,96 @@ void BotGui::handleExplorationStatus(const lcm::ReceiveBuffer* rbuf,
 }
 
 
+void BotGui::handlePlanReply(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const plan_reply_t* reply)
+{
+    // Replies to other clients' requests and to clicks that were superseded by a newer one are ignored
+    if(reply->request_id != pendingPlanRequestId_)
+    {
+        return;
+    }
+
+    // Without a map, the server can't plan, so leave the request for planPathIfServerSilent
+    if(reply->status == plan_reply_t::STATUS_NO_MAP)
+    {
+        std::cout << "INFO: planning_server hasn't received a map yet.\n";
+        return;
+    }
+
+    // The request may have been planned locally in the meantime
+    int64_t requestId = reply->request_id;
+    if(!pendingPlanRequestId_.compare_exchange_strong(requestId, -1))
+    {
+        return;
+    }
+
+    std::cout << "Path " << ((reply->status == plan_reply_t::STATUS_PATH_FOUND) ? "found" : "not found") << " in "
+        << (reply->planning_time_us / 1000.0) << "ms\n";
+    lcmInstance_->publish(CONTROLLER_PATH_CHANNEL, &reply->path);
+}
+
+
+void BotGui::planPathIfServerSilent(void)
+{
+    // Request ids are the time the request was sent
+    int64_t requestId = pendingPlanRequestId_;
+    if((requestId < 0) || (utime_now() - requestId < kPlanReplyTimeoutUs))
+    {
+        return;
+    }
+
+    // The reply may have arrived in the meantime
+    if(!pendingPlanRequestId_.compare_exchange_strong(requestId, -1))
+    {
+        return;
+    }
+
+    std::cout << "INFO: planning_server didn't answer. Planning path to (" << pendingPlanRequest_.goal.x << ','
+        << pendingPlanRequest_.goal.y << ") in botgui...\n";
+
+    // render holds vxLock_, so only copy the map here and leave the search to the fallback thread. A request that
+    // hasn't been started yet is replaced, since only the latest click matters.
+    std::shared_ptr<const OccupancyGrid> map = std::make_shared<OccupancyGrid>(map_);
+    {
+        std::lock_guard<std::mutex> autoLock(fallbackLock_);
+        fallbackMap_ = map;
+        fallbackRequest_ = pendingPlanRequest_;
+    }
+    fallbackCondition_.notify_one();
+}
+
+
+void BotGui::runFallbackPlanner(void)
+{
+    while(true)
+    {
+        std::shared_ptr<const OccupancyGrid> map;
+        plan_request_t request;
+        {
+            std::unique_lock<std::mutex> autoLock(fallbackLock_);
+            fallbackCondition_.wait(autoLock, [this]() { return shouldStopFallback_ || fallbackMap_; });
+
+            if(shouldStopFallback_)
+            {
+                return;
+            }
+
+            map.swap(fallbackMap_);
+            request = fallbackRequest_;
+        }
+
+        int64_t startTime = utime_now();
+
+        // Only the parts of the map that changed since the last local plan need to be updated in the planner
+        planner_.setMap(*map);
+        robot_path_t plannedPath = planner_.planPath(request.start, request.goal);
+        lcmInstance_->publish(CONTROLLER_PATH_CHANNEL, &plannedPath);
+
+        std::cout << "Path to (" << request.goal.x << ',' << request.goal.y << ") planned in botgui in "
+            << ((utime_now() - startTime) / 1000) << "ms\n";
+    }
+}
+
+
 void BotGui::addPose(const pose_xyt_t& pose, const std::string& channel)
 {
     auto traceIt = traces_.find(channel);
@@ -10,15 +10,21 @@
 #include <lcmtypes/particles_t.hpp>
 #include <lcmtypes/robot_path_t.hpp>
 #include <lcmtypes/lidar_t.hpp>
+#include <lcmtypes/plan_reply_t.hpp>
+#include <lcmtypes/plan_request_t.hpp>
 #include <planning/frontiers.hpp>
+#include <planning/motion_planner.hpp>
 #include <planning/obstacle_distance_grid.hpp>
 #include <vx/vx_display.h>
 #include <gtk/gtk.h>
 #include <lcm/lcm-cpp.hpp>
 #include <atomic>
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 
 /**
@@ -43,6 +49,11 @@ public:
     * \pre framesPerSecond > 0
     */
     BotGui(lcm::LCM* lcmInstance, int argc, char** argv, int widthInPixels, int heightInPixels, int framesPerSecond);
+
+    /**
+    * Destructor for BotGui. Stops the thread planning right-clicks the planning_server didn't answer.
+    */
+    ~BotGui(void);
     
     // GTK widget event handlers -- note these methods should only be called from the GTK event loop!
     void clearAllTraces(void);
@@ -69,6 +80,7 @@ public:
     void handleExplorationStatus(const lcm::ReceiveBuffer* rbuf, 
                                  const std::string& channel, 
                                  const exploration_status_t* status);
+    void handlePlanReply(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const plan_reply_t* reply);
 
 private:
     
@@ -119,6 +131,19 @@ private:
                                                     // enumeration
     std::atomic<bool> shouldResetStateLabels_;      // Flag indicating if the status of the state labels should be reset to the initial colors    
     std::atomic<bool> shouldClearTraces_;           // Flag indicating if all traces should be cleared on the next update
+    std::atomic<int64_t> pendingPlanRequestId_;     // Id of the last request sent to the planning_server, or -1 once
+                                                    // its path has been sent to the controller
+    plan_request_t pendingPlanRequest_;             // Last request sent to the planning_server
+
+    // Right-clicks the planning_server doesn't answer are planned on fallbackThread_, so the GUI never waits for them
+    MotionPlanner planner_;                         // Only used by fallbackThread_
+    std::mutex fallbackLock_;                       // guards the fallback request, its map, and shouldStopFallback_
+    std::condition_variable fallbackCondition_;
+    std::shared_ptr<const OccupancyGrid> fallbackMap_;  // Map to plan the fallback request in, nullptr if none waits
+    plan_request_t fallbackRequest_;
+    bool shouldStopFallback_;
+    std::thread fallbackThread_;
+
     std::vector<GtkWidget*> traceBoxesToAdd_;       // PoseTrace checkboxes that need to be added in the next render update    
     std::vector<const float*> traceColors_;         // Storage for the colors to assign to the various traces
     int nextColorIndex_;                            // Next color to assign to things
@@ -135,6 +160,8 @@ private:
     void populateNewTraceBoxes(void);
     void updateExplorationStatusIfNeeded(void);
     void resetExplorationStatusIfRequested(void);
+    void planPathIfServerSilent(void);
+    void runFallbackPlanner(void);
     void updateGridStatusBarText(void);
     
     // VxGtkWindowBase interface -- GUI construction
@@ -0,0 +1,59 @@
+#include <common/lidar_compact.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+void compress_lidar_scan(const lidar_t& scan, lidar_compact_t& compact)
+{
+    const int numRanges = std::max(scan.num_ranges, 0);
+
+    compact.utime = scan.utime;
+    compact.num_ranges = numRanges;
+    compact.ranges.resize(numRanges);
+    compact.intensities.resize(numRanges);
+
+    if(numRanges == 0)
+    {
+        compact.start_time = compact.end_time = scan.utime;
+        compact.start_theta = compact.end_theta = 0.0f;
+        return;
+    }
+
+    compact.start_time  = scan.times.front();
+    compact.end_time    = scan.times.back();
+    compact.start_theta = scan.thetas.front();
+    compact.end_theta   = scan.thetas.back();
+
+    for(int n = 0; n < numRanges; ++n)
+    {
+        long rangeInMm = std::lround(scan.ranges[n] * 1000.0f);
+        long intensity = std::lround(scan.intensities[n]);
+        compact.ranges[n] = static_cast<int16_t>(static_cast<uint16_t>(std::min(std::max(rangeInMm, 0L), 65535L)));
+        compact.intensities[n] = static_cast<uint8_t>(std::min(std::max(intensity, 0L), 255L));
+    }
+}
+
+
+void expand_lidar_scan(const lidar_compact_t& compact, lidar_t& scan)
+{
+    const int numRanges = std::max(compact.num_ranges, 0);
+
+    scan.utime = compact.utime;
+    scan.num_ranges = numRanges;
+    scan.ranges.resize(numRanges);
+    scan.thetas.resize(numRanges);
+    scan.times.resize(numRanges);
+    scan.intensities.resize(numRanges);
+
+    // Step through the angles and times incrementally rather than calling compact_ray_theta/time for each ray
+    const double thetaStep = (numRanges > 1) ? (compact.end_theta - compact.start_theta) / (numRanges - 1.0) : 0.0;
+    const double timeStep  = (numRanges > 1) ? (compact.end_time - compact.start_time) / (numRanges - 1.0) : 0.0;
+
+    for(int n = 0; n < numRanges; ++n)
+    {
+        scan.ranges[n]      = compact_ray_range(compact, n);
+        scan.thetas[n]      = compact.start_theta + thetaStep * n;
+        scan.times[n]       = compact.start_time + static_cast<int64_t>(std::llround(timeStep * n));
+        scan.intensities[n] = compact.intensities[n];
+    }
+}
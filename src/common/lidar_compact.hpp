@@ -0,0 +1,81 @@
+#ifndef COMMON_LIDAR_COMPACT_HPP
+#define COMMON_LIDAR_COMPACT_HPP
+
+#include <lcmtypes/lidar_compact_t.hpp>
+#include <lcmtypes/lidar_t.hpp>
+#include <cstdint>
+
+/**
+* compact_ray_range retrieves the range of a ray in a compact scan.
+*
+* \param    scan            Compact scan containing the ray
+* \param    index           Index of the ray, 0 <= index < scan.num_ranges
+* \return   Range of the ray in meters.
+*/
+inline float compact_ray_range(const lidar_compact_t& scan, int index)
+{
+    return static_cast<uint16_t>(scan.ranges[index]) * 0.001f;
+}
+
+
+/**
+* compact_ray_theta retrieves the angle of a ray in a compact scan. The rays are evenly spaced between start_theta and
+* end_theta.
+*
+* \param    scan            Compact scan containing the ray
+* \param    index           Index of the ray, 0 <= index < scan.num_ranges
+* \return   Angle of the ray in the lidar frame.
+*/
+inline float compact_ray_theta(const lidar_compact_t& scan, int index)
+{
+    if(scan.num_ranges < 2)
+    {
+        return scan.start_theta;
+    }
+
+    return scan.start_theta + (scan.end_theta - scan.start_theta) * index / (scan.num_ranges - 1);
+}
+
+
+/**
+* compact_ray_time retrieves the time a ray in a compact scan was measured. The rays are evenly spaced between
+* start_time and end_time.
+*
+* \param    scan            Compact scan containing the ray
+* \param    index           Index of the ray, 0 <= index < scan.num_ranges
+* \return   Time of the ray measurement in microseconds.
+*/
+inline int64_t compact_ray_time(const lidar_compact_t& scan, int index)
+{
+    if(scan.num_ranges < 2)
+    {
+        return scan.start_time;
+    }
+
+    return scan.start_time + (scan.end_time - scan.start_time) * index / (scan.num_ranges - 1);
+}
+
+
+/**
+* compress_lidar_scan converts a full lidar_t scan into the compact format. Ranges are rounded to the nearest
+* millimeter and saturate at 65.535m. Intensities saturate at 255. Only the angle and time of the first and last rays
+* are kept.
+*
+* The arrays in compact are resized in place, so reusing the same message for every scan avoids allocations.
+*
+* \param    scan            Scan to compress
+* \param    compact         Compact scan to fill in (output)
+*/
+void compress_lidar_scan(const lidar_t& scan, lidar_compact_t& compact);
+
+/**
+* expand_lidar_scan converts a compact scan back into a full lidar_t scan with an explicit angle and time for every ray.
+*
+* The arrays in scan are resized in place, so reusing the same message for every scan avoids allocations.
+*
+* \param    compact         Compact scan to expand
+* \param    scan            Full scan to fill in (output)
+*/
+void expand_lidar_scan(const lidar_compact_t& compact, lidar_t& scan);
+
+#endif // COMMON_LIDAR_COMPACT_HPP
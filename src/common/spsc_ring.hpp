@@ -0,0 +1,91 @@
+#ifndef COMMON_SPSC_RING_HPP
+#define COMMON_SPSC_RING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+* SpscRing is a fixed-size, lock-free ring of preallocated slots shared by exactly one producer thread and exactly one
+* consumer thread.
+*
+* The slots are filled in place rather than copied in and out:
+*
+*   producer:   T* slot = ring.beginWrite();  if(slot) { fill *slot; ring.commitWrite(); }
+*   consumer:   T* slot = ring.beginRead();   if(slot) { use *slot;  ring.commitRead(); }
+*
+* beginWrite returns nullptr when every slot is waiting to be read and beginRead returns nullptr when no slot has been
+* written. A slot is owned by the caller between begin and commit, so neither side ever blocks the other or allocates.
+*
+* Calling the producer methods from more than one thread, or the consumer methods from more than one thread, is not
+* supported.
+*/
+template <class T, std::size_t N>
+class SpscRing
+{
+public:
+
+    static_assert(N > 0, "SpscRing needs at least one slot");
+
+    SpscRing(void)
+    : head_(0)
+    , tail_(0)
+    {
+    }
+
+    /**
+    * beginWrite retrieves the next slot to be filled by the producer.
+    *
+    * \return   Slot to fill or nullptr if the ring is full.
+    */
+    T* beginWrite(void)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if(tail - head_.load(std::memory_order_acquire) == N)
+        {
+            return nullptr;
+        }
+        return &slots_[tail % N];
+    }
+
+    /**
+    * commitWrite makes the slot returned by the last beginWrite visible to the consumer.
+    */
+    void commitWrite(void)
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+    * beginRead retrieves the oldest slot written by the producer.
+    *
+    * \return   Oldest written slot or nullptr if the ring is empty.
+    */
+    T* beginRead(void)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if(head == tail_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &slots_[head % N];
+    }
+
+    /**
+    * commitRead hands the slot returned by the last beginRead back to the producer.
+    */
+    void commitRead(void)
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::size_t capacity(void) const { return N; }
+
+private:
+
+    std::array<T, N> slots_;
+    std::atomic<std::size_t> head_;     // number of slots read by the consumer
+    std::atomic<std::size_t> tail_;     // number of slots written by the producer
+};
+
+#endif // COMMON_SPSC_RING_HPP
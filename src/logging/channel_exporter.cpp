@@ -0,0 +1,363 @@
+#include <logging/channel_exporter.hpp>
+#include <mbot/mbot_channels.h>
+#include <lcmtypes/lidar_t.hpp>
+#include <lcmtypes/mbot_encoder_t.hpp>
+#include <lcmtypes/odometry_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sys/stat.h>
+
+
+ChannelExporter::ChannelExporter(const std::string& channel, const std::string& type)
+: channel_(channel)
+, type_(type)
+, numMessages_(0)
+, numDecodeErrors_(0)
+{
+}
+
+
+bool ChannelExporter::open(const std::string& outputDirectory)
+{
+    directory_ = outputDirectory + '/' + channel_;
+    if((mkdir(directory_.c_str(), 0755) != 0) && (errno != EEXIST))
+    {
+        fprintf(stderr, "ERROR: Failed to create %s\n", directory_.c_str());
+        return false;
+    }
+
+    logUtime_ = addColumn("log_utime", "i64");
+    return openColumns() && (logUtime_ != nullptr);
+}
+
+
+void ChannelExporter::add(const LcmLogEvent& event)
+{
+    if(decode(event))
+    {
+        logUtime_->append(event.timestamp);
+        ++numMessages_;
+    }
+    else
+    {
+        ++numDecodeErrors_;
+    }
+}
+
+
+bool ChannelExporter::close(void)
+{
+    bool success = true;
+    for(auto& column : columns_)
+    {
+        success = column->close() && success;
+    }
+    return success;
+}
+
+
+void ChannelExporter::writeManifest(std::ostream& out) const
+{
+    out << "    {\n"
+        << "      \"channel\": \"" << channel_ << "\",\n"
+        << "      \"type\": \"" << type_ << "\",\n"
+        << "      \"messages\": " << numMessages_ << ",\n"
+        << "      \"columns\": [\n";
+
+    for(std::size_t n = 0; n < columns_.size(); ++n)
+    {
+        const ColumnWriter& column = *columns_[n];
+        out << "        {\"name\": \"" << column.name() << "\", \"file\": \"" << channel_ << '/' << column.filename()
+            << "\", \"dtype\": \"" << column.numpyType() << "\", \"length\": " << column.length() << '}'
+            << ((n + 1 < columns_.size()) ? ",\n" : "\n");
+    }
+
+    out << "      ]\n"
+        << "    }";
+}
+
+
+ColumnWriter* ChannelExporter::addColumn(const std::string& name, const std::string& type)
+{
+    std::unique_ptr<ColumnWriter> column(new ColumnWriter);
+    if(!column->open(directory_, name, type))
+    {
+        return nullptr;
+    }
+
+    columns_.push_back(std::move(column));
+    return columns_.back().get();
+}
+
+
+namespace
+{
+
+/**
+* LidarExporter exports lidar_t. There is one row per scan in utime and num_ranges and one row per ray in the ray
+* columns. ray_offset has numMessages + 1 rows: the rays for scan i are [ray_offset[i], ray_offset[i+1]).
+*/
+class LidarExporter : public ChannelExporter
+{
+public:
+
+    explicit LidarExporter(const std::string& channel)
+    : ChannelExporter(channel, "lidar_t")
+    , numRays_(0)
+    {
+    }
+
+private:
+
+    lidar_t scan_;
+    uint64_t numRays_;
+    ColumnWriter* utime_;
+    ColumnWriter* numRanges_;
+    ColumnWriter* rayOffset_;
+    ColumnWriter* ranges_;
+    ColumnWriter* thetas_;
+    ColumnWriter* times_;
+    ColumnWriter* intensities_;
+
+    bool openColumns(void) override
+    {
+        utime_ = addColumn("utime", "i64");
+        numRanges_ = addColumn("num_ranges", "i32");
+        rayOffset_ = addColumn("ray_offset", "u64");
+        ranges_ = addColumn("ranges", "f32");
+        thetas_ = addColumn("thetas", "f32");
+        times_ = addColumn("times", "i64");
+        intensities_ = addColumn("intensities", "f32");
+
+        bool success = utime_ && numRanges_ && rayOffset_ && ranges_ && thetas_ && times_ && intensities_;
+        if(success)
+        {
+            rayOffset_->append(numRays_);
+        }
+        return success;
+    }
+
+    bool decode(const LcmLogEvent& event) override
+    {
+        if(scan_.decode(event.data, 0, event.dataLength) < 0)
+        {
+            return false;
+        }
+
+        // The generated decode leaves the arrays untouched for an empty scan
+        std::size_t numRanges = std::max(scan_.num_ranges, 0);
+        numRays_ += numRanges;
+
+        utime_->append(scan_.utime);
+        numRanges_->append(static_cast<int32_t>(numRanges));
+        rayOffset_->append(numRays_);
+        ranges_->append(scan_.ranges, numRanges);
+        thetas_->append(scan_.thetas, numRanges);
+        times_->append(scan_.times, numRanges);
+        intensities_->append(scan_.intensities, numRanges);
+        return true;
+    }
+};
+
+
+/**
+* PoseExporter exports the messages holding a timestamped (x, y, theta): odometry_t and pose_xyt_t.
+*/
+template <class Pose>
+class PoseExporter : public ChannelExporter
+{
+public:
+
+    PoseExporter(const std::string& channel, const std::string& type)
+    : ChannelExporter(channel, type)
+    {
+    }
+
+private:
+
+    Pose pose_;
+    ColumnWriter* utime_;
+    ColumnWriter* x_;
+    ColumnWriter* y_;
+    ColumnWriter* theta_;
+
+    bool openColumns(void) override
+    {
+        utime_ = this->addColumn("utime", "i64");
+        x_ = this->addColumn("x", "f32");
+        y_ = this->addColumn("y", "f32");
+        theta_ = this->addColumn("theta", "f32");
+        return utime_ && x_ && y_ && theta_;
+    }
+
+    bool decode(const LcmLogEvent& event) override
+    {
+        if(pose_.decode(event.data, 0, event.dataLength) < 0)
+        {
+            return false;
+        }
+
+        utime_->append(pose_.utime);
+        x_->append(pose_.x);
+        y_->append(pose_.y);
+        theta_->append(pose_.theta);
+        return true;
+    }
+};
+
+
+/**
+* EncoderExporter exports mbot_encoder_t.
+*/
+class EncoderExporter : public ChannelExporter
+{
+public:
+
+    explicit EncoderExporter(const std::string& channel)
+    : ChannelExporter(channel, "mbot_encoder_t")
+    {
+    }
+
+private:
+
+    mbot_encoder_t encoders_;
+    ColumnWriter* utime_;
+    ColumnWriter* leftTicks_;
+    ColumnWriter* rightTicks_;
+    ColumnWriter* leftDelta_;
+    ColumnWriter* rightDelta_;
+
+    bool openColumns(void) override
+    {
+        utime_ = addColumn("utime", "i64");
+        leftTicks_ = addColumn("leftticks", "i64");
+        rightTicks_ = addColumn("rightticks", "i64");
+        leftDelta_ = addColumn("left_delta", "i16");
+        rightDelta_ = addColumn("right_delta", "i16");
+        return utime_ && leftTicks_ && rightTicks_ && leftDelta_ && rightDelta_;
+    }
+
+    bool decode(const LcmLogEvent& event) override
+    {
+        if(encoders_.decode(event.data, 0, event.dataLength) < 0)
+        {
+            return false;
+        }
+
+        utime_->append(encoders_.utime);
+        leftTicks_->append(encoders_.leftticks);
+        rightTicks_->append(encoders_.rightticks);
+        leftDelta_->append(encoders_.left_delta);
+        rightDelta_->append(encoders_.right_delta);
+        return true;
+    }
+};
+
+
+const char* kSupportedTypes[] = { "lidar_t", "odometry_t", "pose_xyt_t", "mbot_encoder_t" };
+
+
+/**
+* default_pose_type picks the type of a channel holding odometry_t or pose_xyt_t that isn't in the channel types.
+*/
+std::string default_pose_type(const std::string& channel)
+{
+    return (channel.find(ODOMETRY_CHANNEL) != std::string::npos) ? "odometry_t" : "pose_xyt_t";
+}
+
+}
+
+
+std::unique_ptr<ChannelExporter> create_exporter(const std::string& channel,
+                                                 const LcmLogEvent& firstEvent,
+                                                 const std::map<std::string, std::string>& channelTypes)
+{
+    if(firstEvent.dataLength < 8)
+    {
+        return nullptr;
+    }
+
+    // The fingerprint is a big-endian int64
+    uint64_t hash = 0;
+    for(int n = 0; n < 8; ++n)
+    {
+        hash = (hash << 8) | firstEvent.data[n];
+    }
+
+    // The fingerprint gives the type, except for telling apart the pose types
+    std::string type;
+    if(static_cast<int64_t>(hash) == lidar_t::getHash())
+    {
+        type = "lidar_t";
+    }
+    else if((static_cast<int64_t>(hash) == odometry_t::getHash())
+        || (static_cast<int64_t>(hash) == pose_xyt_t::getHash()))
+    {
+        type = default_pose_type(channel);
+    }
+    else if(static_cast<int64_t>(hash) == mbot_encoder_t::getHash())
+    {
+        type = "mbot_encoder_t";
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    auto typeIt = channelTypes.find(channel);
+    if(typeIt != channelTypes.end())
+    {
+        bool isPoseType = (type == "odometry_t") || (type == "pose_xyt_t");
+        bool isGivenPoseType = (typeIt->second == "odometry_t") || (typeIt->second == "pose_xyt_t");
+        if((typeIt->second != type) && !(isPoseType && isGivenPoseType))
+        {
+            fprintf(stderr, "ERROR: %s holds %s, not %s\n", channel.c_str(), type.c_str(), typeIt->second.c_str());
+            return nullptr;
+        }
+        type = typeIt->second;
+    }
+
+    if(type == "lidar_t")
+    {
+        return std::unique_ptr<ChannelExporter>(new LidarExporter(channel));
+    }
+    else if(type == "odometry_t")
+    {
+        return std::unique_ptr<ChannelExporter>(new PoseExporter<odometry_t>(channel, type));
+    }
+    else if(type == "pose_xyt_t")
+    {
+        return std::unique_ptr<ChannelExporter>(new PoseExporter<pose_xyt_t>(channel, type));
+    }
+    else
+    {
+        return std::unique_ptr<ChannelExporter>(new EncoderExporter(channel));
+    }
+}
+
+
+bool parse_channel_types(const std::string& types, std::map<std::string, std::string>& channelTypes)
+{
+    for(auto& pair : split_channels(types))
+    {
+        std::size_t separator = pair.find('=');
+        if((separator == 0) || (separator == std::string::npos))
+        {
+            fprintf(stderr, "ERROR: Expected CHANNEL=type instead of %s\n", pair.c_str());
+            return false;
+        }
+
+        std::string type = pair.substr(separator + 1);
+        if(std::find(std::begin(kSupportedTypes), std::end(kSupportedTypes), type) == std::end(kSupportedTypes))
+        {
+            fprintf(stderr, "ERROR: %s isn't one of the supported types\n", type.c_str());
+            return false;
+        }
+
+        channelTypes[pair.substr(0, separator)] = type;
+    }
+
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef LOGGING_CHANNEL_EXPORTER_HPP
+#define LOGGING_CHANNEL_EXPORTER_HPP
+
+#include <logging/column_writer.hpp>
+#include <logging/lcm_log.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+* ChannelExporter writes the messages of one channel to a directory of column files. Every exporter writes log_utime,
+* the time the logger received each message, along with the columns for the fields of the message type.
+*
+* The messages are decoded into a single reused message, so after the first few messages, exporting doesn't allocate.
+*/
+class ChannelExporter
+{
+public:
+
+    ChannelExporter(const std::string& channel, const std::string& type);
+    virtual ~ChannelExporter(void) {}
+
+    /**
+    * open creates <outputDirectory>/<channel> and the columns of the channel in it.
+    *
+    * \return   True if every column was created.
+    */
+    bool open(const std::string& outputDirectory);
+
+    /**
+    * add decodes a message of the channel and appends it to the columns. Messages that fail to decode are counted and
+    * skipped.
+    */
+    void add(const LcmLogEvent& event);
+
+    /**
+    * close flushes the columns to disk.
+    *
+    * \return   True if every value was written successfully.
+    */
+    bool close(void);
+
+    /**
+    * writeManifest writes the JSON object describing the channel, its message type, and its columns.
+    */
+    void writeManifest(std::ostream& out) const;
+
+    const std::string& channel(void) const { return channel_; }
+    const std::string& type(void) const { return type_; }
+    uint64_t numMessages(void) const { return numMessages_; }
+    uint64_t numDecodeErrors(void) const { return numDecodeErrors_; }
+
+protected:
+
+    ColumnWriter* addColumn(const std::string& name, const std::string& type);
+
+    /**
+    * openColumns creates the columns for the fields of the message type.
+    */
+    virtual bool openColumns(void) = 0;
+
+    /**
+    * decode decodes a message and appends its fields to the columns.
+    *
+    * \return   True if the message was decoded successfully.
+    */
+    virtual bool decode(const LcmLogEvent& event) = 0;
+
+private:
+
+    std::string channel_;
+    std::string type_;
+    std::string directory_;
+    std::vector<std::unique_ptr<ColumnWriter>> columns_;
+    ColumnWriter* logUtime_;
+    uint64_t numMessages_;
+    uint64_t numDecodeErrors_;
+};
+
+
+/**
+* create_exporter creates the exporter for a channel based on the type fingerprint at the start of its first message.
+*
+* odometry_t and pose_xyt_t have the same fields, so they have the same fingerprint. A channel holding either is
+* exported as the type given for it in channelTypes. Otherwise, it's odometry_t if its name contains ODOMETRY, as
+* published by the odometry process, and pose_xyt_t if not, e.g. SLAM_POSE or TRUE_POSE.
+*
+* \param    channel         Name of the channel
+* \param    firstEvent      First message on the channel
+* \param    channelTypes    Message type of the channels whose type can't be told from the fingerprint
+* \return   Exporter for the channel or nullptr if the channel doesn't hold a supported type or the fingerprint doesn't
+*   match the type given in channelTypes.
+*/
+std::unique_ptr<ChannelExporter> create_exporter(const std::string& channel,
+                                                 const LcmLogEvent& firstEvent,
+                                                 const std::map<std::string, std::string>& channelTypes);
+
+/**
+* parse_channel_types parses a comma-separated list of CHANNEL=type pairs, e.g. from a --types option, such as
+* "SLAM_POSE=pose_xyt_t,WHEEL_POSE=odometry_t". Empty pairs are skipped.
+*
+* \param    types           List of pairs to parse
+* \param    channelTypes    Message type of each channel in the list (output)
+* \return   True if every pair has a channel and one of the supported types.
+*/
+bool parse_channel_types(const std::string& types, std::map<std::string, std::string>& channelTypes);
+
+#endif // LOGGING_CHANNEL_EXPORTER_HPP
@@ -0,0 +1,239 @@
+#include <logging/channel_exporter.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+* The channel exporter test checks the exporters used by log_to_columns:
+*
+*   - pose_xyt_t messages, which have the same fingerprint as odometry_t, are exported as pose_xyt_t on SLAM_POSE,
+*     as odometry_t on ODOMETRY, and as the type given for the channel otherwise, and the manifest names that type,
+*   - a channel given a type that doesn't match its fingerprint isn't exported,
+*   - parse_channel_types accepts CHANNEL=type pairs and rejects malformed pairs and unsupported types.
+*
+* Run it from a writable directory, since the columns are written to the current directory.
+*/
+
+
+const char* kDirectory = ".";
+const std::size_t kNumMessages = 50;
+
+
+bool test_pose_types(void);
+bool test_type_mismatch(void);
+bool test_parse_channel_types(void);
+
+std::vector<uint8_t> encode_pose(int n);
+LcmLogEvent make_event(const char* channel, const std::vector<uint8_t>& data, int n);
+bool read_floats(const std::string& filename, std::vector<float>& values);
+
+
+int main(int argc, char** argv)
+{
+    if(test_pose_types())
+    {
+        std::cout << "PASSED: test_pose_types\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_pose_types\n";
+    }
+
+    if(test_type_mismatch())
+    {
+        std::cout << "PASSED: test_type_mismatch\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_type_mismatch\n";
+    }
+
+    if(test_parse_channel_types())
+    {
+        std::cout << "PASSED: test_parse_channel_types\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_parse_channel_types\n";
+    }
+
+    return 0;
+}
+
+
+bool test_pose_types(void)
+{
+    std::map<std::string, std::string> channelTypes;
+    if(!parse_channel_types("WHEEL_POSE=odometry_t,SLAM_POSE_COPY=pose_xyt_t", channelTypes))
+    {
+        return false;
+    }
+
+    // Every channel holds the same pose_xyt_t messages
+    const char* kChannels[][2] = {
+        { "SLAM_POSE", "pose_xyt_t" },
+        { "TRUE_POSE", "pose_xyt_t" },
+        { "ODOMETRY", "odometry_t" },
+        { "WHEEL_POSE", "odometry_t" },
+        { "SLAM_POSE_COPY", "pose_xyt_t" }
+    };
+
+    for(auto& channel : kChannels)
+    {
+        std::vector<std::vector<uint8_t>> messages;
+        for(std::size_t n = 0; n < kNumMessages; ++n)
+        {
+            messages.push_back(encode_pose(n));
+        }
+
+        std::unique_ptr<ChannelExporter> exporter
+            = create_exporter(channel[0], make_event(channel[0], messages.front(), 0), channelTypes);
+        if(!exporter || !exporter->open(kDirectory))
+        {
+            std::cout << "No exporter for " << channel[0] << '\n';
+            return false;
+        }
+
+        for(std::size_t n = 0; n < kNumMessages; ++n)
+        {
+            exporter->add(make_event(channel[0], messages[n], n));
+        }
+        bool closed = exporter->close();
+
+        std::ostringstream manifest;
+        exporter->writeManifest(manifest);
+
+        const std::string directory = std::string(kDirectory) + '/' + channel[0];
+        std::vector<float> x;
+        bool isRead = read_floats(directory + "/x.f32", x);
+        for(auto column : { "log_utime.i64", "utime.i64", "x.f32", "y.f32", "theta.f32" })
+        {
+            std::remove((directory + '/' + column).c_str());
+        }
+        std::remove(directory.c_str());
+
+        if(!closed || (exporter->type() != channel[1])
+            || (manifest.str().find(std::string("\"type\": \"") + channel[1] + '"') == std::string::npos))
+        {
+            std::cout << channel[0] << " was exported as " << exporter->type() << " instead of " << channel[1] << '\n';
+            return false;
+        }
+
+        if((exporter->numMessages() != kNumMessages) || (exporter->numDecodeErrors() != 0) || !isRead
+            || (x.size() != kNumMessages) || (x.back() != (kNumMessages - 1) * 0.5f))
+        {
+            std::cout << channel[0] << " exported " << exporter->numMessages() << " messages with "
+                << exporter->numDecodeErrors() << " decode errors and " << x.size() << " x values\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_type_mismatch(void)
+{
+    std::map<std::string, std::string> channelTypes;
+    channelTypes["SLAM_POSE"] = "lidar_t";
+
+    std::cout << "Expect an error about SLAM_POSE not holding lidar_t:\n";
+    std::vector<uint8_t> pose = encode_pose(0);
+    if(create_exporter("SLAM_POSE", make_event("SLAM_POSE", pose, 0), channelTypes))
+    {
+        std::cout << "Exported a pose channel as lidar_t\n";
+        return false;
+    }
+
+    // Messages of an unsupported type or too short to hold a fingerprint are skipped
+    std::vector<uint8_t> garbage(pose.size(), 0x5A);
+    std::vector<uint8_t> truncated(pose.begin(), pose.begin() + 4);
+    if(create_exporter("OTHER", make_event("OTHER", garbage, 0), channelTypes)
+        || create_exporter("OTHER", make_event("OTHER", truncated, 0), channelTypes))
+    {
+        std::cout << "Exported a channel without a supported fingerprint\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool test_parse_channel_types(void)
+{
+    std::map<std::string, std::string> channelTypes;
+    if(!parse_channel_types("A=pose_xyt_t,,B=lidar_t,A=odometry_t", channelTypes) || (channelTypes.size() != 2)
+        || (channelTypes["A"] != "odometry_t") || (channelTypes["B"] != "lidar_t")
+        || !parse_channel_types("", channelTypes))
+    {
+        std::cout << "parse_channel_types didn't parse a valid list\n";
+        return false;
+    }
+
+    std::cout << "Expect three errors about malformed pairs and an unsupported type:\n";
+    if(parse_channel_types("A", channelTypes) || parse_channel_types("=pose_xyt_t", channelTypes)
+        || parse_channel_types("A=occupancy_grid_t", channelTypes))
+    {
+        std::cout << "parse_channel_types accepted an invalid list\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+std::vector<uint8_t> encode_pose(int n)
+{
+    pose_xyt_t pose;
+    pose.utime = 1000000 + n * 10000;
+    pose.x = n * 0.5f;
+    pose.y = -n * 0.25f;
+    pose.theta = n * 0.01f;
+
+    std::vector<uint8_t> data(pose.getEncodedSize());
+    pose.encode(data.data(), 0, data.size());
+    return data;
+}
+
+
+LcmLogEvent make_event(const char* channel, const std::vector<uint8_t>& data, int n)
+{
+    // The event points into channel and data, as into a memory-mapped log
+    LcmLogEvent event;
+    event.eventNumber = n;
+    event.timestamp = 1000000 + n * 10000;
+    event.channel = channel;
+    event.channelLength = std::strlen(channel);
+    event.channelId = 0;
+    event.data = data.data();
+    event.dataLength = data.size();
+    event.raw = nullptr;
+    event.offset = 0;
+    event.size = data.size();
+    return event;
+}
+
+
+bool read_floats(const std::string& filename, std::vector<float>& values)
+{
+    FILE* file = std::fopen(filename.c_str(), "rb");
+    if(!file)
+    {
+        return false;
+    }
+
+    float value;
+    while(std::fread(&value, sizeof(float), 1, file) == 1)
+    {
+        values.push_back(value);
+    }
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,71 @@
+#include <logging/column_writer.hpp>
+#include <iostream>
+
+namespace
+{
+
+const std::size_t kBufferSize = 1 << 20;
+
+}
+
+
+ColumnWriter::ColumnWriter(void)
+: file_(nullptr)
+, length_(0)
+, ok_(false)
+{
+}
+
+
+ColumnWriter::~ColumnWriter(void)
+{
+    close();
+}
+
+
+bool ColumnWriter::open(const std::string& directory, const std::string& name, const std::string& type)
+{
+    close();
+
+    name_ = name;
+    type_ = type;
+    filename_ = name + '.' + type;
+    length_ = 0;
+
+    std::string path = directory + '/' + filename_;
+    file_ = std::fopen(path.c_str(), "wb");
+    if(!file_)
+    {
+        std::cerr << "ERROR: ColumnWriter::open: Failed to create " << path << '\n';
+        ok_ = false;
+        return false;
+    }
+
+    buffer_.resize(kBufferSize);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+    ok_ = true;
+    return true;
+}
+
+
+bool ColumnWriter::close(void)
+{
+    if(file_)
+    {
+        ok_ = (std::fclose(file_) == 0) && ok_;
+        file_ = nullptr;
+    }
+
+    return ok_;
+}
+
+
+std::string ColumnWriter::numpyType(void) const
+{
+    if(type_ == "i16") { return "<i2"; }
+    if(type_ == "i32") { return "<i4"; }
+    if(type_ == "i64") { return "<i8"; }
+    if(type_ == "u64") { return "<u8"; }
+    if(type_ == "f32") { return "<f4"; }
+    return "";
+}
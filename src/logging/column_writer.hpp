@@ -0,0 +1,79 @@
+#ifndef LOGGING_COLUMN_WRITER_HPP
+#define LOGGING_COLUMN_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+* ColumnWriter writes one column of a columnar export: a flat binary file holding a packed array of a single
+* fixed-width type in little-endian byte order, with no header. A column can be memory-mapped directly, e.g. in numpy:
+*
+*   ranges = np.memmap('LIDAR/ranges.f32', dtype='<f4', mode='r')
+*
+* Writes go through a large stdio buffer, so appending a value at a time is cheap.
+*/
+class ColumnWriter
+{
+public:
+
+    ColumnWriter(void);
+    ~ColumnWriter(void);
+
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+    /**
+    * open creates the file for the column. The file is named <directory>/<name>.<type>, e.g. LIDAR/ranges.f32.
+    *
+    * \param    directory           Directory to hold the column
+    * \param    name                Name of the column
+    * \param    type                Short name of the element type: i16, i32, i64, u64, or f32
+    * \return   True if the file was created.
+    */
+    bool open(const std::string& directory, const std::string& name, const std::string& type);
+
+    /**
+    * close flushes the column to disk.
+    *
+    * \return   True if every value was written successfully.
+    */
+    bool close(void);
+
+    template <typename T>
+    void append(const T& value)
+    {
+        ok_ = ok_ && (std::fwrite(&value, sizeof(T), 1, file_) == 1);
+        ++length_;
+    }
+
+    template <typename T>
+    void append(const std::vector<T>& values, std::size_t count)
+    {
+        ok_ = ok_ && ((count == 0) || (std::fwrite(values.data(), sizeof(T), count, file_) == count));
+        length_ += count;
+    }
+
+    const std::string& name(void) const { return name_; }
+    const std::string& type(void) const { return type_; }
+    const std::string& filename(void) const { return filename_; }
+    uint64_t length(void) const { return length_; }
+
+    /**
+    * numpyType retrieves the numpy dtype string for the column's element type, e.g. '<f4'.
+    */
+    std::string numpyType(void) const;
+
+private:
+
+    FILE* file_;
+    std::vector<char> buffer_;
+    std::string name_;
+    std::string type_;
+    std::string filename_;
+    uint64_t length_;
+    bool ok_;
+};
+
+#endif // LOGGING_COLUMN_WRITER_HPP
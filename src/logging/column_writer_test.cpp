@@ -0,0 +1,213 @@
+#include <logging/column_writer.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The column writer test checks ColumnWriter:
+*
+*   - values appended one at a time and in blocks, including empty blocks, read back unchanged and in order from
+*     <directory>/<name>.<type>, with the expected length,
+*   - a column larger than the write buffer reads back unchanged,
+*   - every element type has the right numpy dtype, and opening a column in a missing directory fails.
+*/
+
+
+const char* kDirectory = ".";
+
+
+bool test_round_trip(void);
+bool test_large_column(void);
+bool test_types_and_errors(void);
+
+template <typename T>
+bool read_column(const std::string& filename, std::vector<T>& values);
+
+
+int main(int argc, char** argv)
+{
+    if(test_round_trip())
+    {
+        std::cout << "PASSED: test_round_trip\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_round_trip\n";
+    }
+
+    if(test_large_column())
+    {
+        std::cout << "PASSED: test_large_column\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_large_column\n";
+    }
+
+    if(test_types_and_errors())
+    {
+        std::cout << "PASSED: test_types_and_errors\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_types_and_errors\n";
+    }
+
+    return 0;
+}
+
+
+bool test_round_trip(void)
+{
+    std::vector<float> expected;
+    std::vector<float> block;
+
+    ColumnWriter column;
+    if(!column.open(kDirectory, "column_writer_test", "f32"))
+    {
+        return false;
+    }
+
+    for(int n = 0; n < 1000; ++n)
+    {
+        if(n % 10 == 0)
+        {
+            // Only the first count values of a block are written, as with a reused scan buffer
+            block.assign(n % 7 + 3, -1.0f);
+            std::size_t count = n % 7;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                block[i] = n + i * 0.25f;
+                expected.push_back(block[i]);
+            }
+            column.append(block, count);
+        }
+        else
+        {
+            float value = n * 0.5f - 100.0f;
+            column.append(value);
+            expected.push_back(value);
+        }
+    }
+
+    bool closed = column.close();
+    std::string filename = column.filename();
+
+    std::vector<float> values;
+    bool isRead = read_column(filename, values);
+    std::remove(filename.c_str());
+
+    if(!closed || !isRead || (filename != "column_writer_test.f32") || (column.length() != expected.size()))
+    {
+        std::cout << "Column " << filename << " wasn't written or has length " << column.length() << " instead of "
+            << expected.size() << '\n';
+        return false;
+    }
+
+    if(values != expected)
+    {
+        std::cout << "Read " << values.size() << " values that don't match the " << expected.size() << " written\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool test_large_column(void)
+{
+    // Several times the write buffer, so the buffer is flushed partway through appends
+    const std::size_t kNumValues = 1 << 20;
+
+    ColumnWriter column;
+    if(!column.open(kDirectory, "column_writer_test", "u64"))
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> block(1000);
+    std::vector<uint64_t> expected;
+    expected.reserve(kNumValues);
+    while(expected.size() < kNumValues)
+    {
+        for(auto& value : block)
+        {
+            value = expected.size() * 0x9E3779B97F4A7C15ull;
+            expected.push_back(value);
+        }
+        column.append(block, block.size());
+    }
+
+    bool closed = column.close();
+
+    std::vector<uint64_t> values;
+    bool isRead = read_column(column.filename(), values);
+    std::remove(column.filename().c_str());
+
+    if(!closed || !isRead || (values != expected))
+    {
+        std::cout << "Large column didn't read back unchanged\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool test_types_and_errors(void)
+{
+    const char* kTypes[][2] = {
+        { "i16", "<i2" }, { "i32", "<i4" }, { "i64", "<i8" }, { "u64", "<u8" }, { "f32", "<f4" }
+    };
+
+    for(auto& type : kTypes)
+    {
+        ColumnWriter column;
+        if(!column.open(kDirectory, "column_writer_test", type[0]) || !column.close())
+        {
+            return false;
+        }
+        std::remove(column.filename().c_str());
+
+        if(column.numpyType() != type[1])
+        {
+            std::cout << "Type " << type[0] << " has dtype " << column.numpyType() << " instead of " << type[1] << '\n';
+            return false;
+        }
+    }
+
+    std::cout << "Expect an error about failing to create a column:\n";
+    ColumnWriter column;
+    if(column.open("column_writer_test_missing_directory", "ranges", "f32") || column.close())
+    {
+        std::cout << "Opening a column in a missing directory succeeded\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+template <typename T>
+bool read_column(const std::string& filename, std::vector<T>& values)
+{
+    FILE* file = std::fopen((std::string(kDirectory) + '/' + filename).c_str(), "rb");
+    if(!file)
+    {
+        return false;
+    }
+
+    // Columns are little-endian, so the bytes are the values on the x86 and ARM machines the robot software runs on
+    T value;
+    while(std::fread(&value, sizeof(T), 1, file) == 1)
+    {
+        values.push_back(value);
+    }
+
+    bool isEnd = std::feof(file);
+    std::fclose(file);
+    return isEnd;
+}
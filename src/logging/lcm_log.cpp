@@ -0,0 +1,422 @@
+#include <logging/lcm_log.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const uint32_t kEventSyncWord = 0xEDA1DA01;
+const int kEventHeaderSize = 4 + 8 + 8 + 4 + 4;    // sync, event number, timestamp, channel length, data length
+
+const char kIndexMagic[8] = { 'L', 'C', 'M', 'L', 'O', 'G', 'I', 'X' };
+const uint32_t kIndexVersion = 1;
+
+// LCM logs are big-endian
+uint32_t read_uint32(const uint8_t* data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+int64_t read_int64(const uint8_t* data)
+{
+    return static_cast<int64_t>((uint64_t(read_uint32(data)) << 32) | read_uint32(data + 4));
+}
+
+template <typename T>
+bool write_value(FILE* file, const T& value)
+{
+    return std::fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+bool read_value(FILE* file, T& value)
+{
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+}
+
+
+LcmLog::LcmLog(void)
+: data_(nullptr)
+, size_(0)
+, modifiedTime_(0)
+, isTimeSorted_(true)
+{
+}
+
+
+LcmLog::~LcmLog(void)
+{
+    close();
+}
+
+
+bool LcmLog::open(const std::string& filename, bool saveIndex)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        std::cerr << "ERROR: LcmLog::open: Failed to open " << filename << '\n';
+        return false;
+    }
+
+    struct stat info;
+    if((fstat(fd, &info) != 0) || (info.st_size == 0))
+    {
+        std::cerr << "ERROR: LcmLog::open: " << filename << " is empty or can't be read.\n";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // the mapping stays valid after the descriptor is closed
+
+    if(mapped == MAP_FAILED)
+    {
+        std::cerr << "ERROR: LcmLog::open: Failed to memory-map " << filename << '\n';
+        return false;
+    }
+
+    filename_ = filename;
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = info.st_size;
+    modifiedTime_ = info.st_mtime;
+
+    if(!loadIndex())
+    {
+        rebuildIndex(saveIndex);
+    }
+
+    return true;
+}
+
+
+void LcmLog::close(void)
+{
+    if(data_)
+    {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+
+    filename_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    modifiedTime_ = 0;
+    entries_.clear();
+    channels_.clear();
+    channelEvents_.clear();
+    isTimeSorted_ = true;
+}
+
+
+bool LcmLog::rebuildIndex(bool saveIndex)
+{
+    if(!isOpen())
+    {
+        return false;
+    }
+
+    buildIndex();
+
+    if(saveIndex && !this->saveIndex())
+    {
+        std::cerr << "WARNING: LcmLog::rebuildIndex: Failed to save index to " << indexFilename() << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+
+LcmLogEvent LcmLog::event(std::size_t index) const
+{
+    const uint8_t* header = data_ + entries_[index].offset;
+
+    LcmLogEvent event;
+    event.eventNumber = read_int64(header + 4);
+    event.timestamp = read_int64(header + 12);
+    event.channelLength = static_cast<int32_t>(read_uint32(header + 20));
+    event.dataLength = static_cast<int32_t>(read_uint32(header + 24));
+    event.channel = reinterpret_cast<const char*>(header + kEventHeaderSize);
+    event.channelId = entries_[index].channel;
+    event.data = header + kEventHeaderSize + event.channelLength;
+    event.raw = header;
+    event.offset = entries_[index].offset;
+    event.size = kEventHeaderSize + event.channelLength + event.dataLength;
+    return event;
+}
+
+
+std::size_t LcmLog::seekToTime(int64_t utime) const
+{
+    if(isTimeSorted_)
+    {
+        auto entryIt = std::lower_bound(entries_.begin(), entries_.end(), utime, [](const Entry& entry, int64_t time) {
+            return entry.timestamp < time;
+        });
+        return entryIt - entries_.begin();
+    }
+
+    for(std::size_t n = 0; n < entries_.size(); ++n)
+    {
+        if(entries_[n].timestamp >= utime)
+        {
+            return n;
+        }
+    }
+
+    return entries_.size();
+}
+
+
+int LcmLog::channelId(const std::string& channel) const
+{
+    auto channelIt = std::find(channels_.begin(), channels_.end(), channel);
+    return (channelIt != channels_.end()) ? (channelIt - channels_.begin()) : kInvalidChannel;
+}
+
+
+std::vector<bool> LcmLog::channelMask(const std::vector<std::string>& channels) const
+{
+    std::vector<bool> mask(channels_.size(), false);
+    for(auto& name : channels)
+    {
+        int id = channelId(name);
+        if(id != kInvalidChannel)
+        {
+            mask[id] = true;
+        }
+    }
+    return mask;
+}
+
+
+void LcmLog::buildIndex(void)
+{
+    entries_.clear();
+    channels_.clear();
+
+    // A log is read front to back exactly once while indexing
+    posix_madvise(const_cast<uint8_t*>(data_), size_, POSIX_MADV_SEQUENTIAL);
+
+    uint64_t offset = 0;
+    uint64_t numSkippedBytes = 0;
+
+    while(offset + kEventHeaderSize <= size_)
+    {
+        const uint8_t* header = data_ + offset;
+
+        // If the log is corrupted, step forward until the next sync word is found, just like lcm-logplayer
+        if(read_uint32(header) != kEventSyncWord)
+        {
+            ++offset;
+            ++numSkippedBytes;
+            continue;
+        }
+
+        int32_t channelLength = static_cast<int32_t>(read_uint32(header + 20));
+        int32_t dataLength = static_cast<int32_t>(read_uint32(header + 24));
+
+        if((channelLength <= 0) || (dataLength < 0))
+        {
+            ++offset;
+            ++numSkippedBytes;
+            continue;
+        }
+
+        uint64_t eventSize = uint64_t(kEventHeaderSize) + channelLength + dataLength;
+        if(offset + eventSize > size_)
+        {
+            // The final event was truncated, most likely because the logger was killed
+            break;
+        }
+
+        Entry entry;
+        entry.offset = offset;
+        entry.timestamp = read_int64(header + 12);
+        entry.channel = addChannel(reinterpret_cast<const char*>(header + kEventHeaderSize), channelLength);
+        entry.padding = 0;
+        entries_.push_back(entry);
+
+        offset += eventSize;
+    }
+
+    posix_madvise(const_cast<uint8_t*>(data_), size_, POSIX_MADV_NORMAL);
+
+    if(numSkippedBytes > 0)
+    {
+        std::cerr << "WARNING: LcmLog::buildIndex: Skipped " << numSkippedBytes << " corrupted bytes in " << filename_
+            << '\n';
+    }
+
+    finishIndex();
+}
+
+
+bool LcmLog::loadIndex(void)
+{
+    FILE* file = std::fopen(indexFilename().c_str(), "rb");
+    if(!file)
+    {
+        return false;
+    }
+
+    char magic[sizeof(kIndexMagic)];
+    uint32_t version = 0;
+    uint32_t isTimeSorted = 0;
+    uint64_t logSize = 0;
+    int64_t modifiedTime = 0;
+    uint64_t numChannels = 0;
+
+    bool isValid = (std::fread(magic, sizeof(magic), 1, file) == 1)
+        && (std::memcmp(magic, kIndexMagic, sizeof(magic)) == 0)
+        && read_value(file, version)
+        && (version == kIndexVersion)
+        && read_value(file, isTimeSorted)
+        && read_value(file, logSize)
+        && read_value(file, modifiedTime)
+        && (logSize == size_)
+        && (modifiedTime == modifiedTime_)
+        && read_value(file, numChannels);
+
+    channels_.clear();
+    for(uint64_t n = 0; isValid && (n < numChannels); ++n)
+    {
+        uint32_t length = 0;
+        isValid = read_value(file, length) && (length < size_);
+        if(isValid)
+        {
+            std::string name(length, '\0');
+            isValid = (length == 0) || (std::fread(&name[0], length, 1, file) == 1);
+            channels_.push_back(name);
+        }
+    }
+
+    uint64_t numEntries = 0;
+    isValid = isValid && read_value(file, numEntries) && (numEntries * kEventHeaderSize <= size_);
+    if(isValid)
+    {
+        entries_.resize(numEntries);
+        isValid = (numEntries == 0) || (std::fread(entries_.data(), sizeof(Entry), numEntries, file) == numEntries);
+    }
+
+    std::fclose(file);
+
+    // Make sure the index can't send event() outside of the log
+    for(std::size_t n = 0; isValid && (n < entries_.size()); ++n)
+    {
+        isValid = (entries_[n].offset + kEventHeaderSize <= size_) && (entries_[n].channel < channels_.size());
+    }
+
+    if(!isValid)
+    {
+        entries_.clear();
+        channels_.clear();
+        return false;
+    }
+
+    finishIndex();
+    return true;
+}
+
+
+bool LcmLog::saveIndex(void) const
+{
+    // Write to a temporary file first so a reader never sees a partially written index
+    std::string tempFilename = indexFilename() + ".tmp";
+    FILE* file = std::fopen(tempFilename.c_str(), "wb");
+    if(!file)
+    {
+        return false;
+    }
+
+    uint32_t isTimeSorted = isTimeSorted_;
+    uint64_t numChannels = channels_.size();
+    uint64_t numEntries = entries_.size();
+
+    bool success = (std::fwrite(kIndexMagic, sizeof(kIndexMagic), 1, file) == 1)
+        && write_value(file, kIndexVersion)
+        && write_value(file, isTimeSorted)
+        && write_value(file, size_)
+        && write_value(file, modifiedTime_)
+        && write_value(file, numChannels);
+
+    for(auto& name : channels_)
+    {
+        uint32_t length = name.length();
+        success = success && write_value(file, length) && (std::fwrite(name.data(), 1, length, file) == length);
+    }
+
+    success = success
+        && write_value(file, numEntries)
+        && (std::fwrite(entries_.data(), sizeof(Entry), numEntries, file) == numEntries);
+
+    success = (std::fclose(file) == 0) && success;
+    success = success && (std::rename(tempFilename.c_str(), indexFilename().c_str()) == 0);
+
+    if(!success)
+    {
+        std::remove(tempFilename.c_str());
+    }
+
+    return success;
+}
+
+
+void LcmLog::finishIndex(void)
+{
+    channelEvents_.assign(channels_.size(), std::vector<uint32_t>());
+    isTimeSorted_ = true;
+
+    for(std::size_t n = 0; n < entries_.size(); ++n)
+    {
+        channelEvents_[entries_[n].channel].push_back(n);
+
+        if((n > 0) && (entries_[n].timestamp < entries_[n - 1].timestamp))
+        {
+            isTimeSorted_ = false;
+        }
+    }
+}
+
+
+uint32_t LcmLog::addChannel(const char* name, int32_t length)
+{
+    // Logs only contain a handful of channels, so a linear search is faster than hashing a new string for every event
+    for(std::size_t n = 0; n < channels_.size(); ++n)
+    {
+        if((channels_[n].length() == std::size_t(length)) && (std::memcmp(channels_[n].data(), name, length) == 0))
+        {
+            return n;
+        }
+    }
+
+    channels_.push_back(std::string(name, length));
+    return channels_.size() - 1;
+}
+
+
+std::vector<std::string> split_channels(const std::string& channels)
+{
+    std::vector<std::string> names;
+    std::istringstream in(channels);
+    std::string name;
+    while(std::getline(in, name, ','))
+    {
+        if(!name.empty())
+        {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
@@ -0,0 +1,212 @@
+#ifndef LOGGING_LCM_LOG_HPP
+#define LOGGING_LCM_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* LcmLogEvent is a single message in an LCM log. The channel and data point directly into the memory-mapped log, so they
+* are only valid while the LcmLog that returned the event is open.
+*
+* To decode the message:
+*
+*   lidar_t scan;
+*   scan.decode(event.data, 0, event.dataLength);
+*/
+struct LcmLogEvent
+{
+    int64_t eventNumber;        ///< Event number assigned by the logger
+    int64_t timestamp;          ///< Time the logger received the message (microseconds)
+    const char* channel;        ///< Channel name -- NOT null-terminated
+    int32_t channelLength;      ///< Number of characters in the channel name
+    int channelId;              ///< Id of the channel, i.e. its index in LcmLog::channels()
+    const uint8_t* data;        ///< Encoded message
+    int32_t dataLength;         ///< Number of bytes in the encoded message
+    const uint8_t* raw;         ///< Start of the event in the log, for copying the event unchanged
+    uint64_t offset;            ///< Offset of the start of the event in the log file
+    uint64_t size;              ///< Total number of bytes of the event in the log file, including its header
+};
+
+
+/**
+* LcmLog provides random access to an LCM log file written by lcm-logger.
+*
+* The log is memory-mapped and an index of every event (file offset, timestamp, channel) is kept alongside it in a
+* sidecar file named <log>.idx. The first time a log is opened, the index is built with a single pass over the file
+* and saved. Later opens just load the index, so jumping to a point in a multi-GB log is a binary search rather than a
+* pass over everything before it.
+*
+* The index is rebuilt automatically if the log's size or modification time no longer matches the sidecar.
+*
+* Events are referred to by their index in the log, 0 <= index < numEvents(). The events of a single channel are
+* available via channelEvents, and forEachEvent iterates over a time range for a subset of channels.
+*
+* Seeking by time assumes the timestamps in the log are non-decreasing, which is true for logs written by lcm-logger.
+* If a log isn't sorted by time, the seek falls back to a linear search.
+*/
+class LcmLog
+{
+public:
+
+    static const int kInvalidChannel = -1;
+
+    LcmLog(void);
+    ~LcmLog(void);
+
+    LcmLog(const LcmLog&) = delete;
+    LcmLog& operator=(const LcmLog&) = delete;
+
+    /**
+    * open memory-maps a log file and loads its index, building the index if needed.
+    *
+    * \param    filename            Log file to open
+    * \param    saveIndex           Flag indicating if a newly built index should be written to <filename>.idx
+    * \return   True if the log was opened. If false, an error message is printed.
+    */
+    bool open(const std::string& filename, bool saveIndex = true);
+
+    /**
+    * close unmaps the log. All events returned by the log are invalid afterward.
+    */
+    void close(void);
+
+    bool isOpen(void) const { return data_ != nullptr; }
+
+    /**
+    * rebuildIndex discards the current index and rebuilds it from the log contents.
+    *
+    * \param    saveIndex           Flag indicating if the new index should be written to the sidecar file
+    * \return   True if the index was written successfully (or if saveIndex was false).
+    */
+    bool rebuildIndex(bool saveIndex = true);
+
+    // Properties of the log
+    const std::string& filename(void) const { return filename_; }
+    uint64_t sizeInBytes(void) const { return size_; }
+    std::size_t numEvents(void) const { return entries_.size(); }
+    int64_t startTime(void) const { return entries_.empty() ? 0 : entries_.front().timestamp; }
+    int64_t endTime(void) const { return entries_.empty() ? 0 : entries_.back().timestamp; }
+
+    /**
+    * event retrieves an event from the log.
+    *
+    * \param    index               Index of the event, 0 <= index < numEvents()
+    */
+    LcmLogEvent event(std::size_t index) const;
+
+    /**
+    * eventTimestamp retrieves the timestamp of an event directly from the index without touching the log.
+    */
+    int64_t eventTimestamp(std::size_t index) const { return entries_[index].timestamp; }
+
+    /**
+    * eventChannel retrieves the channel id of an event directly from the index without touching the log.
+    */
+    int eventChannel(std::size_t index) const { return entries_[index].channel; }
+
+    /**
+    * seekToTime finds the first event in the log with timestamp >= utime.
+    *
+    * \param    utime               Time to seek to (microseconds)
+    * \return   Index of the first event at or after utime. numEvents() if there isn't one.
+    */
+    std::size_t seekToTime(int64_t utime) const;
+
+    // Channels that appear in the log, in order of first appearance. A channel id is the index into this vector.
+    const std::vector<std::string>& channels(void) const { return channels_; }
+
+    /**
+    * channelId finds the id of a channel.
+    *
+    * \return   Id of the channel or kInvalidChannel if the channel doesn't appear in the log.
+    */
+    int channelId(const std::string& channel) const;
+
+    /**
+    * channelEvents retrieves the indices of every event on a channel, in log order.
+    */
+    const std::vector<uint32_t>& channelEvents(int channel) const { return channelEvents_[channel]; }
+
+    /**
+    * forEachEvent calls f(const LcmLogEvent&) for every event in [startTime, endTime) whose channel is in the mask.
+    * Events are visited in log order.
+    *
+    * \param    startTime           First time to include (microseconds)
+    * \param    endTime             First time not to include (microseconds)
+    * \param    channelMask         channelMask[id] is true if events on channel id should be visited. If empty, every
+    *                               channel is visited.
+    * \param    f                   Function to call for each event
+    * \return   Number of events visited.
+    */
+    template <class Function>
+    std::size_t forEachEvent(int64_t startTime, int64_t endTime, const std::vector<bool>& channelMask, Function f) const
+    {
+        std::size_t numVisited = 0;
+        for(std::size_t n = seekToTime(startTime); n < entries_.size(); ++n)
+        {
+            if(entries_[n].timestamp >= endTime)
+            {
+                if(isTimeSorted_)
+                {
+                    break;
+                }
+                continue;
+            }
+            else if(entries_[n].timestamp < startTime)
+            {
+                continue;   // only possible if the log isn't sorted by time
+            }
+
+            if(channelMask.empty() || channelMask[entries_[n].channel])
+            {
+                f(event(n));
+                ++numVisited;
+            }
+        }
+        return numVisited;
+    }
+
+    /**
+    * channelMask creates a mask for forEachEvent that includes the named channels. Names that don't appear in the log
+    * are ignored.
+    */
+    std::vector<bool> channelMask(const std::vector<std::string>& channels) const;
+
+private:
+
+    // The index entry for one event
+    struct Entry
+    {
+        uint64_t offset;        // offset of the event in the log
+        int64_t timestamp;      // timestamp of the event
+        uint32_t channel;       // channel id of the event
+        uint32_t padding;       // keeps the entry layout identical in memory and in the index file
+    };
+
+    std::string filename_;
+    const uint8_t* data_;               // memory-mapped log
+    uint64_t size_;                     // size of the log in bytes
+    int64_t modifiedTime_;              // modification time of the log, used to validate the index
+
+    std::vector<Entry> entries_;                        // every event in log order
+    std::vector<std::string> channels_;                 // name of each channel id
+    std::vector<std::vector<uint32_t>> channelEvents_;  // events on each channel
+    bool isTimeSorted_;                                 // flag indicating if the timestamps never decrease
+
+    std::string indexFilename(void) const { return filename_ + ".idx"; }
+    void buildIndex(void);
+    bool loadIndex(void);
+    bool saveIndex(void) const;
+    void finishIndex(void);
+    uint32_t addChannel(const char* name, int32_t length);
+};
+
+
+/**
+* split_channels splits a comma-separated list of channel names, e.g. from a --channels option. Empty names are skipped.
+*/
+std::vector<std::string> split_channels(const std::string& channels);
+
+#endif // LOGGING_LCM_LOG_HPP
@@ -0,0 +1,360 @@
+#include <logging/lcm_log.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The LCM log test checks LcmLog against a synthetic log written in the lcm-logger format:
+*
+*   - every event is indexed with the right channel, timestamp, event number, and data, including when the index is
+*     loaded from the sidecar file instead of being built, and corrupted bytes and a truncated final event are skipped,
+*   - seekToTime, channelEvents, and forEachEvent with a channel mask and time range visit exactly the expected events,
+*   - split_channels and channelMask handle empty and unknown channel names.
+*/
+
+
+const char* kLogFilename = "lcm_log_test.log";
+const int kNumEvents = 300;
+const int64_t kStartTime = 1000000;
+const int64_t kTimeStep = 10000;
+const uint64_t kEventHeaderSize = 4 + 8 + 8 + 4 + 4;    // sync, event number, timestamp, channel length, data length
+
+
+// Description of one event written to the synthetic log
+struct TestEvent
+{
+    int64_t timestamp;
+    std::string channel;
+    std::vector<uint8_t> data;
+};
+
+
+bool test_index(void);
+bool test_seek_and_ranges(void);
+bool test_channel_names(void);
+
+std::vector<TestEvent> make_events(void);
+bool write_log(const std::vector<TestEvent>& events, const std::string& filename);
+bool is_same_event(const LcmLogEvent& logEvent, const TestEvent& event, int64_t eventNumber);
+void remove_log(void);
+
+
+int main(int argc, char** argv)
+{
+    if(test_index())
+    {
+        std::cout << "PASSED: test_index\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_index\n";
+    }
+
+    if(test_seek_and_ranges())
+    {
+        std::cout << "PASSED: test_seek_and_ranges\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_seek_and_ranges\n";
+    }
+
+    if(test_channel_names())
+    {
+        std::cout << "PASSED: test_channel_names\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_channel_names\n";
+    }
+
+    remove_log();
+    return 0;
+}
+
+
+bool test_index(void)
+{
+    std::vector<TestEvent> events = make_events();
+    remove_log();
+    if(!write_log(events, kLogFilename))
+    {
+        std::cout << "Failed to write " << kLogFilename << '\n';
+        return false;
+    }
+
+    // The first open builds and saves the index, the second loads it
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        LcmLog log;
+        if(!log.open(kLogFilename))
+        {
+            return false;
+        }
+
+        if(log.numEvents() != events.size())
+        {
+            std::cout << "Pass " << pass << ": indexed " << log.numEvents() << " events instead of " << events.size()
+                << '\n';
+            return false;
+        }
+
+        if((log.channels().size() != 3) || (log.startTime() != events.front().timestamp)
+            || (log.endTime() != events.back().timestamp))
+        {
+            std::cout << "Pass " << pass << ": wrong channels or time range\n";
+            return false;
+        }
+
+        std::size_t numChannelEvents = 0;
+        for(std::size_t id = 0; id < log.channels().size(); ++id)
+        {
+            for(auto index : log.channelEvents(id))
+            {
+                if(events[index].channel != log.channels()[id])
+                {
+                    std::cout << "Pass " << pass << ": event " << index << " listed on the wrong channel\n";
+                    return false;
+                }
+            }
+            numChannelEvents += log.channelEvents(id).size();
+        }
+
+        if(numChannelEvents != events.size())
+        {
+            std::cout << "Pass " << pass << ": channel event lists don't cover the log\n";
+            return false;
+        }
+
+        for(std::size_t n = 0; n < events.size(); ++n)
+        {
+            if(!is_same_event(log.event(n), events[n], n)
+                || (log.eventTimestamp(n) != events[n].timestamp)
+                || (log.channels()[log.eventChannel(n)] != events[n].channel))
+            {
+                std::cout << "Pass " << pass << ": event " << n << " doesn't match the event written\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_seek_and_ranges(void)
+{
+    std::vector<TestEvent> events = make_events();
+    remove_log();
+    if(!write_log(events, kLogFilename))
+    {
+        std::cout << "Failed to write " << kLogFilename << '\n';
+        return false;
+    }
+
+    LcmLog log;
+    if(!log.open(kLogFilename, false))
+    {
+        return false;
+    }
+
+    for(std::size_t n = 0; n < events.size(); ++n)
+    {
+        // Seeking to an event's time or just after the previous event lands on the event
+        if((log.seekToTime(events[n].timestamp) != n) || (log.seekToTime(events[n].timestamp - kTimeStep + 1) != n))
+        {
+            std::cout << "seekToTime didn't find event " << n << '\n';
+            return false;
+        }
+    }
+
+    if((log.seekToTime(0) != 0) || (log.seekToTime(events.back().timestamp + 1) != log.numEvents()))
+    {
+        std::cout << "seekToTime failed before the start or after the end of the log\n";
+        return false;
+    }
+
+    std::vector<std::vector<std::string>> masks = { {}, { "LIDAR" }, { "ODOMETRY", "SLAM_POSE" } };
+    for(auto& maskChannels : masks)
+    {
+        std::vector<bool> mask = log.channelMask(maskChannels);
+        if(maskChannels.empty())
+        {
+            mask.clear();
+        }
+
+        int64_t startTime = events[50].timestamp;
+        int64_t endTime = events[200].timestamp;
+
+        std::vector<int64_t> expected;
+        for(std::size_t n = 0; n < events.size(); ++n)
+        {
+            bool isInMask = maskChannels.empty();
+            for(auto& channel : maskChannels)
+            {
+                isInMask |= (channel == events[n].channel);
+            }
+
+            if(isInMask && (events[n].timestamp >= startTime) && (events[n].timestamp < endTime))
+            {
+                expected.push_back(n);
+            }
+        }
+
+        std::vector<int64_t> visited;
+        std::size_t numVisited = log.forEachEvent(startTime, endTime, mask, [&](const LcmLogEvent& event) {
+            visited.push_back(event.eventNumber);
+        });
+
+        if((numVisited != visited.size()) || (visited != expected))
+        {
+            std::cout << "forEachEvent visited " << visited.size() << " events instead of " << expected.size()
+                << " with a mask of " << maskChannels.size() << " channels\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_channel_names(void)
+{
+    std::vector<std::string> names = split_channels("LIDAR,,ODOMETRY,");
+    if((names.size() != 2) || (names[0] != "LIDAR") || (names[1] != "ODOMETRY") || !split_channels("").empty())
+    {
+        std::cout << "split_channels didn't skip empty names\n";
+        return false;
+    }
+
+    remove_log();
+    if(!write_log(make_events(), kLogFilename))
+    {
+        std::cout << "Failed to write " << kLogFilename << '\n';
+        return false;
+    }
+
+    LcmLog log;
+    if(!log.open(kLogFilename, false))
+    {
+        return false;
+    }
+
+    std::vector<bool> mask = log.channelMask(split_channels("ODOMETRY,MISSING"));
+    int odometryId = log.channelId("ODOMETRY");
+    if((log.channelId("MISSING") != LcmLog::kInvalidChannel) || (odometryId == LcmLog::kInvalidChannel)
+        || (mask.size() != log.channels().size()))
+    {
+        std::cout << "channelId or channelMask mishandled an unknown channel\n";
+        return false;
+    }
+
+    for(std::size_t id = 0; id < mask.size(); ++id)
+    {
+        if(mask[id] != (static_cast<int>(id) == odometryId))
+        {
+            std::cout << "channelMask included the wrong channels\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::vector<TestEvent> make_events(void)
+{
+    const char* kChannels[] = { "LIDAR", "ODOMETRY", "SLAM_POSE" };
+
+    // Interleave the channels unevenly and vary the message sizes, including empty messages
+    std::vector<TestEvent> events(kNumEvents);
+    for(int n = 0; n < kNumEvents; ++n)
+    {
+        events[n].timestamp = kStartTime + n * kTimeStep;
+        events[n].channel = kChannels[(n % 7 == 0) ? 0 : ((n % 3 == 0) ? 2 : 1)];
+        events[n].data.resize((n * 37) % 101);
+        for(std::size_t i = 0; i < events[n].data.size(); ++i)
+        {
+            events[n].data[i] = static_cast<uint8_t>(n + i);
+        }
+    }
+    return events;
+}
+
+
+void write_uint32(uint32_t value, std::vector<uint8_t>& out)
+{
+    for(int shift = 24; shift >= 0; shift -= 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+
+void write_int64(int64_t value, std::vector<uint8_t>& out)
+{
+    write_uint32(static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32), out);
+    write_uint32(static_cast<uint32_t>(value), out);
+}
+
+
+bool write_log(const std::vector<TestEvent>& events, const std::string& filename)
+{
+    const uint32_t kSyncWord = 0xEDA1DA01;
+
+    std::vector<uint8_t> log;
+    for(std::size_t n = 0; n < events.size(); ++n)
+    {
+        // A few garbage bytes between events, as left by a corrupted write, must be skipped
+        if(n == events.size() / 2)
+        {
+            log.insert(log.end(), { 0xED, 0xA1, 0x00, 0x42, 0x17 });
+        }
+
+        write_uint32(kSyncWord, log);
+        write_int64(n, log);
+        write_int64(events[n].timestamp, log);
+        write_uint32(events[n].channel.length(), log);
+        write_uint32(events[n].data.size(), log);
+        log.insert(log.end(), events[n].channel.begin(), events[n].channel.end());
+        log.insert(log.end(), events[n].data.begin(), events[n].data.end());
+    }
+
+    // The logger was killed partway through writing the final event
+    write_uint32(kSyncWord, log);
+    write_int64(events.size(), log);
+    write_int64(events.back().timestamp + kTimeStep, log);
+    write_uint32(5, log);
+    write_uint32(1000, log);
+    log.insert(log.end(), { 'L', 'I', 'D', 'A', 'R', 0x01, 0x02 });
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if(!file)
+    {
+        return false;
+    }
+
+    bool success = std::fwrite(log.data(), 1, log.size(), file) == log.size();
+    return (std::fclose(file) == 0) && success;
+}
+
+
+bool is_same_event(const LcmLogEvent& logEvent, const TestEvent& event, int64_t eventNumber)
+{
+    return (logEvent.eventNumber == eventNumber)
+        && (logEvent.timestamp == event.timestamp)
+        && (std::string(logEvent.channel, logEvent.channelLength) == event.channel)
+        && (logEvent.dataLength == static_cast<int32_t>(event.data.size()))
+        && (event.data.empty() || (std::memcmp(logEvent.data, event.data.data(), event.data.size()) == 0))
+        && (logEvent.size == kEventHeaderSize + event.channel.length() + event.data.size());
+}
+
+
+void remove_log(void)
+{
+    std::remove(kLogFilename);
+    std::remove((std::string(kLogFilename) + ".idx").c_str());
+}
@@ -0,0 +1,188 @@
+#include <logging/lcm_log.hpp>
+#include <common/getopt.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+void print_usage(getopt_t* gopt, const char* program)
+{
+    printf("Usage: %s [options] <command> <log> [output]\n\n"
+           "Commands:\n"
+           "  info    Print the channels, message counts, and duration of the log\n"
+           "  index   Rebuild the <log>.idx index used for seeking\n"
+           "  list    Print the time, channel, and size of each message\n"
+           "  slice   Copy the messages within [start, end) on the selected channels to the output log\n\n"
+           "Options:\n", program);
+    getopt_do_usage(gopt);
+}
+
+
+void print_info(const LcmLog& log)
+{
+    double duration = (log.endTime() - log.startTime()) / 1.0e6;
+
+    printf("Log:      %s\n", log.filename().c_str());
+    printf("Size:     %.1f MB\n", log.sizeInBytes() / 1.0e6);
+    printf("Events:   %zu\n", log.numEvents());
+    printf("Duration: %.3f s\n\n", duration);
+    printf("%-32s %10s %10s %12s\n", "Channel", "Events", "Rate (Hz)", "Size (MB)");
+
+    for(std::size_t id = 0; id < log.channels().size(); ++id)
+    {
+        const std::vector<uint32_t>& events = log.channelEvents(id);
+
+        uint64_t numBytes = 0;
+        for(auto index : events)
+        {
+            numBytes += log.event(index).size;
+        }
+
+        printf("%-32s %10zu %10.1f %12.2f\n",
+               log.channels()[id].c_str(),
+               events.size(),
+               (duration > 0.0) ? events.size() / duration : 0.0,
+               numBytes / 1.0e6);
+    }
+}
+
+
+/**
+* slice_log copies the selected events to a new log. Events that are adjacent in the source log are copied with a
+* single write, so slicing all channels is a straight copy of one contiguous byte range.
+*/
+bool slice_log(const LcmLog& log,
+               const std::string& outputFilename,
+               int64_t startTime,
+               int64_t endTime,
+               const std::vector<bool>& channelMask)
+{
+    FILE* out = std::fopen(outputFilename.c_str(), "wb");
+    if(!out)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s for writing.\n", outputFilename.c_str());
+        return false;
+    }
+
+    const uint8_t* runStart = nullptr;
+    std::size_t runLength = 0;
+    bool success = true;
+
+    std::size_t numEvents = log.forEachEvent(startTime, endTime, channelMask, [&](const LcmLogEvent& event) {
+        if(runStart && (runStart + runLength == event.raw))
+        {
+            runLength += event.size;
+            return;
+        }
+
+        if(runStart)
+        {
+            success = success && (std::fwrite(runStart, 1, runLength, out) == runLength);
+        }
+
+        runStart = event.raw;
+        runLength = event.size;
+    });
+
+    if(runStart)
+    {
+        success = success && (std::fwrite(runStart, 1, runLength, out) == runLength);
+    }
+
+    success = (std::fclose(out) == 0) && success;
+
+    if(!success)
+    {
+        fprintf(stderr, "ERROR: Failed to write %s.\n", outputFilename.c_str());
+        return false;
+    }
+
+    printf("Wrote %zu events to %s\n", numEvents, outputFilename.c_str());
+    return true;
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* kStartArg = "start";
+    const char* kEndArg = "end";
+    const char* kChannelsArg = "channels";
+
+    getopt_t* gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_double(gopt, 's', kStartArg, "0", "Start of the time range, in seconds from the start of the log");
+    getopt_add_double(gopt, 'e', kEndArg, "-1", "End of the time range, in seconds from the start of the log (-1 = end)");
+    getopt_add_string(gopt, 'c', kChannelsArg, "", "Comma-separated channels to include (default = all)");
+
+    if(!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help"))
+    {
+        print_usage(gopt, argv[0]);
+        return 1;
+    }
+
+    const zarray_t* args = getopt_get_extra_args(gopt);
+    if(zarray_size(args) < 2)
+    {
+        print_usage(gopt, argv[0]);
+        return 1;
+    }
+
+    char* command = nullptr;
+    char* logFilename = nullptr;
+    zarray_get(args, 0, &command);
+    zarray_get(args, 1, &logFilename);
+
+    LcmLog log;
+    if(!log.open(logFilename))
+    {
+        return 1;
+    }
+
+    int64_t startTime = log.startTime() + static_cast<int64_t>(getopt_get_double(gopt, kStartArg) * 1.0e6);
+    int64_t endTime = (getopt_get_double(gopt, kEndArg) < 0.0)
+        ? log.endTime() + 1
+        : log.startTime() + static_cast<int64_t>(getopt_get_double(gopt, kEndArg) * 1.0e6);
+    std::vector<bool> channelMask = log.channelMask(split_channels(getopt_get_string(gopt, kChannelsArg)));
+    if(std::strlen(getopt_get_string(gopt, kChannelsArg)) == 0)
+    {
+        channelMask.clear();
+    }
+
+    int result = 0;
+
+    if(std::strcmp(command, "info") == 0)
+    {
+        print_info(log);
+    }
+    else if(std::strcmp(command, "index") == 0)
+    {
+        result = log.rebuildIndex() ? 0 : 1;
+        printf("Indexed %zu events in %s\n", log.numEvents(), log.filename().c_str());
+    }
+    else if(std::strcmp(command, "list") == 0)
+    {
+        log.forEachEvent(startTime, endTime, channelMask, [&log](const LcmLogEvent& event) {
+            printf("%12.6f %-32.*s %10d\n",
+                   (event.timestamp - log.startTime()) / 1.0e6,
+                   event.channelLength,
+                   event.channel,
+                   event.dataLength);
+        });
+    }
+    else if((std::strcmp(command, "slice") == 0) && (zarray_size(args) > 2))
+    {
+        char* outputFilename = nullptr;
+        zarray_get(args, 2, &outputFilename);
+        result = slice_log(log, outputFilename, startTime, endTime, channelMask) ? 0 : 1;
+    }
+    else
+    {
+        print_usage(gopt, argv[0]);
+        result = 1;
+    }
+
+    getopt_destroy(gopt);
+    return result;
+}
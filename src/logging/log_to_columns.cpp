@@ -0,0 +1,184 @@
+#include <logging/channel_exporter.hpp>
+#include <logging/lcm_log.hpp>
+#include <common/getopt.h>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+
+int main(int argc, char** argv)
+{
+    const char* kStartArg = "start";
+    const char* kEndArg = "end";
+    const char* kChannelsArg = "channels";
+    const char* kTypesArg = "types";
+
+    getopt_t* gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_double(gopt, 's', kStartArg, "0", "Start of the time range, in seconds from the start of the log");
+    getopt_add_double(gopt, 'e', kEndArg, "-1", "End of the time range, in seconds from the start of the log (-1 = end)");
+    getopt_add_string(gopt, 'c', kChannelsArg, "", "Comma-separated channels to export (default = all supported)");
+    getopt_add_string(gopt, 't', kTypesArg, "", "Comma-separated CHANNEL=type pairs for the odometry_t and pose_xyt_t "
+                      "channels (default = odometry_t if the name contains ODOMETRY, else pose_xyt_t)");
+
+    const zarray_t* args = nullptr;
+    std::map<std::string, std::string> channelTypes;
+    if(getopt_parse(gopt, argc, argv, 1) && !getopt_get_bool(gopt, "help")
+        && parse_channel_types(getopt_get_string(gopt, kTypesArg), channelTypes))
+    {
+        args = getopt_get_extra_args(gopt);
+    }
+
+    if(!args || (zarray_size(args) < 2))
+    {
+        printf("Usage: %s [options] <log> <output directory>\n\n"
+               "Exports the lidar_t, odometry_t, pose_xyt_t, and mbot_encoder_t channels of a log to flat binary\n"
+               "column files. See manifest.json in the output directory for the layout. odometry_t and pose_xyt_t\n"
+               "can't be told apart from the messages, so use --types for channels not named like the defaults.\n\n"
+               "Options:\n", argv[0]);
+        getopt_do_usage(gopt);
+        return 1;
+    }
+
+    // The columns are written in native byte order, which is only correct on little-endian machines
+    const uint16_t kEndianTest = 1;
+    if(*reinterpret_cast<const uint8_t*>(&kEndianTest) != 1)
+    {
+        fprintf(stderr, "ERROR: log_to_columns only supports little-endian machines.\n");
+        return 1;
+    }
+
+    char* logFilename = nullptr;
+    char* outputDirectory = nullptr;
+    zarray_get(args, 0, &logFilename);
+    zarray_get(args, 1, &outputDirectory);
+
+    LcmLog log;
+    if(!log.open(logFilename))
+    {
+        return 1;
+    }
+
+    if((mkdir(outputDirectory, 0755) != 0) && (errno != EEXIST))
+    {
+        fprintf(stderr, "ERROR: Failed to create %s\n", outputDirectory);
+        return 1;
+    }
+
+    std::vector<std::string> requestedChannels = split_channels(getopt_get_string(gopt, kChannelsArg));
+    std::vector<bool> requestedMask = log.channelMask(requestedChannels);
+
+    // Find the exporter for every channel, indexed by channel id so each event is a single lookup
+    std::vector<std::unique_ptr<ChannelExporter>> exporters(log.channels().size());
+    std::vector<bool> exportMask(log.channels().size(), false);
+
+    for(std::size_t id = 0; id < log.channels().size(); ++id)
+    {
+        if(!requestedChannels.empty() && !requestedMask[id])
+        {
+            continue;
+        }
+
+        exporters[id] = create_exporter(log.channels()[id], log.event(log.channelEvents(id).front()), channelTypes);
+        if(!exporters[id])
+        {
+            if(!requestedChannels.empty())
+            {
+                printf("Skipping %s: not one of the supported types\n", log.channels()[id].c_str());
+            }
+            continue;
+        }
+
+        if(!exporters[id]->open(outputDirectory))
+        {
+            return 1;
+        }
+
+        exportMask[id] = true;
+    }
+
+    int64_t startTime = log.startTime() + static_cast<int64_t>(getopt_get_double(gopt, kStartArg) * 1.0e6);
+    int64_t endTime = (getopt_get_double(gopt, kEndArg) < 0.0)
+        ? log.endTime() + 1
+        : log.startTime() + static_cast<int64_t>(getopt_get_double(gopt, kEndArg) * 1.0e6);
+
+    int64_t conversionStart = utime_now();
+    uint64_t numBytes = 0;
+
+    // An empty mask means every channel, so skip the pass entirely if nothing is being exported
+    if(std::find(exportMask.begin(), exportMask.end(), true) != exportMask.end())
+    {
+        log.forEachEvent(startTime, endTime, exportMask, [&](const LcmLogEvent& event) {
+            exporters[event.channelId]->add(event);
+            numBytes += event.size;
+        });
+    }
+
+    bool success = true;
+    for(auto& exporter : exporters)
+    {
+        if(exporter)
+        {
+            success = exporter->close() && success;
+        }
+    }
+
+    double elapsedSeconds = (utime_now() - conversionStart) / 1.0e6;
+
+    std::string manifestFilename = std::string(outputDirectory) + "/manifest.json";
+    std::ofstream manifest(manifestFilename);
+    manifest << "{\n"
+             << "  \"source\": \"" << logFilename << "\",\n"
+             << "  \"byte_order\": \"little\",\n"
+             << "  \"channels\": [\n";
+
+    bool isFirstChannel = true;
+    for(auto& exporter : exporters)
+    {
+        if(exporter)
+        {
+            manifest << (isFirstChannel ? "" : ",\n");
+            exporter->writeManifest(manifest);
+            isFirstChannel = false;
+        }
+    }
+
+    manifest << "\n  ]\n}\n";
+    manifest.close();
+    success = success && !manifest.fail();
+
+    for(auto& exporter : exporters)
+    {
+        if(exporter)
+        {
+            printf("%-24s %-16s %10" PRIu64 " messages", exporter->channel().c_str(), exporter->type().c_str(),
+                   exporter->numMessages());
+            if(exporter->numDecodeErrors() > 0)
+            {
+                printf(" (%" PRIu64 " failed to decode)", exporter->numDecodeErrors());
+            }
+            printf("\n");
+        }
+    }
+
+    printf("Converted %.1f MB in %.2f s (%.0f MB/s)\n",
+           numBytes / 1.0e6,
+           elapsedSeconds,
+           (elapsedSeconds > 0.0) ? numBytes / 1.0e6 / elapsedSeconds : 0.0);
+
+    if(!success)
+    {
+        fprintf(stderr, "ERROR: Failed to write the columns to %s\n", outputDirectory);
+    }
+
+    getopt_destroy(gopt);
+    return success ? 0 : 1;
+}
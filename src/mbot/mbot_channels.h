@@ -7,6 +7,8 @@
 #define MBOT_IMU_CHANNEL "MBOT_IMU"
 #define MBOT_ENCODERS_CHANNEL "MBOT_ENCODERS"
 #define LIDAR_CHANNEL "LIDAR"
+#define LIDAR_COMPACT_CHANNEL "LIDAR_COMPACT"
+#define LIDAR_SECTOR_CHANNEL "LIDAR_SECTOR"
 #define WIFI_READINGS_CHANNEL "WIFI"
 
 //////// Additional channels for processes that run on the Mbot -- odometry and motion_controller.
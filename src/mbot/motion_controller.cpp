@@ -9,6 +9,7 @@
 #include <common/angle_functions.hpp>
 #include <common/pose_trace.hpp>
 #include <common/lcm_config.h>
+#include <common/getopt.h>
 #include <slam/slam_channels.h>
 #include <lcm/lcm-cpp.hpp>
 #include <algorithm>
@@ -38,8 +39,15 @@ public:
     
     /**
     * Constructor for MotionController.
+    *
+    * \param    instance                    Instance of LCM to use for communication
+    * \param    shouldDriveThroughWaypoints Flag indicating if the robot keeps driving through waypoints that are nearly
+    *                                       straight ahead, like those along the arcs of a lattice path, instead of
+    *                                       stopping to turn toward every waypoint
     */
-    MotionController(lcm::LCM * instance) : lcmInstance(instance)
+    MotionController(lcm::LCM * instance, bool shouldDriveThroughWaypoints)
+    : shouldDriveThroughWaypoints_(shouldDriveThroughWaypoints)
+    , lcmInstance(instance)
     {
         ////////// TODO: Initialize your controller state //////////////
         
@@ -255,6 +263,8 @@ private:
     PoseTrace  odomTrace_;              // trace of odometry for maintaining the offset estimate
     std::vector<pose_xyt_t> targets_;
     
+    bool shouldDriveThroughWaypoints_;  // don't stop to turn toward waypoints nearly straight ahead
+
     // Error terms for the current target
     State state_;
     double lastError_;      // for D-term
@@ -311,7 +321,21 @@ private:
         lastError_ = 0.0f;
         totalError_ = 0.0f;
         state_ = TURN;
-        
+
+        // Keep driving through waypoints that are nearly straight ahead, like those along the arcs of a lattice path,
+        // rather than stopping to turn toward each one. Grid paths turn in place at their corners, so they only do
+        // this if requested.
+        const float kMaxDrivingHeadingError = 0.5f;
+        if(shouldDriveThroughWaypoints_ && !targets_.empty() && !odomTrace_.empty())
+        {
+            pose_xyt_t pose = currentPose();
+            double targetHeading = std::atan2(targets_.back().y - pose.y, targets_.back().x - pose.x);
+            if(std::abs(angle_diff(targetHeading, pose.theta)) < kMaxDrivingHeadingError)
+            {
+                state_ = DRIVE;
+            }
+        }
+
         return !targets_.empty();
     }
     
@@ -346,9 +370,23 @@ private:
 
 int main(int argc, char** argv)
 {
+    const char* kDriveThroughArg = "drive-through-waypoints";
+
+    getopt_t *gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_bool(gopt, '\0', kDriveThroughArg, 0,
+                    "Flag indicating if the robot should keep driving through waypoints nearly straight ahead instead "
+                    "of stopping to turn toward each one. Use it for lattice paths, e.g. exploration --lattice-paths.");
+
+    if (!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help")) {
+        printf("Usage: %s [options]", argv[0]);
+        getopt_do_usage(gopt);
+        return 1;
+    }
+
     lcm::LCM lcmInstance(MULTICAST_URL);
     
-    MotionController controller(&lcmInstance);
+    MotionController controller(&lcmInstance, getopt_get_bool(gopt, kDriveThroughArg));
     lcmInstance.subscribe(ODOMETRY_CHANNEL, &MotionController::handleOdometry, &controller);
     lcmInstance.subscribe(SLAM_POSE_CHANNEL, &MotionController::handlePose, &controller);
     lcmInstance.subscribe(CONTROLLER_PATH_CHANNEL, &MotionController::handlePath, &controller);
@@ -1,18 +1,29 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
 
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
 #include <signal.h>
 #include <sys/time.h>
 
 #include <lcm/lcm-cpp.hpp>
 #include <lcmtypes/lidar_t.hpp>
+#include <lcmtypes/lidar_compact_t.hpp>
 
 #include <common/rplidar.h>
 #include <common/lcm_config.h> 
 #include <common/timestamp.h>
+#include <common/lidar_compact.hpp>
+#include <common/spsc_ring.hpp>
+#include <mbot/mbot_channels.h>
+#include <string.h>
 
 #ifndef _countof
 #define _countof(_Array) (int)(sizeof(_Array) / sizeof(_Array[0]))
@@ -45,12 +56,495 @@ bool checkRPLIDARHealth(RPlidarDriver * drv)
 }
 
 #include <signal.h>
-bool ctrl_c_pressed;
+std::atomic<bool> ctrl_c_pressed(false);
 void ctrlc(int)
 {
     ctrl_c_pressed = true;
 }
 
+const int kMaxNodesPerScan = 360*2;         // most nodes the rplidar returns for one revolution
+const int kMaxSectors = 64;
+const int64_t kMaxScanPeriodUs = 1000000;   // a gap longer than this between grabs means scans were missed
+
+// One revolution of raw nodes as grabbed from the rplidar
+struct RawScan
+{
+    rplidar_response_measurement_node_t nodes[kMaxNodesPerScan];
+    size_t  count;
+    int64_t startTime;      // time the revolution started (approximately the end of the previous revolution)
+    int64_t endTime;        // time grabScanData returned the revolution
+};
+
+typedef SpscRing<RawScan, 4> RawScanRing;
+typedef SpscRing<RawScan, 16> RawSectorRing;     // sectors use the same buffers as revolutions
+
+
+/**
+* capture_scans runs on the capture thread. It grabs each revolution from the rplidar directly into a free slot of the
+* ring, so the serial link is drained as soon as a revolution completes, regardless of how long publishing takes.
+* If the publisher has fallen behind and the ring is full, the revolution is grabbed into a scratch buffer and dropped.
+*/
+void capture_scans(RPlidarDriver* drv, RawScanRing* ring, std::atomic<int>* numDropped)
+{
+    RawScan scratch;
+    int64_t lastScanEnd = 0;
+
+    while (!ctrl_c_pressed) {
+        RawScan* scan = ring->beginWrite();
+        if (!scan) {
+            scan = &scratch;
+        }
+
+        scan->count = _countof(scan->nodes);
+        u_result op_result = drv->grabScanData(scan->nodes, scan->count);
+        int64_t now = utime_now();
+
+        if (IS_FAIL(op_result)) {
+            lastScanEnd = 0;
+            continue;
+        }
+
+        drv->ascendScanData(scan->nodes, scan->count);
+
+        // The rays are spread over the revolution that ended at this grab, not stamped with a single time
+        scan->endTime = now;
+        scan->startTime = ((lastScanEnd > 0) && (now - lastScanEnd < kMaxScanPeriodUs)) ? lastScanEnd : now;
+        lastScanEnd = now;
+
+        if (scan == &scratch) {
+            ++(*numDropped);
+        } else {
+            ring->commitWrite();
+        }
+    }
+}
+
+
+/**
+* convert_raw_scan fills in a lidar_t from a raw revolution. The arrays are resized in place, so reusing the same
+* message for every scan doesn't allocate. The nodes are sorted by angle, which is also the order they were measured,
+* so the ray times are spread evenly across the revolution.
+*/
+void convert_raw_scan(const RawScan& raw, lidar_t& scan)
+{
+    const int count = static_cast<int>(raw.count);
+
+    scan.utime = raw.endTime;
+    scan.num_ranges = count;
+
+    scan.ranges.resize(count);
+    scan.thetas.resize(count);
+    scan.intensities.resize(count);
+    scan.times.resize(count);
+
+    const double timeStep = (count > 1) ? (raw.endTime - raw.startTime) / (count - 1.0) : 0.0;
+
+    for (int pos = 0; pos < count; ++pos) {
+        scan.ranges[pos] = raw.nodes[pos].distance_q2/4000.0f;
+        scan.thetas[pos] = (raw.nodes[pos].angle_q6_checkbit >> RPLIDAR_RESP_MEASUREMENT_ANGLE_SHIFT)*3.1415926535f/11520.0f;
+        scan.intensities[pos] = raw.nodes[pos].sync_quality >> RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT;
+        scan.times[pos] = raw.startTime + static_cast<int64_t>(std::llround(timeStep * pos));
+    }
+}
+
+
+/**
+* open_serial_port opens the rplidar's serial port for reading measurement nodes directly, in raw mode at the given
+* baud rate. Reads return after at most 100ms, so the capture thread notices ctrl-c even if the rplidar goes quiet.
+*
+* \return   File descriptor of the port, or -1 if it couldn't be opened at that baud rate.
+*/
+int open_serial_port(const char* path, _u32 baudrate)
+{
+    speed_t speed;
+    switch (baudrate) {
+        case 115200: speed = B115200; break;
+        case 230400: speed = B230400; break;
+        case 460800: speed = B460800; break;
+        case 921600: speed = B921600; break;
+        default:
+            fprintf(stderr, "Error, sectors need a standard baud rate (115200, 230400, 460800, or 921600), not %u.\n",
+                baudrate);
+            return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Error, cannot open %s for reading sectors.\n", path);
+        return -1;
+    }
+
+    termios options;
+    tcgetattr(fd, &options);
+    cfmakeraw(&options);
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+    options.c_cflag |= CLOCAL | CREAD;
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 1;
+
+    if (tcsetattr(fd, TCSANOW, &options) != 0) {
+        fprintf(stderr, "Error, cannot configure %s for reading sectors.\n", path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/**
+* send_command sends a command without a payload to the rplidar.
+*/
+bool send_command(int fd, _u8 cmd)
+{
+    const _u8 packet[2] = { RPLIDAR_CMD_SYNC_BYTE, cmd };
+    return write(fd, packet, sizeof(packet)) == static_cast<ssize_t>(sizeof(packet));
+}
+
+
+/**
+* start_node_stream asks the rplidar to start a normal scan and waits for the response descriptor that comes before
+* the measurement nodes. It's the same request startScanNormal makes, but the nodes are then read by capture_sectors
+* rather than the SDK's thread.
+*
+* \return   True if the rplidar answered with a stream of measurement nodes.
+*/
+bool start_node_stream(int fd)
+{
+    const int64_t kTimeoutUs = 2000000;
+    const size_t kDescriptorSize = sizeof(rplidar_ans_header_t);
+
+    tcflush(fd, TCIFLUSH);
+    if (!send_command(fd, RPLIDAR_CMD_SCAN)) {
+        return false;
+    }
+
+    _u8 descriptor[kDescriptorSize];
+    size_t numRead = 0;
+    int64_t deadline = utime_now() + kTimeoutUs;
+
+    while ((numRead < kDescriptorSize) && (utime_now() < deadline) && !ctrl_c_pressed) {
+        if (read(fd, descriptor + numRead, 1) != 1) {
+            continue;
+        }
+
+        // Skip anything before the two sync bytes that start the descriptor
+        if (((numRead == 0) && (descriptor[0] != RPLIDAR_ANS_SYNC_BYTE1))
+            || ((numRead == 1) && (descriptor[1] != RPLIDAR_ANS_SYNC_BYTE2))) {
+            numRead = 0;
+            continue;
+        }
+        ++numRead;
+    }
+
+    return (numRead == kDescriptorSize) && (descriptor[kDescriptorSize - 1] == RPLIDAR_ANS_TYPE_MEASUREMENT);
+}
+
+
+/**
+* SectorAssembler cuts the stream of measurement nodes into sectors and revolutions as the nodes arrive. A sector is
+* committed to its ring as soon as the first node of the next sector arrives, and a revolution as soon as the first
+* node of the next revolution arrives. When a ring is full, the sector or revolution is assembled in a scratch buffer
+* and dropped.
+*/
+class SectorAssembler
+{
+public:
+
+    SectorAssembler(int numSectors, RawScanRing* scans, RawSectorRing* sectors, std::atomic<int>* numDropped)
+    : sectorWidth_(2.0f * 3.1415926535f / numSectors)
+    , numSectors_(numSectors)
+    , scans_(scans)
+    , sectors_(sectors)
+    , numDropped_(numDropped)
+    , scan_(nullptr)
+    , sector_(nullptr)
+    , sectorIndex_(-1)
+    , lastScanEnd_(0)
+    , lastSectorEnd_(0)
+    {
+    }
+
+    void addNode(const rplidar_response_measurement_node_t& node, int64_t now)
+    {
+        const bool isNewScan = node.sync_quality & RPLIDAR_RESP_MEASUREMENT_SYNCBIT;
+        const float theta = (node.angle_q6_checkbit >> RPLIDAR_RESP_MEASUREMENT_ANGLE_SHIFT)*3.1415926535f/11520.0f;
+        const int sectorIndex = std::min(numSectors_ - 1, static_cast<int>(theta / sectorWidth_));
+
+        if (isNewScan) {
+            commitSector(now);
+            commitScan(now);
+            beginScan(now);
+        } else if (!scan_) {
+            return;     // wait for the start of the first revolution, so sectors always come in angular order
+        }
+
+        // Nodes are measured in angular order, so a node in a later sector means the current sector is complete
+        if (sector_ && (sectorIndex > sectorIndex_)) {
+            commitSector(now);
+        }
+        if (!sector_) {
+            beginSector(sectorIndex, now);
+        }
+
+        if (scan_->count < kMaxNodesPerScan) {
+            scan_->nodes[scan_->count++] = node;
+        }
+        if (sector_->count < kMaxNodesPerScan) {
+            sector_->nodes[sector_->count++] = node;
+        }
+    }
+
+private:
+
+    const float sectorWidth_;
+    const int numSectors_;
+    RawScanRing* scans_;
+    RawSectorRing* sectors_;
+    std::atomic<int>* numDropped_;
+
+    RawScan* scan_;         // revolution being assembled, or nullptr before the first revolution starts
+    RawScan* sector_;       // sector being assembled, or nullptr between sectors
+    int sectorIndex_;
+    int64_t lastScanEnd_;
+    int64_t lastSectorEnd_;
+    RawScan scanScratch_;
+    RawScan sectorScratch_;
+
+    void beginScan(int64_t now)
+    {
+        scan_ = scans_->beginWrite();
+        if (!scan_) {
+            scan_ = &scanScratch_;
+        }
+        scan_->count = 0;
+        scan_->startTime = ((lastScanEnd_ > 0) && (now - lastScanEnd_ < kMaxScanPeriodUs)) ? lastScanEnd_ : now;
+    }
+
+    void commitScan(int64_t now)
+    {
+        if (!scan_) {
+            return;
+        }
+
+        // Same order as ascendScanData gives the revolutions grabbed through the SDK
+        std::stable_sort(scan_->nodes, scan_->nodes + scan_->count,
+            [](const rplidar_response_measurement_node_t& lhs, const rplidar_response_measurement_node_t& rhs) {
+                return (lhs.angle_q6_checkbit >> RPLIDAR_RESP_MEASUREMENT_ANGLE_SHIFT)
+                    < (rhs.angle_q6_checkbit >> RPLIDAR_RESP_MEASUREMENT_ANGLE_SHIFT);
+            });
+        scan_->endTime = now;
+        lastScanEnd_ = now;
+
+        if (scan_ == &scanScratch_) {
+            ++(*numDropped_);
+        } else {
+            scans_->commitWrite();
+        }
+        scan_ = nullptr;
+    }
+
+    void beginSector(int sectorIndex, int64_t now)
+    {
+        sector_ = sectors_->beginWrite();
+        if (!sector_) {
+            sector_ = &sectorScratch_;
+        }
+        sector_->count = 0;
+        sector_->startTime = ((lastSectorEnd_ > 0) && (now - lastSectorEnd_ < kMaxScanPeriodUs)) ? lastSectorEnd_ : now;
+        sectorIndex_ = sectorIndex;
+    }
+
+    void commitSector(int64_t now)
+    {
+        if (!sector_) {
+            return;
+        }
+
+        sector_->endTime = now;
+        lastSectorEnd_ = now;
+
+        if (sector_ == &sectorScratch_) {
+            ++(*numDropped_);
+        } else {
+            sectors_->commitWrite();
+        }
+        sector_ = nullptr;
+        sectorIndex_ = -1;
+    }
+};
+
+
+/**
+* capture_sectors runs on the capture thread when sectors are published. It reads measurement nodes straight from
+* the serial port as the rplidar sends them, rather than waiting for grabScanData to hand over a whole revolution, so
+* each sector is ready for publishing as soon as its last ray has been measured.
+*/
+void capture_sectors(int fd, int numSectors, RawScanRing* scans, RawSectorRing* sectors, std::atomic<int>* numDropped)
+{
+    const size_t kNodeSize = sizeof(rplidar_response_measurement_node_t);
+
+    SectorAssembler assembler(numSectors, scans, sectors, numDropped);
+    _u8 buffer[512];
+    size_t numBuffered = 0;
+
+    while (!ctrl_c_pressed) {
+        ssize_t numRead = read(fd, buffer + numBuffered, sizeof(buffer) - numBuffered);
+        if (numRead <= 0) {
+            continue;
+        }
+
+        numBuffered += numRead;
+        int64_t now = utime_now();
+
+        size_t pos = 0;
+        while (numBuffered - pos >= kNodeSize) {
+            const _u8* bytes = buffer + pos;
+            const bool syncBit = bytes[0] & 0x1;
+            const bool inverseSyncBit = (bytes[0] >> 1) & 0x1;
+
+            // A node whose sync bits agree or whose check bit is clear means the stream is out of step, so slide
+            // forward a byte at a time until the nodes line up again
+            if ((syncBit == inverseSyncBit) || !(bytes[1] & RPLIDAR_RESP_MEASUREMENT_CHECKBIT)) {
+                ++pos;
+                continue;
+            }
+
+            rplidar_response_measurement_node_t node;
+            memcpy(&node, bytes, kNodeSize);
+            assembler.addNode(node, now);
+            pos += kNodeSize;
+        }
+
+        memmove(buffer, buffer + pos, numBuffered - pos);
+        numBuffered -= pos;
+    }
+}
+
+
+/**
+* publish_scans publishes every revolution, and every sector if sectors isn't nullptr, that the capture thread
+* commits to the rings until ctrl-c is pressed. Sectors are published on LIDAR_SECTOR_CHANNEL as soon as they're read.
+*/
+void publish_scans(RawScanRing* scans,
+                   RawSectorRing* sectors,
+                   lcm::LCM& lcmConnection,
+                   bool publishFull,
+                   bool publishCompact)
+{
+    // All messages are reused for every scan, so after the first revolution publishing doesn't allocate
+    lidar_t newLidar;
+    lidar_t sectorLidar;
+    lidar_compact_t compactLidar;
+
+    newLidar.ranges.reserve(kMaxNodesPerScan);
+    newLidar.thetas.reserve(kMaxNodesPerScan);
+    newLidar.intensities.reserve(kMaxNodesPerScan);
+    newLidar.times.reserve(kMaxNodesPerScan);
+    sectorLidar.ranges.reserve(kMaxNodesPerScan);
+    sectorLidar.thetas.reserve(kMaxNodesPerScan);
+    sectorLidar.intensities.reserve(kMaxNodesPerScan);
+    sectorLidar.times.reserve(kMaxNodesPerScan);
+    compactLidar.ranges.reserve(kMaxNodesPerScan);
+    compactLidar.intensities.reserve(kMaxNodesPerScan);
+
+    while (!ctrl_c_pressed) {
+        bool havePublished = false;
+
+        while (const RawScan* rawSector = (sectors ? sectors->beginRead() : nullptr)) {
+            convert_raw_scan(*rawSector, sectorLidar);
+            sectors->commitRead();
+            lcmConnection.publish(LIDAR_SECTOR_CHANNEL, &sectorLidar);
+            havePublished = true;
+        }
+
+        if (const RawScan* rawScan = scans->beginRead()) {
+            convert_raw_scan(*rawScan, newLidar);
+            scans->commitRead();
+
+            if (publishFull) {
+                lcmConnection.publish(LIDAR_CHANNEL, &newLidar);
+            }
+
+            if (publishCompact) {
+                compress_lidar_scan(newLidar, compactLidar);
+                lcmConnection.publish(LIDAR_COMPACT_CHANNEL, &compactLidar);
+            }
+            havePublished = true;
+        }
+
+        if (!havePublished) {
+            // Nothing captured yet. A short sleep is plenty given a sector takes several milliseconds to measure.
+            usleep(500);
+        }
+    }
+}
+
+
+/**
+* stream_scans starts the capture thread and publishes every revolution it captures until ctrl-c is pressed.
+*/
+void stream_scans(RPlidarDriver* drv, lcm::LCM& lcmConnection, bool publishFull, bool publishCompact)
+{
+    RawScanRing scans;
+    std::atomic<int> numDropped(0);
+
+    drv->startScan();
+    std::thread captureThread(capture_scans, drv, &scans, &numDropped);
+    publish_scans(&scans, nullptr, lcmConnection, publishFull, publishCompact);
+    captureThread.join();
+
+    if (numDropped > 0) {
+        printf("Dropped %d scans because publishing fell behind the lidar.\n", numDropped.load());
+    }
+}
+
+
+/**
+* stream_sectors reads the measurement nodes from the serial port on the capture thread and publishes each of the
+* numSectors equal angular sectors of a revolution as soon as it's read, along with every full revolution, until
+* ctrl-c is pressed.
+*
+* The SDK only hands over complete revolutions, so it is left to control the motor while the nodes are read from a
+* second descriptor of the same port.
+*/
+bool stream_sectors(const char* path,
+                    _u32 baudrate,
+                    lcm::LCM& lcmConnection,
+                    bool publishFull,
+                    bool publishCompact,
+                    int numSectors)
+{
+    int fd = open_serial_port(path, baudrate);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (!start_node_stream(fd)) {
+        fprintf(stderr, "Error, the rplidar didn't start sending measurements on %s.\n", path);
+        close(fd);
+        return false;
+    }
+
+    RawScanRing scans;
+    RawSectorRing sectors;
+    std::atomic<int> numDropped(0);
+
+    std::thread captureThread(capture_sectors, fd, numSectors, &scans, &sectors, &numDropped);
+    publish_scans(&scans, &sectors, lcmConnection, publishFull, publishCompact);
+    captureThread.join();
+
+    send_command(fd, RPLIDAR_CMD_STOP);
+    tcdrain(fd);
+    close(fd);
+
+    if (numDropped > 0) {
+        printf("Dropped %d scans or sectors because publishing fell behind the lidar.\n", numDropped.load());
+    }
+    return true;
+}
+
 int main(int argc, const char * argv[]) {
 
     //Shouldn't need to adjust these with the exception of pwm
@@ -58,16 +552,9 @@ int main(int argc, const char * argv[]) {
     _u32         opt_com_baudrate = 115200;
     u_result     op_result;
     uint16_t pwm = 700;
-
-/** speed stabilization tests
-int updateHZ_count = 0;
-int speeds[] = {300, 700, 250, 850};
-int speed_at = 0;
-float stab_time = 0.0f;
-uint64_t changed_time = 0;
-uint prev_size[] = {0, 0, 0};
-bool stabilized = false;
-**/
+    bool publishFull = true;        // publish lidar_t on LIDAR_CHANNEL
+    bool publishCompact = false;    // publish lidar_compact_t on LIDAR_COMPACT_CHANNEL
+    int numSectors = 0;             // if > 0, also publish each revolution as this many sectors on LIDAR_SECTOR_CHANNEL
 
     lcm::LCM lcmConnection(MULTICAST_URL);
 
@@ -85,6 +572,27 @@ bool stabilized = false;
     // read baud rate from the command line if specified...
     if (argc>3) opt_com_baudrate = strtoul(argv[3], NULL, 10);
 
+    // read the scan format from the command line if specified: full (default), compact, or both
+    if (argc>4) {
+        publishFull = (strcmp(argv[4], "full") == 0) || (strcmp(argv[4], "both") == 0);
+        publishCompact = (strcmp(argv[4], "compact") == 0) || (strcmp(argv[4], "both") == 0);
+
+        if (!publishFull && !publishCompact) {
+            fprintf(stderr, "Error, unknown scan format %s. Use full, compact, or both.\n", argv[4]);
+            return 1;
+        }
+    }
+
+    // read the number of sectors to split each revolution into from the command line if specified...
+    if (argc>5) {
+        numSectors = atoi(argv[5]);
+
+        if (numSectors < 0 || numSectors > kMaxSectors) {
+            fprintf(stderr, "Error, number of sectors must be between 0 and %d.\n", kMaxSectors);
+            return 1;
+        }
+    }
+
 
     if (!opt_com_path) {
 #ifdef _WIN32
@@ -146,101 +654,11 @@ bool stabilized = false;
 	drv->startMotor();
     // start scan...
     drv->setMotorPWM(pwm);
-    drv->startScan();
-
-    // fetech result and print it out...
-    while (1) {
-
-        rplidar_response_measurement_node_t nodes[360*2];
-        size_t   count = _countof(nodes);
-
-        op_result = drv->grabScanData(nodes, count);
-
-           
-        //gettimeofday(&tv, NULL);
-	    int64_t now = utime_now();//(int64_t) tv.tv_sec * 1000000 + tv.tv_usec; //get current timestamp in milliseconds
-
-/**speed stabilization tests
-        updateHZ_count++;
-
 
-        if(updateHZ_count > 100){
-            updateHZ_count = 0;
-
-            drv->setMotorPWM(speeds[speed_at]);
-
-            std::cout << "set speed to: " << speeds[speed_at] << "\n";
-
-            speed_at++;
-            if(speed_at > 3) speed_at = 0;
-
-            prev_size[0] = 0;
-            prev_size[1] = 0;
-            prev_size[2] = 0;
-            changed_time = now;
-
-            stabilized = false;
-        }
-**/
-
-        if (IS_OK(op_result)) {
-            drv->ascendScanData(nodes, count);
-
-            lidar_t newLidar;
-
-            newLidar.utime = now;
-            newLidar.num_ranges = count;
-
-            newLidar.ranges.resize(count);
-            newLidar.thetas.resize(count);
-            newLidar.intensities.resize(count);
-            newLidar.times.resize(count);
-
-/**speed stabilization tests
-
-            if(!stabilized && count == prev_size[0] && prev_size[0] == prev_size[1] && prev_size[1] == prev_size[2]){
-                prev_size[0] = 0;
-                prev_size[1] = 0;
-                prev_size[2] = 0;
-
-                stab_time = float(now - changed_time) / 1000.0f;
-
-                std::cout << "stabilization time: " << stab_time << "\n";
-
-                stabilized = true;
-            }else{
-                prev_size[2] = prev_size[1];
-                prev_size[1] = prev_size[0];
-                prev_size[0] = count;
-            }
-*/
-
-            //	    std::cout << count << "\n";
-            //		printf("theta,dist,Q\n");
-
-            for (int pos = 0; pos < (int)count ; ++pos) {
-            	//gettimeofday(&tv, NULL);
-		        now = utime_now();//(int64_t) tv.tv_sec * 1000000 + tv.tv_usec; //get current timestamp in milliseconds
-            	newLidar.ranges[pos] = nodes[pos].distance_q2/4000.0f;
-            	newLidar.thetas[pos] = (nodes[pos].angle_q6_checkbit >> RPLIDAR_RESP_MEASUREMENT_ANGLE_SHIFT)*3.1415926535f/11520.0f;
-            	newLidar.intensities[pos] = nodes[pos].sync_quality >> RPLIDAR_RESP_MEASUREMENT_QUALITY_SHIFT;
-            	newLidar.times[pos] = now;
-
-//                printf("%s theta: %03.2f Dist: %08.2f Q: %f Time: %" PRIu64 "\n", 
-//                    (nodes[pos].sync_quality & RPLIDAR_RESP_MEASUREMENT_SYNCBIT) ?"S ":"  ", 
-//                   	newLidar.thetas[pos],
-//                    newLidar.ranges[pos],
-//                    newLidar.intensities[pos],
-//                    newLidar.times[pos]);
-//		printf("%03.2f,%08.2f,%f\n", newLidar.thetas[pos], newLidar.ranges[pos], newLidar.intensities[pos]);
-            }
-
-            lcmConnection.publish("LIDAR", &newLidar);
-        }
-
-        if (ctrl_c_pressed){ 
-			break;
-		}
+    if (numSectors > 0) {
+        stream_sectors(opt_com_path, opt_com_baudrate, lcmConnection, publishFull, publishCompact, numSectors);
+    } else {
+        stream_scans(drv, lcmConnection, publishFull, publishCompact);
     }
 
     drv->stop();
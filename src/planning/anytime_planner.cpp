@@ -0,0 +1,417 @@
+#include <planning/anytime_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+
+const float AnytimePlanner::kInfiniteCost = std::numeric_limits<float>::max();
+const int AnytimePlanner::kExpansionsPerClockCheck;
+
+
+namespace
+{
+
+// Amount epsilon is lowered by after each path is found, unless the path's bound is already lower
+const float kInflationStep = 0.5f;
+
+}
+
+
+AnytimePlanner::AnytimePlanner(void)
+: generation_(0)
+, iteration_(0)
+, inflation_(1.0f)
+, hasIterationPath_(false)
+, distances_(nullptr)
+, startIndex_(-1)
+, goalIndex_(-1)
+, bound_(std::numeric_limits<float>::infinity())
+, isFinished_(true)
+, numExpanded_(0)
+, numIterations_(0)
+, shouldStop_(false)
+, isImproving_(false)
+{
+    start_.utime = 0;
+    start_.x = start_.y = start_.theta = 0.0f;
+    bestPath_.utime = 0;
+    bestPath_.path_length = 0;
+}
+
+
+AnytimePlanner::AnytimePlanner(const AnytimePlanner& rhs)
+: AnytimePlanner()
+{
+}
+
+
+AnytimePlanner& AnytimePlanner::operator=(const AnytimePlanner& rhs)
+{
+    // The search isn't copied, so drop the current one
+    if(this != &rhs)
+    {
+        stopImproving();
+
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        distances_ = nullptr;
+        bestPath_.path.clear();
+        bestPath_.path_length = 0;
+        bound_ = std::numeric_limits<float>::infinity();
+        isFinished_ = true;
+        numExpanded_ = 0;
+        numIterations_ = 0;
+    }
+    return *this;
+}
+
+
+AnytimePlanner::~AnytimePlanner(void)
+{
+    stopImproving();
+}
+
+
+robot_path_t AnytimePlanner::plan(const pose_xyt_t& start,
+                                  const pose_xyt_t& goal,
+                                  const ObstacleDistanceGrid& distances,
+                                  const SearchParams& params)
+{
+    const int64_t deadlineUs = (params.timeBudgetUs > 0) ? utime_now() + params.timeBudgetUs : 0;
+
+    stopImproving();
+    params_ = params;
+    beginSearch(start, goal, distances);
+
+    if(!isFinished())
+    {
+        search(deadlineUs);
+    }
+
+    return bestPath();
+}
+
+
+void AnytimePlanner::improveInBackground(void)
+{
+    if(isImproving_ || isFinished())
+    {
+        return;
+    }
+
+    if(improveThread_.joinable())
+    {
+        improveThread_.join();
+    }
+
+    shouldStop_ = false;
+    isImproving_ = true;
+    improveThread_ = std::thread([this]() {
+        search(0);
+        isImproving_ = false;
+    });
+}
+
+
+void AnytimePlanner::stopImproving(void)
+{
+    shouldStop_ = true;
+    if(improveThread_.joinable())
+    {
+        improveThread_.join();
+    }
+    shouldStop_ = false;
+}
+
+
+bool AnytimePlanner::isImproving(void) const
+{
+    return isImproving_;
+}
+
+
+robot_path_t AnytimePlanner::bestPath(void) const
+{
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    return bestPath_;
+}
+
+
+float AnytimePlanner::suboptimalityBound(void) const
+{
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    return bound_;
+}
+
+
+bool AnytimePlanner::isFinished(void) const
+{
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    return isFinished_;
+}
+
+
+std::size_t AnytimePlanner::numExpanded(void) const
+{
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    return numExpanded_;
+}
+
+
+int AnytimePlanner::numIterations(void) const
+{
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    return numIterations_;
+}
+
+
+void AnytimePlanner::reserve(const ObstacleDistanceGrid& distances)
+{
+    const std::size_t numCells = static_cast<std::size_t>(distances.widthInCells()) * distances.heightInCells();
+    if(cells_.size() != numCells)
+    {
+        CellState unvisited;
+        unvisited.gCost = kInfiniteCost;
+        unvisited.parent = -1;
+        unvisited.generation = 0;
+        unvisited.closedIteration = 0;
+        unvisited.inconsistentIteration = 0;
+        cells_.assign(numCells, unvisited);
+        generation_ = 0;
+    }
+
+    openList_.reset(numCells);
+}
+
+
+void AnytimePlanner::beginSearch(const pose_xyt_t& start, const pose_xyt_t& goal, const ObstacleDistanceGrid& distances)
+{
+    distances_ = &distances;
+    start_ = start;
+
+    const int width = distances.widthInCells();
+    reserve(distances);
+
+    ++generation_;
+    ++iteration_;
+    inconsistentCells_.clear();
+    inflation_ = std::max(params_.initialInflation, 1.0);
+    hasIterationPath_ = false;
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        bestPath_.utime = start.utime;
+        bestPath_.path.assign(1, start);
+        bestPath_.path_length = bestPath_.path.size();
+        bound_ = std::numeric_limits<float>::infinity();
+        isFinished_ = true;
+        numExpanded_ = 0;
+        numIterations_ = 0;
+    }
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    // Reject the same queries as search_for_path
+    if(!is_traversable(startCell.x, startCell.y, distances, params_)
+        || !is_traversable(goalCell.x, goalCell.y, distances, params_)
+        || (startCell == goalCell))
+    {
+        return;
+    }
+
+    startIndex_ = startCell.y*width + startCell.x;
+    goalIndex_ = goalCell.y*width + goalCell.x;
+
+    CellState& startState = cells_[startIndex_];
+    startState.generation = generation_;
+    startState.gCost = 0.0f;
+    startState.parent = -1;
+    openList_.push(startIndex_, inflation_ * hCost(startIndex_));
+
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    isFinished_ = false;
+}
+
+
+void AnytimePlanner::search(int64_t deadlineUs)
+{
+    // Each iteration ends when it finds a path, then the next one starts right away with a lower epsilon
+    while(!isFinished())
+    {
+        if(!improvePath(deadlineUs) || !finishIteration(deadlineUs))
+        {
+            return;
+        }
+    }
+}
+
+
+bool AnytimePlanner::improvePath(int64_t deadlineUs)
+{
+    const int width = distances_->widthInCells();
+    const float metersPerCell = distances_->metersPerCell();
+
+    const int xDeltas[4] = { 1, -1, 0,  0 };
+    const int yDeltas[4] = { 0,  0, 1, -1 };
+
+    std::size_t numExpanded = 0;
+    bool isIterationDone = true;
+
+    // Expand until no open cell could lead to a path cheaper than the inflated cost of the path to the goal
+    while(!openList_.empty() && (openList_.topKey() < gCost(goalIndex_)))
+    {
+        if(((numExpanded + 1) % kExpansionsPerClockCheck == 0) && shouldPause(deadlineUs))
+        {
+            isIterationDone = false;
+            break;
+        }
+
+        int index = openList_.pop();
+        cells_[index].closedIteration = iteration_;
+        ++numExpanded;
+
+        const int x = index % width;
+        const int y = index / width;
+        const float gCurrent = cells_[index].gCost;
+
+        for(int n = 0; n < 4; ++n)
+        {
+            int adjacentX = x + xDeltas[n];
+            int adjacentY = y + yDeltas[n];
+            if(!is_traversable(adjacentX, adjacentY, *distances_, params_))
+            {
+                continue;
+            }
+
+            int adjacentIndex = adjacentY*width + adjacentX;
+            float gNew = gCurrent + metersPerCell + obstacle_cost((*distances_)(adjacentX, adjacentY), params_);
+            if(gNew >= gCost(adjacentIndex))
+            {
+                continue;
+            }
+
+            CellState& adjacent = cells_[adjacentIndex];
+            adjacent.generation = generation_;
+            adjacent.gCost = gNew;
+            adjacent.parent = index;
+
+            // A cell already expanded this iteration isn't expanded again until the next one
+            if(adjacent.closedIteration == iteration_)
+            {
+                if(adjacent.inconsistentIteration != iteration_)
+                {
+                    adjacent.inconsistentIteration = iteration_;
+                    inconsistentCells_.push_back(adjacentIndex);
+                }
+            }
+            else
+            {
+                openList_.pushOrDecrease(adjacentIndex, gNew + inflation_*hCost(adjacentIndex));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(resultMutex_);
+    numExpanded_ += numExpanded;
+    return isIterationDone;
+}
+
+
+bool AnytimePlanner::finishIteration(int64_t deadlineUs)
+{
+    const int width = distances_->widthInCells();
+    const float goalCost = gCost(goalIndex_);
+
+    // The open list ran out without reaching the goal, so no path exists
+    if(goalCost == kInfiniteCost)
+    {
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        isFinished_ = true;
+        return true;
+    }
+
+    // Keep the path right away, bounded by epsilon, in case time runs out before the bound is tightened
+    if(!hasIterationPath_)
+    {
+        std::vector<cell_t> cells;
+        for(int index = goalIndex_; index != startIndex_; index = cells_[index].parent)
+        {
+            cells.push_back(cell_t(index % width, index / width));
+        }
+        std::reverse(cells.begin(), cells.end());
+        robot_path_t path = cells_to_path(start_, cells, *distances_);
+
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        bestPath_ = path;
+        bound_ = inflation_;
+        ++numIterations_;
+        hasIterationPath_ = true;
+    }
+
+    // Tightening the bound and reopening the cells takes time linear in the open cells, so leave it for the next
+    // call to search if the time is up. improvePath then returns right away because the goal cost hasn't changed.
+    if(shouldPause(deadlineUs))
+    {
+        return false;
+    }
+
+    // Every path to the goal still passes through an open or inconsistent cell, so the cheapest one costs at least
+    // their smallest uninflated f-cost
+    float minFCost = kInfiniteCost;
+    openList_.forEach([&](int index, float) {
+        minFCost = std::min(minFCost, cells_[index].gCost + hCost(index));
+    });
+    for(int index : inconsistentCells_)
+    {
+        minFCost = std::min(minFCost, cells_[index].gCost + hCost(index));
+    }
+
+    float bound = std::max(1.0f, std::min(inflation_, goalCost / minFCost));
+    bool isOptimal = bound <= 1.0f;
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        bound_ = bound;
+        isFinished_ = isOptimal;
+    }
+
+    if(isOptimal)
+    {
+        return true;
+    }
+
+    // Start the next iteration with every open and inconsistent cell open under the lower epsilon. Only the keys of
+    // the open cells change, so the heap is rebuilt in place rather than popping and pushing every cell.
+    inflation_ = std::max(1.0f, std::min(inflation_ - kInflationStep, bound));
+    ++iteration_;
+    hasIterationPath_ = false;
+    openList_.rekey([this](int index) {
+        return cells_[index].gCost + inflation_*hCost(index);
+    });
+    for(int index : inconsistentCells_)
+    {
+        openList_.push(index, cells_[index].gCost + inflation_*hCost(index));
+    }
+    inconsistentCells_.clear();
+
+    return true;
+}
+
+
+bool AnytimePlanner::shouldPause(int64_t deadlineUs) const
+{
+    return shouldStop_ || ((deadlineUs > 0) && (utime_now() >= deadlineUs));
+}
+
+
+float AnytimePlanner::hCost(int index) const
+{
+    // Moves are 4-connected, so the Manhattan distance is the tightest admissible heuristic
+    const int width = distances_->widthInCells();
+    return (std::abs(goalIndex_ % width - index % width) + std::abs(goalIndex_ / width - index / width))
+        * distances_->metersPerCell();
+}
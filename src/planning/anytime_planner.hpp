@@ -0,0 +1,171 @@
+#ifndef PLANNING_ANYTIME_PLANNER_HPP
+#define PLANNING_ANYTIME_PLANNER_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/astar.hpp>
+#include <planning/indexed_heap.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* AnytimePlanner finds paths with Anytime Repairing A* (ARA*, Likhachev, Gordon, and Thrun, 2003), which quickly finds
+* a path that may cost more than the cheapest one, then keeps finding cheaper paths until it runs out of time.
+*
+* Each iteration is an A* search over the same 4-connected cells and costs as grid_astar, with the heuristic inflated
+* by a factor epsilon, so every path found costs at most epsilon times the cheapest one. The first iteration uses
+* SearchParams::initialInflation. Each later iteration lowers epsilon and reuses the costs found by the earlier ones,
+* only expanding again the cells whose costs were lowered since they were last expanded, so it's far cheaper than a new
+* search. The last iteration, with epsilon of 1, finds the cheapest path.
+*
+* plan stops at SearchParams::timeBudgetUs and returns the best path found so far, along with a bound on how much more
+* it can cost than the cheapest path -- see suboptimalityBound. The bound is often much tighter than epsilon. If no path
+* was found in time, the search can still be continued with improveInBackground.
+*
+* improveInBackground keeps running the iterations on a background thread after plan returns, until the cheapest path
+* is found or stopImproving is called. bestPath then retrieves the best path found so far. The grid passed to plan must
+* not change while the planner is improving, so stop it before updating the grid. Starting a new plan stops it too.
+*
+* The search state of every cell is kept between calls, so keep the same AnytimePlanner around rather than creating a
+* new one for each plan. A copy of an AnytimePlanner starts without a search.
+*/
+class AnytimePlanner
+{
+public:
+
+    AnytimePlanner(void);
+    AnytimePlanner(const AnytimePlanner& rhs);
+    AnytimePlanner& operator=(const AnytimePlanner& rhs);
+    ~AnytimePlanner(void);
+
+    // Number of cells expanded between checks of the clock and of stopImproving, which bounds how far plan can
+    // overrun its time budget along with the time to extract one path
+    static const int kExpansionsPerClockCheck = 64;
+
+    /**
+    * plan finds the best path from start to goal within the time budget in params.
+    *
+    * \param    start           Starting pose of the robot
+    * \param    goal            Desired goal pose of the robot
+    * \param    distances       Distance to the nearest obstacle for each cell in the grid
+    * \param    params          Parameters specifying the costs, time budget, and initial inflation of the search.
+    *   params.mode is ignored.
+    * \return   The best path found to the goal, containing every cell from the start to the goal. If no path was found,
+    *   because the goal is unreachable or the time ran out, then a path with just the initial pose is returned, per
+    *   the robot_path_t specification.
+    */
+    robot_path_t plan(const pose_xyt_t& start,
+                      const pose_xyt_t& goal,
+                      const ObstacleDistanceGrid& distances,
+                      const SearchParams& params);
+
+    /**
+    * reserve allocates the search state for every cell of a grid the size of distances. plan does this itself whenever
+    * the size of the grid changes, but the allocation counts against its time budget, so reserve ahead of time to keep
+    * the whole budget for searching. Don't call reserve while the planner is improving.
+    *
+    * \param    distances       Grid that will be passed to plan
+    */
+    void reserve(const ObstacleDistanceGrid& distances);
+
+    /**
+    * improveInBackground continues the search started by the last call to plan on a background thread, until the
+    * cheapest path is found or stopImproving is called. If the search is already finished, nothing happens.
+    */
+    void improveInBackground(void);
+
+    /**
+    * stopImproving stops the background search, waiting for it to finish its current step. The search can be
+    * continued again later.
+    */
+    void stopImproving(void);
+
+    /**
+    * isImproving checks if the background search is still running.
+    */
+    bool isImproving(void) const;
+
+    /**
+    * bestPath retrieves the best path found so far by the last search, or a path with just the initial pose if none
+    * has been found.
+    */
+    robot_path_t bestPath(void) const;
+
+    /**
+    * suboptimalityBound retrieves how many times the cost of the cheapest path the best path found so far can cost at
+    * most. It's 1 if the best path is the cheapest, and infinity if no path has been found.
+    */
+    float suboptimalityBound(void) const;
+
+    /**
+    * isFinished checks if the last search is done, because it found the cheapest path or proved the goal unreachable.
+    */
+    bool isFinished(void) const;
+
+    /**
+    * numExpanded retrieves the number of cells expanded by the last search, over all its iterations so far.
+    */
+    std::size_t numExpanded(void) const;
+
+    /**
+    * numIterations retrieves the number of iterations of the last search that finished, i.e. the number of paths found.
+    */
+    int numIterations(void) const;
+
+private:
+
+    struct CellState
+    {
+        float gCost;
+        int32_t parent;
+        uint32_t generation;        // search that last touched the cell
+        uint32_t closedIteration;   // iteration that last expanded the cell
+        uint32_t inconsistentIteration;     // iteration that last lowered the cost of the cell after expanding it
+    };
+
+    // Search state, only touched by the thread running the search
+    std::vector<CellState> cells_;
+    IndexedHeap<float> openList_;
+    std::vector<int> inconsistentCells_;    // cells whose costs were lowered after they were expanded this iteration
+    uint32_t generation_;
+    uint32_t iteration_;
+    float inflation_;
+    bool hasIterationPath_;     // the path found by the current iteration is in bestPath_
+
+    const ObstacleDistanceGrid* distances_;
+    SearchParams params_;
+    pose_xyt_t start_;
+    int startIndex_;
+    int goalIndex_;
+
+    // Results, shared with the background thread
+    mutable std::mutex resultMutex_;
+    robot_path_t bestPath_;
+    float bound_;
+    bool isFinished_;
+    std::size_t numExpanded_;
+    int numIterations_;
+
+    std::thread improveThread_;
+    std::atomic<bool> shouldStop_;
+    std::atomic<bool> isImproving_;
+
+    void beginSearch(const pose_xyt_t& start, const pose_xyt_t& goal, const ObstacleDistanceGrid& distances);
+    void search(int64_t deadlineUs);
+    bool improvePath(int64_t deadlineUs);
+    bool finishIteration(int64_t deadlineUs);
+    bool shouldPause(int64_t deadlineUs) const;
+
+    bool isVisited(int index) const { return cells_[index].generation == generation_; }
+    float gCost(int index) const { return isVisited(index) ? cells_[index].gCost : kInfiniteCost; }
+    float hCost(int index) const;
+
+    static const float kInfiniteCost;
+};
+
+#endif // PLANNING_ANYTIME_PLANNER_HPP
@@ -0,0 +1,432 @@
+#include <planning/anytime_planner.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* The anytime planner test checks AnytimePlanner and the anytime_astar search mode:
+*
+*   - on the data/astar maps, without a time budget, the paths cost the same as grid_astar's,
+*   - on a large office map, plan stops at the first clock check past its time budget, and each path costs at most its
+*     suboptimality bound times the cost of grid_astar's path. The latency, bound, and number of paths found for each
+*     budget are printed, but the latency isn't checked because it depends on the machine,
+*   - improveInBackground finds the cheapest path after plan runs out of time, and stopImproving stops it,
+*   - MotionPlanner plans safe paths in the anytime_astar mode, and setMap stops the background search,
+*   - MotionPlanner::setParams switches the search mode and robot radius of a planner that already has a map.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+const std::vector<std::string> kMaps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+
+bool test_same_costs(void);
+bool test_time_budget(void);
+bool test_background_improvement(void);
+bool test_motion_planner(void);
+bool test_set_params(void);
+
+std::vector<PlanQuery> random_queries(const ObstacleDistanceGrid& distances,
+                                      const SearchParams& params,
+                                      int numQueries,
+                                      uint32_t seed);
+
+
+int main(int argc, char** argv)
+{
+    if(test_same_costs())
+    {
+        std::cout << "PASSED: test_same_costs\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_same_costs\n";
+    }
+
+    if(test_time_budget())
+    {
+        std::cout << "PASSED: test_time_budget\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_time_budget\n";
+    }
+
+    if(test_background_improvement())
+    {
+        std::cout << "PASSED: test_background_improvement\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_background_improvement\n";
+    }
+
+    if(test_motion_planner())
+    {
+        std::cout << "PASSED: test_motion_planner\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_motion_planner\n";
+    }
+
+    if(test_set_params())
+    {
+        std::cout << "PASSED: test_set_params\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_set_params\n";
+    }
+
+    return 0;
+}
+
+
+bool test_same_costs(void)
+{
+    SearchParams params = search_params(anytime_astar);
+    AStarWorkspace workspace;
+    AnytimePlanner planner;
+    bool allCorrect = true;
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        for(auto& query : queries)
+        {
+            robot_path_t path = search_for_path(query.start, query.goal, distances, params, workspace);
+            robot_path_t anytimePath = planner.plan(query.start, query.goal, distances, params);
+
+            if((path.path_length > 1) != (anytimePath.path_length > 1))
+            {
+                std::cout << "A* " << ((path.path_length > 1) ? "found" : "didn't find") << " a path that ARA* "
+                    << ((anytimePath.path_length > 1) ? "found" : "didn't find") << " on " << name << " map\n";
+                allCorrect = false;
+            }
+            else if(path.path_length > 1)
+            {
+                float cost = path_cost(path, distances, params);
+                float anytimeCost = path_cost(anytimePath, distances, params);
+                if((std::abs(cost - anytimeCost) > 1.0e-4f * cost) || (planner.suboptimalityBound() != 1.0f))
+                {
+                    std::cout << "ARA* path on " << name << " map costs " << anytimeCost << " instead of " << cost
+                        << " with bound " << planner.suboptimalityBound() << '\n';
+                    allCorrect = false;
+                }
+            }
+
+            if(!planner.isFinished())
+            {
+                std::cout << "ARA* search on " << name << " map didn't finish without a time budget\n";
+                allCorrect = false;
+            }
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_time_budget(void)
+{
+    const int kNumQueries = 20;
+
+    OccupancyGrid grid = generate_office_grid(50.0f, 0.05f, 3.0, 1);
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    SearchParams params = search_params(anytime_astar);
+    std::vector<PlanQuery> queries = random_queries(distances, params, kNumQueries, 4);
+
+    // Find the cheapest paths to check the bounds against
+    AStarWorkspace workspace;
+    std::vector<float> cheapestCosts;
+    int64_t astarTimeUs = 0;
+    for(auto& query : queries)
+    {
+        int64_t startTime = utime_now();
+        robot_path_t path = search_for_path(query.start, query.goal, distances, params, workspace);
+        astarTimeUs += utime_now() - startTime;
+        cheapestCosts.push_back((path.path_length > 1) ? path_cost(path, distances, params) : 0.0f);
+    }
+
+    std::cout << "Planning " << kNumQueries << " queries on a " << grid.widthInCells() << "x" << grid.heightInCells()
+        << " office map, A* takes " << (astarTimeUs / kNumQueries) << " us on average:\n";
+    printf("%10s %12s %12s %12s %12s\n", "budget us", "mean us", "max us", "found", "mean bound");
+
+    // Allocate the search state for the grid before timing
+    AnytimePlanner planner;
+    params.timeBudgetUs = 1;
+    planner.plan(queries.front().start, queries.front().goal, distances, params);
+
+    bool allCorrect = true;
+
+    // The budget is up by the first clock check, so each plan stops there, or right after extracting its first path
+    for(std::size_t n = 0; n < queries.size(); ++n)
+    {
+        planner.plan(queries[n].start, queries[n].goal, distances, params);
+        if(planner.numExpanded() >= static_cast<std::size_t>(AnytimePlanner::kExpansionsPerClockCheck)
+            || (planner.numIterations() > 1))
+        {
+            std::cout << "Query " << n << " expanded " << planner.numExpanded() << " cells and found "
+                << planner.numIterations() << " paths with a budget of 1 us\n";
+            allCorrect = false;
+        }
+    }
+
+    for(int64_t budgetUs : { 500, 2000, 10000, 0 })
+    {
+        params.timeBudgetUs = budgetUs;
+
+        int64_t totalUs = 0;
+        int64_t maxUs = 0;
+        int numFound = 0;
+        double totalBound = 0.0;
+
+        for(std::size_t n = 0; n < queries.size(); ++n)
+        {
+            int64_t startTime = utime_now();
+            robot_path_t path = planner.plan(queries[n].start, queries[n].goal, distances, params);
+            int64_t elapsedUs = utime_now() - startTime;
+
+            totalUs += elapsedUs;
+            maxUs = std::max(maxUs, elapsedUs);
+
+            if(path.path_length > 1)
+            {
+                float bound = planner.suboptimalityBound();
+                float cost = path_cost(path, distances, params);
+                ++numFound;
+                totalBound += bound;
+
+                if((bound < 1.0f) || (cost > bound * cheapestCosts[n] * 1.0001f))
+                {
+                    std::cout << "Query " << n << " path costs " << cost << ", more than its bound " << bound
+                        << " times the cheapest cost " << cheapestCosts[n] << '\n';
+                    allCorrect = false;
+                }
+            }
+        }
+
+        printf("%10lld %12lld %12lld %12d %12.3f\n",
+               static_cast<long long>(budgetUs),
+               static_cast<long long>(totalUs / kNumQueries),
+               static_cast<long long>(maxUs),
+               numFound,
+               (numFound > 0) ? totalBound / numFound : 0.0);
+    }
+
+    return allCorrect;
+}
+
+
+bool test_background_improvement(void)
+{
+    OccupancyGrid grid = generate_office_grid(50.0f, 0.05f, 3.0, 1);
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    SearchParams params = search_params(anytime_astar);
+    std::vector<PlanQuery> queries = random_queries(distances, params, 5, 5);
+
+    AStarWorkspace workspace;
+    AnytimePlanner planner;
+
+    for(auto& query : queries)
+    {
+        robot_path_t cheapestPath = search_for_path(query.start, query.goal, distances, params, workspace);
+        float cheapestCost = path_cost(cheapestPath, distances, params);
+
+        // Stopping partway leaves a search that can be continued
+        params.timeBudgetUs = 200;
+        planner.plan(query.start, query.goal, distances, params);
+        planner.improveInBackground();
+        planner.stopImproving();
+        if(planner.isImproving())
+        {
+            std::cout << "Background search still running after stopImproving\n";
+            return false;
+        }
+
+        planner.improveInBackground();
+        while(planner.isImproving())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        robot_path_t path = planner.bestPath();
+        float cost = path_cost(path, distances, params);
+        if(!planner.isFinished() || (planner.suboptimalityBound() != 1.0f)
+            || (std::abs(cost - cheapestCost) > 1.0e-4f * cheapestCost))
+        {
+            std::cout << "Background search ended with a path costing " << cost << " instead of " << cheapestCost
+                << " with bound " << planner.suboptimalityBound() << " after " << planner.numIterations()
+                << " iterations\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_motion_planner(void)
+{
+    OccupancyGrid grid = generate_office_grid(30.0f, 0.05f, 3.0, 2);
+
+    MotionPlannerParams params = planner_params();
+    params.searchMode = anytime_astar;
+    params.timeBudgetUs = 1000;
+
+    MotionPlanner planner = make_planner(grid, params);
+    std::vector<PlanQuery> queries = random_queries(planner, 10, 6);
+    for(auto& query : queries)
+    {
+        robot_path_t path = planner.planPath(query.start, query.goal);
+        if(!planner.isPathSafe(path))
+        {
+            std::cout << "planPath found an unsafe path\n";
+            return false;
+        }
+
+        // Changing the map must stop the search before the distances change
+        planner.improvePathInBackground();
+        planner.setMap(grid);
+
+        robot_path_t improvedPath = planner.improvedPath();
+        if(!planner.isPathSafe(improvedPath) || (planner.suboptimalityBound() < 1.0f))
+        {
+            std::cout << "Improved path is unsafe or has bound " << planner.suboptimalityBound() << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_set_params(void)
+{
+    OccupancyGrid grid = generate_office_grid(30.0f, 0.05f, 3.0, 3);
+    MotionPlanner planner = make_planner(grid);
+    std::vector<PlanQuery> queries = random_queries(planner, 10, 7);
+
+    // Only the anytime_astar mode sets a bound, so a finite one shows which mode planned the path
+    planner.planPath(queries[0].start, queries[0].goal);
+    if(planner.suboptimalityBound() != std::numeric_limits<float>::infinity())
+    {
+        std::cout << "grid_astar planned with ARA*\n";
+        return false;
+    }
+
+    MotionPlannerParams params = planner_params();
+    params.searchMode = anytime_astar;
+    planner.setParams(params);
+
+    for(auto& query : queries)
+    {
+        robot_path_t path = planner.planPath(query.start, query.goal);
+        if((path.path_length > 1) && (planner.suboptimalityBound() != 1.0f))
+        {
+            std::cout << "setParams didn't switch to anytime_astar: bound " << planner.suboptimalityBound() << '\n';
+            return false;
+        }
+    }
+
+    // A wider robot must keep farther from obstacles, even on paths that were cached before the change
+    params.searchMode = grid_astar;
+    params.robotRadius = 3.0 * planner_params().robotRadius;
+    planner.setParams(params);
+
+    ObstacleDistanceGrid distances = planner.obstacleDistances();
+    for(auto& query : queries)
+    {
+        robot_path_t path = planner.planPath(query.start, query.goal);
+        cell_t goalCell = global_position_to_grid_cell(Point<double>(query.goal.x, query.goal.y), distances);
+        if(planner.isValidGoal(query.goal) != (distances(goalCell.x, goalCell.y) > params.robotRadius))
+        {
+            std::cout << "isValidGoal used the old radius\n";
+            return false;
+        }
+
+        if((path.path_length > 1) && !planner.isPathSafe(path))
+        {
+            std::cout << "Path is unsafe for the new radius\n";
+            return false;
+        }
+
+        for(std::size_t n = 1; n < path.path.size(); ++n)
+        {
+            cell_t cell = path_cell(path.path[n], distances);
+            if(distances(cell.x, cell.y) <= params.robotRadius)
+            {
+                std::cout << "Path passes " << distances(cell.x, cell.y) << " m from an obstacle with radius "
+                    << params.robotRadius << '\n';
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+std::vector<PlanQuery> random_queries(const ObstacleDistanceGrid& distances,
+                                      const SearchParams& params,
+                                      int numQueries,
+                                      uint32_t seed)
+{
+    // Queries between the centers of random cells the robot fits in
+    std::mt19937 rng(seed);
+
+    auto randomPose = [&]() {
+        cell_t cell;
+        do
+        {
+            cell = cell_t(rng() % distances.widthInCells(), rng() % distances.heightInCells());
+        } while(distances(cell.x, cell.y) <= params.minDistanceToObstacle*1.000001);
+
+        Point<double> position = grid_position_to_global_position(Point<double>(cell.x + 0.5, cell.y + 0.5),
+                                                                   distances);
+        pose_xyt_t pose;
+        pose.utime = 0;
+        pose.x = position.x;
+        pose.y = position.y;
+        pose.theta = 0.0f;
+        return pose;
+    };
+
+    std::vector<PlanQuery> queries(numQueries);
+    for(auto& query : queries)
+    {
+        query.start = randomPose();
+        query.goal = randomPose();
+    }
+    return queries;
+}
@@ -1,274 +1,889 @@
 #include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/landmark_heuristic.hpp>
 #include <planning/obstacle_distance_grid.hpp>
 #include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
-#include <queue>
+#include <string>
+#include <utility>
 #include <vector>
-#include <stack>
 
-robot_path_t search_for_path(pose_xyt_t start, 
-                             pose_xyt_t goal, 
-                             const ObstacleDistanceGrid& distances,
-                             const SearchParams& params)
-{  
-    printf("\nin global Start x: %f, y: %f --- Goal x: %f,y: %f\n",start.x,start.y,goal.x,goal.y);
-    // initializing open and closed list
-    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> openList;
-    std::vector<Node> closedList;
+namespace
+{
 
-    robot_path_t path;
-    path.utime = start.utime;
-    path.path.push_back(start);  
-    
-    Point<double> goalPoint;
-    goalPoint.x = goal.x;
-    goalPoint.y = goal.y;
-    cell_t end = global_position_to_grid_cell(goalPoint, distances);
+const float kSqrt2 = 1.41421356f;
 
+// Number of cells expanded between checks of the clock when a search has a time budget
+const int kExpansionsPerClockCheck = 64;
 
-    Point<double> startPoint;
-    startPoint.x = start.x;
-    startPoint.y = start.y;
-    double initialtheta = start.theta;
-    cell_t startCell = global_position_to_grid_cell(startPoint, distances);
+// Moves are 4-connected, so the Manhattan distance is the tightest admissible heuristic
+float h_cost(int x, int y, cell_t goal, float metersPerCell)
+{
+    return (std::abs(goal.x - x) + std::abs(goal.y - y)) * metersPerCell;
+}
 
-    printf("in cell Start x: %d, y: %d --- Goal x: %d,y: %d\n",startCell.x,startCell.y,end.x,end.y);
 
+// For 8-connected moves, the octile distance is the tightest admissible heuristic. It's also the length of a jump.
+float octile_distance(int x, int y, cell_t goal, float metersPerCell)
+{
+    int dx = std::abs(goal.x - x);
+    int dy = std::abs(goal.y - y);
+    return (std::max(dx, dy) + (kSqrt2 - 1.0f) * std::min(dx, dy)) * metersPerCell;
+}
 
-    // check conditions!!
-    // VALID GOAL
-    if (!isValid(end, distances, params.minDistanceToObstacle)){
-		printf("Destination is cannot be reached\n");
-		path.path_length = path.path.size();
-		return path;
-    }  
-    // VALID HOME	
-	if (!isValid(startCell, distances, params.minDistanceToObstacle)){
-		printf("Origin is invalid\n");
-		path.path_length = path.path.size();
-		return path;
-    } 
-    // If Home == Goal
-	if(isDestination(startCell, end)){
-        printf("Already at Destination\n");
-		path.path_length = path.path.size();
-        return path;
+
+int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+
+robot_path_t make_path(int goalIndex,
+                       int startIndex,
+                       const pose_xyt_t& start,
+                       const ObstacleDistanceGrid& distances,
+                       const AStarWorkspace& workspace)
+{
+    const int width = distances.widthInCells();
+
+    // Walk the parents back from the goal to find the cells along the path, excluding the start cell. A parent is
+    // either adjacent to its child or the start of a straight or diagonal jump to it, so fill in the cells jumped over.
+    std::vector<cell_t> cells;
+    for(int index = goalIndex; index != startIndex; index = workspace.parent(index))
+    {
+        int parentIndex = workspace.parent(index);
+        cell_t cell(index % width, index / width);
+        cell_t parent(parentIndex % width, parentIndex / width);
+        cell_t step(sign(parent.x - cell.x), sign(parent.y - cell.y));
+
+        for(; cell != parent; cell += step)
+        {
+            cells.push_back(cell);
+        }
     }
-	
-	if(!distances.isCellInGrid(end.x, end.y) || !distances.isCellInGrid(startCell.x, startCell.y)){
-		printf("Start or Destination not in grid \n");
-		path.path_length = path.path.size();
-        return path;
-	}
-
-
-    Node firstNode;
-    firstNode.cell = startCell;
-    firstNode.gCost = 0;
-    firstNode.hCost = 0;
-    firstNode.fCost = 0;
-    openList.push(firstNode);
-
-    // bool destinationFound = false;
-      
-
-    while (!openList.empty()){
-        int breakcount = 0;
-        Node nNode = openList.top();
-        closedList.push_back(nNode);
-        openList.pop();
-        vector<Node> kids = expand_node(nNode, distances);
-        vector<Node> templist = closedList;
-        Node tempnode;
-        // printf("\nClosedList \n");
-        for (auto& element : templist) {
-            // printf("node x: %d y: %d -- parent x: %d y: %d\n", element.cell.x, element.cell.y, element.parent.x, element.parent.y);
+
+    std::reverse(cells.begin(), cells.end());
+    return cells_to_path(start, cells, distances);
+}
+
+
+bool grid_astar_search(cell_t startCell,
+                       cell_t goalCell,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params,
+                       AStarWorkspace& workspace)
+{
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    const int startIndex = startCell.y*width + startCell.x;
+    const int goalIndex = goalCell.y*width + goalCell.x;
+
+    const int xDeltas[4] = { 1, -1, 0,  0 };
+    const int yDeltas[4] = { 0,  0, 1, -1 };
+
+    // With landmarks, the heuristic is the larger of the Manhattan distance and the landmarks' bound on the cost of
+    // the rest of the path -- see LandmarkHeuristic::lowerBound. Both are consistent, so their maximum is too.
+    const LandmarkHeuristic* landmarks = params.landmarks;
+    const float goalObstacleCost = obstacle_cost(distances(goalCell.x, goalCell.y), params);
+    auto heuristic = [&](int x, int y, int index, float cellObstacleCost) {
+        float hCost = h_cost(x, y, goalCell, metersPerCell);
+        if(landmarks)
+        {
+            float landmarkCost = landmarks->lowerBound(index, goalIndex) + 0.5f*(goalObstacleCost - cellObstacleCost);
+            hCost = std::max(hCost, landmarkCost);
+        }
+        return hCost;
+    };
+
+    workspace.setCost(startIndex, 0.0f, AStarWorkspace::kNoParent);
+
+    IndexedHeap<float>& openList = workspace.openList();
+    openList.push(startIndex, heuristic(startCell.x, startCell.y, startIndex,
+                                        obstacle_cost(distances(startCell.x, startCell.y), params)));
+
+    while(!openList.empty())
+    {
+        int index = openList.pop();
+
+        if(index == goalIndex)
+        {
+            return true;
         }
-        // printf("Node ----- x: %d, y: %d\n", nNode.cell.x, nNode.cell.y);   
-
-        priority_queue<Node, vector<Node>, greater<Node>> tempopen = openList;
-        Node opennode;
-        // printf("\nOPENLIST \n");
-        while (!tempopen.empty()){
-			opennode = tempopen.top();
-            // printf("x: %d, y: %d, fcost: %d, gcost: %d\n", opennode.cell.x, opennode.cell.y, opennode.fCost, opennode.gCost);
-			tempopen.pop();
-		}
-        for (auto& kid : kids){
-            Node ngbr;      // neighbour
-            if(is_member(kid.cell, closedList)){
-                ngbr = get_member(kid.cell, closedList);
-            }else{
-                ngbr = kid;
-                ngbr.fCost = INT16_MAX;
+
+        workspace.close(index);
+
+        const int x = index % width;
+        const int y = index / width;
+        const float gCost = workspace.gCost(index);
+
+        for(int n = 0; n < 4; ++n)
+        {
+            cell_t adjacent(x + xDeltas[n], y + yDeltas[n]);
+
+            if(!is_traversable(adjacent.x, adjacent.y, distances, params))
+            {
+                continue;
             }
-            // printf("Neighbour ----- x: %d, y: %d\n", ngbr.cell.x, ngbr.cell.y);
-            if(isValid(ngbr.cell, distances, params.minDistanceToObstacle)){
-                if (is_goal(ngbr.cell, end)){
-                    robot_path_t usablePath;
-                    usablePath.utime = start.utime;
-                    usablePath.path.push_back(start);  
-                    // destinationFound = true;
-                    // printf("Found Path \n");
-                    return makePath(ngbr, firstNode, initialtheta, usablePath, distances, closedList);
-                }
-                
-                int gNew, hNew, fNew, obstacleCost = 0;
-                gNew = get_gCost(nNode, ngbr.cell);
-                hNew = get_hCost(end, ngbr.cell);
-                obstacleCost = get_oCost(ngbr.cell, params, distances);
-                fNew = gNew + hNew + obstacleCost;
-
-                // printf("gnew: %d, hnew: %d, fnew: %d, gCost: %d, hCost: %d, fCost: %d\n", gNew, hNew, fNew, ngbr.gCost, ngbr.hCost, ngbr.fCost);
-                
-                if(!is_member(ngbr.cell, closedList)){
-                    if(ngbr.fCost > fNew){
-                        ngbr.gCost = gNew;
-                        ngbr.hCost = hNew;
-                        ngbr.fCost = fNew;
-                        ngbr.parent = nNode.cell;
-                        openList.push(ngbr);
-                    }
-                } 
+
+            int adjacentIndex = adjacent.y*width + adjacent.x;
+            if(workspace.isClosed(adjacentIndex))
+            {
+                continue;
+            }
+
+            float adjacentObstacleCost = obstacle_cost(distances(adjacent.x, adjacent.y), params);
+            float gNew = gCost + metersPerCell + adjacentObstacleCost;
+            if(gNew < workspace.gCost(adjacentIndex))
+            {
+                workspace.setCost(adjacentIndex, gNew, index);
+                openList.pushOrDecrease(adjacentIndex,
+                                        gNew + heuristic(adjacent.x, adjacent.y, adjacentIndex, adjacentObstacleCost));
             }
         }
     }
 
+    return false;
 }
 
-// to check if cell is not obstacle and is in the cellgrid
-bool isValid(cell_t givenCell, const ObstacleDistanceGrid& distances, const double minDist) { 
-	if (distances(givenCell.x, givenCell.y) >  minDist*1.000001) {
-		if (givenCell.x < 0 || givenCell.y < 0 || givenCell.x >= (distances.widthInCells()) || 
-            givenCell.y >= (distances.heightInCells())) {
+
+/*
+* JumpGrid answers the cell queries needed by jump point search.
+*
+* Jump point search relies on every move within a region costing the same, so it only jumps through open cells, which
+* are free cells, those with no distance cost, whose traversable neighbors are all free too. A jump stops at the
+* first cell that isn't open, so the cells with a distance cost, and the free cells bordering them, are reached and
+* expanded one at a time like A*.
+*
+* Diagonal moves can't cut the corner of an untraversable cell, so the robot never squeezes diagonally between two
+* cells that are too close to obstacles.
+*
+* Whether a cell is open and where the straight jumps from it end are cached in the workspace, so each is only
+* computed once per search no matter how many diagonal jumps pass through the cell.
+*/
+class JumpGrid
+{
+public:
+
+    JumpGrid(const ObstacleDistanceGrid& distances,
+             const SearchParams& params,
+             cell_t goal,
+             AStarWorkspace& workspace)
+    : distances_(distances)
+    , params_(params)
+    , goal_(goal)
+    , width_(distances.widthInCells())
+    , workspace_(workspace)
+    {
+    }
+
+    bool isTraversable(int x, int y) const
+    {
+        return is_traversable(x, y, distances_, params_);
+    }
+
+    // A free cell can be traversed and has no distance cost
+    bool isFree(int x, int y) const
+    {
+        return isTraversable(x, y) && (distances_(x, y) >= params_.maxDistanceWithCost);
+    }
+
+    bool isOpen(int x, int y)
+    {
+        if(!isFree(x, y))
+        {
             return false;
         }
-        return true;
-    } 
-    return false;
-}
 
-bool isDestination(cell_t home, cell_t goal) 
+        AStarWorkspace::JumpState& state = workspace_.jumpState(y*width_ + x);
+        if(state.isOpen == AStarWorkspace::JumpState::kUnknown)
+        {
+            state.isOpen = 1;
+            for(int dy = -1; (dy <= 1) && state.isOpen; ++dy)
+            {
+                for(int dx = -1; (dx <= 1) && state.isOpen; ++dx)
+                {
+                    if(isTraversable(x + dx, y + dy) && !isFree(x + dx, y + dy))
+                    {
+                        state.isOpen = 0;
+                    }
+                }
+            }
+        }
+
+        return state.isOpen;
+    }
+
+    bool canMove(int x, int y, int dx, int dy) const
+    {
+        return isTraversable(x + dx, y + dy)
+            && ((dx == 0) || (dy == 0) || (isTraversable(x + dx, y) && isTraversable(x, y + dy)));
+    }
+
+    // A cell reached moving straight has a forced neighbor beside it if the cell behind that neighbor is blocked
+    bool hasForcedNeighbor(int x, int y, int dx, int dy) const
+    {
+        return (isTraversable(x + dy, y + dx) && !isTraversable(x + dy - dx, y + dx - dy))
+            || (isTraversable(x - dy, y - dx) && !isTraversable(x - dy - dx, y - dx - dy));
+    }
+
+    /*
+    * jump moves from (x, y) in direction (dx, dy) until reaching a cell that must be expanded: the goal, a cell that
+    * isn't open, or a cell with a forced neighbor, i.e. a neighbor whose shortest path must pass through the cell.
+    *
+    * \return   True if a jump point was found, which is stored in jumpPoint.
+    */
+    bool jump(int x, int y, int dx, int dy, cell_t& jumpPoint)
+    {
+        while(canMove(x, y, dx, dy))
+        {
+            x += dx;
+            y += dy;
+
+            bool isJumpPoint = false;
+            if((x == goal_.x && y == goal_.y) || !isOpen(x, y))
+            {
+                isJumpPoint = true;
+            }
+            else if(dx != 0 && dy != 0)
+            {
+                // A diagonal jump stops wherever one of its straight components would find a jump point
+                isJumpPoint = (straightJump(x, y, dx, 0) != AStarWorkspace::JumpState::kNotJumped)
+                    || (straightJump(x, y, 0, dy) != AStarWorkspace::JumpState::kNotJumped);
+            }
+            else
+            {
+                isJumpPoint = hasForcedNeighbor(x, y, dx, dy);
+            }
+
+            if(isJumpPoint)
+            {
+                jumpPoint = cell_t(x, y);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*
+    * straightJump finds the jump point of a straight jump made from a cell passed by a diagonal jump. These jumps only
+    * look for the goal and forced neighbors and treat cells that aren't open like obstacles. Otherwise, every diagonal
+    * jump would stop after one step, because every straight jump eventually runs into the cells with a distance cost
+    * around the obstacles. Those cells are still reached by the jumps from the cells the diagonal jump stops at.
+    *
+    * Every cell passed along the way leads to the same jump point, so the result is cached for all of them.
+    *
+    * \return   Index of the jump point or JumpState::kNotJumped if there isn't one.
+    */
+    int straightJump(int x, int y, int dx, int dy)
+    {
+        const int direction = (dx != 0) ? (dx > 0 ? 0 : 1) : (dy > 0 ? 2 : 3);
+
+        int jumpIndex = AStarWorkspace::JumpState::kNotJumped;
+        int endX = x;
+        int endY = y;
+        while(true)
+        {
+            int cached = workspace_.jumpState(endY*width_ + endX).jumps[direction];
+            if(cached != AStarWorkspace::JumpState::kNotJumped)
+            {
+                jumpIndex = cached;
+                break;
+            }
+
+            if(!canMove(endX, endY, dx, dy))
+            {
+                jumpIndex = kNoJumpPoint;
+                break;
+            }
+
+            int nextX = endX + dx;
+            int nextY = endY + dy;
+            if((nextX == goal_.x && nextY == goal_.y) || (isOpen(nextX, nextY) && hasForcedNeighbor(nextX, nextY, dx, dy)))
+            {
+                jumpIndex = nextY*width_ + nextX;
+                break;
+            }
+            else if(!isOpen(nextX, nextY))
+            {
+                jumpIndex = kNoJumpPoint;
+                break;
+            }
+
+            endX = nextX;
+            endY = nextY;
+        }
+
+        for(; (x != endX) || (y != endY); x += dx, y += dy)
+        {
+            workspace_.jumpState(y*width_ + x).jumps[direction] = jumpIndex;
+        }
+        workspace_.jumpState(endY*width_ + endX).jumps[direction] = jumpIndex;
+
+        return (jumpIndex == kNoJumpPoint) ? AStarWorkspace::JumpState::kNotJumped : jumpIndex;
+    }
+
+    /*
+    * successorDirections finds the directions to search from a cell reached from parent. Directions from an open cell
+    * are pruned to those where a shortest path could continue through the cell. Every direction is searched from the
+    * start and from cells that aren't open.
+    */
+    int successorDirections(cell_t cell, int parentIndex, cell_t* directions)
+    {
+        int numDirections = 0;
+
+        if(parentIndex == AStarWorkspace::kNoParent || !isOpen(cell.x, cell.y))
+        {
+            for(int dy = -1; dy <= 1; ++dy)
+            {
+                for(int dx = -1; dx <= 1; ++dx)
+                {
+                    if((dx != 0 || dy != 0) && canMove(cell.x, cell.y, dx, dy))
+                    {
+                        directions[numDirections++] = cell_t(dx, dy);
+                    }
+                }
+            }
+            return numDirections;
+        }
+
+        const int dx = sign(cell.x - parentIndex % width_);
+        const int dy = sign(cell.y - parentIndex / width_);
+
+        // Moving diagonally, keep going diagonally or along either of its straight components
+        if(dx != 0 && dy != 0)
+        {
+            const cell_t candidates[3] = { cell_t(dx, 0), cell_t(0, dy), cell_t(dx, dy) };
+            for(auto& direction : candidates)
+            {
+                if(canMove(cell.x, cell.y, direction.x, direction.y))
+                {
+                    directions[numDirections++] = direction;
+                }
+            }
+        }
+        // Moving straight, keep going straight. Also turn toward a neighbor beside the cell if the cell behind it is
+        // blocked, because then the shortest path to that neighbor passes through this cell.
+        else
+        {
+            if(canMove(cell.x, cell.y, dx, dy))
+            {
+                directions[numDirections++] = cell_t(dx, dy);
+            }
+
+            for(int side = -1; side <= 1; side += 2)
+            {
+                const cell_t sideways(dy * side, dx * side);
+                if(isTraversable(cell.x + sideways.x, cell.y + sideways.y)
+                    && !isTraversable(cell.x + sideways.x - dx, cell.y + sideways.y - dy))
+                {
+                    directions[numDirections++] = sideways;
+                    if(canMove(cell.x, cell.y, dx + sideways.x, dy + sideways.y))
+                    {
+                        directions[numDirections++] = cell_t(dx + sideways.x, dy + sideways.y);
+                    }
+                }
+            }
+        }
+
+        return numDirections;
+    }
+
+private:
+
+    // Cached for straight jumps that end without a jump point, since kNotJumped marks jumps that haven't been made
+    static const int kNoJumpPoint = -1;
+
+    const ObstacleDistanceGrid& distances_;
+    const SearchParams& params_;
+    cell_t goal_;
+    int width_;
+    AStarWorkspace& workspace_;
+};
+
+
+bool jump_point_search(cell_t startCell,
+                       cell_t goalCell,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params,
+                       AStarWorkspace& workspace)
 {
-    if (home.x == goal.x && home.y == goal.y) {
-        return true;
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    const int startIndex = startCell.y*width + startCell.x;
+    const int goalIndex = goalCell.y*width + goalCell.x;
+
+    workspace.beginJumpPointSearch();
+    JumpGrid grid(distances, params, goalCell, workspace);
+
+    workspace.setCost(startIndex, 0.0f, AStarWorkspace::kNoParent);
+
+    IndexedHeap<float>& openList = workspace.openList();
+    openList.push(startIndex, octile_distance(startCell.x, startCell.y, goalCell, metersPerCell));
+
+    cell_t directions[8];
+
+    while(!openList.empty())
+    {
+        int index = openList.pop();
+
+        if(index == goalIndex)
+        {
+            return true;
+        }
+
+        workspace.close(index);
+
+        const cell_t cell(index % width, index / width);
+        const float gCost = workspace.gCost(index);
+        const bool isOpen = grid.isOpen(cell.x, cell.y);
+
+        int numDirections = grid.successorDirections(cell, workspace.parent(index), directions);
+        for(int n = 0; n < numDirections; ++n)
+        {
+            // Open cells jump to the next cell that must be expanded. Other cells only move to their neighbors.
+            cell_t successor(cell.x + directions[n].x, cell.y + directions[n].y);
+            if(isOpen && !grid.jump(cell.x, cell.y, directions[n].x, directions[n].y, successor))
+            {
+                continue;
+            }
+
+            int successorIndex = successor.y*width + successor.x;
+            if(workspace.isClosed(successorIndex))
+            {
+                continue;
+            }
+
+            // Every cell jumped over is free, so only the successor can have a distance cost
+            float gNew = gCost
+                + octile_distance(cell.x, cell.y, successor, metersPerCell)
+                + obstacle_cost(distances(successor.x, successor.y), params);
+            if(gNew < workspace.gCost(successorIndex))
+            {
+                workspace.setCost(successorIndex, gNew, index);
+                openList.pushOrDecrease(successorIndex,
+                                        gNew + octile_distance(successor.x, successor.y, goalCell, metersPerCell));
+            }
+        }
     }
+
     return false;
 }
 
 
+/*
+* bidirectional_astar_search runs A* forward from the start and backward from the goal at the same time, expanding
+* whichever direction has the smaller open list. The backward search finds the cost from each cell to the goal, so
+* moving into a cell still costs that cell's distance cost and both directions agree on the cost of every path.
+*
+* Both directions order their open lists by the same balanced heuristic, half the difference between the Manhattan
+* distances to the goal and to the start, which the forward search adds and the reverse search subtracts. Since the
+* heuristic is consistent for both directions, the two searches behave like a bidirectional Dijkstra search on the same
+* reduced costs. Whenever one direction reaches a cell the other has already reached, the path through that cell is a
+* candidate, and the best candidate is the cheapest path once the smallest f-costs of the open lists add up to at least
+* its cost.
+*/
+bool bidirectional_astar_search(cell_t startCell,
+                                cell_t goalCell,
+                                const ObstacleDistanceGrid& distances,
+                                const SearchParams& params,
+                                AStarWorkspace& workspace,
+                                int& meetingIndex)
+{
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    const int startIndex = startCell.y*width + startCell.x;
+    const int goalIndex = goalCell.y*width + goalCell.x;
+
+    const int xDeltas[4] = { 1, -1, 0,  0 };
+    const int yDeltas[4] = { 0,  0, 1, -1 };
+
+    workspace.beginBidirectionalSearch();
+
+    IndexedHeap<float>& forwardList = workspace.openList();
+    IndexedHeap<float>& reverseList = workspace.reverseOpenList();
+
+    auto balancedHeuristic = [&](int x, int y) {
+        return 0.5f * (h_cost(x, y, goalCell, metersPerCell) - h_cost(x, y, startCell, metersPerCell));
+    };
+
+    workspace.setCost(startIndex, 0.0f, AStarWorkspace::kNoParent);
+    forwardList.push(startIndex, balancedHeuristic(startCell.x, startCell.y));
+    workspace.setReverseCost(goalIndex, 0.0f, AStarWorkspace::kNoParent);
+    reverseList.push(goalIndex, -balancedHeuristic(goalCell.x, goalCell.y));
+
+    float bestCost = AStarWorkspace::kInfiniteCost;
+    meetingIndex = AStarWorkspace::kNoParent;
+
+    while(!forwardList.empty() && !reverseList.empty() && (forwardList.topKey() + reverseList.topKey() < bestCost))
+    {
+        const bool isForward = forwardList.size() <= reverseList.size();
+        const int index = isForward ? forwardList.pop() : reverseList.pop();
+        const int x = index % width;
+        const int y = index / width;
+
+        float gCost;
+        float reverseStepCost = 0.0f;
+        if(isForward)
+        {
+            workspace.close(index);
+            gCost = workspace.gCost(index);
+        }
+        else
+        {
+            // Moving from any neighbor into this cell costs the same
+            workspace.closeReverse(index);
+            gCost = workspace.reverseGCost(index);
+            reverseStepCost = metersPerCell + obstacle_cost(distances(x, y), params);
+        }
+
+        for(int n = 0; n < 4; ++n)
+        {
+            cell_t adjacent(x + xDeltas[n], y + yDeltas[n]);
+
+            if(!is_traversable(adjacent.x, adjacent.y, distances, params))
+            {
+                continue;
+            }
+
+            int adjacentIndex = adjacent.y*width + adjacent.x;
+
+            if(isForward)
+            {
+                if(workspace.isClosed(adjacentIndex))
+                {
+                    continue;
+                }
+
+                float gNew = gCost + metersPerCell + obstacle_cost(distances(adjacent.x, adjacent.y), params);
+                if(gNew < workspace.gCost(adjacentIndex))
+                {
+                    workspace.setCost(adjacentIndex, gNew, index);
+                    forwardList.pushOrDecrease(adjacentIndex, gNew + balancedHeuristic(adjacent.x, adjacent.y));
+
+                    float reverseCost = workspace.reverseGCost(adjacentIndex);
+                    if((reverseCost != AStarWorkspace::kInfiniteCost) && (gNew + reverseCost < bestCost))
+                    {
+                        bestCost = gNew + reverseCost;
+                        meetingIndex = adjacentIndex;
+                    }
+                }
+            }
+            else
+            {
+                if(workspace.isReverseClosed(adjacentIndex))
+                {
+                    continue;
+                }
 
-int get_gCost(Node parent, cell_t current){
-    int x = abs(parent.cell.x - current.x); 
-    int y = abs(parent.cell.y - current.y);
-    if((x == 1) & (y == 1))
-        return parent.gCost + 14;
-    else
-        return parent.gCost + 10;
+                float gNew = gCost + reverseStepCost;
+                if(gNew < workspace.reverseGCost(adjacentIndex))
+                {
+                    workspace.setReverseCost(adjacentIndex, gNew, index);
+                    reverseList.pushOrDecrease(adjacentIndex, gNew - balancedHeuristic(adjacent.x, adjacent.y));
+
+                    float forwardCost = workspace.gCost(adjacentIndex);
+                    if((forwardCost != AStarWorkspace::kInfiniteCost) && (forwardCost + gNew < bestCost))
+                    {
+                        bestCost = forwardCost + gNew;
+                        meetingIndex = adjacentIndex;
+                    }
+                }
+            }
+        }
+    }
+
+    return meetingIndex != AStarWorkspace::kNoParent;
 }
 
-int get_hCost(Point<double> goal, cell_t current){
-    int x = abs(goal.x - current.x);
-    int y = abs(goal.y - current.y);
-    int cost;
-    if (x >= y)
-        cost = 14*y + 10*(x-y);
-    else
-        cost = 14*x + 10*(y-x);
-    return cost;
+
+robot_path_t make_bidirectional_path(int meetingIndex,
+                                     int startIndex,
+                                     const pose_xyt_t& start,
+                                     const ObstacleDistanceGrid& distances,
+                                     const AStarWorkspace& workspace)
+{
+    const int width = distances.widthInCells();
+
+    // The forward parents lead from the meeting cell back to the start and the reverse parents lead on to the goal
+    std::vector<cell_t> cells;
+    for(int index = meetingIndex; index != startIndex; index = workspace.parent(index))
+    {
+        cells.push_back(cell_t(index % width, index / width));
+    }
+    std::reverse(cells.begin(), cells.end());
+
+    for(int index = workspace.reverseParent(meetingIndex); index != AStarWorkspace::kNoParent;
+        index = workspace.reverseParent(index))
+    {
+        cells.push_back(cell_t(index % width, index / width));
+    }
+
+    return cells_to_path(start, cells, distances);
 }
 
-int get_oCost(cell_t cell, const SearchParams& params, const ObstacleDistanceGrid& distances){
-    int obstacleCost = 0;
-    if (distances(cell.x, cell.y) > params.minDistanceToObstacle && distances(cell.x, cell.y) < params.maxDistanceWithCost)
-        obstacleCost = static_cast<int>(pow(params.maxDistanceWithCost - distances(cell.x, cell.y)*2000, params.distanceCostExponent));
-    return obstacleCost;
 }
 
-bool is_member(const cell_t toSearch_cell, vector<Node> givenList){
-    for (auto& n : givenList){
-        if (n.cell.x == toSearch_cell.x && n.cell.y == toSearch_cell.y){   
-            return true;
+
+bool expand_cost_field(const pose_xyt_t& start,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params,
+                       AStarWorkspace& workspace)
+{
+    const int64_t deadlineUs = (params.timeBudgetUs > 0) ? utime_now() + params.timeBudgetUs : 0;
+
+    workspace.beginSearch(distances.widthInCells(), distances.heightInCells());
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    if(!is_traversable(startCell.x, startCell.y, distances, params))
+    {
+        return false;
+    }
+
+    // This is grid_astar_search without a goal or heuristic, i.e. Dijkstra's algorithm, so it runs until every
+    // reachable cell is closed or the time budget runs out
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    const int startIndex = startCell.y*width + startCell.x;
+
+    const int xDeltas[4] = { 1, -1, 0,  0 };
+    const int yDeltas[4] = { 0,  0, 1, -1 };
+
+    workspace.setCost(startIndex, 0.0f, AStarWorkspace::kNoParent);
+
+    IndexedHeap<float>& openList = workspace.openList();
+    openList.push(startIndex, 0.0f);
+
+    for(std::size_t numExpanded = 1; !openList.empty(); ++numExpanded)
+    {
+        if((deadlineUs > 0) && (numExpanded % kExpansionsPerClockCheck == 0) && (utime_now() >= deadlineUs))
+        {
+            break;
+        }
+
+        int index = openList.pop();
+        workspace.close(index);
+
+        const int x = index % width;
+        const int y = index / width;
+        const float gCost = workspace.gCost(index);
+
+        for(int n = 0; n < 4; ++n)
+        {
+            cell_t adjacent(x + xDeltas[n], y + yDeltas[n]);
+
+            if(!is_traversable(adjacent.x, adjacent.y, distances, params))
+            {
+                continue;
+            }
+
+            int adjacentIndex = adjacent.y*width + adjacent.x;
+            if(workspace.isClosed(adjacentIndex))
+            {
+                continue;
+            }
+
+            float gNew = gCost + metersPerCell + obstacle_cost(distances(adjacent.x, adjacent.y), params);
+            if(gNew < workspace.gCost(adjacentIndex))
+            {
+                workspace.setCost(adjacentIndex, gNew, index);
+                openList.pushOrDecrease(adjacentIndex, gNew);
+            }
         }
     }
-    return false;
+
+    return true;
 }
 
-Node get_member(const cell_t toSearch_cell, vector<Node> givenList){
-    for (auto& n : givenList){
-        if (n.cell.x == toSearch_cell.x && n.cell.y == toSearch_cell.y){   
-            return n;
+
+robot_path_t path_in_cost_field(const pose_xyt_t& start,
+                                const pose_xyt_t& goal,
+                                const ObstacleDistanceGrid& distances,
+                                const AStarWorkspace& workspace)
+{
+    robot_path_t path;
+    path.utime = start.utime;
+    path.path.push_back(start);
+    path.path_length = path.path.size();
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    if(!distances.isCellInGrid(startCell.x, startCell.y) || !distances.isCellInGrid(goalCell.x, goalCell.y)
+        || (startCell == goalCell))
+    {
+        return path;
+    }
+
+    const int width = distances.widthInCells();
+    const int goalIndex = goalCell.y*width + goalCell.x;
+    if(!workspace.isClosed(goalIndex))
+    {
+        return path;
+    }
+
+    return make_path(goalIndex, startCell.y*width + startCell.x, start, distances, workspace);
+}
+
+
+robot_path_t cells_to_path(const pose_xyt_t& start,
+                           const std::vector<cell_t>& cells,
+                           const ObstacleDistanceGrid& distances)
+{
+    robot_path_t path;
+    path.utime = start.utime;
+    path.path.reserve(cells.size() + 1);
+    path.path.push_back(start);
+
+    // Each pose faces the next cell in the path. The final pose keeps the starting heading.
+    for(auto cellIt = cells.begin(); cellIt != cells.end(); ++cellIt)
+    {
+        Point<double> position = grid_position_to_global_position(Point<double>(cellIt->x, cellIt->y), distances);
+
+        pose_xyt_t pose;
+        pose.utime = start.utime;
+        pose.x = position.x;
+        pose.y = position.y;
+
+        if(cellIt + 1 != cells.end())
+        {
+            cell_t next = *(cellIt + 1);
+            pose.theta = std::atan2(next.y - cellIt->y, next.x - cellIt->x);
+        }
+        else
+        {
+            pose.theta = start.theta;
         }
+
+        path.path.push_back(pose);
     }
+
+    path.path_length = path.path.size();
+    return path;
 }
 
-bool is_goal(const cell_t currCell, const Point<double> goalPt){
-    if(currCell.x == goalPt.x && currCell.y == goalPt.y){
-        return true;
+
+robot_path_t search_for_path(pose_xyt_t start,
+                             pose_xyt_t goal,
+                             const ObstacleDistanceGrid& distances,
+                             const SearchParams& params)
+{
+    AStarWorkspace workspace;
+    return search_for_path(start, goal, distances, params, workspace);
+}
+
+
+bool search_mode_from_name(const std::string& name, SearchMode& mode)
+{
+    const std::pair<const char*, SearchMode> kModes[] = {
+        { "grid_astar", grid_astar },
+        { "jump_point", jump_point },
+        { "hierarchical", hierarchical },
+        { "bidirectional_astar", bidirectional_astar },
+        { "state_lattice", state_lattice },
+        { "anytime_astar", anytime_astar },
+    };
+
+    for(auto& namedMode : kModes)
+    {
+        if(name == namedMode.first)
+        {
+            mode = namedMode.second;
+            return true;
+        }
     }
+
     return false;
 }
 
 
-vector<Node> expand_node(Node currentNode, const ObstacleDistanceGrid& grid){
-    // Perform a expansion of each cell
-    const int xDeltas[8] = { 1, -1, 0,  0, 1, 1, -1, -1 };
-    const int yDeltas[8] = { 0,  0, 1, -1, 1, -1, 1, -1 };
-    
-    vector<Node> kids;
-    
-    for(int n = 0; n < 4; ++n)          //CHANGE TO 8 TO INCLUDE DIAGONALS AS WELL
+bool is_traversable(int x, int y, const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    return distances.isCellInGrid(x, y) && (distances(x, y) > params.minDistanceToObstacle*1.000001);
+}
+
+
+float obstacle_cost(float cellDistance, const SearchParams& params)
+{
+    if((cellDistance > params.minDistanceToObstacle) && (cellDistance < params.maxDistanceWithCost))
     {
-        cell_t adjacentCell(currentNode.cell.x + xDeltas[n], currentNode.cell.y + yDeltas[n]);
+        return std::pow(params.maxDistanceWithCost - cellDistance, params.distanceCostExponent);
+    }
+    return 0.0f;
+}
+
 
-        if(grid.isCellInGrid(adjacentCell.x, adjacentCell.y))
+robot_path_t search_for_path(pose_xyt_t start,
+                             pose_xyt_t goal,
+                             const ObstacleDistanceGrid& distances,
+                             const SearchParams& params,
+                             AStarWorkspace& workspace)
+{
+    robot_path_t path;
+    path.utime = start.utime;
+    path.path.push_back(start);
+    path.path_length = path.path.size();
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    // Begin before checking the query, so a rejected query reports no expanded cells
+    workspace.beginSearch(distances.widthInCells(), distances.heightInCells());
+
+    // check conditions!!
+    // VALID GOAL
+    if(!is_traversable(goalCell.x, goalCell.y, distances, params))
+    {
+        if(params.verbose)
         {
-            Node kid;
-            kid.parent = currentNode.cell;
-            kid.cell = adjacentCell;
-            kids.push_back(kid);
+            printf("Destination is cannot be reached\n");
         }
+        return path;
+    }
+    // VALID HOME
+    if(!is_traversable(startCell.x, startCell.y, distances, params))
+    {
+        if(params.verbose)
+        {
+            printf("Origin is invalid\n");
+        }
+        return path;
+    }
+    // If Home == Goal
+    if(startCell == goalCell)
+    {
+        if(params.verbose)
+        {
+            printf("Already at Destination\n");
+        }
+        return path;
     }
-    return kids;    
-}
 
-robot_path_t makePath(Node goal, Node start, double initTheta, robot_path_t usablePath, const ObstacleDistanceGrid& distances, vector<Node> CL){
-    // printf("-------MAKE PATH------");
-    stack<pose_xyt_t> initPath;
-    int c = 0;
-    float prevX, prevY;
-
-    Node tempnode = goal;
-
-    while (!(tempnode.cell.x == start.cell.x && tempnode.cell.y == start.cell.y)){
-        Point<double> temp;
-        temp.x = tempnode.cell.x;
-        temp.y = tempnode.cell.y;
-        int ocost = tempnode.fCost - tempnode.gCost - tempnode.hCost;
-        // printf("PATH POINT -- x: %f y: %f fcost: %d gcost: %d hcost: %d ocost: %d\n", temp.x, temp.y, tempnode.fCost, tempnode.gCost, tempnode.hCost, ocost);
-
-        Point<double> temp2 = grid_position_to_global_position(temp, distances);
-        pose_xyt_t nextPoint;
-        nextPoint.x = temp2.x;
-        nextPoint.y = temp2.y;
-        if (c == 0){
-            nextPoint.theta = initTheta;
-            c++;
-        }else
-            nextPoint.theta = atan2(prevY - temp.y, prevX - temp.x);          
-        initPath.push(nextPoint);
-        prevX = temp.x;
-        prevY = temp.y;
-        // printf("PARENT x: %f y: %f ---- \n", node.parent.x, node.parent.y);
-        tempnode = get_member(tempnode.parent, CL);
+    if(params.mode == bidirectional_astar)
+    {
+        const int width = distances.widthInCells();
+        int meetingIndex;
+        if(bidirectional_astar_search(startCell, goalCell, distances, params, workspace, meetingIndex))
+        {
+            return make_bidirectional_path(meetingIndex, startCell.y*width + startCell.x, start, distances, workspace);
+        }
+        return path;
     }
 
-    while (!initPath.empty())
+    bool foundPath = (params.mode == jump_point)
+        ? jump_point_search(startCell, goalCell, distances, params, workspace)
+        : grid_astar_search(startCell, goalCell, distances, params, workspace);
+
+    if(foundPath)
     {
-        pose_xyt_t top = initPath.top();
-        initPath.pop();
-        usablePath.path.emplace_back(top);
+        const int width = distances.widthInCells();
+        return make_path(goalCell.y*width + goalCell.x, startCell.y*width + startCell.x, start, distances, workspace);
     }
-    usablePath.path_length = usablePath.path.size();
-    return usablePath;
-}
\ No newline at end of file
+
+    // The open list ran out without reaching the goal, so no path exists
+    return path;
+}
@@ -4,11 +4,45 @@
 #include <lcmtypes/robot_path_t.hpp>
 #include <lcmtypes/pose_xyt_t.hpp>
 #include <common/point.hpp>
+#include <cstdint>
+#include <string>
 #include <vector>
 using namespace std;
 
+class LandmarkHeuristic;
 class ObstacleDistanceGrid;
 
+/**
+* SearchMode selects the algorithm search_for_path uses to find a path.
+*/
+enum SearchMode
+{
+    grid_astar,         ///< A* over 4-connected cells, expanding every cell it reaches
+    jump_point,         ///< Jump point search over 8-connected cells. Cells with no distance cost are skipped over in
+                        ///< straight and diagonal jumps. Cells with a distance cost are expanded one at a time, as
+                        ///< in A*, so the path still weighs the distance to obstacles.
+    hierarchical,       ///< Hierarchical A* over clusters of cells -- see HierarchicalPlanner. Only MotionPlanner keeps
+                        ///< the clusters between searches. search_for_path runs grid_astar instead.
+    bidirectional_astar, ///< A* over 4-connected cells from the start and goal at the same time. Finds paths with
+                         ///< the same cost as grid_astar. Expands fewer cells when the goal is in a dead end, like a
+                         ///< room or maze corridor, and more in open space, where A*'s heuristic is nearly exact.
+    state_lattice,      ///< A* over cells and headings with smooth motion primitives -- see LatticePlanner. Only
+                        ///< MotionPlanner plans with the lattice. search_for_path runs grid_astar instead.
+    anytime_astar,      ///< Anytime repairing A* (ARA*) over 4-connected cells, which returns the best path found
+                        ///< within SearchParams::timeBudgetUs -- see AnytimePlanner. Only MotionPlanner plans with
+                        ///< ARA*. search_for_path runs grid_astar instead.
+};
+
+/**
+* search_mode_from_name finds the SearchMode with the same name as its enumerator, e.g. "jump_point", for reading the
+* mode from the command line.
+*
+* \param    name            Name of the search mode
+* \param    mode            Mode with the name (output)
+* \return   True if a mode has the name. Otherwise, mode isn't changed.
+*/
+bool search_mode_from_name(const std::string& name, SearchMode& mode);
+
 /**
 * SearchParams defines the parameters to use when searching for a path. See associated comments for details
 */
@@ -24,30 +58,66 @@ struct SearchParams
     double distanceCostExponent;    ///< The exponent to apply to the distance cost, whose function is:
                                     ///<   pow(maxDistanceWithCost - cellDistance, distanceCostExponent)
                                     ///< for cellDistance > minDistanceToObstacle && cellDistance < maxDistanceWithCost
-};
 
-typedef Point<int> cell_t;
+    SearchMode mode;                ///< Algorithm to use for the search
 
-struct Node{
-    cell_t cell;            // Cell represented by this node
-    cell_t parent;
-    int gCost;        
-    int hCost;
-    int fCost;
-    bool operator<(const Node& rhs) const
-    {
-        return fCost < rhs.fCost;
-    }
-    bool operator>(const Node& rhs) const
+    int64_t timeBudgetUs;           ///< Time the anytime_astar and state_lattice modes may take to plan a path, and
+                                    ///< expand_cost_field may take to expand the field (us), or 0 for no limit
+
+    double initialInflation;        ///< Factor the anytime_astar mode inflates the heuristic by for its first path,
+                                    ///< which costs at most this many times the cheapest path. Each later path lowers
+                                    ///< the factor until it reaches 1, where the path is the cheapest.
+
+    const LandmarkHeuristic* landmarks; ///< Landmark tables for the grid being searched, or nullptr. If set, the
+                                        ///< grid_astar mode adds their lower bounds to its heuristic -- see
+                                        ///< LandmarkHeuristic. They must have been built for the same grid and
+                                        ///< parameters. The other modes ignore them.
+
+    bool verbose;                   ///< Flag indicating if search_for_path should print why it rejected a query.
+                                    ///< Off by default, since batches and exploration reject queries routinely.
+
+    /**
+    * Default constructor for SearchParams.
+    *
+    * The defaults match the parameters MotionPlanner uses for the default robot radius.
+    */
+    SearchParams(void)
+    : minDistanceToObstacle(0.2)
+    , maxDistanceWithCost(2.0)
+    , distanceCostExponent(1.0)
+    , mode(grid_astar)
+    , timeBudgetUs(0)
+    , initialInflation(2.5)
+    , landmarks(nullptr)
+    , verbose(false)
     {
-        return fCost > rhs.fCost;
     }
 };
 
+typedef Point<int> cell_t;
+
+class AStarWorkspace;
+
+
+/**
+* is_traversable checks if the robot can enter a cell, i.e. the cell is in the grid and farther than
+* params.minDistanceToObstacle from the nearest obstacle. Every planner uses this test, so they agree on which cells
+* are free.
+*/
+bool is_traversable(int x, int y, const ObstacleDistanceGrid& distances, const SearchParams& params);
+
+/**
+* obstacle_cost computes the extra cost of entering a cell at cellDistance from the nearest obstacle -- see
+* SearchParams::distanceCostExponent. Every planner adds this cost to each step, so their paths have the same cost.
+*/
+float obstacle_cost(float cellDistance, const SearchParams& params);
+
 
 /**
 * search_for_path uses an A* search to find a path from the start to goal poses. The search assumes a circular robot
 * 
+* The path contains every cell from the start to the goal, regardless of params.mode.
+* 
 * \param    start           Starting pose of the robot
 * \param    goal            Desired goal pose of the robot
 * \param    distances       Distance to the nearest obstacle for each cell in the grid
@@ -60,16 +130,76 @@ robot_path_t search_for_path(pose_xyt_t start,
                              const ObstacleDistanceGrid& distances,
                              const SearchParams& params);
 
-bool isValid(cell_t givenCell, const ObstacleDistanceGrid& distances, const double minDist);
-bool isDestination(cell_t home, cell_t goal); 
-int get_gCost(Node parent, cell_t current);
-int get_hCost(Point<double> goal, cell_t current);
-int get_oCost(cell_t cell, const SearchParams& params, const ObstacleDistanceGrid& distances);
-bool is_member(const cell_t toSearch_cell, vector<Node> givenList);
-Node get_member(const cell_t toSearch_cell, vector<Node> givenList);
-bool is_goal(const cell_t currCell, const Point<double> goalPt);
-vector<Node> expand_node(Node currentNode, const ObstacleDistanceGrid& grid);
-robot_path_t makePath(Node goal, Node start, double initTheta, robot_path_t usablePath, const ObstacleDistanceGrid& distances, vector<Node> CL);
+/**
+* search_for_path performs the same search as above, but keeps the per-cell search state in the provided workspace.
+* Reusing the same workspace for every search avoids allocating and clearing the state for every cell of the grid
+* on each call.
+* 
+* \param    start           Starting pose of the robot
+* \param    goal            Desired goal pose of the robot
+* \param    distances       Distance to the nearest obstacle for each cell in the grid
+* \param    params          Parameters specifying the behavior of the A* search
+* \param    workspace       Workspace to hold the search state (modified)
+* \return   The path found to the goal, if one exists. If the goal is unreachable, then a path with just the initial
+*   pose is returned, per the robot_path_t specification.
+*/
+robot_path_t search_for_path(pose_xyt_t start, 
+                             pose_xyt_t goal, 
+                             const ObstacleDistanceGrid& distances,
+                             const SearchParams& params,
+                             AStarWorkspace& workspace);
+
+/**
+* expand_cost_field runs a single Dijkstra search from the start to every reachable cell, rather than to a single goal.
+* The search moves between the same 4-connected cells with the same costs as the grid_astar mode of search_for_path.
+* 
+* Afterward, the workspace holds the cost of the cheapest path from the start to every cell, or
+* AStarWorkspace::kInfiniteCost if the cell can't be reached, and the parent of each reached cell. Use
+* path_in_cost_field to get the path to any reached cell without searching again. The field is kept until the workspace
+* is used for another search.
+*
+* If params.timeBudgetUs is set, the search stops once the budget runs out. Cells are closed in order of their cost, so
+* every cell cheaper to reach than the last one closed still has its cheapest path. Only the closed cells count as
+* reached -- see AStarWorkspace::isClosed.
+* 
+* \param    start           Starting pose of the robot
+* \param    distances       Distance to the nearest obstacle for each cell in the grid
+* \param    params          Parameters specifying the costs and time budget of the search. params.mode is ignored.
+* \param    workspace       Workspace to hold the cost field (modified)
+* \return   True if the start cell can be traversed, so the field was expanded. Otherwise, no cell is reachable.
+*/
+bool expand_cost_field(const pose_xyt_t& start,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params,
+                       AStarWorkspace& workspace);
 
+/**
+* path_in_cost_field extracts the path from the start of a cost field to a goal by following the parents in the field.
+* The cost of extracting the path is proportional to its length.
+* 
+* \param    start           Starting pose passed to expand_cost_field
+* \param    goal            Desired goal pose of the robot
+* \param    distances       Distances passed to expand_cost_field
+* \param    workspace       Workspace holding the cost field
+* \return   The cheapest path to the goal, if the goal was closed by the field. Otherwise, a path with just the start
+*   pose.
+*/
+robot_path_t path_in_cost_field(const pose_xyt_t& start,
+                                const pose_xyt_t& goal,
+                                const ObstacleDistanceGrid& distances,
+                                const AStarWorkspace& workspace);
+
+/**
+* cells_to_path converts the cells along a path found by a grid search into a robot_path_t. Each pose faces the next
+* cell in the path, except the final pose, which keeps the heading of the start pose.
+*
+* \param    start           Starting pose of the robot, which becomes the first pose in the path
+* \param    cells           Cells along the path after the start cell, ending with the goal cell
+* \param    distances       Grid the cells belong to
+* \return   Path with the start pose followed by a pose for each cell.
+*/
+robot_path_t cells_to_path(const pose_xyt_t& start,
+                           const std::vector<cell_t>& cells,
+                           const ObstacleDistanceGrid& distances);
 
 #endif // PLANNING_ASTAR_HPP
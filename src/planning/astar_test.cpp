@@ -32,6 +32,7 @@ bool animatePath;
 int repeatTimes;            // Global Variable that sets number of repeat times, obtained from 
 int pauseTime;           // Time to wait between executions of different cases
 int selected_test;
+bool useJumpPoint;          // Search with jump point search instead of A*
 
 // Setup Lcm
 lcm::LCM lcmConnection(MULTICAST_URL); 
@@ -73,6 +74,7 @@ int main(int argc, char** argv)
     const char* pauseTimeArg = "pause-time";
     const char* animatePathArg = "animate-path";
     const char* testSelectArg = "test-num";
+    const char* jumpPointArg = "jump-point";
     
     // Handle Options
     getopt_t *gopt = getopt_create();
@@ -82,6 +84,7 @@ int main(int argc, char** argv)
     getopt_add_int(gopt, '\0', numRepeatsArg, "1", "Number of times to repeat the A* .");
     getopt_add_int(gopt, '\0', pauseTimeArg, "2", "Time [s] to pause the A* test for each tested pair of start and goal in each map");
     getopt_add_int(gopt, '\0', testSelectArg, "6", "[0-6] Number corresponding of case to test. Leave at 6 to test all cases");
+    getopt_add_bool(gopt, '\0', jumpPointArg, 0, "Flag to plan with jump point search instead of A*");
 
     // PRINT HELP IF FAILED TO PARSE STRING, OR IF SENT --help ARGUMENT
     if (!getopt_parse(gopt, argc, argv, 1)  || getopt_get_bool(gopt, "help")) {
@@ -96,6 +99,7 @@ int main(int argc, char** argv)
     repeatTimes = getopt_get_int(gopt, numRepeatsArg);
     pauseTime = getopt_get_int(gopt, pauseTimeArg);
     selected_test = getopt_get_int(gopt, testSelectArg);
+    useJumpPoint = getopt_get_bool(gopt, jumpPointArg);
 
     printf("\n%s",std::string(70,'=').c_str());
     printf("\nTesting your A* with the following settings :\n");
@@ -104,6 +108,7 @@ int main(int argc, char** argv)
     printf("Number of repeats : %d\n", repeatTimes);
     printf("Pause time in [s] : %d\n", pauseTime);
     printf("Working on test case : %d\n", selected_test);
+    printf("Search mode : %s\n", useJumpPoint ? "jump point" : "A*");
     printf("Call the binary with --help argument passed for options\n");
     printf("%s\n",std::string(70,'=').c_str());
     // printf("="*20);
@@ -226,6 +231,7 @@ bool test_saved_poses(const std::string& mapFile, const std::string& posesFile,
     
     MotionPlannerParams plannerParams;
     plannerParams.robotRadius = 0.1;
+    plannerParams.searchMode = useJumpPoint ? jump_point : grid_astar;
     
     MotionPlanner planner(plannerParams);
     planner.setMap(grid);
@@ -0,0 +1,89 @@
+#include <planning/astar_workspace.hpp>
+#include <algorithm>
+
+constexpr float AStarWorkspace::kInfiniteCost;
+const int8_t AStarWorkspace::JumpState::kUnknown;
+const int32_t AStarWorkspace::JumpState::kNotJumped;
+
+
+AStarWorkspace::AStarWorkspace(void)
+: generation_(0)
+, width_(0)
+, height_(0)
+, numExpanded_(0)
+{
+}
+
+
+void AStarWorkspace::beginSearch(int widthInCells, int heightInCells)
+{
+    std::size_t numCells = static_cast<std::size_t>(std::max(widthInCells, 0)) * std::max(heightInCells, 0);
+
+    if(cells_.size() != numCells)
+    {
+        CellState unvisited;
+        unvisited.gCost = kInfiniteCost;
+        unvisited.parent = kNoParent;
+        unvisited.generation = 0;
+        unvisited.isClosed = 0;
+        cells_.assign(numCells, unvisited);
+        jumpStates_.clear();
+        reverseCells_.clear();
+        generation_ = 0;
+    }
+
+    openList_.reset(numCells);
+
+    width_ = widthInCells;
+    height_ = heightInCells;
+    numExpanded_ = 0;
+
+    ++generation_;
+
+    // After 4 billion searches, the generation wraps around and the old generations must actually be cleared
+    if(generation_ == 0)
+    {
+        for(auto& cell : cells_)
+        {
+            cell.generation = 0;
+        }
+        for(auto& state : jumpStates_)
+        {
+            state.generation = 0;
+        }
+        for(auto& cell : reverseCells_)
+        {
+            cell.generation = 0;
+        }
+        generation_ = 1;
+    }
+}
+
+
+void AStarWorkspace::beginJumpPointSearch(void)
+{
+    if(jumpStates_.size() != cells_.size())
+    {
+        JumpState untouched;
+        untouched.generation = 0;
+        untouched.isOpen = JumpState::kUnknown;
+        std::fill(untouched.jumps, untouched.jumps + 4, JumpState::kNotJumped);
+        jumpStates_.assign(cells_.size(), untouched);
+    }
+}
+
+
+void AStarWorkspace::beginBidirectionalSearch(void)
+{
+    if(reverseCells_.size() != cells_.size())
+    {
+        CellState unvisited;
+        unvisited.gCost = kInfiniteCost;
+        unvisited.parent = kNoParent;
+        unvisited.generation = 0;
+        unvisited.isClosed = 0;
+        reverseCells_.assign(cells_.size(), unvisited);
+    }
+
+    reverseOpenList_.reset(cells_.size());
+}
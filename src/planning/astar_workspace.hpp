@@ -0,0 +1,217 @@
+#ifndef PLANNING_ASTAR_WORKSPACE_HPP
+#define PLANNING_ASTAR_WORKSPACE_HPP
+
+#include <planning/indexed_heap.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+* AStarWorkspace holds the per-cell search state used by search_for_path: the g-cost, parent, and closed flag of every
+* cell in the grid being searched. Cells are identified by their row-major index, y*width + x, in the
+* ObstacleDistanceGrid.
+*
+* The state arrays are sized to the grid once and then reused for every search. Rather than clearing every cell at
+* the start of a search, each cell records the generation of the search that last touched it. beginSearch increments
+* the generation, which invalidates the state of every cell at once, so starting a search costs O(1) instead of
+* O(cells).
+*
+* The workspace also owns the open list, an IndexedHeap of cell indices ordered by f-cost, so a cell is in the open list
+* at most once and its f-cost is lowered in place when a cheaper path to it is found.
+*
+* Jump point search keeps additional per-cell state, JumpState, which is only allocated once a jump point search is run.
+* Likewise, bidirectional search keeps a second g-cost, parent, and closed flag for the search from the goal, along with
+* a second open list, which are only allocated once a bidirectional search is run.
+*
+* A workspace can only be used by one search at a time.
+*/
+class AStarWorkspace
+{
+public:
+
+    static constexpr float kInfiniteCost = std::numeric_limits<float>::max();
+    static const int kNoParent = -1;
+
+    /**
+    * JumpState caches the work done by jump point search for a cell during the current search.
+    */
+    struct JumpState
+    {
+        static const int8_t kUnknown = -1;
+        static const int32_t kNotJumped = -2;
+
+        uint32_t generation;    // search that last touched the cell
+        int8_t isOpen;          // 1 if jumps can pass through the cell, 0 if not, or kUnknown
+        int32_t jumps[4];       // result of the straight jump from the cell in each direction or kNotJumped
+    };
+
+    AStarWorkspace(void);
+
+    /**
+    * beginSearch prepares the workspace for a new search of a grid. Every cell starts out unvisited.
+    *
+    * \param    widthInCells        Width of the grid to be searched
+    * \param    heightInCells       Height of the grid to be searched
+    */
+    void beginSearch(int widthInCells, int heightInCells);
+
+    /**
+    * isVisited checks if a cell has been assigned a cost during the current search.
+    */
+    bool isVisited(int index) const { return cells_[index].generation == generation_; }
+
+    /**
+    * isClosed checks if a cell has been expanded during the current search.
+    */
+    bool isClosed(int index) const { return isVisited(index) && cells_[index].isClosed; }
+
+    /**
+    * gCost retrieves the cost of the best path found to a cell. Unvisited cells have kInfiniteCost.
+    */
+    float gCost(int index) const { return isVisited(index) ? cells_[index].gCost : kInfiniteCost; }
+
+    /**
+    * parent retrieves the cell preceding a visited cell along the best path found to it.
+    */
+    int parent(int index) const { return cells_[index].parent; }
+
+    /**
+    * setCost assigns a new best cost and parent to a cell, marking it visited.
+    */
+    void setCost(int index, float gCost, int parent)
+    {
+        CellState& cell = cells_[index];
+        if(cell.generation != generation_)
+        {
+            cell.generation = generation_;
+            cell.isClosed = 0;
+        }
+        cell.gCost = gCost;
+        cell.parent = parent;
+    }
+
+    /**
+    * close marks a visited cell as expanded.
+    */
+    void close(int index)
+    {
+        cells_[index].isClosed = 1;
+        ++numExpanded_;
+    }
+
+    /**
+    * beginJumpPointSearch allocates the jump point state for the grid. Call it after beginSearch.
+    */
+    void beginJumpPointSearch(void);
+
+    /**
+    * jumpState retrieves the jump point state of a cell. The state of a cell not yet touched by the current search is
+    * reset to unknown.
+    */
+    JumpState& jumpState(int index)
+    {
+        JumpState& state = jumpStates_[index];
+        if(state.generation != generation_)
+        {
+            state.generation = generation_;
+            state.isOpen = JumpState::kUnknown;
+            state.jumps[0] = state.jumps[1] = state.jumps[2] = state.jumps[3] = JumpState::kNotJumped;
+        }
+        return state;
+    }
+
+    /**
+    * beginBidirectionalSearch allocates the state of the reverse search, the search from the goal, for the grid and
+    * empties its open list. Call it after beginSearch.
+    */
+    void beginBidirectionalSearch(void);
+
+    /**
+    * isReverseClosed checks if a cell has been expanded by the reverse search.
+    */
+    bool isReverseClosed(int index) const
+    {
+        return (reverseCells_[index].generation == generation_) && reverseCells_[index].isClosed;
+    }
+
+    /**
+    * reverseGCost retrieves the cost of the best path found from a cell to the goal. Cells not visited by the reverse
+    * search have kInfiniteCost.
+    */
+    float reverseGCost(int index) const
+    {
+        return (reverseCells_[index].generation == generation_) ? reverseCells_[index].gCost : kInfiniteCost;
+    }
+
+    /**
+    * reverseParent retrieves the cell following a cell visited by the reverse search along the best path found from it
+    * to the goal.
+    */
+    int reverseParent(int index) const { return reverseCells_[index].parent; }
+
+    /**
+    * setReverseCost assigns a new best cost to the goal and next cell to a cell, marking it visited by the reverse
+    * search.
+    */
+    void setReverseCost(int index, float gCost, int parent)
+    {
+        CellState& cell = reverseCells_[index];
+        if(cell.generation != generation_)
+        {
+            cell.generation = generation_;
+            cell.isClosed = 0;
+        }
+        cell.gCost = gCost;
+        cell.parent = parent;
+    }
+
+    /**
+    * closeReverse marks a cell visited by the reverse search as expanded.
+    */
+    void closeReverse(int index)
+    {
+        reverseCells_[index].isClosed = 1;
+        ++numExpanded_;
+    }
+
+    /**
+    * openList retrieves the open list for the current search. It is emptied by beginSearch.
+    */
+    IndexedHeap<float>& openList(void) { return openList_; }
+
+    /**
+    * reverseOpenList retrieves the open list for the reverse search. It is emptied by beginBidirectionalSearch.
+    */
+    IndexedHeap<float>& reverseOpenList(void) { return reverseOpenList_; }
+
+    int widthInCells(void) const { return width_; }
+    int heightInCells(void) const { return height_; }
+
+    /**
+    * numExpanded retrieves the number of cells closed during the current search, by both directions of a
+    * bidirectional search.
+    */
+    std::size_t numExpanded(void) const { return numExpanded_; }
+
+private:
+
+    struct CellState
+    {
+        float gCost;
+        int32_t parent;
+        uint32_t generation;    // search that last touched the cell
+        uint32_t isClosed;
+    };
+
+    std::vector<CellState> cells_;
+    std::vector<JumpState> jumpStates_;
+    std::vector<CellState> reverseCells_;
+    IndexedHeap<float> openList_;
+    IndexedHeap<float> reverseOpenList_;
+    uint32_t generation_;
+    int width_;
+    int height_;
+    std::size_t numExpanded_;
+};
+
+#endif // PLANNING_ASTAR_WORKSPACE_HPP
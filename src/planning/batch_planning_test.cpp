@@ -0,0 +1,201 @@
+#include <planning/motion_planner.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* The batch planning test checks MotionPlanner::planBatch:
+*
+*   - on the data/astar maps, each result is the path planPath finds for the same query, in the same order,
+*   - the results don't depend on the number of threads, for every search mode,
+*   - planning a batch of long queries on a large office map with more threads increases the throughput. The queries
+*     per second for each number of threads are printed. The speedup is limited by the number of cores.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+const std::vector<std::string> kMaps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+
+bool test_matches_plan_path(void);
+bool test_thread_counts_agree(void);
+bool test_throughput(void);
+
+bool is_same_path(const robot_path_t& lhs, const robot_path_t& rhs);
+
+
+int main(int argc, char** argv)
+{
+    if(test_matches_plan_path())
+    {
+        std::cout << "PASSED: test_matches_plan_path\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_matches_plan_path\n";
+    }
+
+    if(test_thread_counts_agree())
+    {
+        std::cout << "PASSED: test_thread_counts_agree\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_thread_counts_agree\n";
+    }
+
+    if(test_throughput())
+    {
+        std::cout << "PASSED: test_throughput\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_throughput\n";
+    }
+
+    return 0;
+}
+
+
+bool test_matches_plan_path(void)
+{
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        MotionPlanner planner = make_planner(grid);
+        std::vector<PlanResult> results = planner.planBatch(queries, 4);
+
+        if(results.size() != queries.size())
+        {
+            std::cout << "Got " << results.size() << " results for " << queries.size() << " queries on " << name
+                << " map\n";
+            return false;
+        }
+
+        for(std::size_t n = 0; n < queries.size(); ++n)
+        {
+            // Repeated queries come out of planPath's cache without a search, so only compare the work of searches
+            std::size_t numHits = planner.pathCache().numHits();
+            robot_path_t path = planner.planPath(queries[n].start, queries[n].goal);
+            bool wasSearched = planner.pathCache().numHits() == numHits;
+
+            if(!is_same_path(path, results[n].path)
+                || (wasSearched && (planner.numExpanded() != results[n].numExpanded)))
+            {
+                std::cout << "Result " << n << " on " << name << " map isn't the path planPath finds\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_thread_counts_agree(void)
+{
+    OccupancyGrid grid = generate_office_grid(20.0f, 0.05f, 3.0, 1);
+
+    for(auto mode : { grid_astar, jump_point, hierarchical, bidirectional_astar, state_lattice, anytime_astar })
+    {
+        MotionPlannerParams params = planner_params();
+        params.searchMode = mode;
+
+        MotionPlanner planner = make_planner(grid, params);
+        std::vector<PlanQuery> queries = random_queries(planner, 20, 2);
+
+        std::vector<PlanResult> singleResults = planner.planBatch(queries, 1);
+        std::vector<PlanResult> multipleResults = planner.planBatch(queries, 3);
+
+        for(std::size_t n = 0; n < queries.size(); ++n)
+        {
+            if(!is_same_path(singleResults[n].path, multipleResults[n].path))
+            {
+                std::cout << "Result " << n << " differs between 1 and 3 threads in search mode " << mode << '\n';
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_throughput(void)
+{
+    const int kNumQueries = 32;
+
+    OccupancyGrid grid = generate_office_grid(50.0f, 0.05f, 3.0, 1);
+    MotionPlanner planner = make_planner(grid);
+    std::vector<PlanQuery> queries = random_queries(planner, kNumQueries, 3);
+
+    const int numCores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Planning " << kNumQueries << " queries on a " << grid.widthInCells() << "x" << grid.heightInCells()
+        << " office map with " << numCores << " cores:\n";
+    printf("%8s %12s %12s\n", "threads", "queries/s", "speedup");
+
+    // Allocate every worker's search state before timing
+    planner.planBatch(queries, 2*numCores);
+
+    double singleRate = 0.0;
+    std::vector<PlanResult> singleResults;
+    for(int numThreads = 1; numThreads <= 2*numCores; numThreads *= 2)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<PlanResult> results = planner.planBatch(queries, numThreads);
+        auto endTime = std::chrono::steady_clock::now();
+
+        double rate = kNumQueries / std::chrono::duration<double>(endTime - startTime).count();
+        if(numThreads == 1)
+        {
+            singleRate = rate;
+            singleResults = results;
+        }
+
+        printf("%8d %12.1f %12.2f\n", numThreads, rate, rate / singleRate);
+
+        for(std::size_t n = 0; n < results.size(); ++n)
+        {
+            if(!is_same_path(results[n].path, singleResults[n].path))
+            {
+                std::cout << "Result " << n << " differs between 1 and " << numThreads << " threads\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool is_same_path(const robot_path_t& lhs, const robot_path_t& rhs)
+{
+    if(lhs.path.size() != rhs.path.size())
+    {
+        return false;
+    }
+
+    for(std::size_t n = 0; n < lhs.path.size(); ++n)
+    {
+        if((lhs.path[n].x != rhs.path[n].x) || (lhs.path[n].y != rhs.path[n].y)
+            || (lhs.path[n].theta != rhs.path[n].theta))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,201 @@
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The bidirectional A* test checks the bidirectional_astar mode of search_for_path against grid_astar on the
+* data/astar maps:
+*
+*   - both find a path for the same queries,
+*   - the paths cost the same, within floating-point rounding, since the directions add up the step costs in a
+*     different order,
+*   - every bidirectional path is a chain of adjacent traversable cells from the start to the goal.
+*
+* It then times both modes on each map's queries and prints the time and cells expanded per query.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+const std::vector<std::string> kMaps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+
+bool test_same_costs(void);
+bool test_timing(void);
+
+bool is_connected_path(const robot_path_t& path,
+                       const PlanQuery& query,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params);
+
+
+int main(int argc, char** argv)
+{
+    if(test_same_costs())
+    {
+        std::cout << "PASSED: test_same_costs\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_same_costs\n";
+    }
+
+    if(test_timing())
+    {
+        std::cout << "PASSED: test_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_timing\n";
+    }
+
+    return 0;
+}
+
+
+bool test_same_costs(void)
+{
+    const SearchParams forwardParams = search_params(grid_astar);
+    const SearchParams bidirectionalParams = search_params(bidirectional_astar);
+
+    bool allCorrect = true;
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries, true))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        AStarWorkspace workspace;
+        for(auto& query : queries)
+        {
+            robot_path_t forwardPath = search_for_path(query.start, query.goal, distances, forwardParams, workspace);
+            robot_path_t bidirectionalPath = search_for_path(query.start,
+                                                             query.goal,
+                                                             distances,
+                                                             bidirectionalParams,
+                                                             workspace);
+
+            if((forwardPath.path_length > 1) != (bidirectionalPath.path_length > 1))
+            {
+                std::cout << "A* " << ((forwardPath.path_length > 1) ? "found" : "didn't find") << " a path that "
+                    << "bidirectional A* " << ((bidirectionalPath.path_length > 1) ? "found" : "didn't find")
+                    << " on " << name << " map\n";
+                allCorrect = false;
+                continue;
+            }
+
+            if(bidirectionalPath.path_length < 2)
+            {
+                continue;
+            }
+
+            if(!is_connected_path(bidirectionalPath, query, distances, forwardParams))
+            {
+                std::cout << "Bidirectional path isn't a chain of traversable cells on " << name << " map\n";
+                allCorrect = false;
+            }
+
+            double forwardCost = path_cost(forwardPath, distances, forwardParams);
+            double bidirectionalCost = path_cost(bidirectionalPath, distances, forwardParams);
+            if(std::abs(forwardCost - bidirectionalCost) > 1.0e-4 * forwardCost)
+            {
+                std::cout << "Bidirectional path cost " << bidirectionalCost << " vs. A* " << forwardCost << " on "
+                    << name << " map\n";
+                allCorrect = false;
+            }
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_timing(void)
+{
+    const int kNumRepeats = 20;
+
+    printf("%-8s %-14s %12s %12s\n", "map", "mode", "us/query", "expanded");
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries, true))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        AStarWorkspace workspace;
+
+        for(auto mode : { grid_astar, bidirectional_astar })
+        {
+            const SearchParams params = search_params(mode);
+            double totalUs = 0.0;
+            std::size_t totalExpanded = 0;
+
+            for(int n = 0; n < kNumRepeats; ++n)
+            {
+                for(auto& query : queries)
+                {
+                    auto startTime = std::chrono::steady_clock::now();
+                    search_for_path(query.start, query.goal, distances, params, workspace);
+                    auto endTime = std::chrono::steady_clock::now();
+
+                    totalUs += std::chrono::duration<double, std::micro>(endTime - startTime).count();
+                    totalExpanded += workspace.numExpanded();
+                }
+            }
+
+            const double numSearches = kNumRepeats * queries.size();
+            printf("%-8s %-14s %12.1f %12.0f\n",
+                   name.c_str(),
+                   (mode == grid_astar) ? "grid_astar" : "bidirectional",
+                   totalUs / numSearches,
+                   totalExpanded / numSearches);
+        }
+    }
+
+    return true;
+}
+
+
+bool is_connected_path(const robot_path_t& path,
+                       const PlanQuery& query,
+                       const ObstacleDistanceGrid& distances,
+                       const SearchParams& params)
+{
+    cell_t previous = global_position_to_grid_cell(Point<double>(query.start.x, query.start.y), distances);
+    cell_t goal = global_position_to_grid_cell(Point<double>(query.goal.x, query.goal.y), distances);
+
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        cell_t cell = path_cell(path.path[n], distances);
+        if((std::abs(cell.x - previous.x) + std::abs(cell.y - previous.y) != 1)
+            || (distances(cell.x, cell.y) <= params.minDistanceToObstacle*1.000001))
+        {
+            return false;
+        }
+        previous = cell;
+    }
+
+    return previous == goal;
+}
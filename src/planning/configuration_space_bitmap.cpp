@@ -0,0 +1,221 @@
+#include <planning/configuration_space_bitmap.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+namespace
+{
+
+// Positions this close to the next cell count as being in it -- see isSegmentFree
+const double kCellTolerance = 1.0e-3;
+
+// Segments passing this close to a cell's boundary don't touch the cell on the other side
+const double kBoundaryTolerance = 1.0e-6;
+
+
+Point<int> position_to_cell(const Point<double>& position)
+{
+    return Point<int>(static_cast<int>(std::floor(position.x + kCellTolerance)),
+                      static_cast<int>(std::floor(position.y + kCellTolerance)));
+}
+
+}
+
+
+void ConfigurationSpaceBitmap::BitRows::reset(int numRows, int rowLength)
+{
+    wordsPerRow = (rowLength + 63) / 64;
+    words.assign(static_cast<std::size_t>(numRows) * wordsPerRow, 0);
+}
+
+
+void ConfigurationSpaceBitmap::BitRows::setBlocked(int row, int cell, bool isBlocked)
+{
+    uint64_t& word = words[static_cast<std::size_t>(row) * wordsPerRow + (cell >> 6)];
+    const uint64_t bit = 1ull << (cell & 63);
+    word = isBlocked ? (word | bit) : (word & ~bit);
+}
+
+
+ConfigurationSpaceBitmap::ConfigurationSpaceBitmap(void)
+: width_(0)
+, height_(0)
+, metersPerCell_(0.05f)
+, cellsPerMeter_(20.0f)
+, globalOrigin_(0.0f, 0.0f)
+, minDistanceToObstacle_(0.0)
+{
+    rows_.reset(0, 0);
+    columns_.reset(0, 0);
+}
+
+
+void ConfigurationSpaceBitmap::build(const ObstacleDistanceGrid& distances, double minDistanceToObstacle)
+{
+    width_ = distances.widthInCells();
+    height_ = distances.heightInCells();
+    metersPerCell_ = distances.metersPerCell();
+    cellsPerMeter_ = distances.cellsPerMeter();
+    globalOrigin_ = distances.originInGlobalFrame();
+    minDistanceToObstacle_ = minDistanceToObstacle;
+
+    rows_.reset(height_, width_);
+    columns_.reset(width_, height_);
+
+    for(int y = 0; y < height_; ++y)
+    {
+        // Fill a row a word at a time
+        uint64_t* rowWords = &rows_.words[static_cast<std::size_t>(y) * rows_.wordsPerRow];
+        for(int x = 0; x < width_; ++x)
+        {
+            if(!isDistanceFree(distances(x, y)))
+            {
+                rowWords[x >> 6] |= 1ull << (x & 63);
+                columns_.setBlocked(x, y, true);
+            }
+        }
+    }
+}
+
+
+void ConfigurationSpaceBitmap::updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances)
+{
+    for(int index : changedCells)
+    {
+        const int x = index % width_;
+        const int y = index / width_;
+        const bool isBlocked = !isDistanceFree(distances(x, y));
+        rows_.setBlocked(y, x, isBlocked);
+        columns_.setBlocked(x, y, isBlocked);
+    }
+}
+
+
+bool ConfigurationSpaceBitmap::isRowSpanFree(int y, int xStart, int xEnd) const
+{
+    if(xStart > xEnd)
+    {
+        std::swap(xStart, xEnd);
+    }
+
+    return (y >= 0) && (y < height_) && (xStart >= 0) && (xEnd < width_) && rows_.isSpanFree(y, xStart, xEnd);
+}
+
+
+bool ConfigurationSpaceBitmap::isBoxFree(int xMin, int yMin, int xMax, int yMax) const
+{
+    if((xMin > xMax) || (yMin > yMax) || (xMin < 0) || (yMin < 0) || (xMax >= width_) || (yMax >= height_))
+    {
+        return false;
+    }
+
+    for(int y = yMin; y <= yMax; ++y)
+    {
+        if(!rows_.isSpanFree(y, xMin, xMax))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool ConfigurationSpaceBitmap::isSegmentFree(const Point<double>& start, const Point<double>& end) const
+{
+    Point<int> startCell = position_to_cell(start);
+    Point<int> endCell = position_to_cell(end);
+
+    if(!isCellFree(startCell.x, startCell.y) || !isCellFree(endCell.x, endCell.y))
+    {
+        return false;
+    }
+
+    // Walk across the shorter axis, checking the longer run of cells along the other with the spans of a BitRows
+    if(std::abs(endCell.x - startCell.x) >= std::abs(endCell.y - startCell.y))
+    {
+        return isShallowSegmentFree(rows_, startCell.x, startCell.y, endCell.x, endCell.y);
+    }
+    else
+    {
+        return isShallowSegmentFree(columns_, startCell.y, startCell.x, endCell.y, endCell.x);
+    }
+}
+
+
+bool ConfigurationSpaceBitmap::isPathFree(const robot_path_t& path) const
+{
+    if(path.path.empty())
+    {
+        return true;
+    }
+
+    Point<double> previous = global_position_to_grid_position(Point<double>(path.path.front().x,
+                                                                            path.path.front().y),
+                                                              *this);
+    if(path.path.size() == 1)
+    {
+        return isSegmentFree(previous, previous);
+    }
+
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        Point<double> next = global_position_to_grid_position(Point<double>(path.path[n].x, path.path[n].y), *this);
+        if(!isSegmentFree(previous, next))
+        {
+            return false;
+        }
+        previous = next;
+    }
+
+    return true;
+}
+
+
+bool ConfigurationSpaceBitmap::isShallowSegmentFree(const BitRows& bits,
+                                                    int startAlong,
+                                                    int startAcross,
+                                                    int endAlong,
+                                                    int endAcross)
+{
+    if(startAcross > endAcross)
+    {
+        std::swap(startAlong, endAlong);
+        std::swap(startAcross, endAcross);
+    }
+
+    const int minAlong = std::min(startAlong, endAlong);
+    const int maxAlong = std::max(startAlong, endAlong);
+
+    if(startAcross == endAcross)
+    {
+        return bits.isSpanFree(startAcross, minAlong, maxAlong);
+    }
+
+    // The segment runs between cell centers. In each row it crosses, it covers the cells between where it enters and
+    // leaves the row.
+    const double slope = static_cast<double>(endAlong - startAlong) / (endAcross - startAcross);
+    const double centerAlong = startAlong + 0.5;
+    const double centerAcross = startAcross + 0.5;
+
+    for(int row = startAcross; row <= endAcross; ++row)
+    {
+        double enter = centerAlong + slope*(std::max<double>(row, centerAcross) - centerAcross);
+        double leave = centerAlong + slope*(std::min<double>(row + 1, endAcross + 0.5) - centerAcross);
+        if(enter > leave)
+        {
+            std::swap(enter, leave);
+        }
+
+        int first = std::max(static_cast<int>(std::floor(enter + kBoundaryTolerance)), minAlong);
+        int last = std::min(static_cast<int>(std::ceil(leave - kBoundaryTolerance)) - 1, maxAlong);
+        if((first <= last) && !bits.isSpanFree(row, first, last))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,160 @@
+#ifndef PLANNING_CONFIGURATION_SPACE_BITMAP_HPP
+#define PLANNING_CONFIGURATION_SPACE_BITMAP_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <common/point.hpp>
+#include <cstdint>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* ConfigurationSpaceBitmap stores one bit per cell saying whether a circular robot of a given radius collides with an
+* obstacle there, i.e. whether the cell is in the robot's configuration space.
+*
+* The bitmap is found once from an ObstacleDistanceGrid, using the same test as search_for_path, so a cell is free
+* exactly when the search could traverse it. Afterward, checking a cell, a span of cells, or a line segment only reads
+* bits, and every span of up to 64 cells within a row is checked with a single 64-bit operation. A copy of the bitmap
+* stored column by column lets the cells of a mostly vertical segment be checked the same way, so checking a segment
+* takes about one operation per cell across its shorter axis, plus one per 64 cells along it.
+*
+* Segments run between the centers of the cells containing their endpoints, and touch every cell whose interior they
+* pass through. A segment passing exactly through the corner shared by two cells doesn't touch them, the same as a
+* diagonal move between them.
+*
+* When only a few obstacle distances change, pass the changed cells to updateCells rather than building the bitmap
+* again.
+*/
+class ConfigurationSpaceBitmap
+{
+public:
+
+    ConfigurationSpaceBitmap(void);
+
+    /**
+    * build finds the free cells of a grid.
+    *
+    * \param    distances               Obstacle distances of the grid
+    * \param    minDistanceToObstacle   Radius of the robot, as in SearchParams::minDistanceToObstacle
+    */
+    void build(const ObstacleDistanceGrid& distances, double minDistanceToObstacle);
+
+    /**
+    * updateCells updates the bits of cells whose obstacle distances changed since build, e.g. the cells found by
+    * ObstacleDistanceGrid::updateDistances. The grid must still be the same size.
+    *
+    * \param    changedCells            Row-major indices, y*width + x, of the changed cells
+    * \param    distances               Updated obstacle distances
+    */
+    void updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances);
+
+    // Accessors for the properties of the grid the bitmap was built for
+    int widthInCells(void) const { return width_; }
+    int heightInCells(void) const { return height_; }
+    float metersPerCell(void) const { return metersPerCell_; }
+    float cellsPerMeter(void) const { return cellsPerMeter_; }
+    Point<float> originInGlobalFrame(void) const { return globalOrigin_; }
+    double minDistanceToObstacle(void) const { return minDistanceToObstacle_; }
+
+    /**
+    * isCellFree checks if the robot fits in a cell. Cells outside the grid aren't free.
+    */
+    bool isCellFree(int x, int y) const
+    {
+        return (x >= 0) && (y >= 0) && (x < width_) && (y < height_) && rows_.isSpanFree(y, x, x);
+    }
+
+    /**
+    * isRowSpanFree checks if the robot fits in every cell of a row from xStart to xEnd, inclusive.
+    *
+    * \param    y                   Row of the span
+    * \param    xStart              First cell of the span
+    * \param    xEnd                Last cell of the span
+    * \return   True if every cell of the span is in the grid and free.
+    */
+    bool isRowSpanFree(int y, int xStart, int xEnd) const;
+
+    /**
+    * isBoxFree checks if the robot fits in every cell of the box with corners (xMin, yMin) and (xMax, yMax), inclusive,
+    * e.g. to check a corridor.
+    *
+    * \return   True if every cell of the box is in the grid and free.
+    */
+    bool isBoxFree(int xMin, int yMin, int xMax, int yMax) const;
+
+    /**
+    * isSegmentFree checks if the robot can move in a straight line between two positions in the grid coordinate frame,
+    * i.e. global_position_to_grid_position.
+    *
+    * Positions within a thousandth of a cell of the next cell count as being in it, so the poses cells_to_path places
+    * at the corners of their cells aren't pushed into the neighboring cell by rounding.
+    *
+    * \param    start               Start of the segment
+    * \param    end                 End of the segment
+    * \return   True if every cell the segment touches is in the grid and free.
+    */
+    bool isSegmentFree(const Point<double>& start, const Point<double>& end) const;
+
+    /**
+    * isPathFree checks if the robot can drive along a path, moving in a straight line from each pose to the next.
+    *
+    * \param    path                Path in the global frame
+    * \return   True if every segment of the path is free. An empty path is free.
+    */
+    bool isPathFree(const robot_path_t& path) const;
+
+private:
+
+    /**
+    * BitRows packs a bit for each cell of a set of rows into 64-bit words, with bit x % 64 of word x / 64 of a row set
+    * if cell x is blocked. Each row starts at a new word.
+    */
+    struct BitRows
+    {
+        int wordsPerRow;
+        std::vector<uint64_t> words;
+
+        void reset(int numRows, int rowLength);
+        void setBlocked(int row, int cell, bool isBlocked);
+
+        // Checks if no cell from first to last, inclusive, is blocked. The cells must be in the row.
+        bool isSpanFree(int row, int first, int last) const
+        {
+            const uint64_t* rowWords = &words[static_cast<std::size_t>(row) * wordsPerRow];
+            const int firstWord = first >> 6;
+            const int lastWord = last >> 6;
+            const uint64_t firstMask = ~0ull << (first & 63);
+            const uint64_t lastMask = ~0ull >> (63 - (last & 63));
+
+            if(firstWord == lastWord)
+            {
+                return (rowWords[firstWord] & firstMask & lastMask) == 0;
+            }
+
+            uint64_t blocked = (rowWords[firstWord] & firstMask) | (rowWords[lastWord] & lastMask);
+            for(int word = firstWord + 1; (word < lastWord) && !blocked; ++word)
+            {
+                blocked = rowWords[word];
+            }
+            return blocked == 0;
+        }
+    };
+
+    BitRows rows_;                  ///< Bits of each row of cells
+    BitRows columns_;               ///< Bits of each column of cells, with row y of the grid as cell y of a column
+
+    int width_;
+    int height_;
+    float metersPerCell_;
+    float cellsPerMeter_;
+    Point<float> globalOrigin_;
+    double minDistanceToObstacle_;
+
+    bool isDistanceFree(float distance) const { return distance > minDistanceToObstacle_*1.000001; }
+
+    // Checks a segment between cell centers along the rows of a BitRows, with at least as many cells along the rows as
+    // across them
+    static bool isShallowSegmentFree(const BitRows& bits, int startAlong, int startAcross, int endAlong, int endAcross);
+};
+
+#endif // PLANNING_CONFIGURATION_SPACE_BITMAP_HPP
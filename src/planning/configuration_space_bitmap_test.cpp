@@ -0,0 +1,373 @@
+#include <planning/configuration_space_bitmap.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+* The configuration space bitmap test checks ConfigurationSpaceBitmap:
+*
+*   - every cell, row span, and box is free exactly when the obstacle distances of its cells say the robot fits,
+*     including after updateCells,
+*   - every segment is free exactly when each cell whose interior it passes through is free,
+*   - the paths MotionPlanner finds in every search mode are safe, and stop being safe when an obstacle is added
+*     along them. The time to check each path, with the bitmap and by checking the distance of each cell it crosses,
+*     is printed.
+*/
+
+
+const double kRobotRadius = 0.1;
+
+
+bool test_cells_and_spans(void);
+bool test_segments(void);
+bool test_planned_paths(void);
+
+bool is_free(int x, int y, const ObstacleDistanceGrid& distances);
+bool is_segment_free_slow(const Point<double>& start, const Point<double>& end, const ObstacleDistanceGrid& distances);
+bool is_path_free_slow(const robot_path_t& path, const ObstacleDistanceGrid& distances);
+
+
+int main(int argc, char** argv)
+{
+    if(test_cells_and_spans())
+    {
+        std::cout << "PASSED: test_cells_and_spans\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_cells_and_spans\n";
+    }
+
+    if(test_segments())
+    {
+        std::cout << "PASSED: test_segments\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_segments\n";
+    }
+
+    if(test_planned_paths())
+    {
+        std::cout << "PASSED: test_planned_paths\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_planned_paths\n";
+    }
+
+    return 0;
+}
+
+
+bool test_cells_and_spans(void)
+{
+    // An odd width, so rows end partway through a word
+    OccupancyGrid grid = generate_cluttered_grid(7.05f, 0.05f, 0.05, 1);
+    std::mt19937 rng(1);
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    ConfigurationSpaceBitmap bitmap;
+    bitmap.build(distances, kRobotRadius);
+
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        for(int y = -1; y <= distances.heightInCells(); ++y)
+        {
+            for(int x = -1; x <= distances.widthInCells(); ++x)
+            {
+                if(bitmap.isCellFree(x, y) != is_free(x, y, distances))
+                {
+                    std::cout << "Cell (" << x << ',' << y << ") is wrong in pass " << pass << '\n';
+                    return false;
+                }
+            }
+        }
+
+        for(int n = 0; n < 20000; ++n)
+        {
+            int y = rng() % distances.heightInCells();
+            int xStart = static_cast<int>(rng() % (distances.widthInCells() + 2)) - 1;
+            int xEnd = xStart + rng() % 200;
+
+            bool isFree = true;
+            for(int x = xStart; x <= xEnd; ++x)
+            {
+                isFree &= is_free(x, y, distances);
+            }
+
+            if(bitmap.isRowSpanFree(y, xStart, xEnd) != isFree)
+            {
+                std::cout << "Span of row " << y << " from " << xStart << " to " << xEnd << " is wrong in pass "
+                    << pass << '\n';
+                return false;
+            }
+
+            int yEnd = std::min(y + static_cast<int>(rng() % 4), distances.heightInCells() - 1);
+            xEnd = std::min(xEnd, distances.widthInCells() - 1);
+            isFree = true;
+            for(int boxY = y; boxY <= yEnd; ++boxY)
+            {
+                for(int x = xStart; x <= xEnd; ++x)
+                {
+                    isFree &= is_free(x, boxY, distances);
+                }
+            }
+
+            if((xStart <= xEnd) && (bitmap.isBoxFree(xStart, y, xEnd, yEnd) != isFree))
+            {
+                std::cout << "Box from (" << xStart << ',' << y << ") to (" << xEnd << ',' << yEnd
+                    << ") is wrong in pass " << pass << '\n';
+                return false;
+            }
+        }
+
+        // Clear some obstacles and add others, then only update the changed cells
+        OccupancyGrid changedGrid = grid;
+        for(int n = 0; n < 200; ++n)
+        {
+            int x = rng() % grid.widthInCells();
+            int y = rng() % grid.heightInCells();
+            changedGrid(x, y) = (changedGrid(x, y) > 0) ? -127 : 127;
+        }
+
+        std::vector<int> changedCells;
+        if(!distances.updateDistances(changedGrid, &changedCells))
+        {
+            std::cout << "Distances weren't updated incrementally\n";
+            return false;
+        }
+        bitmap.updateCells(changedCells, distances);
+    }
+
+    return true;
+}
+
+
+bool test_segments(void)
+{
+    OccupancyGrid grid = generate_cluttered_grid(10.0f, 0.05f, 0.02, 2);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> position(-0.5, 200.5);
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    ConfigurationSpaceBitmap bitmap;
+    bitmap.build(distances, kRobotRadius);
+
+    int numFree = 0;
+    const int kNumSegments = 8000;
+    for(int n = 0; n < kNumSegments; ++n)
+    {
+        Point<double> start(position(rng), position(rng));
+        Point<double> end;
+
+        // Mix in short segments, axis-aligned ones, and ones running exactly through cell corners
+        switch(n % 4)
+        {
+        case 0:
+            end = Point<double>(position(rng), position(rng));
+            break;
+        case 1:
+            end = Point<double>(start.x + position(rng) / 20.0, start.y - position(rng) / 20.0);
+            break;
+        case 2:
+            start = Point<double>(std::floor(start.x), std::floor(start.y));
+            end = (rng() % 2) ? Point<double>(start.x, std::floor(position(rng)))
+                : Point<double>(std::floor(position(rng)), start.y);
+            break;
+        default:
+            start = Point<double>(std::floor(start.x), std::floor(start.y));
+            int length = rng() % 40;
+            end = Point<double>(start.x + length, start.y + ((rng() % 2) ? length : -length));
+            break;
+        }
+
+        bool isFree = is_segment_free_slow(start, end, distances);
+        if(bitmap.isSegmentFree(start, end) != isFree)
+        {
+            std::cout << "Segment from " << start << " to " << end << " should" << (isFree ? "" : "n't")
+                << " be free\n";
+            return false;
+        }
+        numFree += isFree;
+    }
+
+    std::cout << numFree << " of " << kNumSegments << " segments were free\n";
+    return (numFree > 0) && (numFree < kNumSegments);
+}
+
+
+bool test_planned_paths(void)
+{
+    OccupancyGrid grid = generate_office_grid(20.0f, 0.05f, 3.0, 3);
+    std::mt19937 rng(3);
+    bool allCorrect = true;
+
+    printf("%-20s %8s %12s %12s\n", "mode", "paths", "bitmap us", "per cell us");
+
+    for(auto mode : { grid_astar, jump_point, hierarchical, bidirectional_astar, state_lattice })
+    {
+        MotionPlannerParams params;
+        params.robotRadius = kRobotRadius;
+        params.searchMode = mode;
+
+        MotionPlanner planner = make_planner(grid, params);
+
+        ObstacleDistanceGrid distances = planner.obstacleDistances();
+        auto randomPose = [&]() {
+            pose_xyt_t pose;
+            pose.utime = 0;
+            pose.theta = 0.0f;
+            do
+            {
+                Point<double> position = grid_position_to_global_position(
+                    Point<double>(rng() % distances.widthInCells() + 0.5, rng() % distances.heightInCells() + 0.5),
+                    distances);
+                pose.x = position.x;
+                pose.y = position.y;
+            } while(!planner.isValidGoal(pose));
+            return pose;
+        };
+
+        std::vector<robot_path_t> paths;
+        while(paths.size() < 20)
+        {
+            robot_path_t path = planner.planPath(randomPose(), randomPose());
+            if(path.path_length > 1)
+            {
+                paths.push_back(path);
+            }
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        int numSafe = 0;
+        for(auto& path : paths)
+        {
+            numSafe += planner.isPathSafe(path);
+        }
+        auto bitmapTime = std::chrono::steady_clock::now();
+        int numSlowSafe = 0;
+        for(auto& path : paths)
+        {
+            numSlowSafe += is_path_free_slow(path, distances);
+        }
+        auto endTime = std::chrono::steady_clock::now();
+
+        printf("%-20d %8zu %12.2f %12.2f\n",
+               mode,
+               paths.size(),
+               std::chrono::duration<double, std::micro>(bitmapTime - startTime).count() / paths.size(),
+               std::chrono::duration<double, std::micro>(endTime - bitmapTime).count() / paths.size());
+
+        if((numSafe != static_cast<int>(paths.size())) || (numSlowSafe != numSafe))
+        {
+            std::cout << "Only " << numSafe << " of " << paths.size() << " planned paths are safe in search mode "
+                << mode << '\n';
+            allCorrect = false;
+            continue;
+        }
+
+        // An obstacle in the middle of a path makes it unsafe
+        robot_path_t& path = paths.front();
+        const pose_xyt_t& middle = path.path[path.path.size() / 2];
+        Point<double> middlePosition = global_position_to_grid_position(Point<double>(middle.x, middle.y), grid);
+        Point<int> middleCell(std::floor(middlePosition.x + 1.0e-3), std::floor(middlePosition.y + 1.0e-3));
+
+        OccupancyGrid blockedGrid = grid;
+        blockedGrid(middleCell.x, middleCell.y) = 127;
+        planner.setMap(blockedGrid);
+
+        if(planner.isPathSafe(path))
+        {
+            std::cout << "Path through a new obstacle is still safe in search mode " << mode << '\n';
+            allCorrect = false;
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool is_free(int x, int y, const ObstacleDistanceGrid& distances)
+{
+    // Same test as search_for_path
+    return distances.isCellInGrid(x, y) && (distances(x, y) > kRobotRadius*1.000001);
+}
+
+
+bool is_segment_free_slow(const Point<double>& start, const Point<double>& end, const ObstacleDistanceGrid& distances)
+{
+    // Check every cell whose interior the segment between the centers of the endpoint cells crosses
+    Point<int> startCell(std::floor(start.x + 1.0e-3), std::floor(start.y + 1.0e-3));
+    Point<int> endCell(std::floor(end.x + 1.0e-3), std::floor(end.y + 1.0e-3));
+    Point<double> a(startCell.x + 0.5, startCell.y + 0.5);
+    Point<double> b(endCell.x + 0.5, endCell.y + 0.5);
+
+    for(int y = std::min(startCell.y, endCell.y); y <= std::max(startCell.y, endCell.y); ++y)
+    {
+        for(int x = std::min(startCell.x, endCell.x); x <= std::max(startCell.x, endCell.x); ++x)
+        {
+            // Clip the segment to the open square of the cell
+            double tMin = 0.0;
+            double tMax = 1.0;
+            const double deltas[2] = { b.x - a.x, b.y - a.y };
+            const double starts[2] = { a.x, a.y };
+            const int lows[2] = { x, y };
+            for(int axis = 0; axis < 2; ++axis)
+            {
+                if(deltas[axis] == 0.0)
+                {
+                    if((starts[axis] <= lows[axis]) || (starts[axis] >= lows[axis] + 1))
+                    {
+                        tMax = -1.0;
+                    }
+                    continue;
+                }
+
+                double t0 = (lows[axis] - starts[axis]) / deltas[axis];
+                double t1 = (lows[axis] + 1 - starts[axis]) / deltas[axis];
+                tMin = std::max(tMin, std::min(t0, t1));
+                tMax = std::min(tMax, std::max(t0, t1));
+            }
+
+            bool isCrossed = (tMax - tMin) * std::max(std::abs(deltas[0]), std::abs(deltas[1])) > 1.0e-6;
+            bool isEndpoint = ((x == startCell.x) && (y == startCell.y)) || ((x == endCell.x) && (y == endCell.y));
+            if((isCrossed || isEndpoint) && !is_free(x, y, distances))
+            {
+                return false;
+            }
+        }
+    }
+
+    return is_free(startCell.x, startCell.y, distances) && is_free(endCell.x, endCell.y, distances);
+}
+
+
+bool is_path_free_slow(const robot_path_t& path, const ObstacleDistanceGrid& distances)
+{
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        Point<double> start = global_position_to_grid_position(Point<double>(path.path[n-1].x, path.path[n-1].y),
+                                                               distances);
+        Point<double> end = global_position_to_grid_position(Point<double>(path.path[n].x, path.path[n].y), distances);
+        if(!is_segment_free_slow(start, end, distances))
+        {
+            return false;
+        }
+    }
+    return true;
+}
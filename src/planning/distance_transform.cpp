@@ -0,0 +1,72 @@
+#include <planning/distance_transform.hpp>
+#include <cmath>
+#include <limits>
+
+
+bool squared_distance_transform(const float* f,
+                                int length,
+                                float* squaredDistances,
+                                int* nearest,
+                                int* vertices,
+                                float* boundaries)
+{
+    const float kInfinity = std::numeric_limits<float>::infinity();
+
+    // vertices[k] is the q of parabola k of the envelope, which is the lowest over [boundaries[k], boundaries[k+1])
+    int numParabolas = 0;
+    for(int q = 0; q < length; ++q)
+    {
+        if(std::isinf(f[q]))
+        {
+            continue;
+        }
+
+        if(numParabolas == 0)
+        {
+            vertices[0] = q;
+            boundaries[0] = -kInfinity;
+            boundaries[1] = kInfinity;
+            numParabolas = 1;
+            continue;
+        }
+
+        // Pop the parabolas that the new one is lower than everywhere they were the lowest. The first boundary is
+        // -infinity, so at least one parabola always remains.
+        float intersection;
+        while(true)
+        {
+            int v = vertices[numParabolas - 1];
+            intersection = ((f[q] + static_cast<float>(q*q)) - (f[v] + static_cast<float>(v*v))) / (2.0f * (q - v));
+            if(intersection > boundaries[numParabolas - 1])
+            {
+                break;
+            }
+            --numParabolas;
+        }
+
+        vertices[numParabolas] = q;
+        boundaries[numParabolas] = intersection;
+        boundaries[numParabolas + 1] = kInfinity;
+        ++numParabolas;
+    }
+
+    if(numParabolas == 0)
+    {
+        return false;
+    }
+
+    int k = 0;
+    for(int x = 0; x < length; ++x)
+    {
+        while(boundaries[k + 1] < x)
+        {
+            ++k;
+        }
+
+        int v = vertices[k];
+        nearest[x] = v;
+        squaredDistances[x] = static_cast<float>((x - v)*(x - v)) + f[v];
+    }
+
+    return true;
+}
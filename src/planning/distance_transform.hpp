@@ -0,0 +1,30 @@
+#ifndef PLANNING_DISTANCE_TRANSFORM_HPP
+#define PLANNING_DISTANCE_TRANSFORM_HPP
+
+/**
+* squared_distance_transform finds the one-dimensional squared distance transform of Felzenszwalb and Huttenlocher,
+* min over q of (x - q)^2 + f(q), for every x in [0, length), along with the q that attains it.
+*
+* Each q is a parabola in x, so the transform is the lower envelope of the parabolas, which is built in a single
+* left-to-right pass and then read off in a second pass. Parabolas with an infinite f(q) are left out of the envelope.
+*
+* Running the transform along the rows of a grid whose f is the squared distance along each column to the nearest
+* obstacle gives the exact squared Euclidean distance transform of the grid, as used by ObstacleDistanceGrid and
+* SignedDistanceField.
+*
+* \param    f                   Value of f for each q in [0, length)
+* \param    length              Number of values in f
+* \param    squaredDistances    (out) Transform at each x in [0, length)
+* \param    nearest             (out) q of the lowest parabola at each x in [0, length)
+* \param    vertices            Scratch space for length values
+* \param    boundaries          Scratch space for length + 1 values
+* \return   True if f has a finite value. Otherwise, squaredDistances and nearest are left unchanged.
+*/
+bool squared_distance_transform(const float* f,
+                                int length,
+                                float* squaredDistances,
+                                int* nearest,
+                                int* vertices,
+                                float* boundaries);
+
+#endif // PLANNING_DISTANCE_TRANSFORM_HPP
@@ -0,0 +1,324 @@
+#include <planning/dstar_lite.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+
+const float kInfiniteCost = std::numeric_limits<float>::infinity();
+
+const int kXDeltas[4] = { 1, -1, 0,  0 };
+const int kYDeltas[4] = { 0,  0, 1, -1 };
+
+}
+
+
+DStarLite::DStarLite(void)
+: distances_(nullptr)
+, hasSearch_(false)
+, keyModifier_(0.0f)
+, width_(0)
+, numExpanded_(0)
+{
+}
+
+
+robot_path_t DStarLite::plan(const pose_xyt_t& start,
+                             const pose_xyt_t& goal,
+                             const ObstacleDistanceGrid& distances,
+                             const SearchParams& params)
+{
+    distances_ = &distances;
+    params_ = params;
+    hasSearch_ = true;
+    width_ = distances.widthInCells();
+
+    const std::size_t numCells = static_cast<std::size_t>(width_) * distances.heightInCells();
+    g_.assign(numCells, kInfiniteCost);
+    rhs_.assign(numCells, kInfiniteCost);
+    openList_.reset(numCells);
+
+    start_ = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    goal_ = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+    lastStart_ = start_;
+    keyModifier_ = 0.0f;
+
+    if(distances.isCellInGrid(goal_.x, goal_.y))
+    {
+        int goalIndex = goal_.y*width_ + goal_.x;
+        rhs_[goalIndex] = 0.0f;
+        openList_.push(goalIndex, calculateKey(goalIndex));
+    }
+
+    return replan(start, distances);
+}
+
+
+void DStarLite::updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances)
+{
+    if(!hasSearch())
+    {
+        return;
+    }
+
+    distances_ = &distances;
+
+    // A changed cell changes the cost of every edge into it and, if its traversability changed, out of it, so both the
+    // cell and its neighbors need their lookahead costs recomputed
+    for(int index : changedCells)
+    {
+        recomputeRhs(index);
+
+        const int x = index % width_;
+        const int y = index / width_;
+        for(int n = 0; n < 4; ++n)
+        {
+            if(distances_->isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+            {
+                recomputeRhs((y + kYDeltas[n])*width_ + x + kXDeltas[n]);
+            }
+        }
+    }
+}
+
+
+robot_path_t DStarLite::replan(const pose_xyt_t& start, const ObstacleDistanceGrid& distances)
+{
+    robot_path_t failedPath;
+    failedPath.utime = start.utime;
+    failedPath.path.push_back(start);
+    failedPath.path_length = failedPath.path.size();
+
+    numExpanded_ = 0;
+
+    if(!hasSearch())
+    {
+        return failedPath;
+    }
+
+    distances_ = &distances;
+    start_ = global_position_to_grid_cell(Point<double>(start.x, start.y), *distances_);
+
+    if(!distances_->isCellInGrid(start_.x, start_.y) || !distances_->isCellInGrid(goal_.x, goal_.y))
+    {
+        return failedPath;
+    }
+
+    // The keys already in the open list were computed with the heuristic from the old start. Rather than recomputing
+    // them all, every new key is increased by the most the heuristic could have dropped because of the move.
+    keyModifier_ += (std::abs(lastStart_.x - start_.x) + std::abs(lastStart_.y - start_.y)) * distances_->metersPerCell();
+    lastStart_ = start_;
+
+    if(!isTraversable(start_.y*width_ + start_.x) || !isTraversable(goal_.y*width_ + goal_.x) || (start_ == goal_))
+    {
+        return failedPath;
+    }
+
+    computeShortestPath();
+    return extractPath(start);
+}
+
+
+void DStarLite::clear(void)
+{
+    hasSearch_ = false;
+    g_.clear();
+    rhs_.clear();
+    openList_.reset(0);
+}
+
+
+bool DStarLite::isTraversable(int index) const
+{
+    return is_traversable(index % width_, index / width_, *distances_, params_);
+}
+
+
+float DStarLite::edgeCost(int from, int to) const
+{
+    if(!isTraversable(from) || !isTraversable(to))
+    {
+        return kInfiniteCost;
+    }
+
+    // Same cost as grid_astar in search_for_path
+    return distances_->metersPerCell() + obstacle_cost((*distances_)(to % width_, to / width_), params_);
+}
+
+
+float DStarLite::heuristic(int index) const
+{
+    return (std::abs(start_.x - index % width_) + std::abs(start_.y - index / width_)) * distances_->metersPerCell();
+}
+
+
+DStarLite::Key DStarLite::calculateKey(int index) const
+{
+    float cost = std::min(g_[index], rhs_[index]);
+    Key key;
+    key.primary = cost + heuristic(index) + keyModifier_;
+    key.secondary = cost;
+    return key;
+}
+
+
+void DStarLite::updateVertex(int index)
+{
+    if(g_[index] != rhs_[index])
+    {
+        if(openList_.contains(index))
+        {
+            openList_.update(index, calculateKey(index));
+        }
+        else
+        {
+            openList_.push(index, calculateKey(index));
+        }
+    }
+    else
+    {
+        openList_.remove(index);
+    }
+}
+
+
+void DStarLite::recomputeRhs(int index)
+{
+    if(index != goal_.y*width_ + goal_.x)
+    {
+        const int x = index % width_;
+        const int y = index / width_;
+
+        float bestCost = kInfiniteCost;
+        for(int n = 0; n < 4; ++n)
+        {
+            if(distances_->isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+            {
+                int successor = (y + kYDeltas[n])*width_ + x + kXDeltas[n];
+                bestCost = std::min(bestCost, edgeCost(index, successor) + g_[successor]);
+            }
+        }
+        rhs_[index] = bestCost;
+    }
+
+    updateVertex(index);
+}
+
+
+void DStarLite::computeShortestPath(void)
+{
+    const int startIndex = start_.y*width_ + start_.x;
+
+    while(!openList_.empty()
+        && ((openList_.topKey() < calculateKey(startIndex)) || (rhs_[startIndex] > g_[startIndex])))
+    {
+        const int index = openList_.top();
+        const Key oldKey = openList_.topKey();
+        const Key newKey = calculateKey(index);
+
+        // The key was computed for an older start, so put the cell back in the right place
+        if(oldKey < newKey)
+        {
+            openList_.update(index, newKey);
+            continue;
+        }
+
+        ++numExpanded_;
+        const int x = index % width_;
+        const int y = index / width_;
+
+        // Overconsistent: a cheaper path to the goal was found, so pass it along to the neighbors
+        if(g_[index] > rhs_[index])
+        {
+            g_[index] = rhs_[index];
+            openList_.remove(index);
+
+            for(int n = 0; n < 4; ++n)
+            {
+                if(!distances_->isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+                {
+                    continue;
+                }
+
+                int predecessor = (y + kYDeltas[n])*width_ + x + kXDeltas[n];
+                if(predecessor != goal_.y*width_ + goal_.x)
+                {
+                    rhs_[predecessor] = std::min(rhs_[predecessor], edgeCost(predecessor, index) + g_[index]);
+                }
+                updateVertex(predecessor);
+            }
+        }
+        // Underconsistent: the path through the cell got more expensive, so the cell and its neighbors that may have
+        // been using it need their costs recomputed
+        else
+        {
+            g_[index] = kInfiniteCost;
+            recomputeRhs(index);
+
+            for(int n = 0; n < 4; ++n)
+            {
+                if(distances_->isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+                {
+                    recomputeRhs((y + kYDeltas[n])*width_ + x + kXDeltas[n]);
+                }
+            }
+        }
+    }
+}
+
+
+robot_path_t DStarLite::extractPath(const pose_xyt_t& start) const
+{
+    robot_path_t failedPath;
+    failedPath.utime = start.utime;
+    failedPath.path.push_back(start);
+    failedPath.path_length = failedPath.path.size();
+
+    int index = start_.y*width_ + start_.x;
+    const int goalIndex = goal_.y*width_ + goal_.x;
+
+    // The search can stop before the start's own cost is updated, so its lookahead cost is the one to check
+    if(rhs_[index] == kInfiniteCost)
+    {
+        return failedPath;
+    }
+
+    // Follow the cheapest neighbor to the goal. Each step strictly reduces the cost-to-goal, so the walk can't be
+    // longer than the number of cells unless the costs are inconsistent.
+    std::vector<cell_t> cells;
+    while(index != goalIndex)
+    {
+        const int x = index % width_;
+        const int y = index / width_;
+
+        int bestNext = -1;
+        float bestCost = kInfiniteCost;
+        for(int n = 0; n < 4; ++n)
+        {
+            if(distances_->isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+            {
+                int successor = (y + kYDeltas[n])*width_ + x + kXDeltas[n];
+                float cost = edgeCost(index, successor) + g_[successor];
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestNext = successor;
+                }
+            }
+        }
+
+        if((bestNext < 0) || (cells.size() >= g_.size()))
+        {
+            return failedPath;
+        }
+
+        index = bestNext;
+        cells.push_back(cell_t(index % width_, index / width_));
+    }
+
+    return cells_to_path(start, cells, *distances_);
+}
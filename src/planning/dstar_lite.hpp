@@ -0,0 +1,131 @@
+#ifndef PLANNING_DSTAR_LITE_HPP
+#define PLANNING_DSTAR_LITE_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/astar.hpp>
+#include <planning/indexed_heap.hpp>
+#include <cstdint>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* DStarLite is an incremental planner that finds paths with the D* Lite algorithm (Koenig and Likhachev, 2002).
+*
+* The planner searches backward from the goal, so the cost from every cell it has explored to the goal stays valid
+* as the robot moves. When the obstacle distances change, only the costs of the cells whose shortest paths ran through
+* the changed cells are repaired. Replanning after a small map update or after the robot moves along the path
+* therefore costs roughly as much as the change rather than a whole new search.
+*
+* Paths are found over the same 4-connected cells with the same distance costs as the grid_astar mode of
+* search_for_path.
+*
+* To use the planner:
+*
+*   - Start a search with plan, which discards any previous search.
+*   - Whenever the distances change, call updateCells with the new distances and every cell whose distance changed.
+*   - Call replan with the robot's current pose to get the repaired path to the same goal.
+*
+* Every call must be given the same grid, apart from the changes passed to updateCells.
+*/
+class DStarLite
+{
+public:
+
+    DStarLite(void);
+
+    /**
+    * plan starts a new search for a path from start to goal.
+    *
+    * \param    start           Starting pose of the robot
+    * \param    goal            Desired goal pose of the robot
+    * \param    distances       Distance to the nearest obstacle for each cell in the grid
+    * \param    params          Parameters specifying the costs of the search. params.mode is ignored.
+    * \return   The path found to the goal, if one exists. If the goal is unreachable, then a path with just the initial
+    *   pose is returned, per the robot_path_t specification.
+    */
+    robot_path_t plan(const pose_xyt_t& start,
+                      const pose_xyt_t& goal,
+                      const ObstacleDistanceGrid& distances,
+                      const SearchParams& params);
+
+    /**
+    * updateCells repairs the search after the obstacle distances of some cells have changed. The distances must
+    * already hold the new values.
+    *
+    * \param    changedCells        Row-major indices, y*width + x, of the cells whose distances changed
+    * \param    distances           Updated distances
+    */
+    void updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances);
+
+    /**
+    * replan finds a path from a new start pose to the goal of the current search, reusing as much of the search as
+    * possible.
+    *
+    * \param    start           Current pose of the robot
+    * \param    distances       Distance to the nearest obstacle for each cell in the grid
+    * \return   The path found to the goal, if one exists. Otherwise, a path with just the start pose.
+    */
+    robot_path_t replan(const pose_xyt_t& start, const ObstacleDistanceGrid& distances);
+
+    /**
+    * clear discards the current search.
+    */
+    void clear(void);
+
+    /**
+    * hasSearch checks if there's a search that can be replanned.
+    */
+    bool hasSearch(void) const { return hasSearch_; }
+
+    /**
+    * goalCell retrieves the goal cell of the current search.
+    */
+    cell_t goalCell(void) const { return goal_; }
+
+    /**
+    * numExpanded retrieves the number of cells expanded by the last call to plan or replan.
+    */
+    std::size_t numExpanded(void) const { return numExpanded_; }
+
+private:
+
+    struct Key
+    {
+        float primary;
+        float secondary;
+
+        bool operator<(const Key& rhs) const
+        {
+            return (primary < rhs.primary) || ((primary == rhs.primary) && (secondary < rhs.secondary));
+        }
+    };
+
+    const ObstacleDistanceGrid* distances_;     // grid passed to the current call
+    SearchParams params_;
+    bool hasSearch_;
+
+    std::vector<float> g_;              // cost-to-goal of each cell as of its last expansion
+    std::vector<float> rhs_;            // one-step lookahead cost-to-goal of each cell
+    IndexedHeap<Key> openList_;         // locally inconsistent cells, g != rhs
+
+    cell_t start_;
+    cell_t goal_;
+    cell_t lastStart_;                  // start when keyModifier_ was last updated
+    float keyModifier_;                 // km -- total heuristic change caused by moving the start
+    int width_;
+    std::size_t numExpanded_;
+
+    bool isTraversable(int index) const;
+    float edgeCost(int from, int to) const;
+    float heuristic(int index) const;
+    Key calculateKey(int index) const;
+
+    void updateVertex(int index);
+    void recomputeRhs(int index);
+    void computeShortestPath(void);
+    robot_path_t extractPath(const pose_xyt_t& start) const;
+};
+
+#endif // PLANNING_DSTAR_LITE_HPP
@@ -0,0 +1,252 @@
+#include <planning/astar.hpp>
+#include <planning/dstar_lite.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The D* Lite test checks that the incremental planner finds paths as cheap as a fresh A* search:
+*
+*   - for the start and goal pairs of the data/astar maps,
+*   - after obstacles are added across and removed from the path, using only the changed cells to repair the search,
+*   - after the robot moves partway along the path.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+bool test_matches_astar(void);
+bool test_replan_after_map_change(void);
+bool test_replan_after_motion(void);
+
+bool costs_match(const robot_path_t& incrementalPath,
+                 const robot_path_t& astarPath,
+                 const ObstacleDistanceGrid& distances,
+                 const SearchParams& params);
+std::vector<int> changed_cells(const ObstacleDistanceGrid& before, const ObstacleDistanceGrid& after);
+
+
+int main(int argc, char** argv)
+{
+    if(test_matches_astar())
+    {
+        std::cout << "PASSED: test_matches_astar\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_matches_astar\n";
+    }
+
+    if(test_replan_after_map_change())
+    {
+        std::cout << "PASSED: test_replan_after_map_change\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_replan_after_map_change\n";
+    }
+
+    if(test_replan_after_motion())
+    {
+        std::cout << "PASSED: test_replan_after_motion\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_replan_after_motion\n";
+    }
+
+    return 0;
+}
+
+
+bool test_matches_astar(void)
+{
+    const std::vector<std::string> maps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+    const SearchParams params = search_params();
+
+    int numQueries = 0;
+    int numCorrect = 0;
+
+    for(auto& name : maps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        for(auto& query : queries)
+        {
+            DStarLite planner;
+            robot_path_t incrementalPath = planner.plan(query.start, query.goal, distances, params);
+            robot_path_t astarPath = search_for_path(query.start, query.goal, distances, params);
+
+            ++numQueries;
+            if(costs_match(incrementalPath, astarPath, distances, params))
+            {
+                ++numCorrect;
+            }
+            else
+            {
+                std::cout << "Path costs differ on " << name << " map: D* Lite "
+                    << path_cost(incrementalPath, distances, params) << " A* "
+                    << path_cost(astarPath, distances, params) << '\n';
+            }
+        }
+    }
+
+    return numCorrect == numQueries;
+}
+
+
+bool test_replan_after_map_change(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("maze", grid, queries))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    bool allCorrect = true;
+
+    for(auto& query : queries)
+    {
+        DStarLite planner;
+        robot_path_t path = planner.plan(query.start, query.goal, distances, params);
+        if(path.path_length < 3)
+        {
+            continue;
+        }
+
+        // Drop a small obstacle in the middle of the path, then take it away again
+        OccupancyGrid changedGrid = grid;
+        const pose_xyt_t& middle = path.path[path.path_length / 2];
+        cell_t blockCell = global_position_to_grid_cell(Point<double>(middle.x, middle.y), changedGrid);
+        for(int dy = -1; dy <= 1; ++dy)
+        {
+            for(int dx = -1; dx <= 1; ++dx)
+            {
+                if(changedGrid.isCellInGrid(blockCell.x + dx, blockCell.y + dy))
+                {
+                    changedGrid.setLogOdds(blockCell.x + dx, blockCell.y + dy, 127);
+                }
+            }
+        }
+
+        for(auto* nextGrid : { &changedGrid, &grid })
+        {
+            ObstacleDistanceGrid previousDistances = distances;
+            distances.setDistances(*nextGrid);
+            planner.updateCells(changed_cells(previousDistances, distances), distances);
+
+            robot_path_t incrementalPath = planner.replan(query.start, distances);
+            std::size_t numIncrementalExpanded = planner.numExpanded();
+
+            DStarLite freshPlanner;
+            freshPlanner.plan(query.start, query.goal, distances, params);
+
+            robot_path_t astarPath = search_for_path(query.start, query.goal, distances, params);
+            if(!costs_match(incrementalPath, astarPath, distances, params))
+            {
+                std::cout << "Repaired path cost " << path_cost(incrementalPath, distances, params)
+                    << " differs from A* path cost " << path_cost(astarPath, distances, params) << '\n';
+                allCorrect = false;
+            }
+
+            std::cout << "Repair expanded " << numIncrementalExpanded << " cells vs. "
+                << freshPlanner.numExpanded() << " for a new search\n";
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_replan_after_motion(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("convex", grid, queries))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    bool allCorrect = true;
+
+    for(auto& query : queries)
+    {
+        DStarLite planner;
+        robot_path_t path = planner.plan(query.start, query.goal, distances, params);
+        if(path.path_length < 3)
+        {
+            continue;
+        }
+
+        // Move the robot a third of the way along the path
+        pose_xyt_t newStart = path.path[path.path_length / 3];
+        robot_path_t incrementalPath = planner.replan(newStart, distances);
+        robot_path_t astarPath = search_for_path(newStart, query.goal, distances, params);
+
+        if(!costs_match(incrementalPath, astarPath, distances, params))
+        {
+            std::cout << "Path cost after moving " << path_cost(incrementalPath, distances, params)
+                << " differs from A* path cost " << path_cost(astarPath, distances, params) << '\n';
+            allCorrect = false;
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool costs_match(const robot_path_t& incrementalPath,
+                 const robot_path_t& astarPath,
+                 const ObstacleDistanceGrid& distances,
+                 const SearchParams& params)
+{
+    if((incrementalPath.path_length > 1) != (astarPath.path_length > 1))
+    {
+        return false;
+    }
+
+    double incrementalCost = path_cost(incrementalPath, distances, params);
+    double astarCost = path_cost(astarPath, distances, params);
+    return std::abs(incrementalCost - astarCost) <= 1e-3 * std::max(1.0, astarCost);
+}
+
+
+std::vector<int> changed_cells(const ObstacleDistanceGrid& before, const ObstacleDistanceGrid& after)
+{
+    std::vector<int> changed;
+    for(int y = 0; y < after.heightInCells(); ++y)
+    {
+        for(int x = 0; x < after.widthInCells(); ++x)
+        {
+            if(before(x, y) != after(x, y))
+            {
+                changed.push_back(y*after.widthInCells() + x);
+            }
+        }
+    }
+    return changed;
+}
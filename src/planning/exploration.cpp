@@ -12,6 +12,7 @@
 #include <cassert>
 
 const float kReachedPositionThreshold = 0.05f;  // must get within this distance of a position for it to be explored
+const int64_t kPlanningBudgetUs = 100000;       // time the planner may take to choose a frontier and plan to it (us)
 
 // Define an equality operator for poses to allow direct comparison of two paths
 bool operator==(const pose_xyt_t& lhs, const pose_xyt_t& rhs)
@@ -21,7 +22,8 @@ bool operator==(const pose_xyt_t& lhs, const pose_xyt_t& rhs)
 
 
 Exploration::Exploration(int32_t teamNumber,
-                         lcm::LCM* lcmInstance)
+                         lcm::LCM* lcmInstance,
+                         bool shouldUseLattice)
 : teamNumber_(teamNumber)
 , state_(exploration_status_t::STATE_INITIALIZING)
 , haveNewPose_(false)
@@ -48,6 +50,14 @@ Exploration::Exploration(int32_t teamNumber,
     
     MotionPlannerParams params;
     params.robotRadius = 0.2; //IS ACTUALLY .15, WE CHANGED TO .1
+    // Choosing a frontier expands a cost field from the robot. Cap it, so a large map can't hold up the exploration
+    // loop. The field reaches the nearest frontiers first, so only the farther ones wait for a later update.
+    params.timeBudgetUs = kPlanningBudgetUs;
+    params.searchMode = shouldUseLattice ? state_lattice : grid_astar;
+    // Leave a pose only where a path turns, so the controller doesn't stop at every cell
+    params.shortcutPaths = true;
+    // Keep the robot off the walls it passes while the map around them is still uncertain
+    params.optimizePaths = true;
     planner_.setParams(params);
 }
 
@@ -298,7 +308,7 @@ int8_t Exploration::executeExploringMap(bool initialize)
 
     printf("EXPLORE\n");
     planner_.setMap(currentMap_);
-    frontiers_ = find_map_frontiers(currentMap_, currentPose_);
+    frontiers_ = frontierTracker_.update(currentMap_, currentPose_);
     planner_.setNumFrontiers(frontiers_.size());
     float distThreshold = 0.5; //45
     float currDist;
@@ -317,6 +327,7 @@ int8_t Exploration::executeExploringMap(bool initialize)
         currentPath_ = plan_path_to_frontier(frontiers_, currentPose_, currentMap_, planner_);
         if (currentPath_.path_length > 1) {
             currentTarget_ = currentPath_.path[currentPath_.path_length - 1];
+            planner_.setPrevGoal(currentTarget_);
         } 
     }
     
@@ -381,11 +392,13 @@ int8_t Exploration::executeReturningHome(bool initialize)
     
    planner_.setMap(currentMap_);
 
-    if (!hasReturnHomePath_) {
-        currentPath_ = planner_.planPath(currentPose_, homePose_);
-        if (planner_.isPathSafe(currentPath_)) {
-            hasReturnHomePath_ = true;
-        }
+    // Repair the incremental search on every update so the path home tracks the changing map and the robot's motion
+    // without searching from scratch. The path being followed is only replaced once it's no longer safe.
+    robot_path_t homePath = planner_.replanPath(currentPose_, homePose_);
+
+    if (!hasReturnHomePath_ || !planner_.isPathSafe(currentPath_)) {
+        currentPath_ = homePath;
+        hasReturnHomePath_ = planner_.isPathSafe(currentPath_);
     }
 
     /////////////////////////////// End student code ///////////////////////////////
@@ -4,6 +4,7 @@
 #include <common/lcm_config.h>
 #include <planning/motion_planner.hpp>
 #include <planning/frontiers.hpp>
+#include <planning/frontier_tracker.hpp>
 #include <slam/occupancy_grid.hpp>
 #include <lcmtypes/exploration_status_t.hpp>
 #include <lcmtypes/pose_xyt_t.hpp>
@@ -54,8 +55,11 @@ public:
     * \param    shouldAttemptEscape     Flag indicating if the robot should try to escape the map, or just explore it
     * \param    targetFile              Name of the file holding the key and treasure target information (only matters if shouldAttemptEscape is true)
     * \param    lcmInstance             Instance of LCM to use for communication
+    * \param    shouldUseLattice        Flag indicating if paths to frontiers should be planned with the state lattice,
+    *                                   so motion_controller --drive-through-waypoints can drive them without stopping
+    *                                   (optional, default = false)
     */
-    Exploration(int32_t teamNumber, lcm::LCM* lcmInstance);
+    Exploration(int32_t teamNumber, lcm::LCM* lcmInstance, bool shouldUseLattice = false);
     
     /**
     * exploreEnvironment explores the robot's environment. The exploration routine assumes that the environment
@@ -87,6 +91,7 @@ private:
 
     robot_path_t currentPath_;          // Current path being followed to a frontier or other target, like the home or key poses
     std::vector<frontier_t> frontiers_; // Current frontiers in the map
+    FrontierTracker frontierTracker_;   // Keeps the frontiers up to date as the map changes
     
     // Data coming in from other modules -- used by LCM thread
     pose_xyt_t incomingPose_;           // Temporary storage for the most recently received pose until needed by explore thread
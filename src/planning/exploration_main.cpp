@@ -8,10 +8,14 @@ int main(int argc, char** argv)
 {
     // Define all command-line arguments
     const char* kTeamNumArg = "team-number";
+    const char* kLatticeArg = "lattice-paths";
 
     getopt_t *gopt = getopt_create();
     getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
     getopt_add_int(gopt, 'n', kTeamNumArg, "-1", "Team number of the robot doing the exploration.");
+    getopt_add_bool(gopt, '\0', kLatticeArg, 0,
+                    "Flag indicating if paths to frontiers should be planned with the state lattice. Run "
+                    "motion_controller with --drive-through-waypoints to drive them without stopping.");
 
     // If help was requested or the command line is invalid, display the help message and exit
     if (!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help")) {
@@ -22,13 +26,14 @@ int main(int argc, char** argv)
 
     // Convert all command-line values into program variables
     int teamNumber = getopt_get_int(gopt, kTeamNumArg);
+    bool shouldUseLattice = getopt_get_bool(gopt, kLatticeArg);
 
     // Instantiate the LCM instance and Exploration instance that will run on the two program threads
     lcm::LCM lcmInstance(MULTICAST_URL);
 
     if(!lcmInstance.good()) return 1;
 
-    Exploration exploration(teamNumber, &lcmInstance);
+    Exploration exploration(teamNumber, &lcmInstance, shouldUseLattice);
 
     std::atomic<bool> explorationComplete;
 
@@ -0,0 +1,621 @@
+#include <planning/frontier_tracker.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+
+// Flags stored for each cell
+enum CellFlag
+{
+    frontier_flag = 0x01,       // cell is a frontier cell
+    reachable_flag = 0x02,      // cell is in the free space reachable from the robot
+    examined_flag = 0x04,       // cell's frontier status was already checked during the current update
+    split_flag = 0x08,          // cell is the root of a frontier that lost cells during the current update
+    lost_flag = 0x10,           // cell was reachable, but isn't passable anymore
+    visited_flag = 0x20,        // cell was visited by the search around lost cells
+};
+
+const int kXDeltas4[4] = { -1, 1, 0,  0 };
+const int kYDeltas4[4] = {  0, 0, 1, -1 };
+
+const int kXDeltas8[8] = { -1, -1, -1, 1, 1,  1, 0,  0 };
+const int kYDeltas8[8] = {  0,  1, -1, 0, 1, -1, 1, -1 };
+
+}
+
+
+FrontierTracker::FrontierTracker(double minFrontierLength)
+: minFrontierLength_(minFrontierLength)
+, robotCell_(-1)
+, numExaminedCells_(0)
+{
+}
+
+
+const std::vector<frontier_t>& FrontierTracker::update(const OccupancyGrid& map, const pose_xyt_t& robotPose)
+{
+    Point<int> robot = global_position_to_grid_cell(Point<float>(robotPose.x, robotPose.y), map);
+    int robotCell = map.isCellInGrid(robot.x, robot.y) ? robot.y*map.widthInCells() + robot.x : -1;
+
+    // Without a previous map to compare against, every cell has to be examined
+    if(!isSameGrid(map))
+    {
+        reset(map);
+
+        const int width = map_.widthInCells();
+        for(int y = 0; y < map_.heightInCells(); ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                if(is_frontier_cell(x, y, map_))
+                {
+                    addFrontierCell(y*width + x);
+                }
+            }
+        }
+
+        // Merge each frontier cell with its neighboring frontier cells
+        for(int index : frontierCells_)
+        {
+            const int x = index % width;
+            const int y = index / width;
+            for(int n = 0; n < 8; ++n)
+            {
+                int neighborX = x + kXDeltas8[n];
+                int neighborY = y + kYDeltas8[n];
+                if(map_.isCellInGrid(neighborX, neighborY) && (cellFlags_[neighborY*width + neighborX] & frontier_flag))
+                {
+                    unite(index, neighborY*width + neighborX);
+                }
+            }
+        }
+
+        numExaminedCells_ = static_cast<std::size_t>(width) * map_.heightInCells();
+        robotCell_ = robotCell;
+        resetReachableSpace();
+        collectFrontiers();
+        return frontiers_;
+    }
+
+    const int width = map_.widthInCells();
+    numExaminedCells_ = 0;
+
+    // A cell's frontier status depends on its own log-odds and those of its 4-connected neighbors, so those are the
+    // only cells that need to be examined again
+    std::vector<int> examinedCells;
+    for(int y = 0; y < map_.heightInCells(); ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            if(map(x, y) == map_(x, y))
+            {
+                continue;
+            }
+
+            map_(x, y) = map(x, y);
+
+            for(int n = -1; n < 4; ++n)
+            {
+                int examinedX = (n < 0) ? x : x + kXDeltas4[n];
+                int examinedY = (n < 0) ? y : y + kYDeltas4[n];
+                int examined = examinedY*width + examinedX;
+                if(map_.isCellInGrid(examinedX, examinedY) && !(cellFlags_[examined] & examined_flag))
+                {
+                    cellFlags_[examined] |= examined_flag;
+                    examinedCells.push_back(examined);
+                }
+            }
+        }
+    }
+
+    numExaminedCells_ = examinedCells.size();
+
+    std::vector<int> addedCells;
+    std::vector<int> removedCells;
+    for(int index : examinedCells)
+    {
+        bool isFrontier = is_frontier_cell(index % width, index / width, map_);
+        if(isFrontier && !(cellFlags_[index] & frontier_flag))
+        {
+            addFrontierCell(index);
+            addedCells.push_back(index);
+        }
+        else if(!isFrontier && (cellFlags_[index] & frontier_flag))
+        {
+            removeFrontierCell(index);
+            removedCells.push_back(index);
+        }
+    }
+
+    splitFrontiers(removedCells);
+
+    for(int index : addedCells)
+    {
+        const int x = index % width;
+        const int y = index / width;
+        for(int n = 0; n < 8; ++n)
+        {
+            int neighborX = x + kXDeltas8[n];
+            int neighborY = y + kYDeltas8[n];
+            if(map_.isCellInGrid(neighborX, neighborY) && (cellFlags_[neighborY*width + neighborX] & frontier_flag))
+            {
+                unite(index, neighborY*width + neighborX);
+            }
+        }
+    }
+
+    // The reachable space can only shrink where reachable cells stopped being passable. The robot's own cell is always
+    // passable, so the cell the robot left is also lost if it isn't free space.
+    bool mustResetReachable = (robotCell < 0) || (robotCell_ < 0);
+
+    int previousRobotCell = robotCell_;
+    robotCell_ = robotCell;
+
+    // A robot that moved onto or next to the reachable space is still connected to it
+    if(!mustResetReachable && !(cellFlags_[robotCell_] & reachable_flag))
+    {
+        mustResetReachable = true;
+
+        const int robotX = robotCell_ % width;
+        const int robotY = robotCell_ / width;
+        for(int n = 0; n < 4; ++n)
+        {
+            int neighborX = robotX + kXDeltas4[n];
+            int neighborY = robotY + kYDeltas4[n];
+            int neighbor = neighborY*width + neighborX;
+            if(map_.isCellInGrid(neighborX, neighborY) && (cellFlags_[neighbor] & reachable_flag)
+                && isExpandable(neighbor))
+            {
+                cellFlags_[robotCell_] |= reachable_flag;
+                mustResetReachable = false;
+                break;
+            }
+        }
+    }
+
+    if(!mustResetReachable)
+    {
+        std::vector<int> lostCells;
+        for(int index : examinedCells)
+        {
+            if((cellFlags_[index] & reachable_flag) && !isPassable(index))
+            {
+                lostCells.push_back(index);
+            }
+        }
+
+        if((previousRobotCell != robotCell_) && !(cellFlags_[previousRobotCell] & examined_flag)
+            && !isPassable(previousRobotCell))
+        {
+            lostCells.push_back(previousRobotCell);
+        }
+
+        mustResetReachable = !removeLostCells(lostCells);
+    }
+
+    if(mustResetReachable)
+    {
+        resetReachableSpace();
+    }
+    else
+    {
+        // Otherwise, it only grows into the newly freed cells that touch it and from the robot's new cell
+        std::vector<int> queue(1, robotCell_);
+        for(int index : examinedCells)
+        {
+            if((cellFlags_[index] & reachable_flag) || !isExpandable(index))
+            {
+                continue;
+            }
+
+            const int x = index % width;
+            const int y = index / width;
+            for(int n = 0; n < 4; ++n)
+            {
+                int neighborX = x + kXDeltas4[n];
+                int neighborY = y + kYDeltas4[n];
+                if(map_.isCellInGrid(neighborX, neighborY) && (cellFlags_[neighborY*width + neighborX] & reachable_flag))
+                {
+                    cellFlags_[index] |= reachable_flag;
+                    queue.push_back(index);
+                    break;
+                }
+            }
+        }
+
+        growReachableSpace(queue);
+    }
+
+    for(int index : examinedCells)
+    {
+        cellFlags_[index] &= ~examined_flag;
+    }
+
+    collectFrontiers();
+    return frontiers_;
+}
+
+
+void FrontierTracker::clear(void)
+{
+    map_ = OccupancyGrid();
+    cellFlags_.clear();
+    parents_.clear();
+    frontierSlots_.clear();
+    frontierCells_.clear();
+    frontiers_.clear();
+    robotCell_ = -1;
+}
+
+
+bool FrontierTracker::isSameGrid(const OccupancyGrid& map) const
+{
+    return (map.widthInCells() == map_.widthInCells())
+        && (map.heightInCells() == map_.heightInCells())
+        && (map.metersPerCell() == map_.metersPerCell())
+        && (map.originInGlobalFrame() == map_.originInGlobalFrame())
+        && (cellFlags_.size() == static_cast<std::size_t>(map.widthInCells()) * map.heightInCells());
+}
+
+
+void FrontierTracker::reset(const OccupancyGrid& map)
+{
+    map_ = map;
+
+    const std::size_t numCells = static_cast<std::size_t>(map.widthInCells()) * map.heightInCells();
+    cellFlags_.assign(numCells, 0);
+    parents_.resize(numCells);
+    frontierSlots_.resize(numCells);
+    frontierCells_.clear();
+}
+
+
+bool FrontierTracker::isExpandable(int index) const
+{
+    // find_map_frontiers only passes through free cells that aren't themselves frontier cells
+    const int width = map_.widthInCells();
+    return (map_(index % width, index / width) < 0) && !(cellFlags_[index] & frontier_flag);
+}
+
+
+bool FrontierTracker::isPassable(int index) const
+{
+    // The search starts from the robot's cell, so it's passable even if it isn't free space
+    return (index == robotCell_) || isExpandable(index);
+}
+
+
+void FrontierTracker::addFrontierCell(int index)
+{
+    cellFlags_[index] |= frontier_flag;
+    parents_[index] = index;
+    frontierSlots_[index] = frontierCells_.size();
+    frontierCells_.push_back(index);
+}
+
+
+void FrontierTracker::removeFrontierCell(int index)
+{
+    // Move the last frontier cell into the removed cell's slot. The parent is left alone because other cells in the same
+    // frontier may still point to it until splitFrontiers runs.
+    cellFlags_[index] &= ~frontier_flag;
+
+    int lastCell = frontierCells_.back();
+    frontierCells_[frontierSlots_[index]] = lastCell;
+    frontierSlots_[lastCell] = frontierSlots_[index];
+    frontierCells_.pop_back();
+}
+
+
+int FrontierTracker::findRoot(int index)
+{
+    // Path halving -- point every other cell along the path at its grandparent
+    while(parents_[index] != index)
+    {
+        parents_[index] = parents_[parents_[index]];
+        index = parents_[index];
+    }
+    return index;
+}
+
+
+void FrontierTracker::unite(int first, int second)
+{
+    int firstRoot = findRoot(first);
+    int secondRoot = findRoot(second);
+    if(firstRoot != secondRoot)
+    {
+        parents_[std::max(firstRoot, secondRoot)] = std::min(firstRoot, secondRoot);
+    }
+}
+
+
+void FrontierTracker::splitFrontiers(const std::vector<int>& removedCells)
+{
+    if(removedCells.empty())
+    {
+        return;
+    }
+
+    // A union-find can't remove cells, so every frontier that lost a cell is rebuilt from its remaining cells. The
+    // removed cells still have their parents, so they lead to the roots of the frontiers they belonged to.
+    std::vector<int> splitRoots;
+    for(int index : removedCells)
+    {
+        int root = findRoot(index);
+        if(!(cellFlags_[root] & split_flag))
+        {
+            cellFlags_[root] |= split_flag;
+            splitRoots.push_back(root);
+        }
+    }
+
+    std::vector<int> members;
+    for(int index : frontierCells_)
+    {
+        if(cellFlags_[findRoot(index)] & split_flag)
+        {
+            members.push_back(index);
+        }
+    }
+
+    for(int root : splitRoots)
+    {
+        cellFlags_[root] &= ~split_flag;
+    }
+
+    for(int index : members)
+    {
+        parents_[index] = index;
+    }
+
+    const int width = map_.widthInCells();
+    for(int index : members)
+    {
+        const int x = index % width;
+        const int y = index / width;
+        for(int n = 0; n < 8; ++n)
+        {
+            int neighborX = x + kXDeltas8[n];
+            int neighborY = y + kYDeltas8[n];
+            if(map_.isCellInGrid(neighborX, neighborY) && (cellFlags_[neighborY*width + neighborX] & frontier_flag))
+            {
+                unite(index, neighborY*width + neighborX);
+            }
+        }
+    }
+}
+
+
+bool FrontierTracker::removeLostCells(const std::vector<int>& lostCells)
+{
+    /*
+    * Any path from the robot that passed through a lost cell entered and left the group of connected lost cells it
+    * belongs to through reachable cells bordering the group. If all the passable cells bordering each group are still
+    * connected to each other, every such path can be rerouted around the group, so nothing else becomes unreachable.
+    *
+    * Lost cells are usually a small blob, like a new obstacle, so the border cells are checked with a search limited to
+    * the area around the group. If the search can't connect them within that area, the reachable space might have been
+    * split and needs to be found again.
+    */
+    const int kSearchMargin = 16;
+    const int width = map_.widthInCells();
+
+    for(int index : lostCells)
+    {
+        cellFlags_[index] |= lost_flag;
+        cellFlags_[index] &= ~reachable_flag;
+    }
+
+    bool isConnected = true;
+    std::vector<int> group;
+    std::vector<int> border;
+    std::vector<int> visited;
+
+    for(int start : lostCells)
+    {
+        if(!isConnected)
+        {
+            break;
+        }
+
+        if(!(cellFlags_[start] & lost_flag))
+        {
+            continue;
+        }
+
+        // Find the group of lost cells, its bounding box, and its border
+        group.assign(1, start);
+        border.clear();
+        cellFlags_[start] &= ~lost_flag;
+
+        int minX = start % width;
+        int maxX = minX;
+        int minY = start / width;
+        int maxY = minY;
+
+        for(std::size_t next = 0; next < group.size(); ++next)
+        {
+            const int x = group[next] % width;
+            const int y = group[next] / width;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+
+            for(int n = 0; n < 4; ++n)
+            {
+                int neighborX = x + kXDeltas4[n];
+                int neighborY = y + kYDeltas4[n];
+                if(!map_.isCellInGrid(neighborX, neighborY))
+                {
+                    continue;
+                }
+
+                int neighbor = neighborY*width + neighborX;
+                if(cellFlags_[neighbor] & lost_flag)
+                {
+                    cellFlags_[neighbor] &= ~lost_flag;
+                    group.push_back(neighbor);
+                }
+                else if(cellFlags_[neighbor] & reachable_flag)
+                {
+                    border.push_back(neighbor);
+                }
+            }
+        }
+
+        if(border.size() < 2)
+        {
+            continue;
+        }
+
+        // Search from one border cell to see if the rest can be reached nearby
+        minX -= kSearchMargin;
+        maxX += kSearchMargin;
+        minY -= kSearchMargin;
+        maxY += kSearchMargin;
+
+        visited.assign(1, border.front());
+        cellFlags_[border.front()] |= visited_flag;
+
+        for(std::size_t next = 0; next < visited.size(); ++next)
+        {
+            const int x = visited[next] % width;
+            const int y = visited[next] / width;
+
+            for(int n = 0; n < 4; ++n)
+            {
+                int neighborX = x + kXDeltas4[n];
+                int neighborY = y + kYDeltas4[n];
+                if((neighborX < minX) || (neighborX > maxX) || (neighborY < minY) || (neighborY > maxY)
+                    || !map_.isCellInGrid(neighborX, neighborY))
+                {
+                    continue;
+                }
+
+                int neighbor = neighborY*width + neighborX;
+                if(!(cellFlags_[neighbor] & visited_flag) && isPassable(neighbor))
+                {
+                    cellFlags_[neighbor] |= visited_flag;
+                    visited.push_back(neighbor);
+                }
+            }
+        }
+
+        for(int index : border)
+        {
+            isConnected &= (cellFlags_[index] & visited_flag) != 0;
+        }
+
+        for(int index : visited)
+        {
+            cellFlags_[index] &= ~visited_flag;
+        }
+    }
+
+    for(int index : lostCells)
+    {
+        cellFlags_[index] &= ~lost_flag;
+    }
+
+    return isConnected;
+}
+
+
+void FrontierTracker::resetReachableSpace(void)
+{
+    for(auto& flags : cellFlags_)
+    {
+        flags &= ~reachable_flag;
+    }
+
+    if(robotCell_ < 0)
+    {
+        return;
+    }
+
+    cellFlags_[robotCell_] |= reachable_flag;
+
+    std::vector<int> queue(1, robotCell_);
+    growReachableSpace(queue);
+}
+
+
+void FrontierTracker::growReachableSpace(std::vector<int>& queue)
+{
+    // The queue is only ever appended to, so it doubles as the FIFO for the breadth-first search
+    const int width = map_.widthInCells();
+    for(std::size_t next = 0; next < queue.size(); ++next)
+    {
+        const int x = queue[next] % width;
+        const int y = queue[next] / width;
+
+        for(int n = 0; n < 4; ++n)
+        {
+            int neighborX = x + kXDeltas4[n];
+            int neighborY = y + kYDeltas4[n];
+            if(!map_.isCellInGrid(neighborX, neighborY))
+            {
+                continue;
+            }
+
+            int neighbor = neighborY*width + neighborX;
+            if(!(cellFlags_[neighbor] & reachable_flag) && isExpandable(neighbor))
+            {
+                cellFlags_[neighbor] |= reachable_flag;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+}
+
+
+void FrontierTracker::collectFrontiers(void)
+{
+    frontiers_.clear();
+
+    // Group the frontier cells by root. Sorting also puts the cells of each frontier in row-major order.
+    std::vector<std::pair<int, int>> cellsByRoot;
+    cellsByRoot.reserve(frontierCells_.size());
+    for(int index : frontierCells_)
+    {
+        cellsByRoot.push_back(std::make_pair(findRoot(index), index));
+    }
+    std::sort(cellsByRoot.begin(), cellsByRoot.end());
+
+    const int width = map_.widthInCells();
+    for(std::size_t begin = 0, end = 0; begin < cellsByRoot.size(); begin = end)
+    {
+        // A frontier can be reached if any of its cells borders the reachable free space
+        bool isReachable = false;
+        for(end = begin; (end < cellsByRoot.size()) && (cellsByRoot[end].first == cellsByRoot[begin].first); ++end)
+        {
+            const int x = cellsByRoot[end].second % width;
+            const int y = cellsByRoot[end].second / width;
+            for(int n = 0; (n < 4) && !isReachable; ++n)
+            {
+                int neighborX = x + kXDeltas4[n];
+                int neighborY = y + kYDeltas4[n];
+                isReachable = map_.isCellInGrid(neighborX, neighborY)
+                    && (cellFlags_[neighborY*width + neighborX] & reachable_flag);
+            }
+        }
+
+        if(!isReachable || ((end - begin) * map_.metersPerCell() < minFrontierLength_))
+        {
+            continue;
+        }
+
+        frontier_t frontier;
+        frontier.cells.reserve(end - begin);
+        for(std::size_t n = begin; n < end; ++n)
+        {
+            Point<int> cell(cellsByRoot[n].second % width, cellsByRoot[n].second / width);
+            frontier.cells.push_back(grid_position_to_global_position(cell, map_));
+        }
+        frontiers_.push_back(frontier);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef PLANNING_FRONTIER_TRACKER_HPP
+#define PLANNING_FRONTIER_TRACKER_HPP
+
+#include <planning/frontiers.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/point.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+* FrontierTracker maintains the frontiers of a map as it is built, finding the same frontiers as find_map_frontiers
+* without searching the whole map on every update.
+*
+* Each update compares the new map to the previous one and only re-examines the cells that changed and their neighbors:
+*
+*   - Frontier cells are stored in a bitmap. A cell's frontier status only depends on it and its 4-connected neighbors,
+*     so only those around the changed cells are checked.
+*   - Frontier cells are clustered into 8-connected frontiers with a union-find. New frontier cells are merged with
+*     their neighbors. When frontier cells are removed, only the frontiers they belonged to are split back apart.
+*   - The free space reachable from the robot is kept in a bitmap and grown from newly freed cells. When reachable cells
+*     stop being free space, a search around them checks that the cells bordering them are still connected. The
+*     reachable space is only searched again from scratch if they might not be or if the robot leaves it.
+*
+* The comparison of the maps is a linear scan, but it only reads a byte per cell. The rest of an update costs as much as
+* the changed area plus the number of frontier cells, rather than the size of the known map.
+*
+* A map with a different size, resolution, or origin starts the tracking over.
+*/
+class FrontierTracker
+{
+public:
+
+    /**
+    * Constructor for FrontierTracker.
+    *
+    * \param    minFrontierLength       Minimum length of a valid frontier (meters) (optional, default = 0.35m)
+    */
+    explicit FrontierTracker(double minFrontierLength = 0.35);
+
+    /**
+    * update brings the frontiers up to date with a new version of the map.
+    *
+    * \param    map                     Current map of the environment
+    * \param    robotPose               Current pose of the robot
+    * \return   All frontiers reachable through free space from the robot, as defined by find_map_frontiers.
+    */
+    const std::vector<frontier_t>& update(const OccupancyGrid& map, const pose_xyt_t& robotPose);
+
+    /**
+    * frontiers retrieves the frontiers found by the last update.
+    */
+    const std::vector<frontier_t>& frontiers(void) const { return frontiers_; }
+
+    /**
+    * clear discards the tracked map, so the next update examines every cell.
+    */
+    void clear(void);
+
+    /**
+    * numExaminedCells retrieves the number of cells whose frontier status was checked by the last update.
+    */
+    std::size_t numExaminedCells(void) const { return numExaminedCells_; }
+
+private:
+
+    double minFrontierLength_;
+    std::vector<frontier_t> frontiers_;
+
+    OccupancyGrid map_;                     // map as of the last update
+    std::vector<uint8_t> cellFlags_;        // frontier, reachable, and scratch flags for each cell
+    std::vector<int32_t> parents_;          // union-find parent of each frontier cell
+    std::vector<int32_t> frontierSlots_;    // position of each frontier cell in frontierCells_
+    std::vector<int> frontierCells_;        // every frontier cell in the map
+    int robotCell_;                         // cell the reachable free space was grown from
+    std::size_t numExaminedCells_;
+
+    bool isSameGrid(const OccupancyGrid& map) const;
+    void reset(const OccupancyGrid& map);
+    bool isExpandable(int index) const;
+    bool isPassable(int index) const;
+
+    void addFrontierCell(int index);
+    void removeFrontierCell(int index);
+    int findRoot(int index);
+    void unite(int first, int second);
+    void splitFrontiers(const std::vector<int>& removedCells);
+
+    bool removeLostCells(const std::vector<int>& lostCells);
+    void resetReachableSpace(void);
+    void growReachableSpace(std::vector<int>& queue);
+    void collectFrontiers(void);
+};
+
+#endif // PLANNING_FRONTIER_TRACKER_HPP
@@ -0,0 +1,319 @@
+#include <planning/frontier_tracker.hpp>
+#include <planning/frontiers.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The frontier tracker test simulates exploring the data/astar maps. The explored map starts out unknown, and at each
+* step the robot drives to a cell on one of the frontiers, uncovering the unexplored cells around it, or wanders through
+* the explored free space once there are no frontiers left. Now and then, obstacles appear in or disappear from the
+* explored free space, as with mapping errors and moving objects.
+*
+* After every step, the frontiers found by FrontierTracker must match those found by find_map_frontiers.
+*
+* The timing test compares the time for each update to the time for find_map_frontiers on a large map, most of which has
+* already been explored. The time and number of cells examined by each update are printed, since the update time grows
+* with the cells examined rather than with the size of the map.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+typedef std::vector<std::vector<Point<int>>> frontier_cells_t;
+
+const CellOdds kWeaklyFree = -3;
+
+
+bool test_matches_find_map_frontiers(void);
+bool test_update_timing(void);
+
+void mark_free_space_known(OccupancyGrid& map);
+bool explore(const OccupancyGrid& trueMap, int numSteps, int sensorRadius, int initialRadius, bool printTiming);
+bool pick_free_cell(const OccupancyGrid& map, Point<int>& cell);
+void uncover(const OccupancyGrid& trueMap, OccupancyGrid& exploredMap, Point<int> center, int radius);
+void change_explored_cells(OccupancyGrid& exploredMap, Point<int> center);
+frontier_cells_t frontier_cells(const std::vector<frontier_t>& frontiers, const OccupancyGrid& map);
+pose_xyt_t cell_to_pose(Point<int> cell, const OccupancyGrid& map);
+
+
+int main(int argc, char** argv)
+{
+    if(test_matches_find_map_frontiers())
+    {
+        std::cout << "PASSED: test_matches_find_map_frontiers\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_matches_find_map_frontiers\n";
+    }
+
+    if(test_update_timing())
+    {
+        std::cout << "PASSED: test_update_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_update_timing\n";
+    }
+
+    return 0;
+}
+
+
+bool test_matches_find_map_frontiers(void)
+{
+    const std::vector<std::string> maps = { "empty", "narrow", "wide", "convex", "maze" };
+
+    std::srand(11);
+
+    for(auto& name : maps)
+    {
+        OccupancyGrid trueMap;
+        if(!trueMap.loadFromFile("../data/astar/" + name + ".map"))
+        {
+            std::cerr << "ERROR: Run frontier_tracker_test from the bin/ directory.\n";
+            return false;
+        }
+        mark_free_space_known(trueMap);
+
+        if(!explore(trueMap, 60, 12, 12, false))
+        {
+            std::cout << "Frontiers differ on " << name << " map\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_update_timing(void)
+{
+    // Tile the convex map to make a large map
+    OccupancyGrid tile;
+    if(!tile.loadFromFile("../data/astar/convex.map"))
+    {
+        std::cerr << "ERROR: Run frontier_tracker_test from the bin/ directory.\n";
+        return false;
+    }
+
+    const int kNumTiles = 5;
+    OccupancyGrid trueMap(tile.widthInMeters() * kNumTiles, tile.heightInMeters() * kNumTiles, tile.metersPerCell());
+    for(int y = 0; y < trueMap.heightInCells(); ++y)
+    {
+        for(int x = 0; x < trueMap.widthInCells(); ++x)
+        {
+            trueMap(x, y) = tile(x % tile.widthInCells(), y % tile.heightInCells());
+        }
+    }
+    mark_free_space_known(trueMap);
+
+    // Start with most of the map explored, like late in an exploration when find_map_frontiers has the most to search
+    return explore(trueMap, 40, 20, trueMap.widthInCells() / 3, true);
+}
+
+
+bool explore(const OccupancyGrid& trueMap, int numSteps, int sensorRadius, int initialRadius, bool printTiming)
+{
+    OccupancyGrid exploredMap(trueMap.widthInMeters(), trueMap.heightInMeters(), trueMap.metersPerCell());
+    exploredMap.setOrigin(trueMap.originInGlobalFrame().x, trueMap.originInGlobalFrame().y);
+
+    Point<int> robotCell;
+    if(!pick_free_cell(trueMap, robotCell))
+    {
+        return true;
+    }
+
+    FrontierTracker tracker;
+    double trackerMs = 0.0;
+    double searchMs = 0.0;
+    std::size_t numExaminedCells = 0;
+
+    for(int step = 0; step < numSteps; ++step)
+    {
+        uncover(trueMap, exploredMap, robotCell, (step == 0) ? initialRadius : sensorRadius);
+        if(step % 5 == 4)
+        {
+            change_explored_cells(exploredMap, robotCell);
+        }
+
+        pose_xyt_t robotPose = cell_to_pose(robotCell, exploredMap);
+
+        auto startTime = std::chrono::steady_clock::now();
+        const std::vector<frontier_t>& trackedFrontiers = tracker.update(exploredMap, robotPose);
+        auto trackerTime = std::chrono::steady_clock::now();
+        std::vector<frontier_t> foundFrontiers = find_map_frontiers(exploredMap, robotPose);
+        auto searchTime = std::chrono::steady_clock::now();
+
+        // The first update examines the whole map, so leave it out of the timing
+        double updateMs = std::chrono::duration<double, std::milli>(trackerTime - startTime).count();
+        double stepSearchMs = std::chrono::duration<double, std::milli>(searchTime - trackerTime).count();
+        if(step > 0)
+        {
+            trackerMs += updateMs;
+            searchMs += stepSearchMs;
+            numExaminedCells += tracker.numExaminedCells();
+        }
+
+        if(printTiming)
+        {
+            std::cout << "  step " << std::setw(2) << step << ": FrontierTracker " << std::setw(8) << updateMs
+                << " ms for " << std::setw(7) << tracker.numExaminedCells() << " cells examined, find_map_frontiers "
+                << std::setw(8) << stepSearchMs << " ms\n";
+        }
+
+        if(frontier_cells(trackedFrontiers, exploredMap) != frontier_cells(foundFrontiers, exploredMap))
+        {
+            std::cout << "Step " << step << ": tracked " << trackedFrontiers.size() << " frontiers, found "
+                << foundFrontiers.size() << '\n';
+            return false;
+        }
+
+        // Drive next to a random cell of a random frontier, so the next step uncovers unexplored cells. Once the map
+        // is explored, wander to a random free cell in the explored area instead.
+        std::vector<Point<int>> nextCells;
+        if(!trackedFrontiers.empty())
+        {
+            const frontier_t& frontier = trackedFrontiers[std::rand() % trackedFrontiers.size()];
+            Point<int> frontierCell
+                = global_position_to_grid_cell(frontier.cells[std::rand() % frontier.cells.size()], exploredMap);
+            nextCells.push_back(Point<int>(frontierCell.x + 1, frontierCell.y));
+            nextCells.push_back(Point<int>(frontierCell.x - 1, frontierCell.y));
+            nextCells.push_back(Point<int>(frontierCell.x, frontierCell.y + 1));
+            nextCells.push_back(Point<int>(frontierCell.x, frontierCell.y - 1));
+        }
+        else
+        {
+            nextCells.push_back(Point<int>(robotCell.x + (std::rand() % (2*sensorRadius + 1)) - sensorRadius,
+                                           robotCell.y + (std::rand() % (2*sensorRadius + 1)) - sensorRadius));
+        }
+
+        for(auto& nextCell : nextCells)
+        {
+            if(exploredMap.isCellInGrid(nextCell.x, nextCell.y) && (exploredMap(nextCell.x, nextCell.y) < 0))
+            {
+                robotCell = nextCell;
+                break;
+            }
+        }
+    }
+
+    if(printTiming && (numExaminedCells > 0))
+    {
+        std::cout << "Timing: " << trueMap.widthInCells() << 'x' << trueMap.heightInCells() << " map: FrontierTracker "
+            << (trackerMs / (numSteps - 1)) << " ms/update (" << (numExaminedCells / (numSteps - 1))
+            << " cells examined, " << (1000.0 * trackerMs / numExaminedCells) << " us/cell), find_map_frontiers "
+            << (searchMs / (numSteps - 1)) << " ms/update\n";
+    }
+
+    return true;
+}
+
+
+void mark_free_space_known(OccupancyGrid& map)
+{
+    // The A* maps leave their free space at log-odds 0, which would look unknown to the explored map
+    for(int y = 0; y < map.heightInCells(); ++y)
+    {
+        for(int x = 0; x < map.widthInCells(); ++x)
+        {
+            map(x, y) = (map(x, y) > 0) ? 100 : -100;
+        }
+    }
+}
+
+
+bool pick_free_cell(const OccupancyGrid& map, Point<int>& cell)
+{
+    for(int attempt = 0; attempt < 10000; ++attempt)
+    {
+        cell.x = std::rand() % map.widthInCells();
+        cell.y = std::rand() % map.heightInCells();
+        if(map(cell.x, cell.y) < 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void uncover(const OccupancyGrid& trueMap, OccupancyGrid& exploredMap, Point<int> center, int radius)
+{
+    for(int y = center.y - radius; y <= center.y + radius; ++y)
+    {
+        for(int x = center.x - radius; x <= center.x + radius; ++x)
+        {
+            // Only cells that are unknown or weakly free get new evidence
+            if(exploredMap.isCellInGrid(x, y)
+                && ((x - center.x)*(x - center.x) + (y - center.y)*(y - center.y) <= radius*radius)
+                && ((exploredMap(x, y) == 0) || (exploredMap(x, y) == kWeaklyFree)))
+            {
+                // Cells at the edge of the sensor range are only weakly free, which is_frontier_cell also treats as
+                // frontier cells
+                bool isEdge = (x - center.x)*(x - center.x) + (y - center.y)*(y - center.y) > (radius - 2)*(radius - 2);
+                CellOdds value = trueMap(x, y);
+                exploredMap(x, y) = ((value < 0) && isEdge && (std::rand() % 2 == 0)) ? kWeaklyFree : value;
+            }
+        }
+    }
+}
+
+
+void change_explored_cells(OccupancyGrid& exploredMap, Point<int> center)
+{
+    // Drop a small obstacle near the robot or knock a hole in a nearby wall
+    const CellOdds kValues[] = { 100, -100 };
+    CellOdds value = kValues[std::rand() % 2];
+
+    int blockX = center.x + (std::rand() % 21) - 10;
+    int blockY = center.y + (std::rand() % 21) - 10;
+    for(int y = blockY - 1; y <= blockY + 1; ++y)
+    {
+        for(int x = blockX - 1; x <= blockX + 1; ++x)
+        {
+            if(exploredMap.isCellInGrid(x, y) && (exploredMap(x, y) != 0) && ((x != center.x) || (y != center.y)))
+            {
+                exploredMap(x, y) = value;
+            }
+        }
+    }
+}
+
+
+frontier_cells_t frontier_cells(const std::vector<frontier_t>& frontiers, const OccupancyGrid& map)
+{
+    // Put the cells of each frontier, and then the frontiers, in a canonical order to compare them
+    frontier_cells_t cells;
+    for(auto& frontier : frontiers)
+    {
+        std::vector<Point<int>> frontierCells;
+        for(auto& position : frontier.cells)
+        {
+            frontierCells.push_back(global_position_to_grid_cell(position, map));
+        }
+        std::sort(frontierCells.begin(), frontierCells.end());
+        cells.push_back(frontierCells);
+    }
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
+
+
+pose_xyt_t cell_to_pose(Point<int> cell, const OccupancyGrid& map)
+{
+    Point<double> position = grid_position_to_global_position(Point<double>(cell.x, cell.y), map);
+    pose_xyt_t pose;
+    pose.utime = 0;
+    pose.x = position.x;
+    pose.y = position.y;
+    pose.theta = 0.0f;
+    return pose;
+}
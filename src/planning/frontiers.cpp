@@ -3,12 +3,25 @@
 #include <common/grid_utils.hpp>
 #include <slam/occupancy_grid.hpp>
 #include <lcmtypes/robot_path_t.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <queue>
 #include <set>
-#include <cassert>
+
+
+// Farthest the goal for a frontier can be from the middle of the frontier
+const float kMaxGoalDistanceFromFrontier = 0.5f;
 
 
 bool is_frontier_cell(int x, int y, const OccupancyGrid& map);
+bool nearest_reachable_goal(Point<int> targetCell,
+                            Point<int> robotCell,
+                            const OccupancyGrid& map,
+                            const MotionPlanner& planner,
+                            pose_xyt_t& goal,
+                            float& goalCost);
 frontier_t grow_frontier(Point<int> cell, const OccupancyGrid& map, std::set<Point<int>>& visitedFrontiers);
 robot_path_t path_to_frontier(const frontier_t& frontier, 
                               const pose_xyt_t& pose, 
@@ -85,132 +98,135 @@ std::vector<frontier_t> find_map_frontiers(const OccupancyGrid& map,
     return frontiers;
 }
 
-bool check_valid(const MotionPlanner& planner, float x, float y, pose_xyt_t curr_pose) {
-    pose_xyt_t pose;
-    pose.x = x;
-    pose.y = y;
-
-    if (planner.isValidGoal(pose)) {
-        robot_path_t temp_path = planner.planPath(curr_pose, pose);
-        if(temp_path.path_length <3) 
-            return false;
-        else
-            return planner.isPathSafe(temp_path);
-    } else {
-        return false;
-    }
-}
-
 robot_path_t plan_path_to_frontier(const std::vector<frontier_t>& frontiers, 
                                    const pose_xyt_t& robotPose,
                                    const OccupancyGrid& map,
                                    const MotionPlanner& planner)
 {
-    ///////////// TODO: Implement your strategy to select the next frontier to explore here //////////////////
     /*
-    * NOTES:
-    *   - If there's multiple frontiers, you'll need to decide which to drive to.
-    *   - A frontier is a collection of cells, you'll need to decide which one to attempt to drive to.
-    *   - The cells along the frontier might not be in the configuration space of the robot, so you won't necessarily
-    *       be able to drive straight to a frontier cell, but will need to drive somewhere close.
+    * The cells along a frontier are unknown, so they aren't in the configuration space of the robot. Instead, the robot
+    * drives to the reachable cell nearest to the middle of a frontier. The frontier picked is the one whose goal is the
+    * cheapest to reach.
+    *
+    * A single Dijkstra search from the robot gives the cost of reaching every cell, so every candidate goal around
+    * every frontier is checked by looking up its cost rather than planning a path to it. The path to the selected goal
+    * is then read out of the same search, unless the planner plans with the state lattice.
     */
-    robot_path_t emptyPath;
+    robot_path_t failedPath;
+    failedPath.utime = robotPose.utime;
+    failedPath.path.push_back(robotPose);
+    failedPath.path_length = failedPath.path.size();
 
-    // if no frontiers, return empty path
-    if (frontiers.size() == 0) return emptyPath;
-    
-    float min_dist = 99999999999999;
-    frontier_t closest_frontier;
-    Point<float> closest_point;
-
-    // step 1: figure out which of the frontiers to drive to
-    // use shortest euclidian distance frontier, effectively making breadth first search
-    for (auto frontier : frontiers) {
-        for (auto point : frontier.cells) {
-            float distance_sq = (robotPose.x - point.x)*(robotPose.x - point.x) + (robotPose.y - point.y)*(robotPose.y - point.y) ;// euclidian distance
-            if (distance_sq < min_dist) {
-                closest_frontier = frontier;
-                closest_point = point;
-                min_dist = distance_sq;
-            }
+    if(frontiers.empty())
+    {
+        return failedPath;
+    }
+
+    planner.expandCostField(robotPose);
+
+    Point<int> robotCell = global_position_to_grid_cell(Point<float>(robotPose.x, robotPose.y), map);
+
+    float bestCost = std::numeric_limits<float>::infinity();
+    pose_xyt_t bestGoal;
+
+    for(auto& frontier : frontiers)
+    {
+        if(frontier.cells.empty())
+        {
+            continue;
+        }
+
+        Point<float> middle = frontier.cells[(frontier.cells.size() - 1) / 2];
+        Point<int> middleCell = global_position_to_grid_cell(middle, map);
+
+        pose_xyt_t goal;
+        float goalCost;
+        if(nearest_reachable_goal(middleCell, robotCell, map, planner, goal, goalCost) && (goalCost < bestCost))
+        {
+            bestCost = goalCost;
+            bestGoal = goal;
         }
     }
 
-    closest_point = closest_frontier.cells[int((closest_frontier.cells.size()-1)/2)];
-
-
-    // Search around the closest frontier until you find the closest point that you can get to
-    bool foundPose = false;
-    float square_radius = .025; // .05
-    float sq_len = .025; // .05;
-    pose_xyt_t goal_pose;
-    while (!foundPose) {
-        std::cout << "Looking for free spot to find path to!\n";
-        // find the white point        //check top and bottom
-        float top_height = closest_point.y + square_radius;
-        float bot_height = closest_point.y - square_radius;
-        for (float i = -square_radius; i <= square_radius; i+=sq_len ) {
-            bool valid_point_top = check_valid(planner, closest_point.x + i, top_height, robotPose); // absolute x, absolute y
-            bool valid_point_bot = check_valid(planner, closest_point.x + i, bot_height, robotPose);
-            /*
-            Point<double> check_top;
-            check_top.x = closest_point.x + i;
-            check_top.y = top_height;
-            printf("Check top X: %d, Y: %d\n", global_position_to_grid_cell(check_top, map).x, global_position_to_grid_cell(check_top, map).y);
-            Point<double> check_bot;
-            check_bot.x = closest_point.x + i;
-            check_bot.y = bot_height;
-            printf("Check bot X: %d, Y: %d\n", global_position_to_grid_cell(check_bot, map).x, global_position_to_grid_cell(check_bot, map).y);
-            */
-            if (valid_point_top) {
-                foundPose = true;
-                goal_pose.x = closest_point.x + i;
-                goal_pose.y = top_height;
-            } else if (valid_point_bot) {
-                foundPose = true;
-                goal_pose.x = closest_point.x + i;
-                goal_pose.y = bot_height;
-            }
-        }        // check left and right
-        float left_bound = closest_point.y + square_radius;
-        float right_bound = closest_point.y - square_radius;
-        for (float i = -square_radius; i <= square_radius; i+=sq_len ) {
-            bool valid_point_right = check_valid(planner, right_bound, closest_point.y + i, robotPose);
-            bool valid_point_left  = check_valid(planner, left_bound, closest_point.y + i, robotPose);
-            /*
-            Point<double> check_left;
-            check_left.x = left_bound;
-            check_left.y = closest_point.y + i;
-            printf("Check left X: %d, Y: %d\n", global_position_to_grid_cell(check_left, map).x, global_position_to_grid_cell(check_left, map).y);
-            Point<double> check_right;
-            check_right.x = right_bound;
-            check_right.y = closest_point.y + i;
-            printf("Check right X: %d, Y: %d\n", global_position_to_grid_cell(check_right, map).x, global_position_to_grid_cell(check_right, map).y);
-            */
-            if (valid_point_right) {
-                foundPose = true;
-                goal_pose.x = right_bound;
-                goal_pose.y = closest_point.y + i;
-            } else if (valid_point_left) {
-                foundPose = true;
-                goal_pose.x = left_bound;
-                goal_pose.y = closest_point.y + i;
+    if(bestCost == std::numeric_limits<float>::infinity())
+    {
+        std::cout << "INFO: plan_path_to_frontier: No reachable goal near any frontier.\n";
+        return failedPath;
+    }
+
+    bestGoal.utime = robotPose.utime;
+    bestGoal.theta = robotPose.theta;
+
+    // The cost field only holds 4-connected paths, which the robot must stop to turn along. A lattice path can be
+    // driven without stopping, so use it if the lattice finds one within the planner's time budget.
+    if(planner.params().searchMode == state_lattice)
+    {
+        robot_path_t latticePath = planner.planPath(robotPose, bestGoal);
+        if(latticePath.path_length > 1)
+        {
+            return latticePath;
+        }
+    }
+
+    return planner.pathFromCostField(bestGoal);
+}
+
+
+bool nearest_reachable_goal(Point<int> targetCell,
+                            Point<int> robotCell,
+                            const OccupancyGrid& map,
+                            const MotionPlanner& planner,
+                            pose_xyt_t& goal,
+                            float& goalCost)
+{
+    // Search outward from the target in square rings. The first ring with a reachable cell holds the nearest ones, and
+    // the cheapest of them is the goal.
+    const int kMaxRadius = static_cast<int>(kMaxGoalDistanceFromFrontier * map.cellsPerMeter());
+
+    goalCost = std::numeric_limits<float>::infinity();
+
+    for(int radius = 1; radius <= kMaxRadius; ++radius)
+    {
+        for(int y = targetCell.y - radius; y <= targetCell.y + radius; ++y)
+        {
+            // Only the cells on the edge of the square are in the ring
+            int xStep = ((y == targetCell.y - radius) || (y == targetCell.y + radius)) ? 1 : 2*radius;
+            for(int x = targetCell.x - radius; x <= targetCell.x + radius; x += xStep)
+            {
+                // Paths to goals next to the robot are too short to be worth driving
+                if(!map.isCellInGrid(x, y) || (std::abs(x - robotCell.x) + std::abs(y - robotCell.y) < 2))
+                {
+                    continue;
+                }
+
+                Point<double> position = grid_position_to_global_position(Point<double>(x, y), map);
+                pose_xyt_t candidate;
+                candidate.utime = 0;
+                candidate.x = position.x;
+                candidate.y = position.y;
+                candidate.theta = 0.0f;
+
+                if(!planner.isValidGoal(candidate))
+                {
+                    continue;
+                }
+
+                float cost = planner.costToReach(candidate);
+                if(cost < goalCost)
+                {
+                    goalCost = cost;
+                    goal = candidate;
+                }
             }
-        }        
-        if (square_radius < 0.5)    
-            square_radius += sq_len;
-        else 
-            square_radius = 0.05;
-    }    /*
-    pose_xyt_t goal_pose;
-    goal_pose.x = closest_point.x;
-    goal_pose.y = closest_point.y;
-    */
+        }
 
+        if(goalCost < std::numeric_limits<float>::infinity())
+        {
+            return true;
+        }
+    }
 
-   // Plan a path to that point that is closest to the frontier and you can get to
-    goal_pose.theta = robotPose.theta;    // step 2: call motion planner to get a path to that frontier with astar
-    return planner.planPath(robotPose, goal_pose);
+    return false;
 }
 
 
@@ -39,11 +39,30 @@ std::vector<frontier_t> find_map_frontiers(const OccupancyGrid& map,
                                            double minFrontierLength = 0.35);
 
 
+/**
+* is_frontier_cell checks if a cell is a frontier cell, as defined by find_map_frontiers.
+*
+* \param    x                       x-coordinate of the cell
+* \param    y                       y-coordinate of the cell
+* \param    map                     Map containing the cell
+* \return   True if the cell is in the map and is a frontier cell.
+*/
+bool is_frontier_cell(int x, int y, const OccupancyGrid& map);
+
+
 /**
 * plan_path_to_frontier selects amongst the available frontiers and plans a path to one of them. The path to the
 * frontier is returned. If no frontiers exist or there are no valid paths to any of the frontiers, then a path of length
 * 1, with the only pose being the robot pose should be returned indicating an error.
 * 
+* The goal for each frontier is the valid goal nearest to the middle of the frontier that the robot can reach, and the
+* frontier whose goal is cheapest to reach is selected. Every candidate is checked against a single cost field expanded
+* from the robot pose with MotionPlanner::expandCostField, so selecting a frontier costs one search.
+*
+* The path is read out of the same cost field and refined as MotionPlanner::planPath's are, unless the planner uses the
+* state_lattice search mode. Then the path to the selected goal is planned with MotionPlanner::planPath, so the robot
+* can drive it without stopping to turn, and the cost field's path is only used if the lattice doesn't find one.
+* 
 * \param    frontiers           Frontiers in the environment
 * \param    robotPose           Pose of the robot from which to plan
 * \param    map                 Map being explored
@@ -55,6 +74,4 @@ robot_path_t plan_path_to_frontier(const std::vector<frontier_t>& frontiers,
                                    const OccupancyGrid& map,
                                    const MotionPlanner& planner);
 
-bool check_valid(const MotionPlanner& planner, float x, float y, pose_xyt_t curr_pose);
-
 #endif // PLANNING_FRONTIERS_HPP
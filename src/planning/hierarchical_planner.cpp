@@ -0,0 +1,606 @@
+#include <planning/hierarchical_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+
+namespace
+{
+
+// Runs of crossable border cells at least this long get an entrance at each end instead of one in the middle, so
+// paths through wide openings don't have to detour through the center
+const int kMinDoubleEntranceWidth = 6;
+
+const int xDeltas[4] = { 1, -1, 0, 0 };
+const int yDeltas[4] = { 0, 0, 1, -1 };
+
+}
+
+
+HierarchicalPlanner::HierarchicalPlanner(int clusterSize)
+: clusterSize_(std::max(clusterSize, 2))
+, distances_(nullptr)
+, width_(0)
+, height_(0)
+, metersPerCell_(0.0f)
+, clustersWide_(0)
+, clustersHigh_(0)
+, numClustersRebuilt_(0)
+, numExpanded_(0)
+{
+}
+
+
+robot_path_t HierarchicalPlanner::plan(const pose_xyt_t& start,
+                                       const pose_xyt_t& goal,
+                                       const ObstacleDistanceGrid& distances,
+                                       const SearchParams& params)
+{
+    robot_path_t path;
+    path.utime = start.utime;
+    path.path.push_back(start);
+    path.path_length = path.path.size();
+
+    if(!isSameGrid(distances, params))
+    {
+        reset(distances, params);
+    }
+    distances_ = &distances;
+
+    numClustersRebuilt_ = 0;
+    numExpanded_ = 0;
+    rebuildStaleClusters();
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    if(!isTraversable(startCell.x, startCell.y) || !isTraversable(goalCell.x, goalCell.y) || (startCell == goalCell))
+    {
+        return path;
+    }
+
+    const int startIndex = startCell.y*width_ + startCell.x;
+    const int goalIndex = goalCell.y*width_ + goalCell.x;
+
+    std::vector<cell_t> cells;
+    if(searchAbstractGraph(startIndex, goalIndex) && refinePath(startIndex, goalIndex, cells))
+    {
+        return cells_to_path(start, cells, distances);
+    }
+
+    return path;
+}
+
+
+void HierarchicalPlanner::updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances)
+{
+    // A grid of a different size is rebuilt from scratch by the next plan anyway
+    if(clusters_.empty() || (distances.widthInCells() != width_) || (distances.heightInCells() != height_))
+    {
+        return;
+    }
+
+    distances_ = &distances;
+
+    for(int index : changedCells)
+    {
+        clusters_[clusterOf(index)].hasChanged = true;
+    }
+}
+
+
+void HierarchicalPlanner::clear(void)
+{
+    clusters_.clear();
+    distances_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+}
+
+
+std::size_t HierarchicalPlanner::numNodes(void) const
+{
+    std::size_t count = 0;
+    for(auto& cluster : clusters_)
+    {
+        count += cluster.nodes.size();
+    }
+    return count;
+}
+
+
+bool HierarchicalPlanner::isSameGrid(const ObstacleDistanceGrid& distances, const SearchParams& params) const
+{
+    return !clusters_.empty()
+        && (distances.widthInCells() == width_)
+        && (distances.heightInCells() == height_)
+        && (distances.metersPerCell() == metersPerCell_)
+        && (params.minDistanceToObstacle == params_.minDistanceToObstacle)
+        && (params.maxDistanceWithCost == params_.maxDistanceWithCost)
+        && (params.distanceCostExponent == params_.distanceCostExponent);
+}
+
+
+void HierarchicalPlanner::reset(const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    params_ = params;
+    width_ = distances.widthInCells();
+    height_ = distances.heightInCells();
+    metersPerCell_ = distances.metersPerCell();
+    clustersWide_ = (width_ + clusterSize_ - 1) / clusterSize_;
+    clustersHigh_ = (height_ + clusterSize_ - 1) / clusterSize_;
+
+    clusters_.clear();
+    clusters_.resize(clustersWide_ * clustersHigh_);
+    for(int y = 0; y < clustersHigh_; ++y)
+    {
+        for(int x = 0; x < clustersWide_; ++x)
+        {
+            Cluster& cluster = clusters_[y*clustersWide_ + x];
+            cluster.minX = x * clusterSize_;
+            cluster.minY = y * clusterSize_;
+            cluster.maxX = std::min(cluster.minX + clusterSize_, width_);
+            cluster.maxY = std::min(cluster.minY + clusterSize_, height_);
+            cluster.hasChanged = true;
+            cluster.needsRebuild = false;
+        }
+    }
+
+    corridor_.assign(clusters_.size(), 0);
+}
+
+
+void HierarchicalPlanner::rebuildStaleClusters(void)
+{
+    // A changed cluster needs new entrances on all of its borders, so each neighbor needs its nodes and costs found
+    // again too. Borders between two unchanged clusters find the same entrances as before, so only the side of the
+    // border being rebuilt gets its nodes added back.
+    std::vector<int> rebuilt;
+    for(int y = 0; y < clustersHigh_; ++y)
+    {
+        for(int x = 0; x < clustersWide_; ++x)
+        {
+            if(!clusters_[y*clustersWide_ + x].hasChanged)
+            {
+                continue;
+            }
+
+            for(int dy = -1; dy <= 1; ++dy)
+            {
+                for(int dx = -1; dx <= 1; ++dx)
+                {
+                    int neighborX = x + dx;
+                    int neighborY = y + dy;
+                    if((std::abs(dx) + std::abs(dy) > 1) || (neighborX < 0) || (neighborX >= clustersWide_)
+                        || (neighborY < 0) || (neighborY >= clustersHigh_))
+                    {
+                        continue;
+                    }
+
+                    int neighbor = neighborY*clustersWide_ + neighborX;
+                    if(!clusters_[neighbor].needsRebuild)
+                    {
+                        clusters_[neighbor].needsRebuild = true;
+                        rebuilt.push_back(neighbor);
+                    }
+                }
+            }
+        }
+    }
+
+    if(rebuilt.empty())
+    {
+        return;
+    }
+
+    for(int index : rebuilt)
+    {
+        clusters_[index].nodes.clear();
+        clusters_[index].exits.clear();
+    }
+
+    // Each border is searched once, from the cluster below or to the left of it
+    for(int index : rebuilt)
+    {
+        int x = index % clustersWide_;
+        int y = index / clustersWide_;
+
+        if((x > 0) && !clusters_[index - 1].needsRebuild)
+        {
+            findEntrances(index - 1, index);
+        }
+        if(x + 1 < clustersWide_)
+        {
+            findEntrances(index, index + 1);
+        }
+        if((y > 0) && !clusters_[index - clustersWide_].needsRebuild)
+        {
+            findEntrances(index - clustersWide_, index);
+        }
+        if(y + 1 < clustersHigh_)
+        {
+            findEntrances(index, index + clustersWide_);
+        }
+    }
+
+    for(int index : rebuilt)
+    {
+        findClusterCosts(clusters_[index]);
+        clusters_[index].hasChanged = false;
+        clusters_[index].needsRebuild = false;
+    }
+
+    numClustersRebuilt_ = rebuilt.size();
+}
+
+
+int HierarchicalPlanner::clusterOf(int cellIndex) const
+{
+    int x = cellIndex % width_;
+    int y = cellIndex / width_;
+    return (y / clusterSize_) * clustersWide_ + (x / clusterSize_);
+}
+
+
+int HierarchicalPlanner::nodeIndex(const Cluster& cluster, int cellIndex) const
+{
+    // Clusters only have a handful of nodes, so a linear search is fastest
+    for(std::size_t n = 0; n < cluster.nodes.size(); ++n)
+    {
+        if(cluster.nodes[n] == cellIndex)
+        {
+            return n;
+        }
+    }
+    return -1;
+}
+
+
+bool HierarchicalPlanner::isTraversable(int x, int y) const
+{
+    return is_traversable(x, y, *distances_, params_);
+}
+
+
+float HierarchicalPlanner::enterCost(int x, int y) const
+{
+    // Same step cost as search_for_path: one cell plus the cost of being near an obstacle
+    return metersPerCell_ + obstacle_cost((*distances_)(x, y), params_);
+}
+
+
+void HierarchicalPlanner::findEntrances(int firstCluster, int secondCluster)
+{
+    const Cluster& first = clusters_[firstCluster];
+    const Cluster& second = clusters_[secondCluster];
+
+    // The second cluster is either to the right of the first or above it
+    const bool isVerticalBorder = (second.minX == first.maxX);
+    const int borderLength = isVerticalBorder ? (first.maxY - first.minY) : (first.maxX - first.minX);
+
+    auto firstCellAt = [&](int n) {
+        return isVerticalBorder ? (first.minY + n)*width_ + first.maxX - 1 : (first.maxY - 1)*width_ + first.minX + n;
+    };
+    auto secondCellAt = [&](int n) {
+        return isVerticalBorder ? (first.minY + n)*width_ + first.maxX : first.maxY*width_ + first.minX + n;
+    };
+    auto isCrossable = [&](int n) {
+        int firstCell = firstCellAt(n);
+        int secondCell = secondCellAt(n);
+        return isTraversable(firstCell % width_, firstCell / width_)
+            && isTraversable(secondCell % width_, secondCell / width_);
+    };
+
+    int n = 0;
+    while(n < borderLength)
+    {
+        if(!isCrossable(n))
+        {
+            ++n;
+            continue;
+        }
+
+        int runStart = n;
+        while((n < borderLength) && isCrossable(n))
+        {
+            ++n;
+        }
+        int runEnd = n - 1;
+
+        if(runEnd - runStart + 1 < kMinDoubleEntranceWidth)
+        {
+            int middle = (runStart + runEnd) / 2;
+            addEntrance(firstCellAt(middle), secondCellAt(middle));
+        }
+        else
+        {
+            addEntrance(firstCellAt(runStart), secondCellAt(runStart));
+            addEntrance(firstCellAt(runEnd), secondCellAt(runEnd));
+        }
+    }
+}
+
+
+void HierarchicalPlanner::addEntrance(int firstCell, int secondCell)
+{
+    auto addExit = [this](int cell, int exit) {
+        Cluster& cluster = clusters_[clusterOf(cell)];
+        if(!cluster.needsRebuild)
+        {
+            return;
+        }
+
+        int node = nodeIndex(cluster, cell);
+        if(node < 0)
+        {
+            node = cluster.nodes.size();
+            cluster.nodes.push_back(cell);
+            cluster.exits.push_back(std::vector<int>());
+        }
+        cluster.exits[node].push_back(exit);
+    };
+
+    addExit(firstCell, secondCell);
+    addExit(secondCell, firstCell);
+}
+
+
+void HierarchicalPlanner::findClusterCosts(Cluster& cluster)
+{
+    const std::size_t numNodes = cluster.nodes.size();
+    cluster.costs.assign(numNodes * numNodes, AStarWorkspace::kInfiniteCost);
+
+    for(std::size_t i = 0; i < numNodes; ++i)
+    {
+        searchCluster(cluster, cluster.nodes[i], false);
+        for(std::size_t j = 0; j < numNodes; ++j)
+        {
+            cluster.costs[i*numNodes + j] = localCost(cluster, cluster.nodes[j]);
+        }
+    }
+}
+
+
+void HierarchicalPlanner::searchCluster(const Cluster& cluster, int sourceCell, bool isReverse)
+{
+    // Dijkstra's algorithm over the cells of the cluster. The forward search finds the cost from the source to each
+    // cell. The reverse search finds the cost from each cell to the source, so a step costs entering the cell it
+    // steps from rather than the cell it steps to.
+    const int clusterWidth = cluster.maxX - cluster.minX;
+    const int clusterHeight = cluster.maxY - cluster.minY;
+    const int numCells = clusterWidth * clusterHeight;
+
+    localCosts_.assign(numCells, AStarWorkspace::kInfiniteCost);
+    localOpenList_.reset(numCells);
+
+    int source = (sourceCell / width_ - cluster.minY)*clusterWidth + (sourceCell % width_ - cluster.minX);
+    localCosts_[source] = 0.0f;
+    localOpenList_.push(source, 0.0f);
+
+    while(!localOpenList_.empty())
+    {
+        int local = localOpenList_.pop();
+        int x = local % clusterWidth + cluster.minX;
+        int y = local / clusterWidth + cluster.minY;
+        float cost = localCosts_[local];
+        float reverseStepCost = isReverse ? enterCost(x, y) : 0.0f;
+        ++numExpanded_;
+
+        for(int n = 0; n < 4; ++n)
+        {
+            int adjacentX = x + xDeltas[n];
+            int adjacentY = y + yDeltas[n];
+
+            if((adjacentX < cluster.minX) || (adjacentX >= cluster.maxX) || (adjacentY < cluster.minY)
+                || (adjacentY >= cluster.maxY) || !isTraversable(adjacentX, adjacentY))
+            {
+                continue;
+            }
+
+            int adjacent = (adjacentY - cluster.minY)*clusterWidth + (adjacentX - cluster.minX);
+            float newCost = cost + (isReverse ? reverseStepCost : enterCost(adjacentX, adjacentY));
+            if(newCost < localCosts_[adjacent])
+            {
+                localCosts_[adjacent] = newCost;
+                localOpenList_.pushOrDecrease(adjacent, newCost);
+            }
+        }
+    }
+}
+
+
+float HierarchicalPlanner::localCost(const Cluster& cluster, int cellIndex) const
+{
+    const int clusterWidth = cluster.maxX - cluster.minX;
+    return localCosts_[(cellIndex / width_ - cluster.minY)*clusterWidth + (cellIndex % width_ - cluster.minX)];
+}
+
+
+bool HierarchicalPlanner::searchAbstractGraph(int startCell, int goalCell)
+{
+    const int startCluster = clusterOf(startCell);
+    const int goalCluster = clusterOf(goalCell);
+    const Cluster& start = clusters_[startCluster];
+    const Cluster& goal = clusters_[goalCluster];
+
+    // Connect the start and goal to the nodes of their clusters
+    searchCluster(start, startCell, false);
+    startCosts_.resize(start.nodes.size());
+    for(std::size_t n = 0; n < start.nodes.size(); ++n)
+    {
+        startCosts_[n] = localCost(start, start.nodes[n]);
+    }
+    float directCost = (startCluster == goalCluster) ? localCost(start, goalCell) : AStarWorkspace::kInfiniteCost;
+
+    searchCluster(goal, goalCell, true);
+    goalCosts_.resize(goal.nodes.size());
+    for(std::size_t n = 0; n < goal.nodes.size(); ++n)
+    {
+        goalCosts_[n] = localCost(goal, goal.nodes[n]);
+    }
+
+    // A* over the nodes, indexed by their cells. Every abstract edge costs at least the Manhattan distance between its
+    // cells, so the Manhattan heuristic stays admissible.
+    const int goalX = goalCell % width_;
+    const int goalY = goalCell / width_;
+    auto heuristic = [&](int cell) {
+        return (std::abs(goalX - cell % width_) + std::abs(goalY - cell / width_)) * metersPerCell_;
+    };
+
+    workspace_.beginSearch(width_, height_);
+    IndexedHeap<float>& openList = workspace_.openList();
+
+    auto relax = [&](int from, int to, float edgeCost) {
+        if((edgeCost == AStarWorkspace::kInfiniteCost) || workspace_.isClosed(to))
+        {
+            return;
+        }
+
+        float gNew = workspace_.gCost(from) + edgeCost;
+        if(gNew < workspace_.gCost(to))
+        {
+            workspace_.setCost(to, gNew, from);
+            openList.pushOrDecrease(to, gNew + heuristic(to));
+        }
+    };
+
+    workspace_.setCost(startCell, 0.0f, AStarWorkspace::kNoParent);
+    openList.push(startCell, heuristic(startCell));
+
+    bool foundPath = false;
+    while(!openList.empty())
+    {
+        int cell = openList.pop();
+        if(cell == goalCell)
+        {
+            foundPath = true;
+            break;
+        }
+
+        workspace_.close(cell);
+        ++numExpanded_;
+
+        const int clusterIndex = clusterOf(cell);
+        const Cluster& cluster = clusters_[clusterIndex];
+        const int node = nodeIndex(cluster, cell);
+        const std::size_t numNodes = cluster.nodes.size();
+
+        if(cell == startCell)
+        {
+            for(std::size_t n = 0; n < numNodes; ++n)
+            {
+                relax(cell, cluster.nodes[n], startCosts_[n]);
+            }
+            relax(cell, goalCell, directCost);
+        }
+        else
+        {
+            for(std::size_t n = 0; n < numNodes; ++n)
+            {
+                relax(cell, cluster.nodes[n], cluster.costs[node*numNodes + n]);
+            }
+
+            if(clusterIndex == goalCluster)
+            {
+                relax(cell, goalCell, goalCosts_[node]);
+            }
+        }
+
+        // The start may also be a node, in which case it can cross the border directly
+        if(node >= 0)
+        {
+            for(int exit : cluster.exits[node])
+            {
+                relax(cell, exit, enterCost(exit % width_, exit / width_));
+            }
+        }
+    }
+
+    if(!foundPath)
+    {
+        return false;
+    }
+
+    // The refinement can search every cluster the abstract path passes through
+    std::fill(corridor_.begin(), corridor_.end(), 0);
+    for(int cell = goalCell; cell != AStarWorkspace::kNoParent; cell = workspace_.parent(cell))
+    {
+        corridor_[clusterOf(cell)] = 1;
+    }
+
+    return true;
+}
+
+
+bool HierarchicalPlanner::refinePath(int startCell, int goalCell, std::vector<cell_t>& cells)
+{
+    // grid_astar_search limited to the cells of the corridor
+    const int goalX = goalCell % width_;
+    const int goalY = goalCell / width_;
+
+    workspace_.beginSearch(width_, height_);
+    IndexedHeap<float>& openList = workspace_.openList();
+
+    workspace_.setCost(startCell, 0.0f, AStarWorkspace::kNoParent);
+    openList.push(startCell, (std::abs(goalX - startCell % width_) + std::abs(goalY - startCell / width_))
+        * metersPerCell_);
+
+    bool foundPath = false;
+    while(!openList.empty())
+    {
+        int index = openList.pop();
+        if(index == goalCell)
+        {
+            foundPath = true;
+            break;
+        }
+
+        workspace_.close(index);
+        ++numExpanded_;
+
+        int x = index % width_;
+        int y = index / width_;
+        float gCost = workspace_.gCost(index);
+
+        for(int n = 0; n < 4; ++n)
+        {
+            int adjacentX = x + xDeltas[n];
+            int adjacentY = y + yDeltas[n];
+
+            if(!isTraversable(adjacentX, adjacentY))
+            {
+                continue;
+            }
+
+            int adjacent = adjacentY*width_ + adjacentX;
+            if(!corridor_[clusterOf(adjacent)] || workspace_.isClosed(adjacent))
+            {
+                continue;
+            }
+
+            float gNew = gCost + enterCost(adjacentX, adjacentY);
+            if(gNew < workspace_.gCost(adjacent))
+            {
+                workspace_.setCost(adjacent, gNew, index);
+                float fNew = gNew + (std::abs(goalX - adjacentX) + std::abs(goalY - adjacentY)) * metersPerCell_;
+                openList.pushOrDecrease(adjacent, fNew);
+            }
+        }
+    }
+
+    if(!foundPath)
+    {
+        return false;
+    }
+
+    cells.clear();
+    for(int index = goalCell; index != startCell; index = workspace_.parent(index))
+    {
+        cells.push_back(cell_t(index % width_, index / width_));
+    }
+    std::reverse(cells.begin(), cells.end());
+    return true;
+}
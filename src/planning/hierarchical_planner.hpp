@@ -0,0 +1,158 @@
+#ifndef PLANNING_HIERARCHICAL_PLANNER_HPP
+#define PLANNING_HIERARCHICAL_PLANNER_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/indexed_heap.hpp>
+#include <cstdint>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* HierarchicalPlanner finds paths with hierarchical path-finding A* (HPA*, Botea, Mueller, and Schaeffer, 2004).
+*
+* The grid is split into square clusters. Wherever the robot can cross the border between two clusters, an entrance is
+* placed: one node on each side of the border. Within each cluster, the cost of the cheapest path between every pair of
+* its nodes is found ahead of time. A query then:
+*
+*   1. connects the start and goal to the nodes of their clusters with a search of just those clusters,
+*   2. searches the abstract graph of nodes, whose size depends on the number of clusters rather than cells,
+*   3. refines the abstract path with an A* search limited to the corridor of clusters it passes through.
+*
+* A long path therefore only expands the cells near the route instead of every cell closer to the start than the goal.
+* The path found is the cheapest path within the corridor, which is at most slightly more expensive than the cheapest
+* path in the whole grid. A path is found whenever one exists.
+*
+* Paths are found over the same 4-connected cells with the same distance costs as the grid_astar mode of
+* search_for_path.
+*
+* When the obstacle distances change, pass the changed cells to updateCells. The clusters containing them are marked
+* as stale and rebuilt, along with their neighbors' entrances, by the next call to plan. Clusters away from the changes
+* keep their entrances and costs.
+*
+* Every call must be given the same grid, apart from the changes passed to updateCells. A grid of a different size or
+* different search parameters rebuilds every cluster.
+*/
+class HierarchicalPlanner
+{
+public:
+
+    /**
+    * Constructor for HierarchicalPlanner.
+    *
+    * \param    clusterSize         Width of the square clusters (cells) (optional, default = 16 cells)
+    */
+    explicit HierarchicalPlanner(int clusterSize = 16);
+
+    /**
+    * plan finds a path from start to goal.
+    *
+    * \param    start           Starting pose of the robot
+    * \param    goal            Desired goal pose of the robot
+    * \param    distances       Distance to the nearest obstacle for each cell in the grid
+    * \param    params          Parameters specifying the costs of the search. params.mode is ignored.
+    * \return   The path found to the goal, if one exists. If the goal is unreachable, then a path with just the initial
+    *   pose is returned, per the robot_path_t specification.
+    */
+    robot_path_t plan(const pose_xyt_t& start,
+                      const pose_xyt_t& goal,
+                      const ObstacleDistanceGrid& distances,
+                      const SearchParams& params);
+
+    /**
+    * updateCells marks the clusters containing cells whose obstacle distances changed, so they are rebuilt before
+    * the next plan.
+    *
+    * \param    changedCells        Row-major indices, y*width + x, of the cells whose distances changed
+    * \param    distances           Updated distances
+    */
+    void updateCells(const std::vector<int>& changedCells, const ObstacleDistanceGrid& distances);
+
+    /**
+    * clear discards every cluster, so the next plan rebuilds them all.
+    */
+    void clear(void);
+
+    int clusterSize(void) const { return clusterSize_; }
+
+    /**
+    * numNodes retrieves the number of entrance nodes in the abstract graph.
+    */
+    std::size_t numNodes(void) const;
+
+    /**
+    * numClustersRebuilt retrieves the number of clusters whose nodes and costs were rebuilt by the last call to plan.
+    */
+    std::size_t numClustersRebuilt(void) const { return numClustersRebuilt_; }
+
+    /**
+    * numExpanded retrieves the number of cells and nodes expanded by the searches of the last call to plan, not
+    * counting the rebuilding of clusters.
+    */
+    std::size_t numExpanded(void) const { return numExpanded_; }
+
+private:
+
+    /**
+    * Cluster holds the entrance nodes of one cluster and the costs of traveling between them.
+    */
+    struct Cluster
+    {
+        int minX;
+        int minY;
+        int maxX;                           // exclusive
+        int maxY;                           // exclusive
+
+        std::vector<int> nodes;             // cells of the entrance nodes in the cluster
+        std::vector<std::vector<int>> exits; // cells across the border reached from each node
+        std::vector<float> costs;           // costs[i*nodes.size() + j] is the cost of the path from node i to node j
+
+        bool hasChanged;                    // some of the cluster's cells changed since it was built
+        bool needsRebuild;                  // nodes and costs need to be found again
+    };
+
+    int clusterSize_;
+    const ObstacleDistanceGrid* distances_;
+    SearchParams params_;
+    int width_;
+    int height_;
+    float metersPerCell_;
+    int clustersWide_;
+    int clustersHigh_;
+
+    std::vector<Cluster> clusters_;
+
+    // Search state
+    AStarWorkspace workspace_;                  // abstract search and refinement, indexed by cell
+    std::vector<float> localCosts_;             // costs of a search within one cluster, indexed by local cell
+    IndexedHeap<float> localOpenList_;
+    std::vector<float> startCosts_;             // cost from the start to each node of its cluster
+    std::vector<float> goalCosts_;              // cost from each node of the goal's cluster to the goal
+    std::vector<uint8_t> corridor_;             // flag for each cluster the refinement can search
+
+    std::size_t numClustersRebuilt_;
+    std::size_t numExpanded_;
+
+    bool isSameGrid(const ObstacleDistanceGrid& distances, const SearchParams& params) const;
+    void reset(const ObstacleDistanceGrid& distances, const SearchParams& params);
+    void rebuildStaleClusters(void);
+
+    int clusterOf(int cellIndex) const;
+    int nodeIndex(const Cluster& cluster, int cellIndex) const;
+    bool isTraversable(int x, int y) const;
+    float enterCost(int x, int y) const;
+
+    void findEntrances(int firstCluster, int secondCluster);
+    void addEntrance(int firstCell, int secondCell);
+    void findClusterCosts(Cluster& cluster);
+    void searchCluster(const Cluster& cluster, int sourceCell, bool isReverse);
+    float localCost(const Cluster& cluster, int cellIndex) const;
+
+    bool searchAbstractGraph(int startCell, int goalCell);
+    bool refinePath(int startCell, int goalCell, std::vector<cell_t>& cells);
+};
+
+#endif // PLANNING_HIERARCHICAL_PLANNER_HPP
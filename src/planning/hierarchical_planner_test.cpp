@@ -0,0 +1,342 @@
+#include <planning/hierarchical_planner.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The hierarchical planner test checks HierarchicalPlanner against search_for_path:
+*
+*   - on the data/astar maps, it finds a path exactly when A* does, and the path costs at most a little more,
+*   - after map changes passed to updateCells, it still agrees with A*, while only rebuilding the clusters around the
+*     changes,
+*   - on large maps tiled from the wide map, long-range queries take nearly the same time no matter the map size.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+// Paths may cost this much more than the cheapest path, since they are limited to the corridor of the abstract path
+const double kMaxCostRatio = 1.1;
+
+
+bool test_matches_astar(void);
+bool test_map_changes(void);
+bool test_long_range_timing(void);
+
+bool check_query(const PlanQuery& query,
+                 const ObstacleDistanceGrid& distances,
+                 HierarchicalPlanner& planner,
+                 const std::string& name,
+                 double& maxCostRatio);
+pose_xyt_t free_pose_near(int x, int y, const ObstacleDistanceGrid& distances, const SearchParams& params);
+
+
+int main(int argc, char** argv)
+{
+    if(test_matches_astar())
+    {
+        std::cout << "PASSED: test_matches_astar\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_matches_astar\n";
+    }
+
+    if(test_map_changes())
+    {
+        std::cout << "PASSED: test_map_changes\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_map_changes\n";
+    }
+
+    if(test_long_range_timing())
+    {
+        std::cout << "PASSED: test_long_range_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_long_range_timing\n";
+    }
+
+    return 0;
+}
+
+
+bool test_matches_astar(void)
+{
+    const std::vector<std::string> maps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+    bool allCorrect = true;
+
+    for(auto& name : maps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        double maxCostRatio = 1.0;
+        for(int clusterSize : { 8, 16, 32 })
+        {
+            HierarchicalPlanner planner(clusterSize);
+            for(auto& query : queries)
+            {
+                allCorrect &= check_query(query, distances, planner, name, maxCostRatio);
+            }
+        }
+
+        std::cout << "Max cost ratio on " << name << " map: " << maxCostRatio << '\n';
+    }
+
+    return allCorrect;
+}
+
+
+bool test_map_changes(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("maze", grid, queries))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    HierarchicalPlanner planner;
+    planner.plan(queries.front().start, queries.front().goal, distances, params);
+
+    const std::size_t numClusters = ((grid.widthInCells() + planner.clusterSize() - 1) / planner.clusterSize())
+        * ((grid.heightInCells() + planner.clusterSize() - 1) / planner.clusterSize());
+    if(planner.numClustersRebuilt() != numClusters)
+    {
+        std::cout << "First plan rebuilt " << planner.numClustersRebuilt() << " of " << numClusters << " clusters\n";
+        return false;
+    }
+
+    bool allCorrect = true;
+    double maxCostRatio = 1.0;
+    std::size_t maxRebuilt = 0;
+
+    // Block the middle of each query's path in turn, so the next queries have to go around all the earlier blocks
+    for(auto& query : queries)
+    {
+        robot_path_t path = search_for_path(query.start, query.goal, distances, params);
+        if(path.path_length < 3)
+        {
+            continue;
+        }
+
+        const pose_xyt_t& middle = path.path[path.path_length / 2];
+        cell_t middleCell = global_position_to_grid_cell(Point<double>(middle.x, middle.y), grid);
+        grid.setLogOdds(middleCell.x, middleCell.y, 127);
+
+        std::vector<int> changedCells;
+        if(!distances.updateDistances(grid, &changedCells))
+        {
+            std::cout << "Distances weren't updated incrementally\n";
+            return false;
+        }
+        planner.updateCells(changedCells, distances);
+
+        allCorrect &= check_query(query, distances, planner, "changed maze", maxCostRatio);
+        maxRebuilt = std::max(maxRebuilt, planner.numClustersRebuilt());
+
+        // A single blocked cell only changes distances nearby, so at most the clusters around it are rebuilt
+        if(planner.numClustersRebuilt() > 16)
+        {
+            std::cout << "Blocking one cell rebuilt " << planner.numClustersRebuilt() << " clusters\n";
+            allCorrect = false;
+        }
+    }
+
+    std::cout << "Max cost ratio after changes: " << maxCostRatio << ", max clusters rebuilt: " << maxRebuilt << " of "
+        << numClusters << '\n';
+    return allCorrect;
+}
+
+
+bool test_long_range_timing(void)
+{
+    OccupancyGrid tile;
+    if(!tile.loadFromFile("../data/astar/wide.map"))
+    {
+        std::cerr << "ERROR: Run hierarchical_planner_test from the bin/ directory.\n";
+        return false;
+    }
+
+    const SearchParams params = search_params();
+    const int kNumQueries = 10;
+
+    for(int numTiles : { 2, 4, 7 })
+    {
+        // Tile the wide map to make a large map. Its gaps line up between tiles, so the whole map is connected.
+        OccupancyGrid grid(tile.widthInMeters() * numTiles, tile.heightInMeters() * numTiles, tile.metersPerCell());
+        for(int y = 0; y < grid.heightInCells(); ++y)
+        {
+            for(int x = 0; x < grid.widthInCells(); ++x)
+            {
+                grid(x, y) = tile(x % tile.widthInCells(), y % tile.heightInCells());
+            }
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        // Queries cross the map from one corner region to the opposite one
+        const int width = distances.widthInCells();
+        const int height = distances.heightInCells();
+        std::vector<PlanQuery> queries;
+        for(int n = 0; n < kNumQueries; ++n)
+        {
+            PlanQuery query;
+            query.start = free_pose_near(width / 20 + n, height / 20 + 2*n, distances, params);
+            query.goal = free_pose_near(width - width / 20 - 2*n, height - height / 20 - n, distances, params);
+            queries.push_back(query);
+        }
+
+        HierarchicalPlanner planner;
+        AStarWorkspace workspace;
+
+        // Build the clusters and allocate the A* workspace before timing the queries
+        auto buildStartTime = std::chrono::steady_clock::now();
+        planner.plan(queries.front().start, queries.front().start, distances, params);
+        auto buildTime = std::chrono::steady_clock::now() - buildStartTime;
+        search_for_path(queries.front().start, queries.front().start, distances, params, workspace);
+
+        double astarUs = 0.0;
+        double hierarchicalUs = 0.0;
+        std::size_t astarExpanded = 0;
+        std::size_t hierarchicalExpanded = 0;
+
+        for(auto& query : queries)
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            robot_path_t astarPath = search_for_path(query.start, query.goal, distances, params, workspace);
+            auto astarTime = std::chrono::steady_clock::now();
+            robot_path_t hierarchicalPath = planner.plan(query.start, query.goal, distances, params);
+            auto hierarchicalTime = std::chrono::steady_clock::now();
+
+            if((astarPath.path_length > 1) != (hierarchicalPath.path_length > 1))
+            {
+                std::cout << "Path existence differs on the " << numTiles << "x tiled map\n";
+                return false;
+            }
+
+            astarUs += std::chrono::duration<double, std::micro>(astarTime - startTime).count();
+            hierarchicalUs += std::chrono::duration<double, std::micro>(hierarchicalTime - astarTime).count();
+            astarExpanded += workspace.numExpanded();
+            hierarchicalExpanded += planner.numExpanded();
+        }
+
+        std::cout << "Timing: " << width << 'x' << height << " map: A* " << (astarUs / kNumQueries) << " us/query ("
+            << (astarExpanded / kNumQueries) << " expanded), hierarchical " << (hierarchicalUs / kNumQueries)
+            << " us/query (" << (hierarchicalExpanded / kNumQueries) << " expanded), "
+            << planner.numNodes() << " nodes built in "
+            << std::chrono::duration<double, std::milli>(buildTime).count() << " ms\n";
+    }
+
+    return true;
+}
+
+
+bool check_query(const PlanQuery& query,
+                 const ObstacleDistanceGrid& distances,
+                 HierarchicalPlanner& planner,
+                 const std::string& name,
+                 double& maxCostRatio)
+{
+    const SearchParams params = search_params();
+
+    robot_path_t astarPath = search_for_path(query.start, query.goal, distances, params);
+    robot_path_t hierarchicalPath = planner.plan(query.start, query.goal, distances, params);
+
+    if((astarPath.path_length > 1) != (hierarchicalPath.path_length > 1))
+    {
+        std::cout << "A* " << ((astarPath.path_length > 1) ? "found" : "didn't find") << " a path that the "
+            << "hierarchical planner " << ((hierarchicalPath.path_length > 1) ? "found" : "didn't find") << " on "
+            << name << " map\n";
+        return false;
+    }
+
+    if(astarPath.path_length < 2)
+    {
+        return true;
+    }
+
+    double astarCost = path_cost(astarPath, distances, params);
+    double hierarchicalCost = path_cost(hierarchicalPath, distances, params);
+    double costRatio = hierarchicalCost / astarCost;
+    maxCostRatio = std::max(maxCostRatio, costRatio);
+
+    if(costRatio > kMaxCostRatio)
+    {
+        std::cout << "Hierarchical path cost " << hierarchicalCost << " vs. A* " << astarCost << " on " << name
+            << " map\n";
+        return false;
+    }
+
+    // The cheapest path can't cost more than any other path
+    if(costRatio < 0.9999)
+    {
+        std::cout << "Hierarchical path cost " << hierarchicalCost << " is less than A* " << astarCost << " on "
+            << name << " map\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+pose_xyt_t free_pose_near(int x, int y, const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    // Search outward in rings for the nearest cell far enough from obstacles
+    for(int radius = 0; radius < distances.widthInCells(); ++radius)
+    {
+        for(int dy = -radius; dy <= radius; ++dy)
+        {
+            for(int dx = -radius; dx <= radius; ++dx)
+            {
+                int cellX = x + dx;
+                int cellY = y + dy;
+                if((std::max(std::abs(dx), std::abs(dy)) == radius) && distances.isCellInGrid(cellX, cellY)
+                    && (distances(cellX, cellY) > params.minDistanceToObstacle * 1.5))
+                {
+                    Point<double> position = grid_position_to_global_position(Point<double>(cellX + 0.5,
+                                                                                            cellY + 0.5),
+                                                                              distances);
+                    pose_xyt_t pose;
+                    pose.utime = 0;
+                    pose.x = position.x;
+                    pose.y = position.y;
+                    pose.theta = 0.0f;
+                    return pose;
+                }
+            }
+        }
+    }
+
+    pose_xyt_t pose;
+    pose.utime = 0;
+    pose.x = pose.y = pose.theta = 0.0f;
+    return pose;
+}
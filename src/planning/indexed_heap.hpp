@@ -0,0 +1,300 @@
+#ifndef PLANNING_INDEXED_HEAP_HPP
+#define PLANNING_INDEXED_HEAP_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+* IndexedHeap is a d-ary min-heap of ids, usually cell indices, ordered by a key, usually a cost. Unlike
+* std::priority_queue, each id is in the heap at most once and the heap tracks where each id is stored, so the key of
+* an id already in the heap can be lowered in place (decrease-key) instead of pushing a duplicate entry.
+*
+* The heap therefore never holds more entries than there are distinct ids waiting to be processed, e.g. the frontier
+* of an A* search or a distance transform, and nothing stale is ever popped.
+*
+* The ids must be in the range [0, numIds) given to reset. A wider heap (larger D) is shallower, which makes push and
+* decrease-key cheaper at the cost of comparing more children in pop. D = 4 works well for grid searches.
+*
+* \tparam   Key         Type of the key, which must support operator<
+* \tparam   D           Number of children per node
+*/
+template <typename Key, int D = 4>
+class IndexedHeap
+{
+public:
+
+    static_assert(D >= 2, "IndexedHeap needs at least two children per node");
+
+    IndexedHeap(void) {}
+
+    /**
+    * reset empties the heap and prepares it to hold ids in the range [0, numIds).
+    *
+    * Only the ids still in the heap are cleared, so resetting an empty heap of the same size is O(1).
+    */
+    void reset(std::size_t numIds)
+    {
+        clear();
+        if(positions_.size() != numIds)
+        {
+            positions_.assign(numIds, kNotInHeap);
+        }
+    }
+
+    /**
+    * clear removes every id from the heap.
+    */
+    void clear(void)
+    {
+        for(auto& entry : heap_)
+        {
+            positions_[entry.id] = kNotInHeap;
+        }
+        heap_.clear();
+    }
+
+    bool empty(void) const { return heap_.empty(); }
+    std::size_t size(void) const { return heap_.size(); }
+
+    /**
+    * contains checks if an id is currently in the heap.
+    */
+    bool contains(int id) const { return positions_[id] != kNotInHeap; }
+
+    /**
+    * key retrieves the key of an id in the heap.
+    */
+    const Key& key(int id) const { return heap_[positions_[id]].key; }
+
+    /**
+    * top retrieves the id with the smallest key.
+    */
+    int top(void) const { return heap_.front().id; }
+    const Key& topKey(void) const { return heap_.front().key; }
+
+    /**
+    * push adds an id that isn't in the heap.
+    */
+    void push(int id, const Key& key)
+    {
+        assert(!contains(id));
+        heap_.push_back(Entry{ key, id });
+        positions_[id] = heap_.size() - 1;
+        siftUp(heap_.size() - 1);
+    }
+
+    /**
+    * decreaseKey lowers the key of an id already in the heap.
+    */
+    void decreaseKey(int id, const Key& key)
+    {
+        assert(contains(id) && !(this->key(id) < key));
+        std::size_t position = positions_[id];
+        heap_[position].key = key;
+        siftUp(position);
+    }
+
+    /**
+    * update changes the key of an id already in the heap to any new value, larger or smaller.
+    */
+    void update(int id, const Key& key)
+    {
+        assert(contains(id));
+        std::size_t position = positions_[id];
+        bool isSmaller = key < heap_[position].key;
+        heap_[position].key = key;
+        if(isSmaller)
+        {
+            siftUp(position);
+        }
+        else
+        {
+            siftDown(position);
+        }
+    }
+
+    /**
+    * pushOrDecrease adds an id to the heap or lowers its key if it's already in the heap and the new key is smaller.
+    *
+    * \return   True if the id was added or its key was lowered.
+    */
+    bool pushOrDecrease(int id, const Key& key)
+    {
+        if(!contains(id))
+        {
+            push(id, key);
+            return true;
+        }
+        else if(key < this->key(id))
+        {
+            decreaseKey(id, key);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+    * forEach calls function(id, key) for every id in the heap, in no particular order.
+    */
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        for(auto& entry : heap_)
+        {
+            function(entry.id, entry.key);
+        }
+    }
+
+    /**
+    * rekey replaces the key of every id in the heap with keyOf(id) and then restores the heap order bottom-up, which
+    * takes O(n) rather than the O(n log n) of popping every id and pushing it again.
+    */
+    template <typename KeyFunction>
+    void rekey(KeyFunction keyOf)
+    {
+        for(auto& entry : heap_)
+        {
+            entry.key = keyOf(entry.id);
+        }
+
+        if(heap_.size() < 2)
+        {
+            return;
+        }
+
+        // Every node after the parent of the last one is a leaf, so only the nodes up to that parent need sifting
+        for(std::size_t position = (heap_.size() - 2) / D + 1; position-- > 0;)
+        {
+            siftDown(position);
+        }
+    }
+
+    /**
+    * pop removes the id with the smallest key.
+    *
+    * \return   The id that was removed.
+    */
+    int pop(void)
+    {
+        assert(!heap_.empty());
+        int id = heap_.front().id;
+        positions_[id] = kNotInHeap;
+
+        if(heap_.size() > 1)
+        {
+            heap_.front() = heap_.back();
+            positions_[heap_.front().id] = 0;
+            heap_.pop_back();
+            siftDown(0);
+        }
+        else
+        {
+            heap_.pop_back();
+        }
+
+        return id;
+    }
+
+    /**
+    * remove takes an id out of the heap if it's there.
+    */
+    void remove(int id)
+    {
+        if(!contains(id))
+        {
+            return;
+        }
+
+        std::size_t position = positions_[id];
+        positions_[id] = kNotInHeap;
+
+        if(position + 1 < heap_.size())
+        {
+            int movedId = heap_.back().id;
+            heap_[position] = heap_.back();
+            positions_[movedId] = position;
+            heap_.pop_back();
+
+            // The moved entry could belong either above or below its new position
+            siftUp(position);
+            siftDown(positions_[movedId]);
+        }
+        else
+        {
+            heap_.pop_back();
+        }
+    }
+
+private:
+
+    static const int32_t kNotInHeap = -1;
+
+    struct Entry
+    {
+        Key key;
+        int id;
+    };
+
+    std::vector<Entry> heap_;
+    std::vector<int32_t> positions_;      // position of each id in heap_ or kNotInHeap
+
+    void siftUp(std::size_t position)
+    {
+        Entry entry = heap_[position];
+        while(position > 0)
+        {
+            std::size_t parent = (position - 1) / D;
+            if(!(entry.key < heap_[parent].key))
+            {
+                break;
+            }
+            heap_[position] = heap_[parent];
+            positions_[heap_[position].id] = position;
+            position = parent;
+        }
+        heap_[position] = entry;
+        positions_[entry.id] = position;
+    }
+
+    void siftDown(std::size_t position)
+    {
+        Entry entry = heap_[position];
+        const std::size_t size = heap_.size();
+        while(true)
+        {
+            std::size_t firstChild = position * D + 1;
+            if(firstChild >= size)
+            {
+                break;
+            }
+
+            std::size_t lastChild = (firstChild + D < size) ? firstChild + D : size;
+            std::size_t minChild = firstChild;
+            for(std::size_t child = firstChild + 1; child < lastChild; ++child)
+            {
+                if(heap_[child].key < heap_[minChild].key)
+                {
+                    minChild = child;
+                }
+            }
+
+            if(!(heap_[minChild].key < entry.key))
+            {
+                break;
+            }
+
+            heap_[position] = heap_[minChild];
+            positions_[heap_[position].id] = position;
+            position = minChild;
+        }
+        heap_[position] = entry;
+        positions_[entry.id] = position;
+    }
+};
+
+template <typename Key, int D>
+const int32_t IndexedHeap<Key, D>::kNotInHeap;
+
+#endif // PLANNING_INDEXED_HEAP_HPP
@@ -0,0 +1,316 @@
+#include <planning/landmark_heuristic.hpp>
+#include <planning/indexed_heap.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+
+namespace
+{
+
+const char kFileMagic[4] = { 'A', 'L', 'T', '1' };
+const float kInfiniteCost = std::numeric_limits<float>::max();
+
+
+// FNV-1a hash of the obstacle distances, to recognize the grid a set of tables was built for
+uint64_t hash_distances(const ObstacleDistanceGrid& distances)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto addBytes = [&hash](const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(std::size_t n = 0; n < size; ++n)
+        {
+            hash = (hash ^ bytes[n]) * 1099511628211ull;
+        }
+    };
+
+    for(int y = 0; y < distances.heightInCells(); ++y)
+    {
+        for(int x = 0; x < distances.widthInCells(); ++x)
+        {
+            float distance = distances(x, y);
+            addBytes(&distance, sizeof(distance));
+        }
+    }
+    return hash;
+}
+
+
+/*
+* find_symmetric_costs runs a Dijkstra search from the source over the traversable cells, where a step costs one cell
+* plus the mean distance cost of the two cells. Unreachable cells are left at kInfiniteCost.
+*/
+void find_symmetric_costs(int source,
+                          const ObstacleDistanceGrid& distances,
+                          const std::vector<float>& obstacleCosts,
+                          const std::vector<uint8_t>& isTraversable,
+                          std::vector<float>& costs,
+                          IndexedHeap<float>& openList)
+{
+    const int width = distances.widthInCells();
+    const int height = distances.heightInCells();
+    const float metersPerCell = distances.metersPerCell();
+
+    costs.assign(obstacleCosts.size(), kInfiniteCost);
+    openList.reset(obstacleCosts.size());
+
+    costs[source] = 0.0f;
+    openList.push(source, 0.0f);
+
+    while(!openList.empty())
+    {
+        int index = openList.pop();
+        int x = index % width;
+        int y = index / width;
+
+        const int neighbors[4] = { (x + 1 < width) ? index + 1 : -1,
+                                   (x > 0) ? index - 1 : -1,
+                                   (y + 1 < height) ? index + width : -1,
+                                   (y > 0) ? index - width : -1 };
+
+        for(int neighbor : neighbors)
+        {
+            if((neighbor < 0) || !isTraversable[neighbor])
+            {
+                continue;
+            }
+
+            float cost = costs[index] + metersPerCell + 0.5f*(obstacleCosts[index] + obstacleCosts[neighbor]);
+            if(cost < costs[neighbor])
+            {
+                costs[neighbor] = cost;
+                openList.pushOrDecrease(neighbor, cost);
+            }
+        }
+    }
+}
+
+}
+
+
+LandmarkHeuristic::LandmarkHeuristic(void)
+: width_(0)
+, height_(0)
+, metersPerCell_(0.0f)
+, gridHash_(0)
+{
+}
+
+
+void LandmarkHeuristic::build(const ObstacleDistanceGrid& distances, const SearchParams& params, int numLandmarks)
+{
+    clear();
+
+    width_ = distances.widthInCells();
+    height_ = distances.heightInCells();
+    metersPerCell_ = distances.metersPerCell();
+    params_ = params;
+    params_.landmarks = nullptr;
+    gridHash_ = hash_distances(distances);
+
+    const std::size_t numCells = static_cast<std::size_t>(width_) * height_;
+    std::vector<float> obstacleCosts(numCells, 0.0f);
+    std::vector<uint8_t> isTraversable(numCells, 0);
+
+    // Start from the traversable cell nearest the middle of the grid
+    int seed = -1;
+    int seedDistance = std::numeric_limits<int>::max();
+    for(int y = 0; y < height_; ++y)
+    {
+        for(int x = 0; x < width_; ++x)
+        {
+            int index = y*width_ + x;
+            isTraversable[index] = is_traversable(x, y, distances, params);
+            obstacleCosts[index] = obstacle_cost(distances(x, y), params);
+
+            int middleDistance = std::abs(2*x - width_) + std::abs(2*y - height_);
+            if(isTraversable[index] && (middleDistance < seedDistance))
+            {
+                seed = index;
+                seedDistance = middleDistance;
+            }
+        }
+    }
+
+    if((seed < 0) || (numLandmarks <= 0))
+    {
+        return;
+    }
+
+    IndexedHeap<float> openList;
+    std::vector<float> costs;
+
+    // Each landmark is the cell farthest from the landmarks picked so far, which spreads them around the edges of the
+    // reachable cells, where they bound the most queries. The first is the cell farthest from the seed.
+    std::vector<float> closestLandmarkCosts;
+    find_symmetric_costs(seed, distances, obstacleCosts, isTraversable, closestLandmarkCosts, openList);
+
+    std::vector<std::vector<uint16_t>> tables;
+    while(static_cast<int>(landmarks_.size()) < numLandmarks)
+    {
+        int farthest = -1;
+        float farthestCost = 0.0f;
+        for(std::size_t index = 0; index < numCells; ++index)
+        {
+            if((closestLandmarkCosts[index] != kInfiniteCost) && (closestLandmarkCosts[index] > farthestCost))
+            {
+                farthest = index;
+                farthestCost = closestLandmarkCosts[index];
+            }
+        }
+
+        // Every reachable cell is already a landmark
+        if(farthest < 0)
+        {
+            break;
+        }
+
+        find_symmetric_costs(farthest, distances, obstacleCosts, isTraversable, costs, openList);
+
+        float maxCost = 0.0f;
+        for(std::size_t index = 0; index < numCells; ++index)
+        {
+            if(costs[index] != kInfiniteCost)
+            {
+                maxCost = std::max(maxCost, costs[index]);
+                closestLandmarkCosts[index] = std::min(closestLandmarkCosts[index], costs[index]);
+            }
+        }
+
+        // Steps run from 0 to kUnreachable - 1, so the largest cost fits
+        float costStep = std::max(maxCost, metersPerCell_) / (kUnreachable - 1);
+        std::vector<uint16_t> table(numCells, kUnreachable);
+        for(std::size_t index = 0; index < numCells; ++index)
+        {
+            if(costs[index] != kInfiniteCost)
+            {
+                table[index] = std::min(static_cast<int>(costs[index] / costStep), kUnreachable - 1);
+            }
+        }
+
+        landmarks_.push_back(farthest);
+        costSteps_.push_back(costStep);
+        tables.push_back(std::move(table));
+    }
+
+    // Interleave the tables, so the costs of every landmark for a cell are next to each other
+    costs_.resize(numCells * landmarks_.size());
+    for(std::size_t index = 0; index < numCells; ++index)
+    {
+        for(std::size_t n = 0; n < landmarks_.size(); ++n)
+        {
+            costs_[index*landmarks_.size() + n] = tables[n][index];
+        }
+    }
+}
+
+
+void LandmarkHeuristic::clear(void)
+{
+    landmarks_.clear();
+    costSteps_.clear();
+    costs_.clear();
+}
+
+
+bool LandmarkHeuristic::saveToFile(const std::string& filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if(!out.is_open())
+    {
+        std::cerr << "ERROR: LandmarkHeuristic::saveToFile: Failed to save to " << filename << '\n';
+        return false;
+    }
+
+    uint32_t numLandmarks = landmarks_.size();
+    int8_t mode = params_.mode;
+
+    out.write(kFileMagic, sizeof(kFileMagic));
+    out.write(reinterpret_cast<const char*>(&width_), sizeof(width_));
+    out.write(reinterpret_cast<const char*>(&height_), sizeof(height_));
+    out.write(reinterpret_cast<const char*>(&metersPerCell_), sizeof(metersPerCell_));
+    out.write(reinterpret_cast<const char*>(&params_.minDistanceToObstacle), sizeof(params_.minDistanceToObstacle));
+    out.write(reinterpret_cast<const char*>(&params_.maxDistanceWithCost), sizeof(params_.maxDistanceWithCost));
+    out.write(reinterpret_cast<const char*>(&params_.distanceCostExponent), sizeof(params_.distanceCostExponent));
+    out.write(reinterpret_cast<const char*>(&mode), sizeof(mode));
+    out.write(reinterpret_cast<const char*>(&gridHash_), sizeof(gridHash_));
+    out.write(reinterpret_cast<const char*>(&numLandmarks), sizeof(numLandmarks));
+    out.write(reinterpret_cast<const char*>(landmarks_.data()), landmarks_.size() * sizeof(int));
+    out.write(reinterpret_cast<const char*>(costSteps_.data()), costSteps_.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(costs_.data()), costs_.size() * sizeof(uint16_t));
+
+    return out.good();
+}
+
+
+bool LandmarkHeuristic::loadFromFile(const std::string& filename)
+{
+    clear();
+
+    std::ifstream in(filename, std::ios::binary);
+    if(!in.is_open())
+    {
+        return false;
+    }
+
+    char magic[sizeof(kFileMagic)];
+    uint32_t numLandmarks = 0;
+    int8_t mode = 0;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&width_), sizeof(width_));
+    in.read(reinterpret_cast<char*>(&height_), sizeof(height_));
+    in.read(reinterpret_cast<char*>(&metersPerCell_), sizeof(metersPerCell_));
+    in.read(reinterpret_cast<char*>(&params_.minDistanceToObstacle), sizeof(params_.minDistanceToObstacle));
+    in.read(reinterpret_cast<char*>(&params_.maxDistanceWithCost), sizeof(params_.maxDistanceWithCost));
+    in.read(reinterpret_cast<char*>(&params_.distanceCostExponent), sizeof(params_.distanceCostExponent));
+    in.read(reinterpret_cast<char*>(&mode), sizeof(mode));
+    in.read(reinterpret_cast<char*>(&gridHash_), sizeof(gridHash_));
+    in.read(reinterpret_cast<char*>(&numLandmarks), sizeof(numLandmarks));
+
+    if(!in.good() || (std::memcmp(magic, kFileMagic, sizeof(kFileMagic)) != 0) || (width_ <= 0) || (height_ <= 0))
+    {
+        std::cerr << "ERROR: LandmarkHeuristic::loadFromFile: " << filename << " isn't a landmark file\n";
+        return false;
+    }
+    params_.mode = static_cast<SearchMode>(mode);
+
+    landmarks_.resize(numLandmarks);
+    costSteps_.resize(numLandmarks);
+    costs_.resize(static_cast<std::size_t>(width_) * height_ * numLandmarks);
+    in.read(reinterpret_cast<char*>(landmarks_.data()), landmarks_.size() * sizeof(int));
+    in.read(reinterpret_cast<char*>(costSteps_.data()), costSteps_.size() * sizeof(float));
+    in.read(reinterpret_cast<char*>(costs_.data()), costs_.size() * sizeof(uint16_t));
+
+    if(!in.good())
+    {
+        std::cerr << "ERROR: LandmarkHeuristic::loadFromFile: " << filename << " is truncated\n";
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool LandmarkHeuristic::matches(const ObstacleDistanceGrid& distances, const SearchParams& params) const
+{
+    return hasSameCosts(params)
+        && (width_ == distances.widthInCells())
+        && (height_ == distances.heightInCells())
+        && (metersPerCell_ == distances.metersPerCell())
+        && (gridHash_ == hash_distances(distances));
+}
+
+
+bool LandmarkHeuristic::hasSameCosts(const SearchParams& params) const
+{
+    // The search mode doesn't change the costs, so only the parameters that do are compared
+    return isBuilt()
+        && (params_.minDistanceToObstacle == params.minDistanceToObstacle)
+        && (params_.maxDistanceWithCost == params.maxDistanceWithCost)
+        && (params_.distanceCostExponent == params.distanceCostExponent);
+}
@@ -0,0 +1,137 @@
+#ifndef PLANNING_LANDMARK_HEURISTIC_HPP
+#define PLANNING_LANDMARK_HEURISTIC_HPP
+
+#include <planning/astar.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* LandmarkHeuristic holds the precomputed tables of the ALT heuristic (A*, landmarks, and the triangle inequality,
+* Goldberg and Harrelson, 2005) for a fixed grid.
+*
+* A few landmark cells are picked, spread across the grid, and a Dijkstra search from each finds its cost to every
+* reachable cell. For any cell v, goal t, and landmark L, the triangle inequality gives |d(L, t) - d(L, v)| as a lower
+* bound on the cost from v to t. In a maze, where the Manhattan distance ignores the walls, the bound from a landmark
+* behind the goal is often close to the true cost, so A* expands far fewer cells.
+*
+* A step into a cell costs one cell plus that cell's distance cost, so the cost of a path from v to t isn't the same as
+* the cost back from t to v. It is, though, the symmetric cost of the path, where each step costs one cell plus the mean
+* distance cost of its two cells, plus half the difference between the distance costs of t and v. The tables hold the
+* symmetric costs, so one table per landmark covers both directions -- see lowerBound.
+*
+* Each table stores the costs as 16-bit fractions of the largest cost in the table, rounded down, which the bound
+* accounts for. A grid of N cells with K landmarks takes 2*N*K bytes.
+*
+* Landmarks are only picked in the cells reachable from the traversable cell nearest the middle of the grid. Queries in
+* other parts of the grid get no bound from the tables.
+*
+* The tables are only valid for the grid and search parameters they were built with. matches checks a saved set of
+* tables against the current grid before it's used.
+*/
+class LandmarkHeuristic
+{
+public:
+
+    LandmarkHeuristic(void);
+
+    /**
+    * build picks the landmarks and finds their tables.
+    *
+    * \param    distances           Grid to build the tables for
+    * \param    params              Search parameters, which determine the traversable cells and distance costs
+    * \param    numLandmarks        Number of landmarks to pick
+    */
+    void build(const ObstacleDistanceGrid& distances, const SearchParams& params, int numLandmarks);
+
+    /**
+    * clear discards the tables.
+    */
+    void clear(void);
+
+    /**
+    * saveToFile saves the tables to a binary file, in the byte order of the machine.
+    *
+    * \param    filename            Name of the file to save to
+    * \return   True if the tables were saved.
+    */
+    bool saveToFile(const std::string& filename) const;
+
+    /**
+    * loadFromFile loads tables saved by saveToFile. If the file can't be read, the tables are cleared.
+    *
+    * \param    filename            Name of the file to load
+    * \return   True if the tables were loaded.
+    */
+    bool loadFromFile(const std::string& filename);
+
+    /**
+    * matches checks if the tables were built for a grid and search parameters.
+    */
+    bool matches(const ObstacleDistanceGrid& distances, const SearchParams& params) const;
+
+    /**
+    * hasSameCosts checks if the tables were built with search parameters that give the same costs as params. Unlike
+    * matches, it doesn't check the grid, so it's cheap enough to call before every search.
+    */
+    bool hasSameCosts(const SearchParams& params) const;
+
+    bool isBuilt(void) const { return !landmarks_.empty(); }
+    int numLandmarks(void) const { return landmarks_.size(); }
+
+    /**
+    * landmarks retrieves the cells of the landmarks, as row-major indices y*width + x.
+    */
+    const std::vector<int>& landmarks(void) const { return landmarks_; }
+
+    /**
+    * lowerBound finds the largest lower bound on the symmetric cost from a cell to the goal given by the landmarks.
+    * The cost of the cheapest path from the cell to the goal is at least
+    *
+    *   lowerBound(cell, goal) + (obstacle cost of goal - obstacle cost of cell) / 2
+    *
+    * The bound never overestimates the cost, and it's consistent to within one step of the tables, a tiny fraction of
+    * the largest cost, so it can be used as an A* heuristic.
+    *
+    * \param    cellIndex           Row-major index of the cell
+    * \param    goalIndex           Row-major index of the goal
+    * \return   Lower bound on the symmetric cost (m), or 0 if no landmark reaches both cells.
+    */
+    float lowerBound(int cellIndex, int goalIndex) const
+    {
+        const uint16_t* cellCosts = &costs_[static_cast<std::size_t>(cellIndex) * landmarks_.size()];
+        const uint16_t* goalCosts = &costs_[static_cast<std::size_t>(goalIndex) * landmarks_.size()];
+
+        float bound = 0.0f;
+        for(std::size_t n = 0; n < landmarks_.size(); ++n)
+        {
+            if((cellCosts[n] != kUnreachable) && (goalCosts[n] != kUnreachable))
+            {
+                // Each cost was rounded down by up to one step, so the difference can be up to one step too large
+                int steps = std::abs(static_cast<int>(cellCosts[n]) - static_cast<int>(goalCosts[n])) - 1;
+                bound = std::max(bound, steps * costSteps_[n]);
+            }
+        }
+        return bound;
+    }
+
+private:
+
+    static const uint16_t kUnreachable = 0xFFFF;
+
+    int width_;
+    int height_;
+    float metersPerCell_;
+    SearchParams params_;
+    uint64_t gridHash_;                 // hash of the obstacle distances the tables were built for
+
+    std::vector<int> landmarks_;
+    std::vector<float> costSteps_;      // cost of one step of each landmark's table (m)
+    std::vector<uint16_t> costs_;       // costs_[cell*numLandmarks + n] is the cost from landmark n to cell, in steps
+};
+
+#endif // PLANNING_LANDMARK_HEURISTIC_HPP
@@ -0,0 +1,299 @@
+#include <planning/landmark_heuristic.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The landmark heuristic test checks LandmarkHeuristic:
+*
+*   - on the data/astar maps, grid_astar finds paths with the same cost with and without the landmarks,
+*   - the landmarks make grid_astar expand far fewer cells on the maze map. The cells expanded on each map, and the
+*     time to build the tables, are printed,
+*   - tables saved to a file load back with the same bounds, and are recognized as stale once the map changes,
+*     including through MotionPlanner::useLandmarks.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+const std::vector<std::string> kMaps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+const int kNumLandmarks = 8;
+const std::string kTablesFilename = "/tmp/landmark_heuristic_test.alt";
+
+
+bool test_same_costs(void);
+bool test_fewer_expansions(void);
+bool test_save_and_load(void);
+
+float path_cost(const PlanQuery& query, const ObstacleDistanceGrid& distances, const AStarWorkspace& workspace);
+
+
+int main(int argc, char** argv)
+{
+    if(test_same_costs())
+    {
+        std::cout << "PASSED: test_same_costs\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_same_costs\n";
+    }
+
+    if(test_fewer_expansions())
+    {
+        std::cout << "PASSED: test_fewer_expansions\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_fewer_expansions\n";
+    }
+
+    if(test_save_and_load())
+    {
+        std::cout << "PASSED: test_save_and_load\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_save_and_load\n";
+    }
+
+    return 0;
+}
+
+
+bool test_same_costs(void)
+{
+    SearchParams params = search_params();
+    AStarWorkspace workspace;
+    bool allCorrect = true;
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        LandmarkHeuristic landmarks;
+        landmarks.build(distances, params, kNumLandmarks);
+
+        for(auto& query : queries)
+        {
+            params.landmarks = nullptr;
+            robot_path_t path = search_for_path(query.start, query.goal, distances, params, workspace);
+            float cost = path_cost(query, distances, workspace);
+
+            params.landmarks = &landmarks;
+            robot_path_t landmarkPath = search_for_path(query.start, query.goal, distances, params, workspace);
+            float landmarkCost = path_cost(query, distances, workspace);
+
+            if((path.path_length > 1) != (landmarkPath.path_length > 1))
+            {
+                std::cout << "A* " << ((path.path_length > 1) ? "found" : "didn't find") << " a path that it "
+                    << ((landmarkPath.path_length > 1) ? "found" : "didn't find") << " with landmarks on " << name
+                    << " map\n";
+                allCorrect = false;
+            }
+            else if((path.path_length > 1) && (std::abs(cost - landmarkCost) > 1.0e-4f * cost))
+            {
+                std::cout << "Path on " << name << " map costs " << landmarkCost << " with landmarks instead of "
+                    << cost << '\n';
+                allCorrect = false;
+            }
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_fewer_expansions(void)
+{
+    SearchParams params = search_params();
+    AStarWorkspace workspace;
+    double mazeRatio = 1.0;
+
+    printf("%-8s %12s %12s %12s %12s\n", "map", "build ms", "A* exp", "ALT exp", "ratio");
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        auto startTime = std::chrono::steady_clock::now();
+        LandmarkHeuristic landmarks;
+        landmarks.build(distances, params, kNumLandmarks);
+        auto endTime = std::chrono::steady_clock::now();
+
+        std::size_t numExpanded = 0;
+        std::size_t numLandmarkExpanded = 0;
+        for(auto& query : queries)
+        {
+            params.landmarks = nullptr;
+            search_for_path(query.start, query.goal, distances, params, workspace);
+            numExpanded += workspace.numExpanded();
+
+            params.landmarks = &landmarks;
+            search_for_path(query.start, query.goal, distances, params, workspace);
+            numLandmarkExpanded += workspace.numExpanded();
+        }
+
+        double ratio = (numExpanded > 0) ? static_cast<double>(numLandmarkExpanded) / numExpanded : 1.0;
+        printf("%-8s %12.1f %12zu %12zu %12.2f\n",
+               name.c_str(),
+               std::chrono::duration<double, std::milli>(endTime - startTime).count(),
+               numExpanded,
+               numLandmarkExpanded,
+               ratio);
+
+        if(name == "maze")
+        {
+            mazeRatio = ratio;
+        }
+    }
+
+    return mazeRatio < 0.5;
+}
+
+
+bool test_save_and_load(void)
+{
+    const SearchParams params = search_params();
+
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("maze", grid, queries))
+    {
+        return false;
+    }
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    LandmarkHeuristic landmarks;
+    landmarks.build(distances, params, kNumLandmarks);
+    if(!landmarks.saveToFile(kTablesFilename))
+    {
+        return false;
+    }
+
+    LandmarkHeuristic loaded;
+    if(!loaded.loadFromFile(kTablesFilename) || !loaded.matches(distances, params)
+        || (loaded.landmarks() != landmarks.landmarks()))
+    {
+        std::cout << "Tables didn't load back from " << kTablesFilename << '\n';
+        return false;
+    }
+
+    const int numCells = distances.widthInCells() * distances.heightInCells();
+    for(int cell = 0; cell < numCells; cell += 7)
+    {
+        for(int goal = 0; goal < numCells; goal += 101)
+        {
+            if(loaded.lowerBound(cell, goal) != landmarks.lowerBound(cell, goal))
+            {
+                std::cout << "Loaded tables give a different bound from " << cell << " to " << goal << '\n';
+                return false;
+            }
+        }
+    }
+
+    SearchParams otherParams = params;
+    otherParams.maxDistanceWithCost *= 2.0;
+    if(loaded.matches(distances, otherParams))
+    {
+        std::cout << "Tables match different search parameters\n";
+        return false;
+    }
+
+    // Block a free cell, which changes the distances around it
+    OccupancyGrid changedGrid = grid;
+    for(int y = 0; y < changedGrid.heightInCells(); ++y)
+    {
+        for(int x = 0; x < changedGrid.widthInCells(); ++x)
+        {
+            if(distances(x, y) > params.minDistanceToObstacle)
+            {
+                changedGrid(x, y) = 127;
+                y = changedGrid.heightInCells();
+                break;
+            }
+        }
+    }
+
+    ObstacleDistanceGrid changedDistances;
+    changedDistances.setDistances(changedGrid);
+    if(loaded.matches(changedDistances, params))
+    {
+        std::cout << "Tables match a changed map\n";
+        return false;
+    }
+
+    // The planner builds the tables the first time, then loads them
+    MotionPlannerParams plannerParams;
+    plannerParams.robotRadius = 0.1;
+    const std::string mapFilename = "/tmp/landmark_heuristic_test.map";
+    std::remove((mapFilename + ".alt").c_str());
+
+    MotionPlanner planner(plannerParams);
+    planner.setMap(grid);
+    bool wasLoaded = planner.useLandmarks(mapFilename);
+
+    MotionPlanner restartedPlanner(plannerParams);
+    restartedPlanner.setMap(grid);
+    bool wasLoadedAgain = restartedPlanner.useLandmarks(mapFilename);
+
+    restartedPlanner.setMap(changedGrid);
+    bool isKeptAfterChange = restartedPlanner.landmarks().isBuilt();
+
+    MotionPlanner changedPlanner(plannerParams);
+    changedPlanner.setMap(changedGrid);
+    bool wasLoadedForChange = changedPlanner.useLandmarks(mapFilename);
+
+    std::remove(kTablesFilename.c_str());
+    std::remove((mapFilename + ".alt").c_str());
+
+    if(wasLoaded || !wasLoadedAgain || isKeptAfterChange || wasLoadedForChange)
+    {
+        std::cout << "MotionPlanner::useLandmarks loaded: " << wasLoaded << " then " << wasLoadedAgain
+            << ", kept after setMap changed the map: " << isKeptAfterChange << ", loaded for the changed map: "
+            << wasLoadedForChange << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+
+float path_cost(const PlanQuery& query, const ObstacleDistanceGrid& distances, const AStarWorkspace& workspace)
+{
+    // The search leaves the cost of the path in the goal cell
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(query.goal.x, query.goal.y), distances);
+    if(!distances.isCellInGrid(goalCell.x, goalCell.y))
+    {
+        return 0.0f;
+    }
+    return workspace.gCost(goalCell.y*distances.widthInCells() + goalCell.x);
+}
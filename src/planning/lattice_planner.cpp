@@ -0,0 +1,367 @@
+#include <planning/lattice_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/angle_functions.hpp>
+#include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+namespace
+{
+
+const float kPi = 3.14159265f;
+const float kBinWidth = 2.0f * kPi / LatticePlanner::kNumHeadings;
+
+// Spacing of the points sampled along a primitive to find the cells it sweeps (cells)
+const float kSweepStep = 0.25f;
+
+// Number of states expanded between checks of the clock when the search has a time budget
+const int kExpansionsPerClockCheck = 64;
+
+/*
+* Primitives for the east (0) and northeast (1) heading bins. The primitives of the other bins are the same motions
+* rotated by multiples of 90 degrees. Each is the cell the primitive ends in and its final heading bin:
+*
+*   - a one-cell step, so every path through the cells can be followed,
+*   - a longer straight segment, so open space takes fewer expansions,
+*   - 45 and 90 degree turns to either side along arcs with a radius of 3 to 3.5 cells.
+*/
+struct PrimitiveEnd
+{
+    int x;
+    int y;
+    int heading;
+};
+
+const PrimitiveEnd kEastPrimitives[] = {
+    { 1, 0, 0 }, { 4, 0, 0 }, { 4, 1, 1 }, { 4, -1, 7 }, { 3, 3, 2 }, { 3, -3, 6 },
+};
+
+const PrimitiveEnd kNortheastPrimitives[] = {
+    { 1, 1, 1 }, { 3, 3, 1 }, { 1, 4, 2 }, { 4, 1, 0 }, { 0, 4, 3 }, { 4, 0, 7 },
+};
+
+
+// The length of a primitive is at least the straight-line distance between its ends, so this never overestimates
+float h_cost(int x, int y, cell_t goal, float metersPerCell)
+{
+    return std::sqrt(static_cast<float>((goal.x - x)*(goal.x - x) + (goal.y - y)*(goal.y - y))) * metersPerCell;
+}
+
+}
+
+
+LatticePlanner::LatticePlanner(float turnInPlaceCost)
+: turnInPlaceCost_(turnInPlaceCost)
+, numTurnsInPlace_(0)
+{
+    for(int rotation = 0; rotation < 4; ++rotation)
+    {
+        auto addRotated = [&](int baseHeading, const PrimitiveEnd& end) {
+            cell_t offset(end.x, end.y);
+            for(int n = 0; n < rotation; ++n)
+            {
+                offset = cell_t(-offset.y, offset.x);
+            }
+            addPrimitive((baseHeading + 2*rotation) % kNumHeadings,
+                         offset,
+                         (end.heading + 2*rotation) % kNumHeadings);
+        };
+
+        for(auto& end : kEastPrimitives)
+        {
+            addRotated(0, end);
+        }
+
+        for(auto& end : kNortheastPrimitives)
+        {
+            addRotated(1, end);
+        }
+    }
+
+    for(int heading = 0; heading < kNumHeadings; ++heading)
+    {
+        addTurnInPlace(heading, (heading + 1) % kNumHeadings);
+        addTurnInPlace(heading, (heading + kNumHeadings - 1) % kNumHeadings);
+    }
+}
+
+
+robot_path_t LatticePlanner::plan(const pose_xyt_t& start,
+                                  const pose_xyt_t& goal,
+                                  const ObstacleDistanceGrid& distances,
+                                  const SearchParams& params)
+{
+    const int64_t deadlineUs = (params.timeBudgetUs > 0) ? utime_now() + params.timeBudgetUs : 0;
+
+    robot_path_t path;
+    path.utime = start.utime;
+    path.path.push_back(start);
+    path.path_length = path.path.size();
+
+    numTurnsInPlace_ = 0;
+    workspace_.beginSearch(distances.widthInCells() * kNumHeadings, distances.heightInCells());
+
+    cell_t startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    cell_t goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    if(!is_traversable(startCell.x, startCell.y, distances, params)
+        || !is_traversable(goalCell.x, goalCell.y, distances, params)
+        || (startCell == goalCell))
+    {
+        return path;
+    }
+
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    auto stateIndex = [width](int x, int y, int heading) {
+        return (y*width + x)*kNumHeadings + heading;
+    };
+
+    IndexedHeap<float>& openList = workspace_.openList();
+
+    const int startIndex = stateIndex(startCell.x, startCell.y, heading_to_bin(start.theta));
+    workspace_.setCost(startIndex, 0.0f, AStarWorkspace::kNoParent);
+    openList.push(startIndex, h_cost(startCell.x, startCell.y, goalCell, metersPerCell));
+
+    int goalIndex = AStarWorkspace::kNoParent;
+
+    for(std::size_t numExpanded = 1; !openList.empty(); ++numExpanded)
+    {
+        if((deadlineUs > 0) && (numExpanded % kExpansionsPerClockCheck == 0) && (utime_now() >= deadlineUs))
+        {
+            break;
+        }
+
+        int index = openList.pop();
+        workspace_.close(index);
+
+        const int heading = index % kNumHeadings;
+        const int x = (index / kNumHeadings) % width;
+        const int y = (index / kNumHeadings) / width;
+
+        if((x == goalCell.x) && (y == goalCell.y))
+        {
+            goalIndex = index;
+            break;
+        }
+
+        const float gCost = workspace_.gCost(index);
+
+        for(auto& primitive : primitives_[heading])
+        {
+            const int endX = x + primitive.offset.x;
+            const int endY = y + primitive.offset.y;
+            const int endIndex = stateIndex(endX, endY, primitive.endHeading);
+
+            if(!distances.isCellInGrid(endX, endY) || workspace_.isClosed(endIndex))
+            {
+                continue;
+            }
+
+            // The robot is safe along the primitive if every cell its center sweeps is safe
+            float gNew = gCost + (primitive.isTurnInPlace() ? turnInPlaceCost_ : primitive.length * metersPerCell);
+            bool isSafe = true;
+            for(auto& offset : primitive.sweptCells)
+            {
+                if(!is_traversable(x + offset.x, y + offset.y, distances, params))
+                {
+                    isSafe = false;
+                    break;
+                }
+                gNew += obstacle_cost(distances(x + offset.x, y + offset.y), params);
+            }
+
+            if(isSafe && (gNew < workspace_.gCost(endIndex)))
+            {
+                workspace_.setCost(endIndex, gNew, index);
+                openList.pushOrDecrease(endIndex, gNew + h_cost(endX, endY, goalCell, metersPerCell));
+            }
+        }
+    }
+
+    if(goalIndex == AStarWorkspace::kNoParent)
+    {
+        return path;
+    }
+
+    // Walk the parents back from the goal to find the primitives along the path
+    std::vector<int> states;
+    for(int index = goalIndex; index != AStarWorkspace::kNoParent; index = workspace_.parent(index))
+    {
+        states.push_back(index);
+    }
+    std::reverse(states.begin(), states.end());
+
+    for(std::size_t n = 1; n < states.size(); ++n)
+    {
+        const int parentCell = states[n-1] / kNumHeadings;
+        const int cell = states[n] / kNumHeadings;
+        const cell_t parent(parentCell % width, parentCell / width);
+        const cell_t offset(cell % width - parent.x, cell / width - parent.y);
+
+        const MotionPrimitive* primitive = findPrimitive(states[n-1] % kNumHeadings, offset, states[n] % kNumHeadings);
+        assert(primitive);
+
+        if(primitive->isTurnInPlace())
+        {
+            // The robot turns toward the next waypoint on its own
+            ++numTurnsInPlace_;
+            continue;
+        }
+
+        for(std::size_t i = 0; i < primitive->poses.size(); ++i)
+        {
+            Point<double> position = grid_position_to_global_position(
+                Point<double>(parent.x + primitive->poses[i].x, parent.y + primitive->poses[i].y), distances);
+
+            pose_xyt_t pose;
+            pose.utime = start.utime;
+            pose.x = position.x;
+            pose.y = position.y;
+            pose.theta = primitive->headings[i];
+            path.path.push_back(pose);
+        }
+    }
+
+    path.path_length = path.path.size();
+    return path;
+}
+
+
+void LatticePlanner::addPrimitive(int startHeading, cell_t offset, int endHeading)
+{
+    const float startTheta = startHeading * kBinWidth;
+    const float turn = wrap_to_pi((endHeading - startHeading) * kBinWidth);
+    const Point<float> startDir(std::cos(startTheta), std::sin(startTheta));
+    const Point<float> endDir(std::cos(startTheta + turn), std::sin(startTheta + turn));
+
+    // The primitive runs straight along the start heading for firstLength, turns along an arc, then runs straight along
+    // the end heading for lastLength. The straight lines through the start and end meet where the arc is inscribed.
+    float firstLength = std::sqrt(static_cast<float>(offset.x*offset.x + offset.y*offset.y));
+    float radius = 0.0f;
+    float lastLength = 0.0f;
+
+    if(startHeading != endHeading)
+    {
+        float det = startDir.x*endDir.y - startDir.y*endDir.x;
+        float toCorner = (offset.x*endDir.y - offset.y*endDir.x) / det;
+        float fromCorner = (startDir.x*offset.y - startDir.y*offset.x) / det;
+        assert((toCorner > 0.0f) && (fromCorner > 0.0f));
+
+        // Use the widest arc that fits, which leaves one of the straight segments empty
+        float tangentLength = std::min(toCorner, fromCorner);
+        radius = tangentLength / std::tan(std::abs(turn) / 2.0f);
+        firstLength = toCorner - tangentLength;
+        lastLength = fromCorner - tangentLength;
+    }
+
+    const float arcLength = radius * std::abs(turn);
+    const float turnSign = (turn > 0.0f) ? 1.0f : -1.0f;
+    const Point<float> leftDir(-startDir.y, startDir.x);
+
+    MotionPrimitive primitive;
+    primitive.startHeading = startHeading;
+    primitive.endHeading = endHeading;
+    primitive.offset = offset;
+    primitive.length = firstLength + arcLength + lastLength;
+
+    auto poseAt = [&](float distance, Point<float>& position, float& theta) {
+        float alongFirst = std::min(distance, firstLength);
+        float alongArc = std::min(std::max(distance - firstLength, 0.0f), arcLength);
+        float alongLast = std::max(distance - firstLength - arcLength, 0.0f);
+        float angle = (radius > 0.0f) ? alongArc / radius : 0.0f;
+
+        float forward = alongFirst + radius*std::sin(angle);
+        float sideways = turnSign * radius * (1.0f - std::cos(angle));
+        position.x = startDir.x*forward + leftDir.x*sideways + endDir.x*alongLast;
+        position.y = startDir.y*forward + leftDir.y*sideways + endDir.y*alongLast;
+        theta = wrap_to_pi(startTheta + turnSign*angle);
+    };
+
+    // Sample the path of the center of the robot to find the cells it sweeps
+    for(float distance = 0.0f; distance < primitive.length + kSweepStep; distance += kSweepStep)
+    {
+        Point<float> position;
+        float theta;
+        poseAt(std::min(distance, primitive.length), position, theta);
+
+        cell_t cell(std::lround(position.x), std::lround(position.y));
+        if((cell != cell_t(0, 0))
+            && (std::find(primitive.sweptCells.begin(), primitive.sweptCells.end(), cell) == primitive.sweptCells.end()))
+        {
+            primitive.sweptCells.push_back(cell);
+        }
+    }
+    assert(primitive.sweptCells.back() == offset);
+
+    // Waypoints at the ends of the straight segments and along the arc every half heading bin, so the robot can follow
+    // the arc by driving from waypoint to waypoint
+    std::vector<float> waypointDistances;
+    if((firstLength > 0.0f) && (arcLength > 0.0f))
+    {
+        waypointDistances.push_back(firstLength);
+    }
+    const int numArcSteps = static_cast<int>(std::lround(std::abs(turn) / (kBinWidth / 2.0f)));
+    for(int n = 1; n < numArcSteps; ++n)
+    {
+        waypointDistances.push_back(firstLength + arcLength*n/numArcSteps);
+    }
+    if((lastLength > 0.0f) && (arcLength > 0.0f))
+    {
+        waypointDistances.push_back(firstLength + arcLength);
+    }
+    waypointDistances.push_back(primitive.length);
+
+    for(float distance : waypointDistances)
+    {
+        Point<float> position;
+        float theta;
+        poseAt(distance, position, theta);
+        primitive.poses.push_back(position);
+        primitive.headings.push_back(theta);
+    }
+    // The end is exactly on the cell, rather than wherever rounding left it
+    primitive.poses.back() = Point<float>(offset.x, offset.y);
+
+    primitives_[startHeading].push_back(primitive);
+}
+
+
+void LatticePlanner::addTurnInPlace(int startHeading, int endHeading)
+{
+    MotionPrimitive primitive;
+    primitive.startHeading = startHeading;
+    primitive.endHeading = endHeading;
+    primitive.offset = cell_t(0, 0);
+    primitive.length = 0.0f;
+    primitives_[startHeading].push_back(primitive);
+}
+
+
+const MotionPrimitive* LatticePlanner::findPrimitive(int startHeading, cell_t offset, int endHeading) const
+{
+    for(auto& primitive : primitives_[startHeading])
+    {
+        if((primitive.offset == offset) && (primitive.endHeading == endHeading))
+        {
+            return &primitive;
+        }
+    }
+    return nullptr;
+}
+
+
+int heading_to_bin(float theta)
+{
+    int heading = static_cast<int>(std::lround(theta / kBinWidth)) % LatticePlanner::kNumHeadings;
+    return (heading < 0) ? heading + LatticePlanner::kNumHeadings : heading;
+}
+
+
+float bin_to_heading(int heading)
+{
+    return wrap_to_pi(heading * kBinWidth);
+}
@@ -0,0 +1,126 @@
+#ifndef PLANNING_LATTICE_PLANNER_HPP
+#define PLANNING_LATTICE_PLANNER_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <common/point.hpp>
+#include <vector>
+
+class ObstacleDistanceGrid;
+
+/**
+* MotionPrimitive is a short, drivable motion of the robot between two lattice states. A primitive starts at the
+* center of a cell facing one of the heading bins and ends at the center of another cell facing a heading bin. It's
+* made of a straight segment, a circular arc, and another straight segment, any of which may be empty, so the robot
+* can follow it without stopping. A turn in place has no offset and no swept cells.
+*/
+struct MotionPrimitive
+{
+    int startHeading;                   ///< Heading bin the primitive starts in
+    int endHeading;                     ///< Heading bin the primitive ends in
+    cell_t offset;                      ///< Cell the primitive ends in, relative to the start cell
+    float length;                       ///< Length of the path followed by the center of the robot (cells)
+    std::vector<cell_t> sweptCells;     ///< Cells the center of the robot passes through, relative to the start cell,
+                                        ///< excluding the start cell
+    std::vector<Point<float>> poses;    ///< Waypoints along the primitive relative to the start cell, ending at offset
+    std::vector<float> headings;        ///< Heading of the robot at each waypoint (rad)
+
+    bool isTurnInPlace(void) const { return (offset.x == 0) && (offset.y == 0); }
+};
+
+/**
+* LatticePlanner finds paths through a state lattice, where each state is a cell and one of kNumHeadings heading bins,
+* by searching with A* over a fixed set of motion primitives. Unlike the cell-by-cell paths of search_for_path, which
+* make the robot stop and turn in place at every corner, the paths are made of straight segments and arcs of at most
+* 90 degrees that a differential-drive robot can follow at full speed.
+*
+* The primitives are generated once, at construction, from a table of end cells and headings for the east and northeast
+* headings, which is rotated to give the primitives of the other headings. For each primitive, the cells swept by the
+* center of the robot are cached as offsets from the start cell, so checking a primitive for collisions only looks up
+* the obstacle distance of each offset cell. Like search_for_path, a cell is safe if it's farther than
+* SearchParams::minDistanceToObstacle from the nearest obstacle, which covers the whole circular footprint of the robot.
+*
+* A primitive costs its length plus the distance cost of every cell it sweeps, which matches the costs of grid_astar
+* for straight motions. Turns in place are allowed, so the planner finds a path whenever grid_astar does, but each costs
+* turnInPlaceCost, so they're only used when the robot has no room to turn along an arc, like at the start of a path
+* facing the wrong way.
+*
+* The search starts in the heading bin closest to the start pose's heading and ends in the goal cell facing any
+* heading.
+*/
+class LatticePlanner
+{
+public:
+
+    static const int kNumHeadings = 8;
+
+    /**
+    * Constructor for LatticePlanner.
+    *
+    * \param    turnInPlaceCost     Cost of turning in place by one heading bin (m) (optional, default = 0.5m)
+    */
+    explicit LatticePlanner(float turnInPlaceCost = 0.5f);
+
+    /**
+    * plan finds a path from start to goal.
+    *
+    * \param    start           Starting pose of the robot
+    * \param    goal            Desired goal pose of the robot
+    * \param    distances       Distance to the nearest obstacle for each cell in the grid
+    * \param    params          Parameters specifying the costs and time budget of the search. params.mode is ignored.
+    * \return   The path found to the goal, if one exists. Each pose after the start is a waypoint along a primitive and
+    *   faces the direction of travel there. If the goal is unreachable or params.timeBudgetUs runs out first, then a
+    *   path with just the initial pose is returned, per the robot_path_t specification.
+    */
+    robot_path_t plan(const pose_xyt_t& start,
+                      const pose_xyt_t& goal,
+                      const ObstacleDistanceGrid& distances,
+                      const SearchParams& params);
+
+    /**
+    * primitives retrieves the primitives that start in a heading bin.
+    */
+    const std::vector<MotionPrimitive>& primitives(int heading) const { return primitives_[heading]; }
+
+    /**
+    * numExpanded retrieves the number of states expanded by the last call to plan.
+    */
+    std::size_t numExpanded(void) const { return workspace_.numExpanded(); }
+
+    /**
+    * numTurnsInPlace retrieves the number of turns in place in the path found by the last call to plan.
+    */
+    int numTurnsInPlace(void) const { return numTurnsInPlace_; }
+
+private:
+
+    float turnInPlaceCost_;
+    std::vector<MotionPrimitive> primitives_[kNumHeadings];
+
+    AStarWorkspace workspace_;      // search state, indexed by (y*width + x)*kNumHeadings + heading
+    int numTurnsInPlace_;
+
+    void addPrimitive(int startHeading, cell_t offset, int endHeading);
+    void addTurnInPlace(int startHeading, int endHeading);
+    const MotionPrimitive* findPrimitive(int startHeading, cell_t offset, int endHeading) const;
+};
+
+/**
+* heading_to_bin finds the lattice heading bin closest to a heading.
+*
+* \param    theta           Heading (rad)
+* \return   Closest heading bin in [0, LatticePlanner::kNumHeadings).
+*/
+int heading_to_bin(float theta);
+
+/**
+* bin_to_heading finds the heading at the center of a lattice heading bin.
+*
+* \param    heading         Heading bin
+* \return   Heading of the bin in (-pi, pi] (rad).
+*/
+float bin_to_heading(int heading);
+
+#endif // PLANNING_LATTICE_PLANNER_HPP
@@ -0,0 +1,299 @@
+#include <planning/lattice_planner.hpp>
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/angle_functions.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The lattice planner test checks LatticePlanner:
+*
+*   - every primitive is a smooth motion from the center of its start cell to the center of its end cell, sweeping a
+*     connected chain of cells,
+*   - on the data/astar maps, it finds a path whenever grid_astar does, and every waypoint of the path is safe,
+*   - its paths make the robot stop and turn far less often than the paths of grid_astar.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+const std::vector<std::string> kMaps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+// A change of direction at a waypoint larger than this makes the robot stop and turn in place
+const float kMaxDrivingTurn = 0.5f;
+
+
+bool test_primitives(void);
+bool test_same_reachability(void);
+bool test_fewer_stops(void);
+
+int count_stops(const robot_path_t& path);
+
+
+int main(int argc, char** argv)
+{
+    if(test_primitives())
+    {
+        std::cout << "PASSED: test_primitives\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_primitives\n";
+    }
+
+    if(test_same_reachability())
+    {
+        std::cout << "PASSED: test_same_reachability\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_same_reachability\n";
+    }
+
+    if(test_fewer_stops())
+    {
+        std::cout << "PASSED: test_fewer_stops\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_fewer_stops\n";
+    }
+
+    return 0;
+}
+
+
+bool test_primitives(void)
+{
+    LatticePlanner planner;
+
+    for(int heading = 0; heading < LatticePlanner::kNumHeadings; ++heading)
+    {
+        for(auto& primitive : planner.primitives(heading))
+        {
+            if(primitive.startHeading != heading)
+            {
+                std::cout << "Primitive listed under heading " << heading << " starts at " << primitive.startHeading
+                    << '\n';
+                return false;
+            }
+
+            if(primitive.isTurnInPlace())
+            {
+                if(!primitive.sweptCells.empty() || !primitive.poses.empty())
+                {
+                    std::cout << "Turn in place sweeps cells\n";
+                    return false;
+                }
+                continue;
+            }
+
+            // The center of the robot moves through 8-connected cells, ending in the primitive's cell
+            cell_t previous(0, 0);
+            for(auto& cell : primitive.sweptCells)
+            {
+                if((std::abs(cell.x - previous.x) > 1) || (std::abs(cell.y - previous.y) > 1))
+                {
+                    std::cout << "Swept cells of primitive from heading " << heading << " to " << primitive.offset
+                        << " skip from " << previous << " to " << cell << '\n';
+                    return false;
+                }
+                previous = cell;
+            }
+
+            if(previous != primitive.offset)
+            {
+                std::cout << "Primitive from heading " << heading << " sweeps to " << previous << " instead of "
+                    << primitive.offset << '\n';
+                return false;
+            }
+
+            const Point<float>& end = primitive.poses.back();
+            if((end.x != primitive.offset.x) || (end.y != primitive.offset.y)
+                || (angle_diff_abs(primitive.headings.back(), bin_to_heading(primitive.endHeading)) > 1.0e-4))
+            {
+                std::cout << "Primitive from heading " << heading << " to " << primitive.offset << " ends at " << end
+                    << " facing " << primitive.headings.back() << '\n';
+                return false;
+            }
+
+            float straightDistance = std::sqrt(static_cast<float>(primitive.offset.x*primitive.offset.x
+                + primitive.offset.y*primitive.offset.y));
+            if(primitive.length < straightDistance - 1.0e-4f)
+            {
+                std::cout << "Primitive to " << primitive.offset << " is shorter than a straight line\n";
+                return false;
+            }
+
+            // No waypoint turns the robot more than it can turn while driving
+            float previousHeading = bin_to_heading(heading);
+            for(float theta : primitive.headings)
+            {
+                if(angle_diff_abs(theta, previousHeading) > kMaxDrivingTurn)
+                {
+                    std::cout << "Primitive to " << primitive.offset << " turns sharply\n";
+                    return false;
+                }
+                previousHeading = theta;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_same_reachability(void)
+{
+    const SearchParams params = search_params();
+
+    LatticePlanner planner;
+    AStarWorkspace workspace;
+    bool allCorrect = true;
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries, true))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        for(auto& query : queries)
+        {
+            robot_path_t gridPath = search_for_path(query.start, query.goal, distances, params, workspace);
+            robot_path_t latticePath = planner.plan(query.start, query.goal, distances, params);
+
+            if((gridPath.path_length > 1) != (latticePath.path_length > 1))
+            {
+                std::cout << "A* " << ((gridPath.path_length > 1) ? "found" : "didn't find") << " a path that "
+                    << "the lattice planner " << ((latticePath.path_length > 1) ? "found" : "didn't find")
+                    << " on " << name << " map\n";
+                allCorrect = false;
+                continue;
+            }
+
+            for(std::size_t n = 1; n < latticePath.path.size(); ++n)
+            {
+                cell_t cell = path_cell(latticePath.path[n], distances);
+                if(!distances.isCellInGrid(cell.x, cell.y)
+                    || (distances(cell.x, cell.y) <= params.minDistanceToObstacle*1.000001))
+                {
+                    std::cout << "Lattice path waypoint " << cell << " is too close to an obstacle on " << name
+                        << " map\n";
+                    allCorrect = false;
+                    break;
+                }
+            }
+
+            cell_t goalCell = global_position_to_grid_cell(Point<double>(query.goal.x, query.goal.y), distances);
+            if((latticePath.path_length > 1) && (path_cell(latticePath.path.back(), distances) != goalCell))
+            {
+                std::cout << "Lattice path doesn't end in the goal cell on " << name << " map\n";
+                allCorrect = false;
+            }
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_fewer_stops(void)
+{
+    const SearchParams params = search_params();
+
+    LatticePlanner planner;
+    AStarWorkspace workspace;
+    int totalGridStops = 0;
+    int totalLatticeStops = 0;
+
+    printf("%-8s %12s %12s %12s %12s %12s\n",
+           "map", "A* stops", "stops", "in place", "us/query", "expanded");
+
+    for(auto& name : kMaps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries, true))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        int gridStops = 0;
+        int latticeStops = 0;
+        int turnsInPlace = 0;
+        double totalUs = 0.0;
+        std::size_t totalExpanded = 0;
+
+        for(auto& query : queries)
+        {
+            robot_path_t gridPath = search_for_path(query.start, query.goal, distances, params, workspace);
+
+            auto startTime = std::chrono::steady_clock::now();
+            robot_path_t latticePath = planner.plan(query.start, query.goal, distances, params);
+            auto endTime = std::chrono::steady_clock::now();
+
+            totalUs += std::chrono::duration<double, std::micro>(endTime - startTime).count();
+            totalExpanded += planner.numExpanded();
+
+            gridStops += count_stops(gridPath);
+            latticeStops += count_stops(latticePath);
+            turnsInPlace += planner.numTurnsInPlace();
+        }
+
+        printf("%-8s %12d %12d %12d %12.1f %12.0f\n",
+               name.c_str(),
+               gridStops,
+               latticeStops,
+               turnsInPlace,
+               totalUs / queries.size(),
+               static_cast<double>(totalExpanded) / queries.size());
+
+        totalGridStops += gridStops;
+        totalLatticeStops += latticeStops;
+    }
+
+    return totalLatticeStops * 2 < totalGridStops;
+}
+
+
+int count_stops(const robot_path_t& path)
+{
+    // The robot drives from waypoint to waypoint, so it stops wherever the direction to the next waypoint changes
+    // sharply. It also stops to turn toward the first waypoint if it isn't already facing it.
+    int numStops = 0;
+    float heading = (path.path.empty()) ? 0.0f : path.path.front().theta;
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        float dx = path.path[n].x - path.path[n-1].x;
+        float dy = path.path[n].y - path.path[n-1].y;
+        if((dx == 0.0f) && (dy == 0.0f))
+        {
+            continue;
+        }
+
+        float direction = std::atan2(dy, dx);
+        if(angle_diff_abs(direction, heading) > kMaxDrivingTurn)
+        {
+            ++numStops;
+        }
+        heading = direction;
+    }
+    return numStops;
+}
@@ -0,0 +1,271 @@
+#include <planning/map_generators.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+const int8_t kFreeLogOdds = -10;
+const int8_t kObstacleLogOdds = 10;
+
+// Thickness of the walls drawn by the generators
+const double kWallThickness = 0.1;
+
+
+int meters_to_cells(double meters, const OccupancyGrid& grid)
+{
+    return std::max(static_cast<int>(std::lround(meters * grid.cellsPerMeter())), 1);
+}
+
+
+// Fills the cells in [minX, maxX) x [minY, maxY), clipped to the grid
+void fill_rect(int minX, int minY, int maxX, int maxY, int8_t logOdds, OccupancyGrid& grid)
+{
+    for(int y = std::max(minY, 0); y < std::min(maxY, grid.heightInCells()); ++y)
+    {
+        for(int x = std::max(minX, 0); x < std::min(maxX, grid.widthInCells()); ++x)
+        {
+            grid(x, y) = logOdds;
+        }
+    }
+}
+
+
+void draw_border(int thickness, OccupancyGrid& grid)
+{
+    const int width = grid.widthInCells();
+    const int height = grid.heightInCells();
+    fill_rect(0, 0, width, thickness, kObstacleLogOdds, grid);
+    fill_rect(0, height - thickness, width, height, kObstacleLogOdds, grid);
+    fill_rect(0, 0, thickness, height, kObstacleLogOdds, grid);
+    fill_rect(width - thickness, 0, width, height, kObstacleLogOdds, grid);
+}
+
+
+// std::mt19937 produces the same sequence everywhere, but the std distributions don't, so draw numbers directly
+int random_int(int numValues, std::mt19937& rng)
+{
+    return (numValues > 0) ? static_cast<int>(rng() % static_cast<uint32_t>(numValues)) : 0;
+}
+
+
+double random_fraction(std::mt19937& rng)
+{
+    return rng() / 4294967296.0;
+}
+
+}
+
+
+OccupancyGrid generate_uniform_grid(float widthInMeters, float heightInMeters, float metersPerCell, int8_t logOdds)
+{
+    OccupancyGrid grid(widthInMeters, heightInMeters, metersPerCell);
+    fill_rect(0, 0, grid.widthInCells(), grid.heightInCells(), logOdds, grid);
+    return grid;
+}
+
+
+OccupancyGrid generate_constricted_grid(float widthInMeters,
+                                        float heightInMeters,
+                                        float metersPerCell,
+                                        double openingWidth)
+{
+    OccupancyGrid grid = generate_uniform_grid(widthInMeters, heightInMeters, metersPerCell, kFreeLogOdds);
+
+    // Draw a line right through the middle of the grid. Have the line start after the opening.
+    int openingCellY = grid.heightInCells() / 2;
+    int openingWidthInCells = std::max(static_cast<int>(openingWidth * grid.cellsPerMeter()), 1);
+
+    for(int x = openingWidthInCells; x < grid.widthInCells(); ++x)
+    {
+        grid(x, openingCellY) = kObstacleLogOdds;
+    }
+
+    return grid;
+}
+
+
+OccupancyGrid generate_maze_grid(float sizeInMeters, float metersPerCell, double passageWidth, uint32_t seed)
+{
+    OccupancyGrid grid = generate_uniform_grid(sizeInMeters, sizeInMeters, metersPerCell, kObstacleLogOdds);
+    std::mt19937 rng(seed);
+
+    // The maze is a lattice of square passage cells separated by walls. Carving removes the wall between two of them.
+    const int wall = meters_to_cells(kWallThickness, grid);
+    const int passage = meters_to_cells(passageWidth, grid);
+    const int pitch = passage + wall;
+    const int mazeWidth = std::max((grid.widthInCells() - wall) / pitch, 1);
+    const int mazeHeight = std::max((grid.heightInCells() - wall) / pitch, 1);
+
+    auto carveCell = [&](int mazeX, int mazeY) {
+        int x = wall + mazeX*pitch;
+        int y = wall + mazeY*pitch;
+        fill_rect(x, y, x + passage, y + passage, kFreeLogOdds, grid);
+    };
+
+    // Iterative depth-first search, so large mazes don't overflow the stack
+    std::vector<uint8_t> isVisited(mazeWidth * mazeHeight, 0);
+    std::vector<std::pair<int, int>> stack;
+    stack.push_back(std::make_pair(0, 0));
+    isVisited[0] = 1;
+    carveCell(0, 0);
+
+    const int xDeltas[4] = { 1, -1, 0, 0 };
+    const int yDeltas[4] = { 0, 0, 1, -1 };
+
+    while(!stack.empty())
+    {
+        int mazeX = stack.back().first;
+        int mazeY = stack.back().second;
+
+        int unvisited[4];
+        int numUnvisited = 0;
+        for(int n = 0; n < 4; ++n)
+        {
+            int neighborX = mazeX + xDeltas[n];
+            int neighborY = mazeY + yDeltas[n];
+            if((neighborX >= 0) && (neighborX < mazeWidth) && (neighborY >= 0) && (neighborY < mazeHeight)
+                && !isVisited[neighborY*mazeWidth + neighborX])
+            {
+                unvisited[numUnvisited++] = n;
+            }
+        }
+
+        if(numUnvisited == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int direction = unvisited[random_int(numUnvisited, rng)];
+        int neighborX = mazeX + xDeltas[direction];
+        int neighborY = mazeY + yDeltas[direction];
+
+        // The wall between the cells spans the passage on the side facing the neighbor
+        int wallX = wall + std::min(mazeX, neighborX)*pitch + ((neighborX != mazeX) ? passage : 0);
+        int wallY = wall + std::min(mazeY, neighborY)*pitch + ((neighborY != mazeY) ? passage : 0);
+        fill_rect(wallX,
+                  wallY,
+                  wallX + ((neighborX != mazeX) ? wall : passage),
+                  wallY + ((neighborY != mazeY) ? wall : passage),
+                  kFreeLogOdds,
+                  grid);
+        carveCell(neighborX, neighborY);
+
+        isVisited[neighborY*mazeWidth + neighborX] = 1;
+        stack.push_back(std::make_pair(neighborX, neighborY));
+    }
+
+    return grid;
+}
+
+
+OccupancyGrid generate_office_grid(float sizeInMeters, float metersPerCell, double roomSize, uint32_t seed)
+{
+    OccupancyGrid grid = generate_uniform_grid(sizeInMeters, sizeInMeters, metersPerCell, kFreeLogOdds);
+    std::mt19937 rng(seed);
+
+    const int kRoomsPerWing = 5;                    // rooms between vertical hallways
+    const double kNeighborDoorProbability = 0.3;
+
+    const int wall = meters_to_cells(kWallThickness, grid);
+    const int room = meters_to_cells(roomSize, grid);
+    const int hall = meters_to_cells(2.0, grid);
+    const int door = std::min(meters_to_cells(1.0, grid), room);
+
+    // The floor is made of blocks, each a horizontal hallway above two rows of rooms, and wings, each a vertical
+    // hallway left of a row of rooms. Hallways run the whole width and height of the floor.
+    const int blockHeight = hall + 2*room + 3*wall;
+    const int wingWidth = hall + kRoomsPerWing*(room + wall) + wall;
+
+    for(int blockY = wall; blockY < grid.heightInCells(); blockY += blockHeight)
+    {
+        const int roomsY = blockY + hall;
+        const int firstRowY = roomsY + wall;
+        const int secondRowY = firstRowY + room + wall;
+
+        for(int wingX = wall; wingX < grid.widthInCells(); wingX += wingWidth)
+        {
+            const int roomsX = wingX + hall;
+            const int roomsEndX = roomsX + kRoomsPerWing*(room + wall) + wall;
+
+            // Walls between the rows of rooms and the hallways
+            for(int lineY : { roomsY, firstRowY + room, secondRowY + room })
+            {
+                fill_rect(roomsX, lineY, roomsEndX, lineY + wall, kObstacleLogOdds, grid);
+            }
+
+            // Walls between the rooms
+            for(int n = 0; n <= kRoomsPerWing; ++n)
+            {
+                int wallX = roomsX + n*(room + wall);
+                fill_rect(wallX, roomsY, wallX + wall, secondRowY + room + wall, kObstacleLogOdds, grid);
+            }
+
+            // Doors into the hallway above the first row and below the second row, plus a few between neighbors.
+            // Rooms cut off by the edge of the floor get their doors in the part that's inside it. If the hallway
+            // below the second row is cut off, its rooms open into the first row instead.
+            const bool hasLowerHall = secondRowY + room + wall + hall <= grid.heightInCells() - wall;
+            const int lowerDoorY = hasLowerHall ? secondRowY + room : firstRowY + room;
+
+            for(int n = 0; n < kRoomsPerWing; ++n)
+            {
+                int roomX = roomsX + wall + n*(room + wall);
+                int visibleWidth = std::min(room, grid.widthInCells() - wall - roomX);
+                if(visibleWidth <= 0)
+                {
+                    break;
+                }
+
+                int doorWidth = std::min(door, visibleWidth);
+                int doorX = roomX + random_int(visibleWidth - doorWidth + 1, rng);
+                fill_rect(doorX, roomsY, doorX + doorWidth, roomsY + wall, kFreeLogOdds, grid);
+
+                doorX = roomX + random_int(visibleWidth - doorWidth + 1, rng);
+                fill_rect(doorX, lowerDoorY, doorX + doorWidth, lowerDoorY + wall, kFreeLogOdds, grid);
+
+                for(int rowY : { firstRowY, secondRowY })
+                {
+                    if((n + 1 < kRoomsPerWing) && (random_fraction(rng) < kNeighborDoorProbability))
+                    {
+                        int doorY = rowY + random_int(room - door + 1, rng);
+                        fill_rect(roomX + room, doorY, roomX + room + wall, doorY + door, kFreeLogOdds, grid);
+                    }
+                }
+            }
+        }
+    }
+
+    draw_border(wall, grid);
+    return grid;
+}
+
+
+OccupancyGrid generate_cluttered_grid(float sizeInMeters, float metersPerCell, double density, uint32_t seed)
+{
+    OccupancyGrid grid = generate_uniform_grid(sizeInMeters, sizeInMeters, metersPerCell, kFreeLogOdds);
+    std::mt19937 rng(seed);
+
+    // Box sides are uniform between the minimum and maximum, so the expected box area is known up front
+    const double kMinBoxSide = 0.2;
+    const double kMaxBoxSide = 1.0;
+    const double meanSide = (kMinBoxSide + kMaxBoxSide) / 2.0;
+    const double meanArea = meanSide * meanSide;
+    const int numBoxes = static_cast<int>(density * sizeInMeters * sizeInMeters / meanArea);
+
+    for(int n = 0; n < numBoxes; ++n)
+    {
+        int boxWidth = meters_to_cells(kMinBoxSide + random_fraction(rng)*(kMaxBoxSide - kMinBoxSide), grid);
+        int boxHeight = meters_to_cells(kMinBoxSide + random_fraction(rng)*(kMaxBoxSide - kMinBoxSide), grid);
+        int x = random_int(grid.widthInCells(), rng);
+        int y = random_int(grid.heightInCells(), rng);
+        fill_rect(x, y, x + boxWidth, y + boxHeight, kObstacleLogOdds, grid);
+    }
+
+    draw_border(meters_to_cells(kWallThickness, grid), grid);
+    return grid;
+}
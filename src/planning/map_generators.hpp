@@ -0,0 +1,73 @@
+#ifndef PLANNING_MAP_GENERATORS_HPP
+#define PLANNING_MAP_GENERATORS_HPP
+
+#include <slam/occupancy_grid.hpp>
+#include <cstdint>
+
+/**
+* The map generators create occupancy grids for testing and benchmarking the planners. Free cells have logOdds -10 and
+* obstacles have logOdds 10. Generators that take a seed create the same map for the same seed on every platform.
+*/
+
+/**
+* generate_uniform_grid creates a grid where every cell has the same log-odds.
+*
+* \param    widthInMeters       Width of the grid
+* \param    heightInMeters      Height of the grid
+* \param    metersPerCell       Resolution of the grid
+* \param    logOdds             Log-odds of every cell
+* \return   The uniform grid.
+*/
+OccupancyGrid generate_uniform_grid(float widthInMeters, float heightInMeters, float metersPerCell, int8_t logOdds);
+
+/**
+* generate_constricted_grid creates an empty grid with a wall across the middle. The only way past the wall is an
+* opening at its left end.
+*
+* \param    widthInMeters       Width of the grid
+* \param    heightInMeters      Height of the grid
+* \param    metersPerCell       Resolution of the grid
+* \param    openingWidth        Width of the opening (m)
+* \return   The constricted grid.
+*/
+OccupancyGrid generate_constricted_grid(float widthInMeters,
+                                        float heightInMeters,
+                                        float metersPerCell,
+                                        double openingWidth);
+
+/**
+* generate_maze_grid creates a square maze with a single path between any two of its passages. The maze is carved by
+* a depth-first search, so it has long winding passages, like the worst case for a planner.
+*
+* \param    sizeInMeters        Width and height of the grid
+* \param    metersPerCell       Resolution of the grid
+* \param    passageWidth        Width of the passages (m)
+* \param    seed                Seed for the random carving
+* \return   The maze grid.
+*/
+OccupancyGrid generate_maze_grid(float sizeInMeters, float metersPerCell, double passageWidth, uint32_t seed);
+
+/**
+* generate_office_grid creates a square office floor: rows of rooms along hallways. Each room has a door to the
+* hallway and some have doors to their neighbors.
+*
+* \param    sizeInMeters        Width and height of the grid
+* \param    metersPerCell       Resolution of the grid
+* \param    roomSize            Width of the rooms (m)
+* \param    seed                Seed for the placement of the doors
+* \return   The office grid.
+*/
+OccupancyGrid generate_office_grid(float sizeInMeters, float metersPerCell, double roomSize, uint32_t seed);
+
+/**
+* generate_cluttered_grid creates a square open area filled with randomly placed boxes, like a warehouse or lab floor.
+*
+* \param    sizeInMeters        Width and height of the grid
+* \param    metersPerCell       Resolution of the grid
+* \param    density             Fraction of the area covered by boxes, which may overlap
+* \param    seed                Seed for the placement of the boxes
+* \return   The cluttered grid.
+*/
+OccupancyGrid generate_cluttered_grid(float sizeInMeters, float metersPerCell, double density, uint32_t seed);
+
+#endif // PLANNING_MAP_GENERATORS_HPP
@@ -3,12 +3,24 @@
 #include <common/grid_utils.hpp>
 #include <common/timestamp.h>
 #include <lcmtypes/robot_path_t.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
+#include <thread>
 
 
 MotionPlanner::MotionPlanner(const MotionPlannerParams& params)
 : params_(params)
+, hasCostField_(false)
+, mapGeneration_(0)
+, numExpanded_(0)
+, hasSignedDistances_(false)
+, num_frontiers(0)
+, hasPrevGoal_(false)
 {
+    prev_goal.utime = 0;
+    prev_goal.x = prev_goal.y = prev_goal.theta = 0.0f;
     setParams(params);
 }
 
@@ -16,7 +28,15 @@ MotionPlanner::MotionPlanner(const MotionPlannerParams& params)
 MotionPlanner::MotionPlanner(const MotionPlannerParams& params, const SearchParams& searchParams)
 : params_(params)
 , searchParams_(searchParams)
+, hasCostField_(false)
+, mapGeneration_(0)
+, numExpanded_(0)
+, hasSignedDistances_(false)
+, num_frontiers(0)
+, hasPrevGoal_(false)
 {
+    prev_goal.utime = 0;
+    prev_goal.x = prev_goal.y = prev_goal.theta = 0.0f;
 }
 
 
@@ -24,6 +44,8 @@ robot_path_t MotionPlanner::planPath(const pose_xyt_t& start,
                                      const pose_xyt_t& goal, 
                                      const SearchParams& searchParams) const
 {
+    numExpanded_ = 0;
+
     // If the goal isn't valid, then no path can actually exist
     if(!isValidGoal(goal))
     {
@@ -38,8 +60,40 @@ robot_path_t MotionPlanner::planPath(const pose_xyt_t& start,
 
         return failedPath;
     }
-    // Otherwise, use A* to find the path
-    return search_for_path(start, goal, distances_, searchParams);
+    // Otherwise, use the path from an earlier search if there is one, or use A* to find the path
+    robot_path_t path;
+    if(searchParams.mode == state_lattice)
+    {
+        path = latticePlanner_.plan(start, goal, distances_, searchParams);
+        numExpanded_ = latticePlanner_.numExpanded();
+        return path;
+    }
+
+    if(searchParams.mode == anytime_astar)
+    {
+        path = anytimePlanner_.plan(start, goal, distances_, searchParams);
+        numExpanded_ = anytimePlanner_.numExpanded();
+        return refinePath(path);
+    }
+
+    // The cache keeps every cell of the path, so a query sharing cells with a cached one can reuse it
+    if(pathCache_.find(start, goal, searchParams, distances_, mapGeneration_, path))
+    {
+        return refinePath(path);
+    }
+
+    if(searchParams.mode == hierarchical)
+    {
+        path = hierarchicalPlanner_.plan(start, goal, distances_, searchParams);
+        numExpanded_ = hierarchicalPlanner_.numExpanded();
+    }
+    else
+    {
+        path = search_for_path(start, goal, distances_, withLandmarks(searchParams), workspace_);
+        numExpanded_ = workspace_.numExpanded();
+    }
+    pathCache_.insert(start, goal, searchParams, distances_, mapGeneration_, path);
+    return refinePath(path);
 }
 
 
@@ -49,13 +103,228 @@ robot_path_t MotionPlanner::planPath(const pose_xyt_t& start, const pose_xyt_t&
 }
 
 
+std::vector<PlanResult> MotionPlanner::planBatch(const std::vector<PlanQuery>& queries, int numThreads) const
+{
+    std::vector<PlanResult> results(queries.size());
+
+    if(numThreads <= 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min(numThreads, std::max(static_cast<int>(queries.size()), 1));
+
+    // The hierarchical planner's clusters are rebuilt and searched by every query, so they can't be shared
+    if(searchParams_.mode == hierarchical)
+    {
+        numThreads = 1;
+    }
+
+    if(batchWorkers_.size() < static_cast<std::size_t>(numThreads))
+    {
+        batchWorkers_.resize(numThreads);
+    }
+
+    // The workers only read the signed distances, so they're brought up to date before the workers start
+    updateSignedDistances();
+
+    // Each worker takes the next query nobody has started until none are left
+    std::atomic<std::size_t> nextQuery(0);
+    auto runWorker = [&](int workerIndex) {
+        for(std::size_t n = nextQuery++; n < queries.size(); n = nextQuery++)
+        {
+            results[n] = planQuery(queries[n], batchWorkers_[workerIndex], workerIndex);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for(int n = 1; n < numThreads; ++n)
+    {
+        threads.emplace_back(runWorker, n);
+    }
+
+    runWorker(0);
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return results;
+}
+
+
+PlanResult MotionPlanner::planQuery(const PlanQuery& query, BatchWorker& worker, int workerIndex) const
+{
+    PlanResult result;
+    result.numExpanded = 0;
+    result.worker = workerIndex;
+
+    int64_t startTime = utime_now();
+
+    // Same as planPath, without the PathCache
+    if(!isValidGoal(query.goal))
+    {
+        result.path.utime = startTime;
+        result.path.path.push_back(query.start);
+        result.path.path_length = result.path.path.size();
+    }
+    else if(searchParams_.mode == hierarchical)
+    {
+        result.path = hierarchicalPlanner_.plan(query.start, query.goal, distances_, searchParams_);
+        result.numExpanded = hierarchicalPlanner_.numExpanded();
+    }
+    else if(searchParams_.mode == state_lattice)
+    {
+        result.path = worker.latticePlanner.plan(query.start, query.goal, distances_, searchParams_);
+        result.numExpanded = worker.latticePlanner.numExpanded();
+    }
+    else if(searchParams_.mode == anytime_astar)
+    {
+        result.path = worker.anytimePlanner.plan(query.start, query.goal, distances_, searchParams_);
+        result.numExpanded = worker.anytimePlanner.numExpanded();
+    }
+    else
+    {
+        result.path = search_for_path(query.start, query.goal, distances_, withLandmarks(searchParams_),
+                                      worker.workspace);
+        result.numExpanded = worker.workspace.numExpanded();
+    }
+
+    if(searchParams_.mode != state_lattice)
+    {
+        result.path = refinePath(result.path);
+    }
+
+    result.planTimeUs = utime_now() - startTime;
+    return result;
+}
+
+
+SearchParams MotionPlanner::withLandmarks(const SearchParams& searchParams) const
+{
+    // The tables only give a valid bound for the costs they were built with
+    SearchParams params = searchParams;
+    if((params.mode == grid_astar) && landmarks_.hasSameCosts(params))
+    {
+        params.landmarks = &landmarks_;
+    }
+    return params;
+}
+
+
+robot_path_t MotionPlanner::refinePath(const robot_path_t& path) const
+{
+    robot_path_t refinedPath = params_.shortcutPaths ? shortcut_path(path, cspace_) : path;
+
+    if(params_.optimizePaths && (refinedPath.path_length > 1))
+    {
+        PathOptimizerParams optimizerParams;
+        optimizerParams.minClearance = searchParams_.minDistanceToObstacle;
+        optimizerParams.desiredClearance = 3.0 * searchParams_.minDistanceToObstacle;
+
+        updateSignedDistances();
+
+        // The band only checks the cells it moves through, so check the whole path before trusting it
+        robot_path_t optimizedPath = optimize_path(refinedPath, signedDistances_, optimizerParams);
+        if(cspace_.isPathFree(optimizedPath))
+        {
+            refinedPath = optimizedPath;
+        }
+    }
+
+    return refinedPath;
+}
+
+
+void MotionPlanner::updateSignedDistances(void) const
+{
+    if(params_.optimizePaths && !hasSignedDistances_)
+    {
+        signedDistances_.build(distances_);
+        hasSignedDistances_ = true;
+    }
+}
+
+
+robot_path_t MotionPlanner::replanPath(const pose_xyt_t& start, const pose_xyt_t& goal)
+{
+    auto goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances_);
+
+    // Keep repairing the same search as long as the goal doesn't change
+    if(incrementalPlanner_.hasSearch() && (incrementalPlanner_.goalCell() == goalCell))
+    {
+        return refinePath(incrementalPlanner_.replan(start, distances_));
+    }
+
+    return refinePath(incrementalPlanner_.plan(start, goal, distances_, searchParams_));
+}
+
+
+void MotionPlanner::expandCostField(const pose_xyt_t& start) const
+{
+    costFieldStart_ = start;
+    hasCostField_ = true;
+    expand_cost_field(start, distances_, searchParams_, costField_);
+}
+
+
+float MotionPlanner::costToReach(const pose_xyt_t& goal) const
+{
+    auto goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances_);
+
+    if(!hasCostField_ || !distances_.isCellInGrid(goalCell.x, goalCell.y))
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // Only closed cells are sure to have their cheapest cost if the field ran out of time
+    int goalIndex = goalCell.y*distances_.widthInCells() + goalCell.x;
+    return costField_.isClosed(goalIndex) ? costField_.gCost(goalIndex) : std::numeric_limits<float>::infinity();
+}
+
+
+robot_path_t MotionPlanner::pathFromCostField(const pose_xyt_t& goal) const
+{
+    if(costToReach(goal) == std::numeric_limits<float>::infinity())
+    {
+        robot_path_t failedPath;
+        failedPath.utime = costFieldStart_.utime;
+        failedPath.path.push_back(costFieldStart_);
+        failedPath.path_length = failedPath.path.size();
+        return failedPath;
+    }
+
+    return refinePath(path_in_cost_field(costFieldStart_, goal, distances_, costField_));
+}
+
+
+bool MotionPlanner::useLandmarks(const std::string& mapFilename, int numLandmarks)
+{
+    const std::string tablesFilename = mapFilename + ".alt";
+
+    if(!mapFilename.empty() && landmarks_.loadFromFile(tablesFilename) && landmarks_.matches(distances_, searchParams_))
+    {
+        return true;
+    }
+
+    landmarks_.build(distances_, searchParams_, numLandmarks);
+
+    if(!mapFilename.empty())
+    {
+        landmarks_.saveToFile(tablesFilename);
+    }
+    return false;
+}
+
+
 bool MotionPlanner::isValidGoal(const pose_xyt_t& goal) const
 {
     float dx = goal.x - prev_goal.x, dy = goal.y - prev_goal.y;
     float distanceFromPrev = std::sqrt(dx * dx + dy * dy);
 
-    //if there's more than 1 frontier, don't go to a target that is within a robot diameter of the current pose
-    if(num_frontiers != 1 && distanceFromPrev < 2 * searchParams_.minDistanceToObstacle) return false;
+    //if there's more than 1 frontier, don't go to a target that is within a robot diameter of the previous goal
+    if(hasPrevGoal_ && num_frontiers != 1 && distanceFromPrev < 2 * searchParams_.minDistanceToObstacle) return false;
 
     auto goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances_);
 
@@ -75,38 +344,108 @@ bool MotionPlanner::isValidGoal(const pose_xyt_t& goal) const
 
 bool MotionPlanner::isPathSafe(const robot_path_t& path) const
 {
-
-    ///////////// TODO: Implement your test for a safe path here //////////////////
-    std::cout << "Check if the path is safe!" << std::endl;
-    for (unsigned i=0; i< path.path.size(); i++){
-        pose_xyt_t pose = path.path[i];
-        int x = pose.x/distances_.metersPerCell() + distances_.widthInCells()/2;
-        int y = pose.y/distances_.metersPerCell() + distances_.heightInCells()/2;
-        if(distances_(x, y) <= searchParams_.minDistanceToObstacle){
-            return false;
-        }
-    }
-    return true;
-
-    // if(path.path_length < 2)
-    // {
-    //     return false;
-    // }
-    // return true;
+    return cspace_.isPathFree(path);
 }
 
 
 void MotionPlanner::setMap(const OccupancyGrid& map)
 {
-    distances_.setDistances(map);
+    // The background search reads the distances
+    anytimePlanner_.stopImproving();
+
+    // Consecutive maps usually differ in only a few cells, so only repair the distances around the changes
+    std::vector<int> changedCells;
+    bool wasIncremental = distances_.updateDistances(map, &changedCells);
+
+    // The cost field was found with the old distances
+    hasCostField_ = false;
+
+    // Only the changed cells can have moved in or out of the configuration space
+    if(wasIncremental)
+    {
+        cspace_.updateCells(changedCells, distances_);
+    }
+    else
+    {
+        cspace_.build(distances_, searchParams_.minDistanceToObstacle);
+    }
+
+    // Allocate the anytime search state now, so it doesn't count against the time budget of the next planPath
+    if(searchParams_.mode == anytime_astar)
+    {
+        anytimePlanner_.reserve(distances_);
+    }
+
+    // Cached paths are only checked again if the distances changed. Their cells mean nothing in a different grid.
+    if(!wasIncremental)
+    {
+        pathCache_.clear();
+    }
+    if(!wasIncremental || !changedCells.empty())
+    {
+        ++mapGeneration_;
+        landmarks_.clear();
+
+        // SLAM sends maps faster than paths are planned, so the signed distances are only rebuilt by the next path
+        // that's optimized
+        hasSignedDistances_ = false;
+    }
+
+    // Only the clusters around the changed cells need to be rebuilt
+    if(wasIncremental)
+    {
+        hierarchicalPlanner_.updateCells(changedCells, distances_);
+    }
+    else
+    {
+        hierarchicalPlanner_.clear();
+    }
+
+    if(!incrementalPlanner_.hasSearch())
+    {
+        return;
+    }
+
+    // If the grid itself moved or changed size, the old search doesn't apply to it anymore
+    if(!wasIncremental)
+    {
+        incrementalPlanner_.clear();
+        return;
+    }
+
+    incrementalPlanner_.updateCells(changedCells, distances_);
 }
 
 
 void MotionPlanner::setParams(const MotionPlannerParams& params)
 {
+    // The background search reads the search parameters
+    anytimePlanner_.stopImproving();
+
+    const bool isNewRadius = params.robotRadius != params_.robotRadius;
+    params_ = params;
+
     searchParams_.minDistanceToObstacle = params_.robotRadius;
     searchParams_.maxDistanceWithCost = 10.0 * searchParams_.minDistanceToObstacle;
     searchParams_.distanceCostExponent = 1.0;
+    searchParams_.mode = params_.searchMode;
+    searchParams_.timeBudgetUs = params_.timeBudgetUs;
+
+    // The radius decides which cells are free and what every step costs, so nothing found with the old one applies
+    if(isNewRadius)
+    {
+        cspace_.build(distances_, searchParams_.minDistanceToObstacle);
+        pathCache_.clear();
+        landmarks_.clear();
+        hierarchicalPlanner_.clear();
+        incrementalPlanner_.clear();
+        hasCostField_ = false;
+    }
+
+    if(searchParams_.mode == anytime_astar)
+    {
+        anytimePlanner_.reserve(distances_);
+    }
 }
 
 robot_path_t MotionPlanner::planPathBackHome(pose_xyt_t& start, pose_xyt_t& goal)
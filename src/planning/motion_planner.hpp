@@ -3,19 +3,38 @@
 
 #include <lcmtypes/robot_path_t.hpp>
 #include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/anytime_planner.hpp>
 #include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/configuration_space_bitmap.hpp>
+#include <planning/dstar_lite.hpp>
+#include <planning/hierarchical_planner.hpp>
+#include <planning/landmark_heuristic.hpp>
+#include <planning/lattice_planner.hpp>
 #include <planning/obstacle_distance_grid.hpp>
+#include <planning/path_cache.hpp>
+#include <planning/path_optimizer.hpp>
+#include <planning/path_shortcutting.hpp>
+#include <planning/signed_distance_field.hpp>
 #include <planning/frontiers.hpp>
 
 //for visualization
 #include <vector>
 #include <common/point.hpp>
+#include <cstdint>
 /**
 * MotionPlannerParams defines the parameters that control the behavior of the motion planner.
 */
 struct MotionPlannerParams
 {
     double robotRadius;     ///< Radius of the robot for which paths are being planned
+    SearchMode searchMode;  ///< Algorithm used to search for paths -- see SearchMode
+    int64_t timeBudgetUs;   ///< Time the anytime_astar and state_lattice search modes may take to plan a path, and
+                            ///< expandCostField may take to expand the field (us), or 0 for no limit
+    bool shortcutPaths;     ///< Flag indicating if planned paths skip every pose the robot can drive straight past
+                            ///< -- see shortcut_path
+    bool optimizePaths;     ///< Flag indicating if planned paths are refined for clearance and smoothness -- see
+                            ///< optimize_path
 
     /**
     * Default constructor for MotionPlannerParams.
@@ -29,11 +48,37 @@ struct MotionPlannerParams
     */
     MotionPlannerParams(void)
     : robotRadius(0.2) // by default, have a little extra slop to keep the robot from getting too close to the walls
+    , searchMode(grid_astar)
+    , timeBudgetUs(0)
+    , shortcutPaths(false)
+    , optimizePaths(false)
     {
     }
 };
 
 
+/**
+* PlanQuery is one pair of poses in a batch of queries -- see MotionPlanner::planBatch.
+*/
+struct PlanQuery
+{
+    pose_xyt_t start;           ///< Starting pose for the path
+    pose_xyt_t goal;            ///< Goal pose for the path
+};
+
+
+/**
+* PlanResult is the answer to one PlanQuery, along with the work it took.
+*/
+struct PlanResult
+{
+    robot_path_t path;          ///< Path found from start to goal, or just the start pose if there is none
+    std::size_t numExpanded;    ///< Cells expanded by the search, 0 if the goal was rejected
+    int64_t planTimeUs;         ///< Time taken to plan the path (us)
+    int worker;                 ///< Index of the worker thread that planned the path
+};
+
+
 /**
 * MotionPlanner is simple motion planning implementation for MAEbots. The MotionPlanner uses an A* search to find the
 * shortest path to a goal in the MAEbot's configuration space.
@@ -45,6 +90,30 @@ struct MotionPlannerParams
 *   - Select a valid goal pose using the isValidGoal method, which confirms that the goal isn't too close to a wall
 *     for the robot to reach
 *   - Find a path to the goal using the planPath method. Use the robot's current estimated pose as the start.
+*
+* The planner keeps the A* search state for every cell between calls to planPath, so a MotionPlanner should only be
+* used by one thread at a time. Keep the same MotionPlanner around rather than creating a new one for each plan.
+*
+* The paths found by planPath are also kept in a PathCache. Repeating a query, or asking for a path between poses in the
+* same start and goal cells, returns the cached path without searching again, as long as setMap hasn't made the path
+* untraversable since it was found.
+*
+* With the hierarchical search mode, planPath uses a HierarchicalPlanner, whose clusters are kept between calls and
+* rebuilt only around the cells each setMap changes.
+*
+* With the state_lattice search mode, planPath uses a LatticePlanner, whose paths of arcs and straight segments start
+* facing the start pose's heading. Since they depend on the heading, they aren't kept in the PathCache.
+*
+* With the anytime_astar search mode, planPath uses an AnytimePlanner, which returns the best path it finds within
+* SearchParams::timeBudgetUs, so a hard query can't stall the caller. suboptimalityBound says how far from the cheapest
+* path it can be, and improvePathInBackground keeps looking for cheaper paths, which improvedPath retrieves. Since the
+* paths depend on the time taken, they aren't kept in the PathCache.
+*
+* When the map doesn't change, as when only localizing in a known map, useLandmarks speeds up the grid_astar search
+* mode with landmark tables built once for the map -- see LandmarkHeuristic.
+*
+* Many independent queries against the same map, like checking which of many goals can be reached, can be planned
+* together with planBatch, which spreads them over several threads.
 */
 class MotionPlanner
 {
@@ -80,6 +149,15 @@ public:
     * of poses at the endpoints of lines defined by the path's cells. If the returned path still has too many turns,
     * additional poses can be removed by checking if skipping them doesn't result in the robot hitting a wall.
     * 
+    * Paths are kept in the planner's PathCache, so repeated queries are answered without a search -- see pathCache.
+    *
+    * If MotionPlannerParams::shortcutPaths is set, every pose the robot can drive straight past is removed from the
+    * path, leaving a pose only where the path turns around an obstacle -- see shortcut_path. If
+    * MotionPlannerParams::optimizePaths is set, the path is then pushed away from obstacles within three times the
+    * robot's radius and smoothed by an elastic band through the map's SignedDistanceField -- see optimize_path. If the
+    * optimized path isn't safe by isPathSafe, the path is returned without optimizing it. Paths planned with the
+    * state_lattice search mode are never refined, since they already follow smooth motions.
+    * 
     * \param    start           Starting pose for the path
     * \param    goal            Goal pose for the path
     * \param    searchParams    Parameters to provide to the A* planner to fine-tune its behavior
@@ -100,6 +178,114 @@ public:
     */
     robot_path_t planPath(const pose_xyt_t& start, const pose_xyt_t& goal) const;
 
+    /**
+    * planBatch plans a path for each of a batch of queries, using the SearchParams provided during construction. The
+    * queries are handed out one at a time to a pool of worker threads, so long and short queries balance out across
+    * the threads. The workers share the obstacle distances, which are only read, and each has its own search state,
+    * which is kept between calls so large grids aren't allocated again for every batch.
+    *
+    * Each path is the same one planPath would find. The PathCache is neither checked nor updated, though, since the
+    * workers would contend for it. In the hierarchical search mode, the queries share the planner's clusters, so they
+    * are planned one at a time on the calling thread.
+    *
+    * Like planPath, planBatch must not be called while another thread is using the MotionPlanner.
+    *
+    * \param    queries         Start and goal poses of each path to plan
+    * \param    numThreads      Number of threads to plan with, including the calling thread (optional, default = 0,
+    *   which uses one per core)
+    * \return   Result of each query, in the same order as queries.
+    */
+    std::vector<PlanResult> planBatch(const std::vector<PlanQuery>& queries, int numThreads = 0) const;
+
+    /**
+    * suboptimalityBound retrieves how many times the cost of the cheapest path the last path found by planPath in the
+    * anytime_astar search mode can cost at most, or the best path found since by improvePathInBackground. It's 1 if
+    * the path is the cheapest, and infinity if no path was found.
+    */
+    float suboptimalityBound(void) const { return anytimePlanner_.suboptimalityBound(); }
+
+    /**
+    * improvePathInBackground keeps searching for cheaper paths than the last one found by planPath in the
+    * anytime_astar search mode, on a background thread, until the cheapest path is found. The search is stopped by the
+    * next call to planPath or setMap.
+    */
+    void improvePathInBackground(void) const { anytimePlanner_.improveInBackground(); }
+
+    /**
+    * improvedPath retrieves the best path found so far for the last query planned in the anytime_astar search mode,
+    * including by improvePathInBackground. The path is refined like planPath's.
+    */
+    robot_path_t improvedPath(void) const { return refinePath(anytimePlanner_.bestPath()); }
+
+    /**
+    * replanPath finds a path like planPath, but keeps its search between calls using D* Lite. If the goal is the same
+    * as the last call to replanPath, only the parts of the search affected by the cells changed in setMap since then
+    * and by the robot's motion are repaired, which costs roughly as much as the change instead of a new search.
+    * Otherwise, a new search is started.
+    *
+    * Use replanPath to keep the path to a fixed goal, like the home pose, up to date while the map is changing. The
+    * search always uses 4-connected cells, regardless of the search mode. The path is refined like planPath's.
+    *
+    * \param    start           Current pose of the robot
+    * \param    goal            Goal pose for the path
+    * \return   Path found from start to end. If no path is found, then the path length is 1 and contains only the start
+    *   pose.
+    */
+    robot_path_t replanPath(const pose_xyt_t& start, const pose_xyt_t& goal);
+
+    /**
+    * expandCostField runs a single Dijkstra search from the start through the robot's configuration space, finding the
+    * cost of the cheapest path to every reachable cell. Afterward, costToReach and pathFromCostField answer queries for
+    * any goal without another search, which makes choosing among many candidate goals, like the cells around the
+    * frontiers, cost one search instead of one per candidate.
+    *
+    * The field is kept until the next call to expandCostField or setMap. It uses the same costs as the grid_astar mode
+    * of planPath, regardless of the search mode. If MotionPlannerParams::timeBudgetUs is set, the search stops when the
+    * budget runs out, and only the cells cheaper to reach than the last one expanded count as reachable, so a large map
+    * can't stall the caller -- see expand_cost_field.
+    *
+    * \param    start           Starting pose for all paths in the field
+    */
+    void expandCostField(const pose_xyt_t& start) const;
+
+    /**
+    * costToReach retrieves the cost of the cheapest path to a goal in the last cost field.
+    *
+    * \param    goal            Goal pose
+    * \return   Cost of the path to goal, or infinity if the goal can't be reached.
+    */
+    float costToReach(const pose_xyt_t& goal) const;
+
+    /**
+    * pathFromCostField retrieves the cheapest path from the start of the last cost field to a goal. The cost is
+    * proportional to the length of the path. The path is refined like planPath's.
+    *
+    * \param    goal            Goal pose for the path
+    * \return   Path found from the start to goal. If goal can't be reached, then the path length is 1 and contains only
+    *   the start pose.
+    */
+    robot_path_t pathFromCostField(const pose_xyt_t& goal) const;
+
+    /**
+    * useLandmarks builds landmark tables for the current map, which the grid_astar search mode of planPath and
+    * planBatch then uses to expand far fewer cells in maps with long detours, like mazes. The paths cost the same.
+    *
+    * Building the tables takes one Dijkstra search per landmark, so they are saved to mapFilename + ".alt" and loaded
+    * from there the next time, if the map and search parameters are still the same. Call useLandmarks after setMap.
+    * The tables are dropped as soon as setMap changes the obstacle distances.
+    *
+    * \param    mapFilename     Name of the file the map was loaded from, or "" to not save or load the tables
+    * \param    numLandmarks    Number of landmarks to build tables for, if they aren't loaded (optional, default = 8)
+    * \return   True if the tables were loaded rather than built.
+    */
+    bool useLandmarks(const std::string& mapFilename, int numLandmarks = 8);
+
+    /**
+    * landmarks retrieves the landmark tables from the last call to useLandmarks. They aren't built if useLandmarks
+    * hasn't been called since the distances last changed.
+    */
+    const LandmarkHeuristic& landmarks(void) const { return landmarks_; }
+
     /**
     * isValidGoal checks if the robot can possibly reach the specified goal pose. A valid goal is one that is at least
     * one robot radius from any known obstacle.
@@ -115,7 +301,8 @@ public:
     
     /**
     * isPathSafe checks if a path that was previously planned is still safe to execute based on updated map
-    * information.
+    * information. The robot must fit in every cell along the straight segments between the poses of the path, which
+    * is checked with the planner's ConfigurationSpaceBitmap rather than one obstacle distance at a time.
     * 
     * \param    path            Path to be checked for safety
     * \return   True if the path is safe to execute.
@@ -125,18 +312,38 @@ public:
     /**
     * setMap sets the map for which path's will be planned.
     *
+    * Only the obstacle distances affected by the cells that changed since the last call are updated -- see
+    * ObstacleDistanceGrid::updateDistances. The cells whose obstacle distances changed are passed along to the search
+    * kept by replanPath. If any distance changed, the map generation is incremented, so cached paths are checked
+    * against the new distances before they are used again. Setting the same map again keeps the cache as is.
+    *
+    * The SignedDistanceField used by optimizePaths isn't rebuilt here. It's rebuilt from the obstacle distances by the
+    * first path optimized after the map changes, so maps that arrive between plans cost nothing extra.
+    *
     * \param    map         OccupancyGrid representation of the environment through which paths will be planned
     */
     void setMap(const OccupancyGrid& map);
     
     /**
-    * setParams changes the default search parameters used by the motion planner.
+    * setParams changes the default search parameters used by the motion planner. If the robot radius changes, the
+    * configuration space is rebuilt and the cached paths, landmark tables, clusters, and searches are dropped, since
+    * they depend on which cells the robot fits in.
     * 
     * \param    params          New parameters for the motion planner
     */
     void setParams(const MotionPlannerParams& params);
 
-    void setPrevGoal(const pose_xyt_t& goal) { prev_goal = goal; }
+    /**
+    * params retrieves the parameters the planner is using.
+    */
+    const MotionPlannerParams& params(void) const { return params_; }
+
+    /**
+    * setPrevGoal sets the goal the robot was last sent to. Once it's set, isValidGoal rejects goals within a robot
+    * diameter of it whenever there's more than one frontier -- see setNumFrontiers -- so exploration doesn't pick the
+    * same target again. Until then, no goal is rejected for being near it.
+    */
+    void setPrevGoal(const pose_xyt_t& goal) { prev_goal = goal; hasPrevGoal_ = true; }
 
     void setNumFrontiers(const size_t& num_f) { num_frontiers = num_f; }
 
@@ -148,6 +355,28 @@ public:
     */
     ObstacleDistanceGrid obstacleDistances(void) const { return distances_; }
 
+    /**
+    * configurationSpace retrieves the bitmap of the cells the robot fits in, kept up to date by setMap, e.g. to check
+    * many candidate segments or corridors quickly.
+    */
+    const ConfigurationSpaceBitmap& configurationSpace(void) const { return cspace_; }
+
+    /**
+    * pathCache retrieves the cache of paths found by planPath, e.g. to check its hit and miss counts.
+    */
+    const PathCache& pathCache(void) const { return pathCache_; }
+
+    /**
+    * numExpanded retrieves the number of cells expanded by the search in the last call to planPath. It's 0 if the path
+    * came from the PathCache or the goal was rejected.
+    */
+    std::size_t numExpanded(void) const { return numExpanded_; }
+
+    /**
+    * mapGeneration retrieves the number of times setMap has changed the obstacle distances.
+    */
+    uint64_t mapGeneration(void) const { return mapGeneration_; }
+
     // A new function for planning a path to free space near a given frontier point
     robot_path_t planPathToFrontier(std::vector<frontier_t> frontier, pose_xyt_t& start, pose_xyt_t& goal);
 
@@ -156,13 +385,45 @@ public:
 
 
 private:
+
+    /**
+    * BatchWorker is the search state of one worker thread of planBatch.
+    */
+    struct BatchWorker
+    {
+        AStarWorkspace workspace;
+        LatticePlanner latticePlanner;
+        AnytimePlanner anytimePlanner;
+    };
     
     ObstacleDistanceGrid distances_;
+    ConfigurationSpaceBitmap cspace_;       // cells the robot fits in, for checking paths
     MotionPlannerParams params_;
     SearchParams searchParams_;
+    mutable AStarWorkspace workspace_;     // search state reused by every call to planPath
+    DStarLite incrementalPlanner_;          // search kept between calls to replanPath
+    mutable HierarchicalPlanner hierarchicalPlanner_;  // clusters used by planPath in hierarchical mode
+    mutable LatticePlanner latticePlanner_;             // primitives used by planPath in state_lattice mode
+    mutable AnytimePlanner anytimePlanner_;             // search used by planPath in anytime_astar mode
+    mutable AStarWorkspace costField_;      // cost field from the last call to expandCostField
+    mutable pose_xyt_t costFieldStart_;
+    mutable bool hasCostField_;
+    mutable PathCache pathCache_;           // paths found by planPath, keyed by start and goal cells
+    uint64_t mapGeneration_;                // incremented whenever setMap changes the distances
+    mutable std::size_t numExpanded_;       // cells expanded by the last call to planPath
+    mutable std::vector<BatchWorker> batchWorkers_;     // search state of each worker thread of planBatch
+    LandmarkHeuristic landmarks_;           // landmark tables used by the grid_astar mode, if built
+    mutable SignedDistanceField signedDistances_;   // signed distances of the map, if paths are optimized
+    mutable bool hasSignedDistances_;       // signedDistances_ were built from the current distances_
 
     size_t num_frontiers;
     pose_xyt_t prev_goal;
+    bool hasPrevGoal_;                      // prev_goal was set by setPrevGoal
+
+    PlanResult planQuery(const PlanQuery& query, BatchWorker& worker, int workerIndex) const;
+    SearchParams withLandmarks(const SearchParams& searchParams) const;
+    robot_path_t refinePath(const robot_path_t& path) const;
+    void updateSignedDistances(void) const;
 };
 
 #endif // PLANNING_MOTION_PLANNER_HPP
@@ -1,31 +1,50 @@
 #include <planning/obstacle_distance_grid.hpp>
+#include <planning/distance_transform.hpp>
 #include <slam/occupancy_grid.hpp>
-#include <iostream>
-#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
 
 typedef Point<int> cell_t;
 
-struct DistanceNode
+namespace
 {
-    cell_t cell;            // Cell represented by this node
-    float distance;        // Distance to the node -- in cells
 
-    bool operator<(const DistanceNode& rhs) const
-    {
-        return rhs.distance < distance;
-    }
+const float kInfiniteDistance = std::numeric_limits<float>::infinity();
+const int32_t kNoObstacle = -1;
+
+// Flags stored for each cell for the dynamic brushfire
+enum CellFlag
+{
+    obstacle_flag = 0x01,       // cell is an obstacle in the current map
+    raise_flag = 0x02,          // cell's nearest obstacle was removed and its neighbors haven't been raised yet
+    touched_flag = 0x04,        // cell's distance before the current update is saved in touchedDistances_
 };
 
-void enqueue_obstacle_cells(const OccupancyGrid& map,
-                            ObstacleDistanceGrid& grid,
-                            std::priority_queue<DistanceNode>& searchQueue);
-void expand_node(const DistanceNode& node,
-                 ObstacleDistanceGrid& grid,
-                 std::priority_queue<DistanceNode>& searchQueue);
+// Grids smaller than this aren't worth the cost of starting threads
+const int kMinCellsPerThread = 32768;
 
-bool is_cell_free_space(cell_t cell, const OccupancyGrid& map);
-bool is_cell_occupied(cell_t cell, const OccupancyGrid& map);
+bool is_cell_free_space(int x, int y, const OccupancyGrid& map);
 
+const int kXDeltas[8] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+const int kYDeltas[8] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+void column_obstacles(const OccupancyGrid& map,
+                      std::vector<int32_t>& nearestObstacles,
+                      std::vector<uint8_t>& cellFlags,
+                      int beginX,
+                      int endX);
+void row_obstacles(std::vector<int32_t>& nearestObstacles,
+                   std::vector<float>& distances,
+                   int width,
+                   float metersPerCell,
+                   int beginY,
+                   int endY);
+void parallel_for(int numItems, int numCells, const std::function<void(int, int)>& function);
+
+}
 
 
 ObstacleDistanceGrid::ObstacleDistanceGrid(void)
@@ -36,58 +55,101 @@ ObstacleDistanceGrid::ObstacleDistanceGrid(void)
 {
 }
 
-void ObstacleDistanceGrid::initializeDistances(const OccupancyGrid& map)
+
+void ObstacleDistanceGrid::setDistances(const OccupancyGrid& map)
 {
-    int width  = map.widthInCells();
-    int height = map.heightInCells();
+    //Ensure map and obstacle distance grid are same dimensions
+    resetGrid(map);
 
-    // go through all the cells
-    // if is an obstacle or unknown, set to 0
-    // if is free, set to -1 to indicate unknown distance.
+    // The exact Euclidean distance transform of Felzenszwalb and Huttenlocher is separable. First, find the nearest
+    // obstacle in the same column. Then, for each row, find the nearest obstacle using the column obstacles of every
+    // cell in the row. Each pass is linear in the number of cells, and the columns, then the rows, are independent of
+    // each other, so both passes are split across threads.
+    parallel_for(width_, width_ * height_, [this, &map](int beginX, int endX) {
+        column_obstacles(map, nearestObstacles_, cellFlags_, beginX, endX);
+    });
+
+    parallel_for(height_, width_ * height_, [this](int beginY, int endY) {
+        row_obstacles(nearestObstacles_, cells_, width_, metersPerCell_, beginY, endY);
+    });
+}
 
-    cell_t cell;
 
-    for(cell.y = 0; cell.y < height; ++cell.y)
+bool ObstacleDistanceGrid::updateDistances(const OccupancyGrid& map, std::vector<int>* changedCells)
+{
+    // Distances can only be repaired if they were computed for the same grid
+    if((width_ != map.widthInCells())
+        || (height_ != map.heightInCells())
+        || (metersPerCell_ != map.metersPerCell())
+        || (globalOrigin_ != map.originInGlobalFrame())
+        || (nearestObstacles_.size() != cells_.size()))
     {
-        for(cell.x = 0; cell.x < width; ++cell.x)
+        setDistances(map);
+        return false;
+    }
+
+    updateQueue_.reset(cells_.size());
+
+    // Start a wave from every cell whose obstacle status changed. New obstacles are their own nearest obstacle and
+    // lower the cells around them. Removed obstacles have no nearest obstacle until their neighbors lower them again,
+    // after raising any other cells that were using them.
+    for(int y = 0; y < height_; ++y)
+    {
+        for(int x = 0; x < width_; ++x)
         {
-            if(is_cell_free_space(cell, map))
+            int index = cellIndex(x, y);
+            bool isObstacle = !is_cell_free_space(x, y, map);
+            if(isObstacle == ((cellFlags_[index] & obstacle_flag) != 0))
             {
-                //set free cells to -1 to indicate we have not set a distance yet
-                distance(cell.x, cell.y) = -1; // was -1 originally changed to 999 to pass the astar empty test
+                continue;
             }
-            else if(is_cell_occupied(cell, map))
+
+            if(isObstacle)
             {
-                distance(cell.x, cell.y ) = 0;
+                cellFlags_[index] |= obstacle_flag;
+                setNearestObstacle(index, index);
             }
             else
             {
-                distance(cell.x, cell.y = 0);
+                cellFlags_[index] &= ~obstacle_flag;
+                cellFlags_[index] |= raise_flag;
+                setNearestObstacle(index, kNoObstacle);
             }
 
-
+            updateQueue_.pushOrDecrease(index, 0);
         }
     }
-}
 
-void ObstacleDistanceGrid::setDistances(const OccupancyGrid& map)
-{
-    //Ensure map and obstacle distance grid are same dimensions
-    resetGrid(map);
-    
-    initializeDistances(map);
+    // Process the waves in order of distance, so each cell is lowered to its final distance the first time
+    while(!updateQueue_.empty())
+    {
+        int index = updateQueue_.pop();
 
-    std::priority_queue<DistanceNode> searchQueue;
-    enqueue_obstacle_cells(map, *this, searchQueue);
+        if(cellFlags_[index] & raise_flag)
+        {
+            raiseCell(index);
+        }
+        else if((nearestObstacles_[index] != kNoObstacle) && (cellFlags_[nearestObstacles_[index]] & obstacle_flag))
+        {
+            lowerCell(index);
+        }
+    }
 
-    while(!searchQueue.empty())
+    for(std::size_t n = 0; n < touchedCells_.size(); ++n)
     {
-        DistanceNode nextNode = searchQueue.top();
-        // std::cout << nextNode.distance << std::endl;
-        searchQueue.pop();
-        expand_node(nextNode, *this, searchQueue);
+        int index = touchedCells_[n];
+        cellFlags_[index] &= ~touched_flag;
+
+        if(changedCells && (cells_[index] != touchedDistances_[n]))
+        {
+            changedCells->push_back(index);
+        }
     }
 
+    touchedCells_.clear();
+    touchedDistances_.clear();
+
+    return true;
 }
 
 
@@ -115,67 +177,245 @@ void ObstacleDistanceGrid::resetGrid(const OccupancyGrid& map)
     height_ = map.heightInCells();
 
     cells_.resize(width_ * height_);
+    nearestObstacles_.resize(width_ * height_);
+    cellFlags_.resize(width_ * height_);
 }
 
-bool is_cell_free_space(cell_t cell, const OccupancyGrid& map)
+
+int32_t ObstacleDistanceGrid::squaredCellDistance(int index, int32_t obstacle) const
 {
-    return map.logOdds(cell.x, cell.y) < 0;
+    int32_t dx = (index % width_) - (obstacle % width_);
+    int32_t dy = (index / width_) - (obstacle / width_);
+    return dx*dx + dy*dy;
 }
 
-bool is_cell_occupied(cell_t cell, const OccupancyGrid& map)
+
+void ObstacleDistanceGrid::setNearestObstacle(int index, int32_t obstacle)
 {
-    return map.logOdds(cell.x, cell.y) >= 0;
+    // Remember the distance from before the update the first time the cell changes
+    if(!(cellFlags_[index] & touched_flag))
+    {
+        cellFlags_[index] |= touched_flag;
+        touchedCells_.push_back(index);
+        touchedDistances_.push_back(cells_[index]);
+    }
+
+    nearestObstacles_[index] = obstacle;
+    cells_[index] = (obstacle == kNoObstacle) ? kInfiniteDistance
+        : std::sqrt(static_cast<float>(squaredCellDistance(index, obstacle))) * metersPerCell_;
 }
 
-void enqueue_obstacle_cells(const OccupancyGrid& map,
-                            ObstacleDistanceGrid& grid,
-                            std::priority_queue<DistanceNode>& searchQueue)
+
+void ObstacleDistanceGrid::raiseCell(int index)
 {
-    int width  = map.widthInCells();
-    int height = map.heightInCells();
+    const int x = index % width_;
+    const int y = index / width_;
 
-    cell_t cell;
+    for(int n = 0; n < 8; ++n)
+    {
+        if(!isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
+        {
+            continue;
+        }
 
-    for(cell.y = 0; cell.y < height; ++cell.y)
+        int neighbor = cellIndex(x + kXDeltas[n], y + kYDeltas[n]);
+        int32_t obstacle = nearestObstacles_[neighbor];
+        if((obstacle == kNoObstacle) || (cellFlags_[neighbor] & raise_flag))
+        {
+            continue;
+        }
+
+        int32_t squaredDistance = squaredCellDistance(neighbor, obstacle);
+
+        // A neighbor whose nearest obstacle is gone is cleared and passes on the raise. Otherwise, it is a boundary of
+        // the raised region and lowers the cleared cells once it's popped.
+        if(!(cellFlags_[obstacle] & obstacle_flag))
+        {
+            cellFlags_[neighbor] |= raise_flag;
+            setNearestObstacle(neighbor, kNoObstacle);
+        }
+
+        updateQueue_.pushOrDecrease(neighbor, squaredDistance);
+    }
+
+    cellFlags_[index] &= ~raise_flag;
+}
+
+
+void ObstacleDistanceGrid::lowerCell(int index)
+{
+    const int x = index % width_;
+    const int y = index / width_;
+    const int32_t obstacle = nearestObstacles_[index];
+
+    for(int n = 0; n < 8; ++n)
     {
-        for(cell.x = 0; cell.x < width; ++cell.x)
+        if(!isCellInGrid(x + kXDeltas[n], y + kYDeltas[n]))
         {
-            if(is_cell_occupied(cell, map))
-            {
-                DistanceNode currentNode;
-                currentNode.cell = cell;
-                currentNode.distance = grid(cell.x, cell.y);
-                expand_node(currentNode, grid, searchQueue);
-            }
+            continue;
+        }
+
+        int neighbor = cellIndex(x + kXDeltas[n], y + kYDeltas[n]);
+        if(cellFlags_[neighbor] & raise_flag)
+        {
+            continue;
+        }
+
+        int32_t squaredDistance = squaredCellDistance(neighbor, obstacle);
+        if((nearestObstacles_[neighbor] == kNoObstacle)
+            || (squaredDistance < squaredCellDistance(neighbor, nearestObstacles_[neighbor])))
+        {
+            setNearestObstacle(neighbor, obstacle);
+            updateQueue_.pushOrDecrease(neighbor, squaredDistance);
         }
     }
 }
 
-void expand_node(const DistanceNode& node,
-                 ObstacleDistanceGrid& grid,
-                 std::priority_queue<DistanceNode>& searchQueue)
+
+namespace
 {
-    // Perform a four-way expansion of each cell
-    const int xDeltas[4] = { 1, -1, 0, 0 };
-    const int yDeltas[4] = { 0, 0, 1, -1 };
 
-    for(int n = 0; n < 4; ++n)
+bool is_cell_free_space(int x, int y, const OccupancyGrid& map)
+{
+    // Unknown cells are treated as obstacles, so the robot never plans through unexplored space. The cell is always in
+    // the grid, so skip the bounds check in logOdds.
+    return map(x, y) < 0;
+}
+
+
+/*
+* column_obstacles finds the row of the nearest obstacle in the same column for each cell in columns [beginX, endX), or
+* kNoObstacle if the column has no obstacles, and marks the obstacle cells. The columns are swept a row at a time, first
+* up, then down, so memory is accessed in order.
+*/
+void column_obstacles(const OccupancyGrid& map,
+                      std::vector<int32_t>& nearestObstacles,
+                      std::vector<uint8_t>& cellFlags,
+                      int beginX,
+                      int endX)
+{
+    const int width = map.widthInCells();
+    const int height = map.heightInCells();
+
+    for(int y = 0; y < height; ++y)
     {
-        cell_t adjacentCell(node.cell.x + xDeltas[n], node.cell.y + yDeltas[n]);
+        int32_t* row = nearestObstacles.data() + y*width;
+        const int32_t* rowBelow = row - width;
 
-        // A cell will be enqueued if:
-        // it is in the grid...
-        if(grid.isCellInGrid(adjacentCell.x, adjacentCell.y))
+        for(int x = beginX; x < endX; ++x)
         {
-            DistanceNode adjacentNode;
-            adjacentNode.cell = adjacentCell;
-            if(grid(adjacentCell.x, adjacentCell.y) == -1)
+            if(!is_cell_free_space(x, y, map))
             {
-                adjacentNode.distance = node.distance + 0.1f;  // should be 0.05
-                grid(adjacentCell.x, adjacentCell.y) = adjacentNode.distance;
-                searchQueue.push(adjacentNode);
+                row[x] = y;
+                cellFlags[y*width + x] = obstacle_flag;
             }
+            else
+            {
+                row[x] = (y > 0) ? rowBelow[x] : kNoObstacle;
+                cellFlags[y*width + x] = 0;
+            }
+        }
+    }
+
+    for(int y = height - 2; y >= 0; --y)
+    {
+        int32_t* row = nearestObstacles.data() + y*width;
+        const int32_t* rowAbove = row + width;
+
+        for(int x = beginX; x < endX; ++x)
+        {
+            if((rowAbove[x] != kNoObstacle) && ((row[x] == kNoObstacle) || (rowAbove[x] - y < y - row[x])))
+            {
+                row[x] = rowAbove[x];
+            }
+        }
+    }
+}
+
 
+/*
+* row_obstacles turns the column obstacle rows of rows [beginY, endY) into the index of the nearest obstacle and the
+* Euclidean distance to it in meters.
+*
+* The squared distance from cell x to the nearest obstacle through cell q in the same row is (x - q)^2 + f(q), where
+* f(q) is the squared distance to the nearest obstacle in the column of q, so each row is a squared_distance_transform.
+*/
+void row_obstacles(std::vector<int32_t>& nearestObstacles,
+                   std::vector<float>& distances,
+                   int width,
+                   float metersPerCell,
+                   int beginY,
+                   int endY)
+{
+    std::vector<float> f(width);
+    std::vector<float> squaredDistances(width);
+    std::vector<int> nearestColumns(width);
+    std::vector<int> vertices(width);
+    std::vector<float> boundaries(width + 1);
+
+    for(int y = beginY; y < endY; ++y)
+    {
+        int32_t* nearestRow = nearestObstacles.data() + y*width;
+        float* distanceRow = distances.data() + y*width;
+
+        // Cells with no obstacle in their column are infinitely far from one
+        for(int q = 0; q < width; ++q)
+        {
+            f[q] = (nearestRow[q] == kNoObstacle) ? kInfiniteDistance
+                : static_cast<float>((y - nearestRow[q]) * (y - nearestRow[q]));
+        }
+
+        // If no column in the row has an obstacle, then there are no obstacles anywhere
+        if(!squared_distance_transform(f.data(), width, squaredDistances.data(), nearestColumns.data(),
+                                       vertices.data(), boundaries.data()))
+        {
+            std::fill(distanceRow, distanceRow + width, kInfiniteDistance);
+            continue;
         }
+
+        // nearestRow keeps the obstacle row of each column until the whole row is done, since any x can read any v
+        for(int x = 0; x < width; ++x)
+        {
+            int v = nearestColumns[x];
+            nearestColumns[x] = nearestRow[v]*width + v;
+            distanceRow[x] = std::sqrt(squaredDistances[x]) * metersPerCell;
+        }
+        std::copy(nearestColumns.begin(), nearestColumns.end(), nearestRow);
     }
 }
+
+
+/*
+* parallel_for splits [0, numItems) into contiguous ranges and calls function(begin, end) for each range on its own
+* thread, blocking until all are done. Small grids are handled on the calling thread.
+*/
+void parallel_for(int numItems, int numCells, const std::function<void(int, int)>& function)
+{
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, std::max(1, numCells / kMinCellsPerThread));
+    numThreads = std::min(numThreads, std::max(1, numItems));
+
+    if(numThreads == 1)
+    {
+        function(0, numItems);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    const int itemsPerThread = (numItems + numThreads - 1) / numThreads;
+    for(int begin = itemsPerThread; begin < numItems; begin += itemsPerThread)
+    {
+        threads.emplace_back(function, begin, std::min(begin + itemsPerThread, numItems));
+    }
+
+    function(0, std::min(itemsPerThread, numItems));
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+}
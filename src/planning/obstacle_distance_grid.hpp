@@ -2,6 +2,8 @@
 #define PLANNING_OBSTACLE_DISTANCE_GRID_HPP
 
 #include <common/point.hpp>
+#include <planning/indexed_heap.hpp>
+#include <cstdint>
 #include <vector>
 
 class OccupancyGrid;
@@ -10,10 +12,20 @@ class OccupancyGrid;
 /**
 * ObstacleDistanceGrid stores the distance to the nearest obstacle for each cell in the occupancy grid.
 * 
-*  - An obstacle is any cell with logOdds > 0.
+*  - An obstacle is any cell with logOdds >= 0, so unknown cells are treated as obstacles.
+*  - Distances are the exact Euclidean distance in meters from the center of the cell to the center of the nearest
+*    obstacle cell. Obstacle cells have distance 0. If the map has no obstacles, every distance is infinity.
 *  - The size of the grid is identical to the occupancy grid whose obstacle distances the distance grid stores.
 * 
 * To update the grid, simply pass an OccupancyGrid to the setDistances method.
+* 
+* When consecutive maps differ in only a few cells, as with the maps built by SLAM, pass each new map to
+* updateDistances instead. It finds the cells that became or stopped being obstacles and repairs only the distances
+* affected by them, using the dynamic brushfire algorithm (Lau, Sprunk, and Burgard, 2013). Each cell stores its
+* nearest obstacle cell. New obstacles send a lowering wave outward, lowering the distance of any cell they are now
+* nearest to. Removed obstacles send a raising wave, which clears every cell whose nearest obstacle was removed, after
+* which the surrounding cells lower the cleared cells again. The cost of an update is proportional to the number of
+* cells whose distance changes rather than the size of the map.
 */
 class ObstacleDistanceGrid
 {
@@ -42,9 +54,29 @@ public:
     /**
     * setDistances sets the obstacle distances stored in the grid based on the provided occupancy grid map of the
     * environment.
+    * 
+    * The distances are found with a separable linear-time distance transform, which is split across threads for
+    * large grids.
     */
     void setDistances(const OccupancyGrid& map);
     
+    /**
+    * updateDistances updates the obstacle distances stored in the grid for a new version of the map passed to the last
+    * call to setDistances or updateDistances.
+    * 
+    * If the new map has a different size, resolution, or origin, then the distances are recomputed with setDistances.
+    * 
+    * The propagated distances are measured to obstacle cell centers, like setDistances, but the waves only pass
+    * nearest obstacles between neighboring cells, so a cell can occasionally end up a tiny fraction of a cell farther
+    * than its true nearest obstacle.
+    * 
+    * \param    map             New map of the environment
+    * \param    changedCells    (optional, out) Row-major indices, y*width + x, of the cells whose distances changed
+    *   are appended, if the update was incremental
+    * \return   True if the distances were updated incrementally. False if they were all recomputed.
+    */
+    bool updateDistances(const OccupancyGrid& map, std::vector<int>* changedCells = nullptr);
+    
     /**
     * isCellInGrid checks to see if the specified cell is within the boundary of the ObstacleDistanceGrid.
     * 
@@ -73,6 +105,12 @@ private:
     
     std::vector<float> cells_;          ///< The actual grid -- stored in row-major order
     
+    std::vector<int32_t> nearestObstacles_;     ///< Index of the nearest obstacle cell to each cell, or -1 if none
+    std::vector<uint8_t> cellFlags_;            ///< Obstacle and update state of each cell
+    IndexedHeap<int32_t> updateQueue_;          ///< Cells waiting to pass on a change, keyed by squared cell distance
+    std::vector<int> touchedCells_;             ///< Cells whose distance was set during the current update
+    std::vector<float> touchedDistances_;       ///< Distance of each touched cell before the update
+    
     int width_;                 ///< Width of the grid in cells
     int height_;                ///< Height of the grid in cells
     float metersPerCell_;       ///< Side length of a cell
@@ -82,15 +120,18 @@ private:
 
     void resetGrid(const OccupancyGrid& map);
     
+    // Dynamic brushfire -- see updateDistances
+    int32_t squaredCellDistance(int index, int32_t obstacle) const;
+    void setNearestObstacle(int index, int32_t obstacle);
+    void raiseCell(int index);
+    void lowerCell(int index);
+    
     // Convert between cells and the underlying vector index
     int cellIndex(int x, int y) const { return y*width_ + x; }
     
     // Allow private write-access to cells
     float& distance(int x, int y) { return cells_[cellIndex(x, y)]; }
 
-    // initialize obstacle distance grid
-    void initializeDistances(const OccupancyGrid& map);
-
 };
 
 #endif // PLANNING_OBSTACLE_DISTANCE_GRID_HPP
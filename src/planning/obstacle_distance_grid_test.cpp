@@ -1,11 +1,22 @@
 #include <planning/obstacle_distance_grid.hpp>
 #include <slam/occupancy_grid.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 
 /*
 * The distance grid test uses a simple square environment with free space in the center of the square. Obstacles one
 * cell from the edge, and unknown cells along the edge. The test makes sure that unknown and obstacle cells are
 * distance 0 and a scattering of cells inside the free space have the correct distances.
+*
+* The incremental test makes random changes to maps, like adding and clearing small blobs of obstacles and exploring
+* unknown space, and checks that updateDistances gives the same distances as setDistances and reports every changed cell.
+*
+* The brute force test compares every distance in randomly generated grids, along with grids with no obstacles and no
+* free space, against a search of every obstacle cell. The timing test prints how long setDistances takes on large
+* grids.
 */
 
 
@@ -17,9 +28,16 @@ const int obstacleHighIndex = kGridSideLength - 2;
 bool test_unknown_distances(void);
 bool test_obstacle_distances(void);
 bool test_free_space_distances(void);
+bool test_brute_force_distances(void);
+bool test_large_grid_timing(void);
+bool test_incremental_updates(void);
+bool test_incremental_update_timing(void);
 float expected_free_distance(int x, int y, const OccupancyGrid& map);
+float brute_force_distance(int x, int y, const OccupancyGrid& map);
 
 OccupancyGrid generate_grid(void);
+OccupancyGrid generate_random_grid(int width, int height, float obstacleProbability);
+void change_random_blob(OccupancyGrid& grid, int maxRadius);
 
 
 int main(int argc, char** argv)
@@ -51,6 +69,42 @@ int main(int argc, char** argv)
         std::cout << "FAILED: test_free_space_distances\n";
     }
 
+    if(test_brute_force_distances())
+    {
+        std::cout << "PASSED: test_brute_force_distances\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_brute_force_distances\n";
+    }
+
+    if(test_large_grid_timing())
+    {
+        std::cout << "PASSED: test_large_grid_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_large_grid_timing\n";
+    }
+
+    if(test_incremental_updates())
+    {
+        std::cout << "PASSED: test_incremental_updates\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_incremental_updates\n";
+    }
+
+    if(test_incremental_update_timing())
+    {
+        std::cout << "PASSED: test_incremental_update_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_incremental_update_timing\n";
+    }
+
     return 0;
 }
 
@@ -157,6 +211,205 @@ bool test_free_space_distances(void)
 }
 
 
+bool test_brute_force_distances(void)
+{
+    const float kObstacleProbabilities[] = { 0.0f, 0.001f, 0.01f, 0.1f, 0.5f, 1.0f };
+    const int kGridSizes[][2] = { { 1, 1 }, { 1, 37 }, { 41, 1 }, { 23, 61 }, { 64, 64 }, { 97, 45 } };
+
+    std::srand(42);
+
+    int numCells = 0;
+    int numCorrectDistances = 0;
+
+    for(float probability : kObstacleProbabilities)
+    {
+        for(auto& size : kGridSizes)
+        {
+            OccupancyGrid grid = generate_random_grid(size[0], size[1], probability);
+            ObstacleDistanceGrid distances;
+            distances.setDistances(grid);
+
+            for(int y = 0; y < grid.heightInCells(); ++y)
+            {
+                for(int x = 0; x < grid.widthInCells(); ++x)
+                {
+                    ++numCells;
+
+                    float expectedDist = brute_force_distance(x, y, grid);
+                    if((distances(x, y) == expectedDist) || (std::abs(distances(x, y) - expectedDist) < 0.0001))
+                    {
+                        ++numCorrectDistances;
+                    }
+                    else
+                    {
+                        std::cout << "FAILED: " << size[0] << 'x' << size[1] << " grid, cell (" << x << ',' << y
+                            << ") Expected:" << expectedDist << " Stored:" << distances(x, y) << '\n';
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Brute force test result: Num cells:" << numCells << " Num correct dists:" << numCorrectDistances
+        << '\n';
+
+    return numCells == numCorrectDistances;
+}
+
+
+bool test_large_grid_timing(void)
+{
+    const int kGridSizes[] = { 500, 1000, 2000 };
+    const int kNumRepeats = 5;
+
+    for(int size : kGridSizes)
+    {
+        OccupancyGrid grid = generate_random_grid(size, size, 0.01f);
+        ObstacleDistanceGrid distances;
+
+        auto startTime = std::chrono::steady_clock::now();
+        for(int n = 0; n < kNumRepeats; ++n)
+        {
+            distances.setDistances(grid);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+        double msPerGrid = std::chrono::duration<double, std::milli>(elapsed).count() / kNumRepeats;
+        std::cout << "Timing: " << size << 'x' << size << " grid: " << msPerGrid << " ms ("
+            << (msPerGrid * 1e6 / (static_cast<double>(size) * size)) << " ns/cell)\n";
+
+        // Spot check the corners against the brute force distances
+        for(int y : { 0, size - 1 })
+        {
+            for(int x : { 0, size - 1 })
+            {
+                if(std::abs(distances(x, y) - brute_force_distance(x, y, grid)) > 0.0001)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_incremental_updates(void)
+{
+    const float kObstacleProbabilities[] = { 0.0f, 0.01f, 0.1f, 0.5f };
+    const int kNumUpdates = 50;
+
+    std::srand(7);
+
+    int numCells = 0;
+    int numCorrectDistances = 0;
+    int numMissedChanges = 0;
+    float maxError = 0.0f;
+
+    for(float probability : kObstacleProbabilities)
+    {
+        OccupancyGrid grid = generate_random_grid(80, 60, probability);
+        ObstacleDistanceGrid incrementalDistances;
+        if(incrementalDistances.updateDistances(grid))
+        {
+            std::cout << "FAILED: First update of an empty grid was incremental\n";
+            return false;
+        }
+
+        for(int n = 0; n < kNumUpdates; ++n)
+        {
+            // Change one to a few blobs at a time, like consecutive SLAM maps
+            int numBlobs = 1 + std::rand() % 3;
+            for(int blob = 0; blob < numBlobs; ++blob)
+            {
+                change_random_blob(grid, 4);
+            }
+
+            ObstacleDistanceGrid previousDistances = incrementalDistances;
+            std::vector<int> changedCells;
+            if(!incrementalDistances.updateDistances(grid, &changedCells))
+            {
+                std::cout << "FAILED: Update of the same grid wasn't incremental\n";
+                return false;
+            }
+
+            ObstacleDistanceGrid expectedDistances;
+            expectedDistances.setDistances(grid);
+
+            std::vector<bool> isReported(grid.widthInCells() * grid.heightInCells(), false);
+            for(int index : changedCells)
+            {
+                isReported[index] = true;
+            }
+
+            for(int y = 0; y < grid.heightInCells(); ++y)
+            {
+                for(int x = 0; x < grid.widthInCells(); ++x)
+                {
+                    ++numCells;
+
+                    float expectedDist = expectedDistances(x, y);
+                    float error = (incrementalDistances(x, y) == expectedDist) ? 0.0f
+                        : std::abs(incrementalDistances(x, y) - expectedDist);
+                    maxError = std::max(maxError, error);
+
+                    // The waves can leave a cell slightly farther than the exact distance
+                    if(error <= 0.1f * grid.metersPerCell())
+                    {
+                        ++numCorrectDistances;
+                    }
+
+                    if((previousDistances(x, y) != incrementalDistances(x, y))
+                        && !isReported[y*grid.widthInCells() + x])
+                    {
+                        ++numMissedChanges;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Incremental test result: Num cells:" << numCells << " Num correct dists:" << numCorrectDistances
+        << " Max error:" << maxError << " Num missed changes:" << numMissedChanges << '\n';
+
+    return (numCells == numCorrectDistances) && (numMissedChanges == 0);
+}
+
+
+bool test_incremental_update_timing(void)
+{
+    const int kGridSize = 2000;
+    const int kNumUpdates = 20;
+
+    OccupancyGrid grid = generate_random_grid(kGridSize, kGridSize, 0.01f);
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    double updateMs = 0.0;
+    double fullMs = 0.0;
+
+    for(int n = 0; n < kNumUpdates; ++n)
+    {
+        change_random_blob(grid, 5);
+
+        auto startTime = std::chrono::steady_clock::now();
+        distances.updateDistances(grid);
+        updateMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        ObstacleDistanceGrid fullDistances;
+        startTime = std::chrono::steady_clock::now();
+        fullDistances.setDistances(grid);
+        fullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    std::cout << "Timing: " << kGridSize << 'x' << kGridSize << " grid with one changed blob: updateDistances "
+        << (updateMs / kNumUpdates) << " ms, setDistances " << (fullMs / kNumUpdates) << " ms\n";
+
+    return true;
+}
+
+
 float expected_free_distance(int x, int y, const OccupancyGrid& map)
 {
     // Because the grid is a square, the nearest obstacle is always a horizontal or vertical wall. The expected distance
@@ -169,6 +422,28 @@ float expected_free_distance(int x, int y, const OccupancyGrid& map)
 }
 
 
+float brute_force_distance(int x, int y, const OccupancyGrid& map)
+{
+    float minDistance = std::numeric_limits<float>::infinity();
+
+    for(int obstacleY = 0; obstacleY < map.heightInCells(); ++obstacleY)
+    {
+        for(int obstacleX = 0; obstacleX < map.widthInCells(); ++obstacleX)
+        {
+            // Unknown cells count as obstacles
+            if(map(obstacleX, obstacleY) >= 0)
+            {
+                float dx = obstacleX - x;
+                float dy = obstacleY - y;
+                minDistance = std::min(minDistance, std::sqrt(dx*dx + dy*dy) * map.metersPerCell());
+            }
+        }
+    }
+
+    return minDistance;
+}
+
+
 OccupancyGrid generate_grid(void)
 {
     const float kMetersPerCell = 0.1f;
@@ -194,3 +469,46 @@ OccupancyGrid generate_grid(void)
 
     return grid;
 }
+
+
+OccupancyGrid generate_random_grid(int width, int height, float obstacleProbability)
+{
+    const float kMetersPerCell = 0.05f;
+
+    OccupancyGrid grid(width * kMetersPerCell, height * kMetersPerCell, kMetersPerCell);
+
+    for(int y = 0; y < grid.heightInCells(); ++y)
+    {
+        for(int x = 0; x < grid.widthInCells(); ++x)
+        {
+            bool isObstacle = (std::rand() / (RAND_MAX + 1.0)) < obstacleProbability;
+            grid(x, y) = isObstacle ? ((std::rand() % 2) ? 50 : 0) : -50;
+        }
+    }
+
+    return grid;
+}
+
+
+void change_random_blob(OccupancyGrid& grid, int maxRadius)
+{
+    // Turn a random disc into obstacles, free space, or unknown space
+    const CellOdds kBlobValues[] = { 50, -50, 0 };
+    CellOdds value = kBlobValues[std::rand() % 3];
+
+    int centerX = std::rand() % grid.widthInCells();
+    int centerY = std::rand() % grid.heightInCells();
+    int radius = std::rand() % (maxRadius + 1);
+
+    for(int y = centerY - radius; y <= centerY + radius; ++y)
+    {
+        for(int x = centerX - radius; x <= centerX + radius; ++x)
+        {
+            if(grid.isCellInGrid(x, y)
+                && ((x - centerX)*(x - centerX) + (y - centerY)*(y - centerY) <= radius*radius))
+            {
+                grid(x, y) = value;
+            }
+        }
+    }
+}
@@ -0,0 +1,279 @@
+#include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <planning/indexed_heap.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/getopt.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <string>
+#include <vector>
+
+/*
+* open_list_bench compares open lists for the A* search in astar.cpp on the data/astar maps:
+*
+*   - priority_queue: std::priority_queue with a new entry pushed every time a cell's cost improves. Stale entries are
+*     skipped when popped. This is the open list the search used before IndexedHeap.
+*   - indexed_heap:   IndexedHeap<float>, which holds each cell once and lowers its key in place.
+*
+* Both run the same search (4-connected moves, Manhattan heuristic, distance cost from SearchParams) over the
+* start/goal pairs in each map's poses file. Run it from the bin/ directory so the map paths resolve.
+*/
+
+struct BenchResult
+{
+    int64_t totalTimeUs = 0;
+    std::size_t numPushes = 0;          // entries added to the open list, including decrease-key updates
+    std::size_t numPops = 0;            // entries removed, including stale entries
+    std::size_t peakSize = 0;           // most entries in the open list at once
+    std::size_t numPathsFound = 0;
+};
+
+
+// Open list built on std::priority_queue with duplicate entries
+class PriorityQueueOpenList
+{
+public:
+
+    void reset(std::size_t numCells) { queue_ = queue_t(); }
+    bool empty(void) const { return queue_.empty(); }
+    std::size_t size(void) const { return queue_.size(); }
+    void update(int index, float fCost) { queue_.push(std::make_pair(fCost, index)); }
+    int pop(void)
+    {
+        int index = queue_.top().second;
+        queue_.pop();
+        return index;
+    }
+
+private:
+
+    typedef std::priority_queue<std::pair<float, int>,
+                                std::vector<std::pair<float, int>>,
+                                std::greater<std::pair<float, int>>> queue_t;
+    queue_t queue_;
+};
+
+
+// Open list built on IndexedHeap
+class IndexedHeapOpenList
+{
+public:
+
+    void reset(std::size_t numCells) { heap_.reset(numCells); }
+    bool empty(void) const { return heap_.empty(); }
+    std::size_t size(void) const { return heap_.size(); }
+    void update(int index, float fCost) { heap_.pushOrDecrease(index, fCost); }
+    int pop(void) { return heap_.pop(); }
+
+private:
+
+    IndexedHeap<float> heap_;
+};
+
+
+template <class OpenList>
+bool run_search(cell_t start,
+                cell_t goal,
+                const ObstacleDistanceGrid& distances,
+                const SearchParams& params,
+                OpenList& openList,
+                std::vector<float>& gCosts,
+                std::vector<uint8_t>& closed,
+                BenchResult& result)
+{
+    const int width = distances.widthInCells();
+    const float metersPerCell = distances.metersPerCell();
+    const int xDeltas[4] = { 1, -1, 0,  0 };
+    const int yDeltas[4] = { 0,  0, 1, -1 };
+
+    auto isTraversable = [&](int x, int y) {
+        return distances.isCellInGrid(x, y) && (distances(x, y) > params.minDistanceToObstacle*1.000001);
+    };
+    auto hCost = [&](int x, int y) {
+        return (std::abs(goal.x - x) + std::abs(goal.y - y)) * metersPerCell;
+    };
+
+    if(!isTraversable(start.x, start.y) || !isTraversable(goal.x, goal.y))
+    {
+        return false;
+    }
+
+    std::fill(gCosts.begin(), gCosts.end(), std::numeric_limits<float>::max());
+    std::fill(closed.begin(), closed.end(), 0);
+    openList.reset(gCosts.size());
+
+    const int startIndex = start.y*width + start.x;
+    const int goalIndex = goal.y*width + goal.x;
+    gCosts[startIndex] = 0.0f;
+    openList.update(startIndex, hCost(start.x, start.y));
+    ++result.numPushes;
+
+    while(!openList.empty())
+    {
+        result.peakSize = std::max(result.peakSize, openList.size());
+        int index = openList.pop();
+        ++result.numPops;
+
+        if(closed[index])
+        {
+            continue;
+        }
+        if(index == goalIndex)
+        {
+            return true;
+        }
+
+        closed[index] = 1;
+        const int x = index % width;
+        const int y = index / width;
+
+        for(int n = 0; n < 4; ++n)
+        {
+            int adjacentX = x + xDeltas[n];
+            int adjacentY = y + yDeltas[n];
+            if(!isTraversable(adjacentX, adjacentY))
+            {
+                continue;
+            }
+
+            int adjacentIndex = adjacentY*width + adjacentX;
+            if(closed[adjacentIndex])
+            {
+                continue;
+            }
+
+            float cellDistance = distances(adjacentX, adjacentY);
+            float obstacleCost = (cellDistance < params.maxDistanceWithCost)
+                ? std::pow(params.maxDistanceWithCost - cellDistance, params.distanceCostExponent)
+                : 0.0f;
+            float gNew = gCosts[index] + metersPerCell + obstacleCost;
+
+            if(gNew < gCosts[adjacentIndex])
+            {
+                gCosts[adjacentIndex] = gNew;
+                openList.update(adjacentIndex, gNew + hCost(adjacentX, adjacentY));
+                ++result.numPushes;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <class OpenList>
+BenchResult bench_map(const ObstacleDistanceGrid& distances,
+                      const SearchParams& params,
+                      const std::vector<std::pair<cell_t, cell_t>>& queries,
+                      int numRepeats)
+{
+    OpenList openList;
+    std::vector<float> gCosts(distances.widthInCells() * distances.heightInCells());
+    std::vector<uint8_t> closed(gCosts.size());
+    BenchResult result;
+
+    for(int n = 0; n < numRepeats; ++n)
+    {
+        for(auto& query : queries)
+        {
+            int64_t startTime = utime_now();
+            bool found = run_search(query.first, query.second, distances, params, openList, gCosts, closed, result);
+            result.totalTimeUs += utime_now() - startTime;
+            result.numPathsFound += found;
+        }
+    }
+
+    return result;
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* kNumRepeatsArg = "num-repeats";
+
+    getopt_t* gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_int(gopt, 'n', kNumRepeatsArg, "20", "Number of times to repeat each query");
+
+    if(!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help"))
+    {
+        printf("Usage: %s [options]\n", argv[0]);
+        getopt_do_usage(gopt);
+        return 1;
+    }
+
+    const int numRepeats = getopt_get_int(gopt, kNumRepeatsArg);
+    const std::vector<std::string> maps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+
+    // Use the same parameters as astar_test
+    MotionPlannerParams plannerParams;
+    plannerParams.robotRadius = 0.1;
+    SearchParams params;
+    params.minDistanceToObstacle = plannerParams.robotRadius;
+    params.maxDistanceWithCost = 10.0 * params.minDistanceToObstacle;
+    params.distanceCostExponent = 1.0;
+
+    printf("%-8s %-15s %10s %12s %12s %10s %6s\n", "map", "open list", "time (us)", "pushes", "pops", "peak size",
+           "paths");
+
+    for(auto& name : maps)
+    {
+        OccupancyGrid grid;
+        if(!grid.loadFromFile("../data/astar/" + name + ".map"))
+        {
+            std::cerr << "ERROR: Run open_list_bench from the bin/ directory.\n";
+            return 1;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        std::ifstream posesIn("../data/astar/" + name + "_poses.txt");
+        int numQueries = 0;
+        posesIn >> numQueries;
+
+        std::vector<std::pair<cell_t, cell_t>> queries;
+        for(int n = 0; n < numQueries; ++n)
+        {
+            Point<double> start;
+            Point<double> goal;
+            bool shouldExist;
+            posesIn >> start.x >> start.y >> goal.x >> goal.y >> shouldExist;
+            queries.push_back(std::make_pair(global_position_to_grid_cell(start, distances),
+                                             global_position_to_grid_cell(goal, distances)));
+        }
+
+        BenchResult queueResult = bench_map<PriorityQueueOpenList>(distances, params, queries, numRepeats);
+        BenchResult heapResult = bench_map<IndexedHeapOpenList>(distances, params, queries, numRepeats);
+
+        for(auto& result : { std::make_pair("priority_queue", queueResult),
+                             std::make_pair("indexed_heap", heapResult) })
+        {
+            printf("%-8s %-15s %10lld %12zu %12zu %10zu %6zu\n",
+                   name.c_str(),
+                   result.first,
+                   static_cast<long long>(result.second.totalTimeUs),
+                   result.second.numPushes,
+                   result.second.numPops,
+                   result.second.peakSize,
+                   result.second.numPathsFound);
+        }
+
+        if(queueResult.numPathsFound != heapResult.numPathsFound)
+        {
+            std::cerr << "ERROR: The open lists found different numbers of paths on " << name << '\n';
+            return 1;
+        }
+    }
+
+    getopt_destroy(gopt);
+    return 0;
+}
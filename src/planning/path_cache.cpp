@@ -0,0 +1,179 @@
+#include <planning/path_cache.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <functional>
+
+namespace
+{
+
+std::size_t combine_hash(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+}
+
+
+PathCache::PathCache(std::size_t capacity)
+: capacity_(capacity > 0 ? capacity : 1)
+, numHits_(0)
+, numMisses_(0)
+{
+}
+
+
+bool PathCache::find(const pose_xyt_t& start,
+                     const pose_xyt_t& goal,
+                     const SearchParams& params,
+                     const ObstacleDistanceGrid& distances,
+                     uint64_t generation,
+                     robot_path_t& path)
+{
+    Key key;
+    auto indexIt = makeKey(start, goal, params, distances, key) ? index_.find(key) : index_.end();
+    if(indexIt == index_.end())
+    {
+        ++numMisses_;
+        return false;
+    }
+
+    EntryList::iterator entryIt = indexIt->second;
+
+    // A path from an older map is only kept if the robot can still drive all of it
+    if(entryIt->generation != generation)
+    {
+        if((entryIt->path.path_length < 2) || !isPathTraversable(entryIt->path, params, distances))
+        {
+            index_.erase(indexIt);
+            entries_.erase(entryIt);
+            ++numMisses_;
+            return false;
+        }
+        entryIt->generation = generation;
+    }
+
+    // Move the entry to the front to mark it as the most recently used
+    entries_.splice(entries_.begin(), entries_, entryIt);
+    ++numHits_;
+
+    // The query only has to share cells with the cached one, so give the path the query's start, as a search would
+    path = entryIt->path;
+    path.utime = start.utime;
+    for(auto& pose : path.path)
+    {
+        pose.utime = start.utime;
+    }
+    if(!path.path.empty())
+    {
+        path.path.front() = start;
+    }
+    if(path.path.size() > 1)
+    {
+        path.path.back().theta = start.theta;
+    }
+    return true;
+}
+
+
+void PathCache::insert(const pose_xyt_t& start,
+                       const pose_xyt_t& goal,
+                       const SearchParams& params,
+                       const ObstacleDistanceGrid& distances,
+                       uint64_t generation,
+                       const robot_path_t& path)
+{
+    Key key;
+    if(!makeKey(start, goal, params, distances, key))
+    {
+        return;
+    }
+
+    auto indexIt = index_.find(key);
+    if(indexIt != index_.end())
+    {
+        entries_.erase(indexIt->second);
+        index_.erase(indexIt);
+    }
+    else if(entries_.size() >= capacity_)
+    {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.generation = generation;
+    entry.path = path;
+    entries_.push_front(entry);
+    index_[key] = entries_.begin();
+}
+
+
+void PathCache::clear(void)
+{
+    entries_.clear();
+    index_.clear();
+}
+
+
+bool PathCache::Key::operator==(const Key& rhs) const
+{
+    return (startIndex == rhs.startIndex)
+        && (goalIndex == rhs.goalIndex)
+        && (params.minDistanceToObstacle == rhs.params.minDistanceToObstacle)
+        && (params.maxDistanceWithCost == rhs.params.maxDistanceWithCost)
+        && (params.distanceCostExponent == rhs.params.distanceCostExponent)
+        && (params.mode == rhs.params.mode);
+}
+
+
+std::size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+    std::size_t hash = std::hash<int>()(key.startIndex);
+    hash = combine_hash(hash, std::hash<int>()(key.goalIndex));
+    hash = combine_hash(hash, std::hash<double>()(key.params.minDistanceToObstacle));
+    hash = combine_hash(hash, std::hash<double>()(key.params.maxDistanceWithCost));
+    hash = combine_hash(hash, std::hash<double>()(key.params.distanceCostExponent));
+    hash = combine_hash(hash, std::hash<int>()(key.params.mode));
+    return hash;
+}
+
+
+bool PathCache::makeKey(const pose_xyt_t& start,
+                        const pose_xyt_t& goal,
+                        const SearchParams& params,
+                        const ObstacleDistanceGrid& distances,
+                        Key& key) const
+{
+    auto startCell = global_position_to_grid_cell(Point<double>(start.x, start.y), distances);
+    auto goalCell = global_position_to_grid_cell(Point<double>(goal.x, goal.y), distances);
+
+    if(!distances.isCellInGrid(startCell.x, startCell.y) || !distances.isCellInGrid(goalCell.x, goalCell.y))
+    {
+        return false;
+    }
+
+    key.startIndex = startCell.y*distances.widthInCells() + startCell.x;
+    key.goalIndex = goalCell.y*distances.widthInCells() + goalCell.x;
+    key.params = params;
+    return true;
+}
+
+
+bool PathCache::isPathTraversable(const robot_path_t& path,
+                                  const SearchParams& params,
+                                  const ObstacleDistanceGrid& distances) const
+{
+    // The path holds every cell from the start to the goal, so checking each pose checks every cell the robot crosses.
+    // Use the same margin as the search so a carried-over path is one the search could have found.
+    for(auto& pose : path.path)
+    {
+        auto cell = global_position_to_grid_cell(Point<double>(pose.x, pose.y), distances);
+        if(!distances.isCellInGrid(cell.x, cell.y)
+            || (distances(cell.x, cell.y) <= params.minDistanceToObstacle*1.000001))
+        {
+            return false;
+        }
+    }
+    return true;
+}
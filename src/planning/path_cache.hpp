@@ -0,0 +1,130 @@
+#ifndef PLANNING_PATH_CACHE_HPP
+#define PLANNING_PATH_CACHE_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <lcmtypes/pose_xyt_t.hpp>
+#include <planning/astar.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+class ObstacleDistanceGrid;
+
+/**
+* PathCache remembers the paths found by recent searches, so a repeated query can be answered without searching again.
+*
+* Paths are keyed by the start and goal cells and the search parameters, so any two queries whose start and goal poses
+* fall in the same cells share a path. Each path is stamped with the generation of the map it was found in, which the
+* owner increments whenever the obstacle distances change:
+*
+*   - A path found in the current generation is returned as is.
+*   - A path found in an older generation is checked against the current distances. If every cell along it can still be
+*     traversed, it's stamped with the current generation and returned. Otherwise, it's dropped. A failed search is
+*     never carried over to a new generation, since the change might have opened a path.
+*
+* A carried-over path is still safe, but it might no longer be the cheapest path if obstacles were removed since it was
+* found.
+*
+* When the cache is full, the least recently used path is evicted.
+*/
+class PathCache
+{
+public:
+
+    /**
+    * Constructor for PathCache.
+    *
+    * \param    capacity            Maximum number of paths to keep (optional, default = 64)
+    */
+    explicit PathCache(std::size_t capacity = 64);
+
+    /**
+    * find looks up the path for a query.
+    *
+    * \param    start               Starting pose of the query
+    * \param    goal                Goal pose of the query
+    * \param    params              Parameters of the search
+    * \param    distances           Current obstacle distances
+    * \param    generation          Generation of the current distances
+    * \param    path                Path to the goal, if one was found (output)
+    * \return   True if the cache held a valid path for the query. The path starts at start, like a new search would.
+    */
+    bool find(const pose_xyt_t& start,
+              const pose_xyt_t& goal,
+              const SearchParams& params,
+              const ObstacleDistanceGrid& distances,
+              uint64_t generation,
+              robot_path_t& path);
+
+    /**
+    * insert adds the path found by a search to the cache, replacing any path already kept for the same query.
+    *
+    * \param    start               Starting pose of the query
+    * \param    goal                Goal pose of the query
+    * \param    params              Parameters of the search
+    * \param    distances           Obstacle distances the search used
+    * \param    generation          Generation of the distances
+    * \param    path                Path found by the search
+    */
+    void insert(const pose_xyt_t& start,
+                const pose_xyt_t& goal,
+                const SearchParams& params,
+                const ObstacleDistanceGrid& distances,
+                uint64_t generation,
+                const robot_path_t& path);
+
+    /**
+    * clear removes every path from the cache. The hit and miss counts are kept.
+    */
+    void clear(void);
+
+    std::size_t size(void) const { return entries_.size(); }
+    std::size_t capacity(void) const { return capacity_; }
+
+    std::size_t numHits(void) const { return numHits_; }
+    std::size_t numMisses(void) const { return numMisses_; }
+
+private:
+
+    struct Key
+    {
+        int startIndex;
+        int goalIndex;
+        SearchParams params;
+
+        bool operator==(const Key& rhs) const;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        uint64_t generation;
+        robot_path_t path;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    std::size_t capacity_;
+    EntryList entries_;                                             // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index_;   // where each key's entry is in entries_
+
+    std::size_t numHits_;
+    std::size_t numMisses_;
+
+    bool makeKey(const pose_xyt_t& start,
+                 const pose_xyt_t& goal,
+                 const SearchParams& params,
+                 const ObstacleDistanceGrid& distances,
+                 Key& key) const;
+    bool isPathTraversable(const robot_path_t& path,
+                           const SearchParams& params,
+                           const ObstacleDistanceGrid& distances) const;
+};
+
+#endif // PLANNING_PATH_CACHE_HPP
@@ -0,0 +1,338 @@
+#include <planning/astar.hpp>
+#include <planning/astar_workspace.hpp>
+#include <planning/path_cache.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* The path cache test checks that PathCache answers repeated queries with the paths a new search would find:
+*
+*   - repeated and near-duplicate queries, whose poses are in the same cells, hit the cache,
+*   - paths blocked by a map change are dropped, while paths the change doesn't touch are kept,
+*   - the least recently used path is evicted when the cache is full,
+*   - a hit takes microseconds, compared to the search it replaces.
+*
+* Run it from the bin/ directory so the map paths resolve.
+*/
+
+
+bool test_repeated_queries(void);
+bool test_map_changes(void);
+bool test_lru_eviction(void);
+bool test_hit_timing(void);
+
+pose_xyt_t pose_in_cell(const pose_xyt_t& pose, double fraction, const ObstacleDistanceGrid& distances);
+bool same_path(const robot_path_t& lhs, const robot_path_t& rhs);
+bool is_path_traversable(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params);
+
+
+int main(int argc, char** argv)
+{
+    if(test_repeated_queries())
+    {
+        std::cout << "PASSED: test_repeated_queries\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_repeated_queries\n";
+    }
+
+    if(test_map_changes())
+    {
+        std::cout << "PASSED: test_map_changes\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_map_changes\n";
+    }
+
+    if(test_lru_eviction())
+    {
+        std::cout << "PASSED: test_lru_eviction\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_lru_eviction\n";
+    }
+
+    if(test_hit_timing())
+    {
+        std::cout << "PASSED: test_hit_timing\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_hit_timing\n";
+    }
+
+    return 0;
+}
+
+
+bool test_repeated_queries(void)
+{
+    const std::vector<std::string> maps = { "empty", "filled", "narrow", "wide", "convex", "maze" };
+    const SearchParams params = search_params();
+
+    for(auto& name : maps)
+    {
+        OccupancyGrid grid;
+        std::vector<PlanQuery> queries;
+        if(!load_map(name, grid, queries, true))
+        {
+            return false;
+        }
+
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        PathCache cache;
+        for(auto& query : queries)
+        {
+            robot_path_t path;
+            if(cache.find(query.start, query.goal, params, distances, 0, path))
+            {
+                std::cout << "Empty cache had a path on " << name << " map\n";
+                return false;
+            }
+
+            robot_path_t searchPath = search_for_path(query.start, query.goal, distances, params);
+            cache.insert(query.start, query.goal, params, distances, 0, searchPath);
+
+            if(!cache.find(query.start, query.goal, params, distances, 0, path) || !same_path(path, searchPath))
+            {
+                std::cout << "Repeated query didn't return the searched path on " << name << " map\n";
+                return false;
+            }
+
+            // Moving the start and goal within their cells must give the path a new search would find
+            pose_xyt_t nearStart = pose_in_cell(query.start, 0.3, distances);
+            pose_xyt_t nearGoal = pose_in_cell(query.goal, 0.7, distances);
+            robot_path_t nearSearchPath = search_for_path(nearStart, nearGoal, distances, params);
+            if(!cache.find(nearStart, nearGoal, params, distances, 0, path) || !same_path(path, nearSearchPath))
+            {
+                std::cout << "Near-duplicate query didn't return the searched path on " << name << " map\n";
+                return false;
+            }
+        }
+
+        if((cache.numHits() != 2 * queries.size()) || (cache.numMisses() != queries.size()))
+        {
+            std::cout << "Counted " << cache.numHits() << " hits and " << cache.numMisses() << " misses for "
+                << queries.size() << " queries on " << name << " map\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_map_changes(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("maze", grid, queries, true))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    bool allCorrect = true;
+
+    for(auto& query : queries)
+    {
+        ObstacleDistanceGrid distances;
+        distances.setDistances(grid);
+
+        PathCache cache;
+        robot_path_t searchPath = search_for_path(query.start, query.goal, distances, params);
+        cache.insert(query.start, query.goal, params, distances, 0, searchPath);
+        if(searchPath.path_length < 3)
+        {
+            // A failed search must be searched again after any change
+            robot_path_t path;
+            distances.setDistances(grid);
+            if(cache.find(query.start, query.goal, params, distances, 1, path))
+            {
+                std::cout << "Failed search was kept after a map change\n";
+                allCorrect = false;
+            }
+            continue;
+        }
+
+        // Put an obstacle in the corner of the map, which most paths stay clear of, then one in the middle of the path
+        cell_t cornerCell(2, 2);
+        const pose_xyt_t& middle = searchPath.path[searchPath.path_length / 2];
+        cell_t middleCell = global_position_to_grid_cell(Point<double>(middle.x, middle.y), grid);
+
+        OccupancyGrid changedGrid = grid;
+        uint64_t generation = 0;
+        for(auto blockCell : { cornerCell, middleCell })
+        {
+            changedGrid.setLogOdds(blockCell.x, blockCell.y, 127);
+            distances.setDistances(changedGrid);
+            ++generation;
+
+            bool shouldHit = is_path_traversable(searchPath, distances, params);
+
+            robot_path_t path;
+            bool isHit = cache.find(query.start, query.goal, params, distances, generation, path);
+            if(isHit != shouldHit)
+            {
+                std::cout << "Cache " << (isHit ? "kept" : "dropped") << " a path that is "
+                    << (shouldHit ? "" : "not ") << "traversable after a map change\n";
+                allCorrect = false;
+            }
+
+            if(!isHit)
+            {
+                cache.insert(query.start, query.goal, params, distances, generation,
+                             search_for_path(query.start, query.goal, distances, params));
+            }
+        }
+
+        // After the path is blocked, the cache must hold the new search's path
+        robot_path_t path;
+        robot_path_t blockedSearchPath = search_for_path(query.start, query.goal, distances, params);
+        if(!cache.find(query.start, query.goal, params, distances, generation, path)
+            || !same_path(path, blockedSearchPath))
+        {
+            std::cout << "Cache didn't return the path found after the map change\n";
+            allCorrect = false;
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_lru_eviction(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("empty", grid, queries, true) || (queries.size() < 3))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    PathCache cache(2);
+    robot_path_t path = search_for_path(queries[0].start, queries[0].goal, distances, params);
+
+    cache.insert(queries[0].start, queries[0].goal, params, distances, 0, path);
+    cache.insert(queries[1].start, queries[1].goal, params, distances, 0, path);
+
+    // Use the first path, so the second is the least recently used when the third is added
+    cache.find(queries[0].start, queries[0].goal, params, distances, 0, path);
+    cache.insert(queries[2].start, queries[2].goal, params, distances, 0, path);
+
+    return (cache.size() == 2)
+        && cache.find(queries[0].start, queries[0].goal, params, distances, 0, path)
+        && !cache.find(queries[1].start, queries[1].goal, params, distances, 0, path)
+        && cache.find(queries[2].start, queries[2].goal, params, distances, 0, path);
+}
+
+
+bool test_hit_timing(void)
+{
+    OccupancyGrid grid;
+    std::vector<PlanQuery> queries;
+    if(!load_map("maze", grid, queries, true))
+    {
+        return false;
+    }
+
+    const SearchParams params = search_params();
+
+    ObstacleDistanceGrid distances;
+    distances.setDistances(grid);
+
+    AStarWorkspace workspace;
+    PathCache cache;
+
+    const int kNumRepeats = 100;
+    double searchUs = 0.0;
+    double hitUs = 0.0;
+
+    for(auto& query : queries)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        robot_path_t searchPath = search_for_path(query.start, query.goal, distances, params, workspace);
+        auto searchTime = std::chrono::steady_clock::now();
+        cache.insert(query.start, query.goal, params, distances, 0, searchPath);
+
+        auto hitStartTime = std::chrono::steady_clock::now();
+        for(int n = 0; n < kNumRepeats; ++n)
+        {
+            robot_path_t path;
+            if(!cache.find(pose_in_cell(query.start, 0.5, distances), query.goal, params, distances, 0, path))
+            {
+                return false;
+            }
+        }
+        auto hitEndTime = std::chrono::steady_clock::now();
+
+        searchUs += std::chrono::duration<double, std::micro>(searchTime - startTime).count();
+        hitUs += std::chrono::duration<double, std::micro>(hitEndTime - hitStartTime).count() / kNumRepeats;
+    }
+
+    std::cout << "Timing: search " << (searchUs / queries.size()) << " us/query, cache hit "
+        << (hitUs / queries.size()) << " us/query\n";
+    return true;
+}
+
+
+pose_xyt_t pose_in_cell(const pose_xyt_t& pose, double fraction, const ObstacleDistanceGrid& distances)
+{
+    cell_t cell = global_position_to_grid_cell(Point<double>(pose.x, pose.y), distances);
+    Point<double> position = grid_position_to_global_position(Point<double>(cell.x + fraction, cell.y + fraction),
+                                                              distances);
+    pose_xyt_t movedPose = pose;
+    movedPose.x = position.x;
+    movedPose.y = position.y;
+    return movedPose;
+}
+
+
+bool same_path(const robot_path_t& lhs, const robot_path_t& rhs)
+{
+    if((lhs.path_length != rhs.path_length) || (lhs.path.size() != rhs.path.size()))
+    {
+        return false;
+    }
+
+    for(std::size_t n = 0; n < lhs.path.size(); ++n)
+    {
+        if((lhs.path[n].x != rhs.path[n].x) || (lhs.path[n].y != rhs.path[n].y)
+            || (lhs.path[n].theta != rhs.path[n].theta))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool is_path_traversable(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    for(auto& pose : path.path)
+    {
+        cell_t cell = global_position_to_grid_cell(Point<double>(pose.x, pose.y), distances);
+        if(distances(cell.x, cell.y) <= params.minDistanceToObstacle*1.000001)
+        {
+            return false;
+        }
+    }
+    return true;
+}
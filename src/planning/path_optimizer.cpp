@@ -0,0 +1,220 @@
+#include <planning/path_optimizer.hpp>
+#include <planning/signed_distance_field.hpp>
+#include <common/grid_utils.hpp>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+namespace
+{
+
+// Positions this close to the next cell count as being in it, as in ConfigurationSpaceBitmap::isSegmentFree
+const double kCellTolerance = 1.0e-3;
+
+// Number of positions checked per cell along a line between nodes
+const int kChecksPerCell = 4;
+
+// Once no node moves farther than this fraction of a cell in a step, the band has converged
+const double kMinMoveCells = 0.01;
+
+// Number of steps between checks of the clock
+const int kIterationsPerClockCheck = 8;
+
+
+double cell_clearance(const Point<double>& position, const SignedDistanceField& sdf)
+{
+    // Same cell as search_for_path uses for the position
+    Point<double> gridPosition = global_position_to_grid_position(position, sdf);
+    int x = static_cast<int>(std::floor(gridPosition.x + kCellTolerance));
+    int y = static_cast<int>(std::floor(gridPosition.y + kCellTolerance));
+    return sdf.isCellInGrid(x, y) ? sdf(x, y) : -std::numeric_limits<double>::infinity();
+}
+
+
+bool is_position_clear(const Point<double>& position, const SignedDistanceField& sdf, double minClearance)
+{
+    return cell_clearance(position, sdf) > minClearance*1.000001;
+}
+
+
+bool is_segment_clear(const Point<double>& start,
+                      const Point<double>& end,
+                      const SignedDistanceField& sdf,
+                      double minClearance)
+{
+    const double dx = end.x - start.x;
+    const double dy = end.y - start.y;
+    const double length = std::sqrt(dx*dx + dy*dy);
+
+    // The cell distances change by at most the distance between the cell centers, which are within half a cell
+    // diagonal of the positions in them, so a start this far from obstacles clears the whole segment
+    if(cell_clearance(start, sdf) > minClearance*1.000001 + length + M_SQRT2*sdf.metersPerCell())
+    {
+        return true;
+    }
+
+    const int numChecks = std::max(1, static_cast<int>(std::ceil(length * sdf.cellsPerMeter() * kChecksPerCell)));
+    for(int n = 0; n <= numChecks; ++n)
+    {
+        const double t = static_cast<double>(n) / numChecks;
+        if(!is_position_clear(Point<double>(start.x + t*dx, start.y + t*dy), sdf, minClearance))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::vector<Point<double>> path_to_band(const robot_path_t& path,
+                                       const SignedDistanceField& sdf,
+                                       const PathOptimizerParams& params)
+{
+    std::vector<Point<double>> nodes(1, Point<double>(path.path.front().x, path.path.front().y));
+
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        const Point<double> start = nodes.back();
+        const Point<double> end(path.path[n].x, path.path[n].y);
+        const double dx = end.x - start.x;
+        const double dy = end.y - start.y;
+        const double length = std::sqrt(dx*dx + dy*dy);
+        if(length < 1.0e-9)
+        {
+            continue;
+        }
+
+        // Grid paths have a pose in every cell, so skip poses until the nodes are about nodeSpacing apart, as long as
+        // the robot can still drive straight to the next pose
+        if(n + 1 < path.path.size())
+        {
+            const Point<double> after(path.path[n + 1].x, path.path[n + 1].y);
+            const double afterLength = std::sqrt((after.x - start.x)*(after.x - start.x)
+                + (after.y - start.y)*(after.y - start.y));
+            if((afterLength <= params.nodeSpacing) && is_segment_clear(start, after, sdf, params.minClearance))
+            {
+                continue;
+            }
+        }
+
+        const int numNodes = std::max(1, static_cast<int>(std::ceil(length / params.nodeSpacing)));
+        for(int node = 1; node < numNodes; ++node)
+        {
+            const double t = static_cast<double>(node) / numNodes;
+            nodes.push_back(Point<double>(start.x + t*dx, start.y + t*dy));
+        }
+        nodes.push_back(end);
+    }
+
+    return nodes;
+}
+
+}
+
+
+robot_path_t optimize_path(const robot_path_t& path, const SignedDistanceField& sdf, const PathOptimizerParams& params)
+{
+    if(path.path.size() < 2)
+    {
+        return path;
+    }
+
+    const int64_t deadlineUs = (params.timeBudgetUs > 0) ? utime_now() + params.timeBudgetUs : 0;
+    const double minMove = kMinMoveCells * sdf.metersPerCell();
+
+    std::vector<Point<double>> nodes = path_to_band(path, sdf, params);
+    std::vector<bool> isLinkClear(nodes.size(), false);    // if the line from node n - 1 to node n is clear
+    for(std::size_t n = 1; n < nodes.size(); ++n)
+    {
+        isLinkClear[n] = is_segment_clear(nodes[n - 1], nodes[n], sdf, params.minClearance);
+    }
+
+    // Each node moves right after its predecessor, so every step sees the latest position of the node before it
+    for(int iteration = 0; iteration < params.maxIterations; ++iteration)
+    {
+        double maxMove = 0.0;
+
+        for(std::size_t n = 1; n + 1 < nodes.size(); ++n)
+        {
+            const Point<double>& previous = nodes[n - 1];
+            const Point<double>& next = nodes[n + 1];
+            Point<double> node = nodes[n];
+
+            Point<double> move(params.smoothnessWeight * (previous.x + next.x - 2.0*node.x),
+                               params.smoothnessWeight * (previous.y + next.y - 2.0*node.y));
+
+            Point<double> gradient;
+            double clearance = sdf.interpolate(node, gradient);
+            if(clearance < params.desiredClearance)
+            {
+                move.x += params.obstacleWeight * (params.desiredClearance - clearance) * gradient.x;
+                move.y += params.obstacleWeight * (params.desiredClearance - clearance) * gradient.y;
+            }
+
+            double moveLength = std::sqrt(move.x*move.x + move.y*move.y);
+            if(moveLength < minMove)
+            {
+                continue;
+            }
+            if(moveLength > params.maxStep)
+            {
+                move.x *= params.maxStep / moveLength;
+                move.y *= params.maxStep / moveLength;
+                moveLength = params.maxStep;
+            }
+
+            // Never move a node into an obstacle or make the robot clip one on the way to a neighbor. A line that
+            // already wasn't clear, like one from a start pose near a wall, may stay that way.
+            Point<double> moved(node.x + move.x, node.y + move.y);
+            if(!is_position_clear(moved, sdf, params.minClearance))
+            {
+                continue;
+            }
+
+            bool isPreviousClear = is_segment_clear(previous, moved, sdf, params.minClearance);
+            bool isNextClear = is_segment_clear(moved, next, sdf, params.minClearance);
+            if((isLinkClear[n] && !isPreviousClear) || (isLinkClear[n + 1] && !isNextClear))
+            {
+                continue;
+            }
+
+            nodes[n] = moved;
+            isLinkClear[n] = isPreviousClear;
+            isLinkClear[n + 1] = isNextClear;
+            maxMove = std::max(maxMove, moveLength);
+        }
+
+        if(maxMove < minMove)
+        {
+            break;
+        }
+
+        if((deadlineUs > 0) && ((iteration + 1) % kIterationsPerClockCheck == 0) && (utime_now() >= deadlineUs))
+        {
+            break;
+        }
+    }
+
+    robot_path_t optimizedPath;
+    optimizedPath.utime = path.utime;
+    optimizedPath.path.reserve(nodes.size());
+    optimizedPath.path.push_back(path.path.front());
+
+    for(std::size_t n = 1; n + 1 < nodes.size(); ++n)
+    {
+        pose_xyt_t pose;
+        pose.utime = path.path.front().utime;
+        pose.x = nodes[n].x;
+        pose.y = nodes[n].y;
+        pose.theta = std::atan2(nodes[n + 1].y - nodes[n].y, nodes[n + 1].x - nodes[n].x);
+        optimizedPath.path.push_back(pose);
+    }
+
+    optimizedPath.path.push_back(path.path.back());
+    optimizedPath.path_length = optimizedPath.path.size();
+
+    return optimizedPath;
+}
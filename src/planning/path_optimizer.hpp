@@ -0,0 +1,65 @@
+#ifndef PLANNING_PATH_OPTIMIZER_HPP
+#define PLANNING_PATH_OPTIMIZER_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+#include <cstdint>
+
+class SignedDistanceField;
+
+/**
+* PathOptimizerParams defines the forces and limits of optimize_path.
+*/
+struct PathOptimizerParams
+{
+    double minClearance;        ///< Distance every node of the band keeps from the nearest obstacle, as in
+                                ///< SearchParams::minDistanceToObstacle (m)
+    double desiredClearance;    ///< Distance from obstacles within which the band is pushed away from them (m)
+    double nodeSpacing;         ///< Distance between the nodes of the band before optimizing (m)
+    double smoothnessWeight;    ///< Fraction of the way each step moves a node toward the midpoint of its neighbors,
+                                ///< which shortens and straightens the band
+    double obstacleWeight;      ///< Fraction of the missing clearance each step moves a node away from obstacles
+    double maxStep;             ///< Farthest a node moves in one step (m)
+    int maxIterations;          ///< Most steps to take
+    int64_t timeBudgetUs;       ///< Time the optimization may take (us), or 0 for no limit
+
+    /**
+    * Default constructor for PathOptimizerParams.
+    *
+    * The defaults are for the 0.05 m cells of the MBot's maps: nodes every two cells, moving at most half a cell per
+    * step, for at most 5 ms.
+    */
+    PathOptimizerParams(void)
+    : minClearance(0.1)
+    , desiredClearance(0.3)
+    , nodeSpacing(0.1)
+    , smoothnessWeight(0.4)
+    , obstacleWeight(0.5)
+    , maxStep(0.025)
+    , maxIterations(500)
+    , timeBudgetUs(5000)
+    {
+    }
+};
+
+/**
+* optimize_path refines a path for clearance and smoothness with an elastic band (Quinlan and Khatib, 1993).
+*
+* The path is turned into a band of nodes spaced params.nodeSpacing apart. Each step, every node besides the ends is
+* pulled toward the midpoint of its neighbors, like a stretched rubber band, and pushed away from any obstacle closer
+* than params.desiredClearance along the gradient of the signed distance field. The steps descend the sum of the
+* squared lengths between nodes and the squared missing clearance of each node. They stop when no node moves more
+* than a hundredth of a cell, or the iterations or time run out, so the result is always usable.
+*
+* A node only moves if the robot still fits in the cell it moves to and in every cell along the lines to its
+* neighbors, by the cell distances of the field, so the band never moves into an obstacle. The band does keep to the
+* side of each obstacle that the original path took.
+*
+* \param    path            Path to refine, in the global frame, e.g. from MotionPlanner::planPath
+* \param    sdf             Signed distance field of the map the path was planned in
+* \param    params          Forces and limits of the optimization
+* \return   The refined path, starting with the same pose as path and ending at the same position and heading. Every
+*   pose in between faces the next. Paths with fewer than two poses are returned unchanged.
+*/
+robot_path_t optimize_path(const robot_path_t& path, const SignedDistanceField& sdf, const PathOptimizerParams& params);
+
+#endif // PLANNING_PATH_OPTIMIZER_HPP
@@ -0,0 +1,358 @@
+#include <planning/path_optimizer.hpp>
+#include <planning/configuration_space_bitmap.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/path_shortcutting.hpp>
+#include <planning/signed_distance_field.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+/*
+* The path optimizer test checks optimize_path and MotionPlannerParams::optimizePaths:
+*
+*   - on generated office and cluttered maps, the A* paths and their shortcut versions are optimized. Optimized paths
+*     keep their start and goal, stay in free space, and have fewer sharp turns on average. Shortcut paths, which hug
+*     the corners they turn around, also keep farther from obstacles. A* paths already keep away from obstacles because
+*     of the distance cost, so the band trades their clearance beyond desiredClearance for a shorter, smoother path.
+*     The clearance, turns, and time to optimize each path are printed,
+*   - with optimizePaths set, planPath and planBatch return safe paths that start and end at the query's poses, and
+*     they're still optimized and safe after setMap adds an obstacle.
+*/
+
+
+const double kRobotRadius = planner_params().robotRadius;
+
+// A change of direction at a pose larger than this makes the robot stop and turn in place
+const double kTurnAngle = 0.3;
+
+// Distance between the positions checked for the clearance of a path (m)
+const double kClearanceStep = 0.01;
+
+
+struct PathStats
+{
+    double minClearance;
+    double meanClearance;
+    double numTurns;
+    double totalTurn;
+};
+
+
+bool test_generated_maps(void);
+bool test_motion_planner(void);
+
+PathStats path_stats(const robot_path_t& path, const SignedDistanceField& sdf);
+bool is_same_position(const pose_xyt_t& lhs, const pose_xyt_t& rhs);
+
+
+int main(int argc, char** argv)
+{
+    if(test_generated_maps())
+    {
+        std::cout << "PASSED: test_generated_maps\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_generated_maps\n";
+    }
+
+    if(test_motion_planner())
+    {
+        std::cout << "PASSED: test_motion_planner\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_motion_planner\n";
+    }
+
+    return 0;
+}
+
+
+bool test_generated_maps(void)
+{
+    const int kNumQueries = 30;
+
+    std::vector<std::pair<std::string, OccupancyGrid>> maps;
+    maps.push_back(std::make_pair("office", generate_office_grid(20.0f, 0.05f, 3.0, 1)));
+    maps.push_back(std::make_pair("cluttered", generate_cluttered_grid(20.0f, 0.05f, 0.1, 1)));
+
+    PathOptimizerParams params;
+    params.minClearance = kRobotRadius;
+    params.desiredClearance = 3.0 * kRobotRadius;
+
+    printf("%-10s %-9s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+           "map", "input", "min m", "optimized", "mean m", "optimized", "turns", "optimized", "turn rad", "optimized",
+           "us");
+
+    bool allCorrect = true;
+    for(auto& map : maps)
+    {
+        MotionPlanner planner = make_planner(map.second);
+        const ConfigurationSpaceBitmap& cspace = planner.configurationSpace();
+        SignedDistanceField sdf;
+        sdf.build(map.second);
+
+        std::vector<robot_path_t> plannedPaths;
+        for(auto& query : random_queries(planner, kNumQueries, 1))
+        {
+            robot_path_t path = planner.planPath(query.start, query.goal);
+            if(path.path_length > 1)
+            {
+                plannedPaths.push_back(path);
+            }
+        }
+
+        if(plannedPaths.empty())
+        {
+            std::cout << "No paths found on " << map.first << " map\n";
+            return false;
+        }
+
+        for(int isShortcut = 0; isShortcut < 2; ++isShortcut)
+        {
+            PathStats before = { 0.0, 0.0, 0.0, 0.0 };
+            PathStats after = { 0.0, 0.0, 0.0, 0.0 };
+            double totalUs = 0.0;
+            double maxUs = 0.0;
+            int numFree = 0;
+
+            for(auto& plannedPath : plannedPaths)
+            {
+                robot_path_t path = isShortcut ? shortcut_path(plannedPath, cspace) : plannedPath;
+
+                auto startTime = std::chrono::steady_clock::now();
+                robot_path_t optimizedPath = optimize_path(path, sdf, params);
+                auto endTime = std::chrono::steady_clock::now();
+                double pathUs = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+                totalUs += pathUs;
+                maxUs = std::max(maxUs, pathUs);
+
+                PathStats pathStats = path_stats(path, sdf);
+                PathStats optimizedStats = path_stats(optimizedPath, sdf);
+                before.minClearance += pathStats.minClearance;
+                before.meanClearance += pathStats.meanClearance;
+                before.numTurns += pathStats.numTurns;
+                before.totalTurn += pathStats.totalTurn;
+                after.minClearance += optimizedStats.minClearance;
+                after.meanClearance += optimizedStats.meanClearance;
+                after.numTurns += optimizedStats.numTurns;
+                after.totalTurn += optimizedStats.totalTurn;
+                numFree += cspace.isPathFree(optimizedPath);
+
+                if((optimizedPath.path_length != static_cast<int32_t>(optimizedPath.path.size()))
+                    || !is_same_position(optimizedPath.path.front(), path.path.front())
+                    || (optimizedPath.path.front().theta != path.path.front().theta)
+                    || !is_same_position(optimizedPath.path.back(), path.path.back())
+                    || (optimizedStats.minClearance < kRobotRadius))
+                {
+                    std::cout << "Optimized path on " << map.first << " map moved its ends or hit an obstacle\n";
+                    allCorrect = false;
+                }
+            }
+
+            const double numPaths = plannedPaths.size();
+            printf("%-10s %-9s %10.3f %10.3f %10.3f %10.3f %10.1f %10.1f %10.2f %10.2f %10.1f\n",
+                   map.first.c_str(),
+                   isShortcut ? "shortcut" : "A*",
+                   before.minClearance / numPaths,
+                   after.minClearance / numPaths,
+                   before.meanClearance / numPaths,
+                   after.meanClearance / numPaths,
+                   before.numTurns / numPaths,
+                   after.numTurns / numPaths,
+                   before.totalTurn / numPaths,
+                   after.totalTurn / numPaths,
+                   totalUs / numPaths);
+
+            // The band checks the cells of the field, while the configuration space checks lines between cell
+            // centers, so a few paths that cut a corner by a hair may fail the stricter check
+            if(numFree < 0.9 * numPaths)
+            {
+                std::cout << "Only " << numFree << " of " << numPaths << " optimized paths on " << map.first
+                    << " map are free in the configuration space\n";
+                allCorrect = false;
+            }
+
+            if(after.numTurns >= before.numTurns)
+            {
+                std::cout << "Optimizing didn't smooth the paths on " << map.first << " map\n";
+                allCorrect = false;
+            }
+
+            if(isShortcut && (after.minClearance <= before.minClearance))
+            {
+                std::cout << "Optimizing didn't add clearance to the shortcut paths on " << map.first << " map\n";
+                allCorrect = false;
+            }
+
+            // The budget is checked every few iterations, so allow for the iterations after it runs out
+            if(maxUs > 2.0 * params.timeBudgetUs)
+            {
+                std::cout << "Optimizing a path took " << maxUs << " us with a budget of " << params.timeBudgetUs
+                    << " us\n";
+                allCorrect = false;
+            }
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_motion_planner(void)
+{
+    OccupancyGrid grid = generate_office_grid(20.0f, 0.05f, 3.0, 2);
+    MotionPlanner planner = make_planner(grid);
+    MotionPlannerParams params = planner_params();
+    params.optimizePaths = true;
+    MotionPlanner optimizingPlanner = make_planner(grid, params);
+
+    std::vector<PlanQuery> queries = random_queries(planner, 20, 2);
+    std::vector<PlanResult> results = optimizingPlanner.planBatch(queries, 2);
+
+    int numOptimized = 0;
+    for(std::size_t n = 0; n < queries.size(); ++n)
+    {
+        robot_path_t plannedPath = planner.planPath(queries[n].start, queries[n].goal);
+        robot_path_t path = optimizingPlanner.planPath(queries[n].start, queries[n].goal);
+
+        if(plannedPath.path_length < 2)
+        {
+            continue;
+        }
+
+        for(auto& candidate : { path, results[n].path })
+        {
+            if(!optimizingPlanner.isPathSafe(candidate)
+                || !is_same_position(candidate.path.front(), queries[n].start)
+                || !is_same_position(candidate.path.back(), plannedPath.path.back()))
+            {
+                std::cout << "Query " << n << " has an unsafe optimized path or moved its ends\n";
+                return false;
+            }
+        }
+
+        numOptimized += (path.path_length != plannedPath.path_length) || (path.path[1].x != plannedPath.path[1].x)
+            || (path.path[1].y != plannedPath.path[1].y);
+    }
+
+    // Optimized paths have fewer, evenly spaced poses, so nearly every path changes
+    if(numOptimized == 0)
+    {
+        std::cout << "planPath didn't optimize any paths\n";
+        return false;
+    }
+
+    // Block the middle of a path. The signed distances are only rebuilt by the next optimized path, which must keep
+    // optimizing paths safely around the new obstacle.
+    for(auto& result : results)
+    {
+        if(result.path.path_length > 2)
+        {
+            const pose_xyt_t& middle = result.path.path[result.path.path_length / 2];
+            Point<int> middleCell = global_position_to_grid_cell(Point<double>(middle.x, middle.y), grid);
+            for(int y = middleCell.y - 3; y <= middleCell.y + 3; ++y)
+            {
+                for(int x = middleCell.x - 3; x <= middleCell.x + 3; ++x)
+                {
+                    grid.setLogOdds(x, y, 127);
+                }
+            }
+            break;
+        }
+    }
+
+    planner.setMap(grid);
+    optimizingPlanner.setMap(grid);
+    std::vector<PlanResult> changedResults = optimizingPlanner.planBatch(queries, 2);
+
+    numOptimized = 0;
+    for(std::size_t n = 0; n < queries.size(); ++n)
+    {
+        robot_path_t plannedPath = planner.planPath(queries[n].start, queries[n].goal);
+        const robot_path_t& path = changedResults[n].path;
+
+        if(plannedPath.path_length < 2)
+        {
+            continue;
+        }
+
+        if(!optimizingPlanner.isPathSafe(path) || !is_same_position(path.path.back(), plannedPath.path.back()))
+        {
+            std::cout << "Query " << n << " has an unsafe optimized path after the map changed\n";
+            return false;
+        }
+
+        numOptimized += (path.path_length != plannedPath.path_length) || (path.path[1].x != plannedPath.path[1].x)
+            || (path.path[1].y != plannedPath.path[1].y);
+    }
+
+    if(numOptimized == 0)
+    {
+        std::cout << "planBatch didn't optimize any paths after the map changed\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+PathStats path_stats(const robot_path_t& path, const SignedDistanceField& sdf)
+{
+    PathStats stats = { std::numeric_limits<double>::max(), 0.0, 0.0, 0.0 };
+    int numSamples = 0;
+
+    double previousDirection = 0.0;
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        double dx = path.path[n].x - path.path[n - 1].x;
+        double dy = path.path[n].y - path.path[n - 1].y;
+        double length = std::sqrt(dx*dx + dy*dy);
+
+        // Clearance is measured at the cells the robot passes through, as the planner does
+        int numSteps = std::max(1, static_cast<int>(std::ceil(length / kClearanceStep)));
+        for(int step = (n == 1) ? 0 : 1; step <= numSteps; ++step)
+        {
+            Point<double> position(path.path[n - 1].x + dx*step/numSteps, path.path[n - 1].y + dy*step/numSteps);
+            cell_t cell = global_position_to_grid_cell(position, sdf);
+            double clearance = sdf.isCellInGrid(cell.x, cell.y) ? sdf(cell.x, cell.y) : 0.0;
+            stats.minClearance = std::min(stats.minClearance, clearance);
+            stats.meanClearance += clearance;
+            ++numSamples;
+        }
+
+        if(length < 1.0e-9)
+        {
+            continue;
+        }
+
+        double direction = std::atan2(dy, dx);
+        if(n > 1)
+        {
+            double turn = std::abs(std::remainder(direction - previousDirection, 2.0 * M_PI));
+            stats.numTurns += turn > kTurnAngle;
+            stats.totalTurn += turn;
+        }
+        previousDirection = direction;
+    }
+
+    stats.meanClearance /= std::max(numSamples, 1);
+    return stats;
+}
+
+
+bool is_same_position(const pose_xyt_t& lhs, const pose_xyt_t& rhs)
+{
+    return (lhs.x == rhs.x) && (lhs.y == rhs.y);
+}
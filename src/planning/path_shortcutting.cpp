@@ -0,0 +1,50 @@
+#include <planning/path_shortcutting.hpp>
+#include <planning/configuration_space_bitmap.hpp>
+#include <common/grid_utils.hpp>
+#include <cmath>
+#include <vector>
+
+
+robot_path_t shortcut_path(const robot_path_t& path, const ConfigurationSpaceBitmap& cspace)
+{
+    if(path.path.size() < 3)
+    {
+        return path;
+    }
+
+    std::vector<Point<double>> positions;
+    positions.reserve(path.path.size());
+    for(auto& pose : path.path)
+    {
+        positions.push_back(global_position_to_grid_position(Point<double>(pose.x, pose.y), cspace));
+    }
+
+    // Extend the segment from the last kept pose one pose at a time until it's blocked, then keep the last pose it
+    // reached. A pose is always visible from the one before it, as long as the original path was free.
+    std::vector<std::size_t> keptPoses(1, 0);
+    for(std::size_t next = 1; next + 1 < path.path.size(); ++next)
+    {
+        if(!cspace.isSegmentFree(positions[keptPoses.back()], positions[next + 1]))
+        {
+            keptPoses.push_back(next);
+        }
+    }
+    keptPoses.push_back(path.path.size() - 1);
+
+    robot_path_t shortcutPath;
+    shortcutPath.utime = path.utime;
+    shortcutPath.path_length = keptPoses.size();
+    shortcutPath.path.reserve(keptPoses.size());
+    for(std::size_t n = 0; n < keptPoses.size(); ++n)
+    {
+        pose_xyt_t pose = path.path[keptPoses[n]];
+        if((n > 0) && (n + 1 < keptPoses.size()))
+        {
+            const pose_xyt_t& nextPose = path.path[keptPoses[n + 1]];
+            pose.theta = std::atan2(nextPose.y - pose.y, nextPose.x - pose.x);
+        }
+        shortcutPath.path.push_back(pose);
+    }
+
+    return shortcutPath;
+}
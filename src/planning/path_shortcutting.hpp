@@ -0,0 +1,26 @@
+#ifndef PLANNING_PATH_SHORTCUTTING_HPP
+#define PLANNING_PATH_SHORTCUTTING_HPP
+
+#include <lcmtypes/robot_path_t.hpp>
+
+class ConfigurationSpaceBitmap;
+
+/**
+* shortcut_path removes the poses of a path that the robot can skip by driving in a straight line past them.
+*
+* A* paths have a pose at every cell, so the robot follows a staircase of short moves along any diagonal. Starting from
+* the first pose, the straight line to each following pose is checked until the robot no longer fits in every cell
+* along it. The last pose reached is kept, and the search repeats from there. Line of sight is checked with
+* ConfigurationSpaceBitmap::isSegmentFree, so each check costs a few bit operations, and the shortcut path is free
+* whenever the original was.
+*
+* The first and last poses are kept as they are. Every other pose kept faces the next one.
+*
+* \param    path            Path to shorten, in the global frame
+* \param    cspace          Configuration space of the robot the path was planned for
+* \return   A path through a subset of the poses of path, never longer than it. Paths with fewer than three poses are
+*   returned unchanged.
+*/
+robot_path_t shortcut_path(const robot_path_t& path, const ConfigurationSpaceBitmap& cspace);
+
+#endif // PLANNING_PATH_SHORTCUTTING_HPP
@@ -0,0 +1,312 @@
+#include <planning/path_shortcutting.hpp>
+#include <planning/configuration_space_bitmap.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <planning/planning_test_utils.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+* The path shortcutting test checks shortcut_path and MotionPlannerParams::shortcutPaths:
+*
+*   - on generated maze, office, and cluttered maps, every shortcut path is free, keeps the start and goal, and is no
+*     longer than the A* path it came from. The poses, length, and turns of the paths before and after shortcutting,
+*     and the time to shortcut each path, are printed,
+*   - a path across an empty map is shortcut to a straight line,
+*   - with shortcutPaths set, planPath, planBatch, replanPath, and pathFromCostField all return the shortcut paths.
+*/
+
+
+const double kRobotRadius = planner_params().robotRadius;
+
+// A change of direction at a pose larger than this makes the robot stop and turn in place
+const double kTurnAngle = 0.3;
+
+
+struct PathStats
+{
+    double numPoses;
+    double length;
+    double numTurns;
+};
+
+
+bool test_generated_maps(void);
+bool test_straight_line(void);
+bool test_motion_planner(void);
+
+PathStats path_stats(const robot_path_t& path);
+bool is_same_pose(const pose_xyt_t& lhs, const pose_xyt_t& rhs);
+bool is_same_path(const robot_path_t& lhs, const robot_path_t& rhs);
+
+
+int main(int argc, char** argv)
+{
+    if(test_generated_maps())
+    {
+        std::cout << "PASSED: test_generated_maps\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_generated_maps\n";
+    }
+
+    if(test_straight_line())
+    {
+        std::cout << "PASSED: test_straight_line\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_straight_line\n";
+    }
+
+    if(test_motion_planner())
+    {
+        std::cout << "PASSED: test_motion_planner\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_motion_planner\n";
+    }
+
+    return 0;
+}
+
+
+bool test_generated_maps(void)
+{
+    const int kNumQueries = 30;
+
+    std::vector<std::pair<std::string, OccupancyGrid>> maps;
+    maps.push_back(std::make_pair("maze", generate_maze_grid(20.0f, 0.05f, 1.0, 1)));
+    maps.push_back(std::make_pair("office", generate_office_grid(20.0f, 0.05f, 3.0, 1)));
+    maps.push_back(std::make_pair("cluttered", generate_cluttered_grid(20.0f, 0.05f, 0.1, 1)));
+
+    printf("%-10s %10s %10s %10s %10s %10s %10s %10s\n",
+           "map", "poses", "shortcut", "length m", "shortcut", "turns", "shortcut", "us");
+
+    bool allCorrect = true;
+    for(auto& map : maps)
+    {
+        MotionPlanner planner = make_planner(map.second);
+        const ConfigurationSpaceBitmap& cspace = planner.configurationSpace();
+
+        PathStats before = { 0.0, 0.0, 0.0 };
+        PathStats after = { 0.0, 0.0, 0.0 };
+        double totalUs = 0.0;
+        int numPaths = 0;
+
+        for(auto& query : random_queries(planner, kNumQueries, 1))
+        {
+            robot_path_t path = planner.planPath(query.start, query.goal);
+            if(path.path_length < 2)
+            {
+                continue;
+            }
+
+            auto startTime = std::chrono::steady_clock::now();
+            robot_path_t shortcutPath = shortcut_path(path, cspace);
+            auto endTime = std::chrono::steady_clock::now();
+            totalUs += std::chrono::duration<double, std::micro>(endTime - startTime).count();
+            ++numPaths;
+
+            PathStats pathStats = path_stats(path);
+            PathStats shortcutStats = path_stats(shortcutPath);
+            before.numPoses += pathStats.numPoses;
+            before.length += pathStats.length;
+            before.numTurns += pathStats.numTurns;
+            after.numPoses += shortcutStats.numPoses;
+            after.length += shortcutStats.length;
+            after.numTurns += shortcutStats.numTurns;
+
+            if(!cspace.isPathFree(shortcutPath)
+                || (shortcutPath.path_length != static_cast<int32_t>(shortcutPath.path.size()))
+                || !is_same_pose(shortcutPath.path.front(), path.path.front())
+                || !is_same_pose(shortcutPath.path.back(), path.path.back())
+                || (shortcutStats.length > pathStats.length + 1.0e-4)
+                || (shortcutStats.numPoses > pathStats.numPoses))
+            {
+                std::cout << "Shortcut path on " << map.first << " map isn't free, moved its ends, or got longer\n";
+                allCorrect = false;
+            }
+        }
+
+        if(numPaths == 0)
+        {
+            std::cout << "No paths found on " << map.first << " map\n";
+            return false;
+        }
+
+        printf("%-10s %10.1f %10.1f %10.2f %10.2f %10.1f %10.1f %10.1f\n",
+               map.first.c_str(),
+               before.numPoses / numPaths,
+               after.numPoses / numPaths,
+               before.length / numPaths,
+               after.length / numPaths,
+               before.numTurns / numPaths,
+               after.numTurns / numPaths,
+               totalUs / numPaths);
+
+        // Paths through open space should lose most of their poses
+        if(after.numPoses > 0.5 * before.numPoses)
+        {
+            std::cout << "Shortcutting only removed " << (before.numPoses - after.numPoses) << " of "
+                << before.numPoses << " poses on " << map.first << " map\n";
+            allCorrect = false;
+        }
+    }
+
+    return allCorrect;
+}
+
+
+bool test_straight_line(void)
+{
+    OccupancyGrid grid = generate_uniform_grid(10.0f, 10.0f, 0.05f, -100);
+    MotionPlanner planner = make_planner(grid);
+
+    Point<double> start = grid_position_to_global_position(Point<double>(50.5, 40.5), grid);
+    Point<double> goal = grid_position_to_global_position(Point<double>(150.5, 110.5), grid);
+
+    pose_xyt_t startPose;
+    startPose.utime = 0;
+    startPose.x = start.x;
+    startPose.y = start.y;
+    startPose.theta = 1.0f;
+    pose_xyt_t goalPose = startPose;
+    goalPose.x = goal.x;
+    goalPose.y = goal.y;
+
+    robot_path_t path = planner.planPath(startPose, goalPose);
+    robot_path_t shortcutPath = shortcut_path(path, planner.configurationSpace());
+
+    if((path.path_length < 3) || (shortcutPath.path_length != 2))
+    {
+        std::cout << "Straight path has " << shortcutPath.path_length << " poses instead of 2, shortcut from "
+            << path.path_length << '\n';
+        return false;
+    }
+
+    // The start keeps its heading, as does the goal, which is placed at the corner of its cell by the search
+    return is_same_pose(shortcutPath.path.front(), startPose)
+        && (shortcutPath.path.back().theta == startPose.theta);
+}
+
+
+bool test_motion_planner(void)
+{
+    OccupancyGrid grid = generate_office_grid(20.0f, 0.05f, 3.0, 2);
+    MotionPlanner planner = make_planner(grid);
+    MotionPlannerParams params = planner_params();
+    params.shortcutPaths = true;
+    MotionPlanner shortcutPlanner = make_planner(grid, params);
+
+    std::vector<PlanQuery> queries = random_queries(planner, 20, 2);
+    std::vector<PlanResult> results = shortcutPlanner.planBatch(queries, 2);
+
+    for(std::size_t n = 0; n < queries.size(); ++n)
+    {
+        robot_path_t expectedPath = shortcut_path(planner.planPath(queries[n].start, queries[n].goal),
+                                                  planner.configurationSpace());
+        robot_path_t path = shortcutPlanner.planPath(queries[n].start, queries[n].goal);
+
+        // The second query comes out of the cache, which must be shortcut too
+        robot_path_t cachedPath = shortcutPlanner.planPath(queries[n].start, queries[n].goal);
+
+        if(!is_same_path(path, expectedPath) || !is_same_path(cachedPath, expectedPath)
+            || !is_same_path(results[n].path, expectedPath))
+        {
+            std::cout << "Query " << n << " wasn't shortcut by planPath or planBatch\n";
+            return false;
+        }
+
+        if(!shortcutPlanner.isPathSafe(path))
+        {
+            std::cout << "Query " << n << " has an unsafe shortcut path\n";
+            return false;
+        }
+    }
+
+    robot_path_t replannedPath = shortcutPlanner.replanPath(queries.front().start, queries.front().goal);
+    robot_path_t expectedPath = shortcut_path(planner.replanPath(queries.front().start, queries.front().goal),
+                                              planner.configurationSpace());
+    if(!shortcutPlanner.isPathSafe(replannedPath) || !is_same_path(replannedPath, expectedPath))
+    {
+        std::cout << "replanPath didn't return a safe shortcut path\n";
+        return false;
+    }
+
+    // Exploration reads its paths out of the cost field
+    planner.expandCostField(queries.front().start);
+    shortcutPlanner.expandCostField(queries.front().start);
+    for(std::size_t n = 0; n < queries.size(); ++n)
+    {
+        robot_path_t fieldPath = shortcutPlanner.pathFromCostField(queries[n].goal);
+        robot_path_t expectedFieldPath = shortcut_path(planner.pathFromCostField(queries[n].goal),
+                                                       planner.configurationSpace());
+        if(!shortcutPlanner.isPathSafe(fieldPath) || !is_same_path(fieldPath, expectedFieldPath))
+        {
+            std::cout << "pathFromCostField didn't return a safe shortcut path for query " << n << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+PathStats path_stats(const robot_path_t& path)
+{
+    PathStats stats = { static_cast<double>(path.path.size()), 0.0, 0.0 };
+
+    double previousDirection = 0.0;
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        double dx = path.path[n].x - path.path[n - 1].x;
+        double dy = path.path[n].y - path.path[n - 1].y;
+        stats.length += std::sqrt(dx*dx + dy*dy);
+
+        double direction = std::atan2(dy, dx);
+        if(n > 1)
+        {
+            double turn = std::abs(std::remainder(direction - previousDirection, 2.0 * M_PI));
+            stats.numTurns += turn > kTurnAngle;
+        }
+        previousDirection = direction;
+    }
+
+    return stats;
+}
+
+
+bool is_same_pose(const pose_xyt_t& lhs, const pose_xyt_t& rhs)
+{
+    return (lhs.x == rhs.x) && (lhs.y == rhs.y) && (lhs.theta == rhs.theta);
+}
+
+
+bool is_same_path(const robot_path_t& lhs, const robot_path_t& rhs)
+{
+    if((lhs.path_length != rhs.path_length) || (lhs.path.size() != rhs.path.size()))
+    {
+        return false;
+    }
+
+    for(std::size_t n = 0; n < lhs.path.size(); ++n)
+    {
+        if(!is_same_pose(lhs.path[n], rhs.path[n]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,551 @@
+#include <planning/map_generators.hpp>
+#include <planning/motion_planner.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <common/getopt.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+* planning_bench measures how MotionPlanner::planPath scales with the size of the map. For each kind of generated map
+* (maze, office, cluttered) and each size, it runs a fixed set of random queries and reports:
+*
+*   - the time for setMap to build the obstacle distances,
+*   - the number of cells expanded per query,
+*   - the mean and p50/p95/p99 latency of planPath,
+*   - the mean cost of the paths found, using the search's own step costs,
+*   - the peak resident memory of the process after the map's queries. Sizes run from smallest to largest, so this is
+*     the memory needed for the largest map so far.
+*
+* The maps and queries only depend on the seed, so runs with the same options plan the same paths. The results are
+* written as JSON, one result per line. Passing a previous run's JSON with --compare prints the change in each metric
+* and exits with an error if any got worse by more than --tolerance, so the benchmark can guard against regressions.
+*/
+
+struct BenchResult
+{
+    std::string map;
+    int sizeInMeters;
+    int widthInCells;
+    int numQueries;
+    int numPathsFound;
+    double setMapMs;
+    double meanExpanded;
+    std::size_t maxExpanded;
+    double meanLatencyUs;
+    double p50LatencyUs;
+    double p95LatencyUs;
+    double p99LatencyUs;
+    double meanPathCost;
+    long peakRssKb;
+};
+
+// Metrics checked by --compare, in the order they're printed. Larger is worse for all of them.
+const char* kComparedMetrics[] = { "latency_p50_us", "latency_p95_us", "latency_p99_us", "expanded_mean",
+                                   "path_cost_mean", "peak_rss_kb" };
+
+
+OccupancyGrid generate_map(const std::string& map, int sizeInMeters, uint32_t seed);
+std::vector<std::pair<pose_xyt_t, pose_xyt_t>> generate_queries(const ObstacleDistanceGrid& distances,
+                                                                 double robotRadius,
+                                                                 int numQueries,
+                                                                 uint32_t seed);
+BenchResult run_bench(const std::string& map,
+                      int sizeInMeters,
+                      int numQueries,
+                      uint32_t seed,
+                      SearchMode mode,
+                      int64_t timeBudgetUs);
+double path_cost(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params);
+double percentile(const std::vector<double>& sortedValues, double fraction);
+long peak_rss_kb(void);
+std::vector<std::string> split(const std::string& list);
+void write_result(const BenchResult& result, std::ostream& out);
+bool load_results(const std::string& filename, std::map<std::string, std::map<std::string, double>>& results);
+bool compare_results(const std::string& baselineFilename, const std::string& currentFilename, double tolerance);
+
+
+int main(int argc, char** argv)
+{
+    const char* kSizesArg = "sizes";
+    const char* kMapsArg = "maps";
+    const char* kNumQueriesArg = "num-queries";
+    const char* kSeedArg = "seed";
+    const char* kSearchModeArg = "search-mode";
+    const char* kTimeBudgetArg = "time-budget";
+    const char* kOutputArg = "output";
+    const char* kCompareArg = "compare";
+    const char* kToleranceArg = "tolerance";
+
+    getopt_t* gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_string(gopt, 's', kSizesArg, "10,25,50,100,200", "Comma-separated widths of the square maps (m)");
+    getopt_add_string(gopt, 'm', kMapsArg, "maze,office,cluttered", "Comma-separated kinds of maps to generate");
+    getopt_add_int(gopt, 'n', kNumQueriesArg, "50", "Number of queries per map");
+    getopt_add_int(gopt, '\0', kSeedArg, "1", "Seed for generating the maps and queries");
+    getopt_add_string(gopt, '\0', kSearchModeArg, "grid_astar",
+                      "Search mode: grid_astar, jump_point, hierarchical, bidirectional_astar, state_lattice, or "
+                      "anytime_astar");
+    getopt_add_int(gopt, '\0', kTimeBudgetArg, "0", "Time anytime_astar may take per query (us), or 0 for no limit");
+    getopt_add_string(gopt, 'o', kOutputArg, "planning_bench.json", "File to write the JSON results to");
+    getopt_add_string(gopt, 'c', kCompareArg, "", "JSON results of an earlier run to compare against");
+    getopt_add_double(gopt, 't', kToleranceArg, "0.1", "Fraction a metric can grow before --compare fails");
+
+    if(!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help"))
+    {
+        printf("Usage: %s [options]\n", argv[0]);
+        getopt_do_usage(gopt);
+        return 1;
+    }
+
+    const std::string modeName = getopt_get_string(gopt, kSearchModeArg);
+    SearchMode mode = grid_astar;
+    if(!search_mode_from_name(modeName, mode))
+    {
+        std::cerr << "ERROR: Unknown search mode: " << modeName << '\n';
+        return 1;
+    }
+
+    std::vector<int> sizes;
+    for(auto& size : split(getopt_get_string(gopt, kSizesArg)))
+    {
+        sizes.push_back(std::atoi(size.c_str()));
+    }
+    std::sort(sizes.begin(), sizes.end());
+
+    const std::vector<std::string> maps = split(getopt_get_string(gopt, kMapsArg));
+    const int numQueries = getopt_get_int(gopt, kNumQueriesArg);
+    const uint32_t seed = getopt_get_int(gopt, kSeedArg);
+    const int64_t timeBudgetUs = getopt_get_int(gopt, kTimeBudgetArg);
+    const std::string outputFilename = getopt_get_string(gopt, kOutputArg);
+    const std::string baselineFilename = getopt_get_string(gopt, kCompareArg);
+    const double tolerance = getopt_get_double(gopt, kToleranceArg);
+
+    std::ofstream out(outputFilename);
+    if(!out.is_open())
+    {
+        std::cerr << "ERROR: Failed to open " << outputFilename << " for writing.\n";
+        return 1;
+    }
+
+    out << "{\n"
+        << "  \"search_mode\": \"" << modeName << "\",\n"
+        << "  \"time_budget_us\": " << timeBudgetUs << ",\n"
+        << "  \"seed\": " << seed << ",\n"
+        << "  \"results\": [\n";
+
+    printf("%-10s %6s %6s %8s %10s %10s %10s %10s %10s %10s\n", "map", "size", "paths", "setMap", "expanded",
+           "p50 (us)", "p95 (us)", "p99 (us)", "cost", "rss (MB)");
+
+    bool isFirstResult = true;
+    for(int size : sizes)
+    {
+        for(auto& map : maps)
+        {
+            BenchResult result = run_bench(map, size, numQueries, seed, mode, timeBudgetUs);
+            if(result.widthInCells == 0)
+            {
+                std::cerr << "ERROR: Unknown map: " << map << '\n';
+                return 1;
+            }
+
+            printf("%-10s %5dm %3d/%-3d %6.0fms %10.0f %10.0f %10.0f %10.0f %10.2f %10.1f\n",
+                   map.c_str(),
+                   size,
+                   result.numPathsFound,
+                   result.numQueries,
+                   result.setMapMs,
+                   result.meanExpanded,
+                   result.p50LatencyUs,
+                   result.p95LatencyUs,
+                   result.p99LatencyUs,
+                   result.meanPathCost,
+                   result.peakRssKb / 1024.0);
+            fflush(stdout);
+
+            out << (isFirstResult ? "" : ",\n");
+            write_result(result, out);
+            isFirstResult = false;
+        }
+    }
+
+    out << "\n  ]\n}\n";
+    out.close();
+
+    getopt_destroy(gopt);
+
+    if(!baselineFilename.empty())
+    {
+        return compare_results(baselineFilename, outputFilename, tolerance) ? 0 : 1;
+    }
+
+    return 0;
+}
+
+
+OccupancyGrid generate_map(const std::string& map, int sizeInMeters, uint32_t seed)
+{
+    const float kMetersPerCell = 0.05f;
+
+    if(map == "maze")
+    {
+        return generate_maze_grid(sizeInMeters, kMetersPerCell, 1.0, seed);
+    }
+    else if(map == "office")
+    {
+        return generate_office_grid(sizeInMeters, kMetersPerCell, 4.0, seed);
+    }
+    else if(map == "cluttered")
+    {
+        return generate_cluttered_grid(sizeInMeters, kMetersPerCell, 0.15, seed);
+    }
+
+    return OccupancyGrid();
+}
+
+
+std::vector<std::pair<pose_xyt_t, pose_xyt_t>> generate_queries(const ObstacleDistanceGrid& distances,
+                                                                 double robotRadius,
+                                                                 int numQueries,
+                                                                 uint32_t seed)
+{
+    std::mt19937 rng(seed);
+
+    // Start and goal cells are ones the robot fits in. The float distances are compared with the same margin as the
+    // search, since a distance of exactly robotRadius as a float is slightly larger than robotRadius as a double.
+    auto randomCell = [&](cell_t& cell) {
+        for(int attempt = 0; attempt < 10000; ++attempt)
+        {
+            cell.x = rng() % distances.widthInCells();
+            cell.y = rng() % distances.heightInCells();
+            if(distances(cell.x, cell.y) > robotRadius*1.000001)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto cellPose = [&](cell_t cell) {
+        Point<double> position = grid_position_to_global_position(Point<double>(cell.x + 0.5, cell.y + 0.5),
+                                                                  distances);
+        pose_xyt_t pose;
+        pose.utime = 0;
+        pose.x = position.x;
+        pose.y = position.y;
+        pose.theta = 0.0f;
+        return pose;
+    };
+
+    // Every query has different cells, so none of them is answered by the PathCache
+    std::set<std::pair<int, int>> usedCells;
+    std::vector<std::pair<pose_xyt_t, pose_xyt_t>> queries;
+    const int width = distances.widthInCells();
+
+    while(static_cast<int>(queries.size()) < numQueries)
+    {
+        cell_t start;
+        cell_t goal;
+        if(!randomCell(start) || !randomCell(goal))
+        {
+            break;
+        }
+
+        auto cells = std::make_pair(start.y*width + start.x, goal.y*width + goal.x);
+        if((start == goal) || !usedCells.insert(cells).second)
+        {
+            continue;
+        }
+
+        queries.push_back(std::make_pair(cellPose(start), cellPose(goal)));
+    }
+
+    return queries;
+}
+
+
+BenchResult run_bench(const std::string& map,
+                      int sizeInMeters,
+                      int numQueries,
+                      uint32_t seed,
+                      SearchMode mode,
+                      int64_t timeBudgetUs)
+{
+    BenchResult result;
+    result.map = map;
+    result.sizeInMeters = sizeInMeters;
+    result.widthInCells = 0;
+
+    OccupancyGrid grid = generate_map(map, sizeInMeters, seed);
+    if(grid.widthInCells() == 0)
+    {
+        return result;
+    }
+
+    MotionPlannerParams params;
+    params.searchMode = mode;
+    params.timeBudgetUs = timeBudgetUs;
+    MotionPlanner planner(params);
+
+    auto setMapStart = std::chrono::steady_clock::now();
+    planner.setMap(grid);
+    auto setMapEnd = std::chrono::steady_clock::now();
+
+    const ObstacleDistanceGrid distances = planner.obstacleDistances();
+    SearchParams searchParams;
+    searchParams.minDistanceToObstacle = params.robotRadius;
+    searchParams.maxDistanceWithCost = 10.0 * searchParams.minDistanceToObstacle;
+    searchParams.distanceCostExponent = 1.0;
+    searchParams.mode = mode;
+
+    auto queries = generate_queries(distances, params.robotRadius, numQueries, seed);
+
+    std::vector<double> latencies;
+    std::size_t totalExpanded = 0;
+    double totalPathCost = 0.0;
+
+    result.numPathsFound = 0;
+    result.maxExpanded = 0;
+
+    for(auto& query : queries)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        robot_path_t path = planner.planPath(query.first, query.second);
+        auto endTime = std::chrono::steady_clock::now();
+
+        latencies.push_back(std::chrono::duration<double, std::micro>(endTime - startTime).count());
+        totalExpanded += planner.numExpanded();
+        result.maxExpanded = std::max(result.maxExpanded, planner.numExpanded());
+
+        if(path.path_length > 1)
+        {
+            ++result.numPathsFound;
+            totalPathCost += path_cost(path, distances, searchParams);
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const double numRun = std::max(static_cast<double>(latencies.size()), 1.0);
+    double totalLatency = 0.0;
+    for(double latency : latencies)
+    {
+        totalLatency += latency;
+    }
+
+    result.widthInCells = grid.widthInCells();
+    result.numQueries = queries.size();
+    result.setMapMs = std::chrono::duration<double, std::milli>(setMapEnd - setMapStart).count();
+    result.meanExpanded = totalExpanded / numRun;
+    result.meanLatencyUs = totalLatency / numRun;
+    result.p50LatencyUs = percentile(latencies, 0.50);
+    result.p95LatencyUs = percentile(latencies, 0.95);
+    result.p99LatencyUs = percentile(latencies, 0.99);
+    result.meanPathCost = (result.numPathsFound > 0) ? totalPathCost / result.numPathsFound : 0.0;
+    result.peakRssKb = peak_rss_kb();
+    return result;
+}
+
+
+double path_cost(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    // Each step costs its length plus the obstacle cost of the cell it enters, as in search_for_path. Jump point
+    // paths skip over cells, so the length of each step is measured instead of counting cells. Poses after the start
+    // are placed at the corner of their cell, so round to find the cell rather than truncating.
+    double cost = 0.0;
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        Point<double> position = global_position_to_grid_position(Point<double>(path.path[n].x, path.path[n].y),
+                                                                   distances);
+        cell_t cell(std::lround(position.x), std::lround(position.y));
+        double cellDistance = distances(cell.x, cell.y);
+        cost += std::sqrt(std::pow(path.path[n].x - path.path[n-1].x, 2)
+            + std::pow(path.path[n].y - path.path[n-1].y, 2));
+        if((cellDistance > params.minDistanceToObstacle) && (cellDistance < params.maxDistanceWithCost))
+        {
+            cost += std::pow(params.maxDistanceWithCost - cellDistance, params.distanceCostExponent);
+        }
+    }
+    return cost;
+}
+
+
+double percentile(const std::vector<double>& sortedValues, double fraction)
+{
+    if(sortedValues.empty())
+    {
+        return 0.0;
+    }
+
+    // Nearest-rank percentile: the smallest value with at least fraction of the values at or below it
+    std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sortedValues.size()));
+    return sortedValues[std::min(std::max(rank, static_cast<std::size_t>(1)), sortedValues.size()) - 1];
+}
+
+
+long peak_rss_kb(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while(std::getline(in, item, ','))
+    {
+        if(!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+void write_result(const BenchResult& result, std::ostream& out)
+{
+    // One result per line, so load_results can read them back without a full JSON parser
+    out << "    { \"map\": \"" << result.map << "\""
+        << ", \"size_m\": " << result.sizeInMeters
+        << ", \"width_cells\": " << result.widthInCells
+        << ", \"num_queries\": " << result.numQueries
+        << ", \"paths_found\": " << result.numPathsFound
+        << ", \"set_map_ms\": " << result.setMapMs
+        << ", \"expanded_mean\": " << result.meanExpanded
+        << ", \"expanded_max\": " << result.maxExpanded
+        << ", \"latency_mean_us\": " << result.meanLatencyUs
+        << ", \"latency_p50_us\": " << result.p50LatencyUs
+        << ", \"latency_p95_us\": " << result.p95LatencyUs
+        << ", \"latency_p99_us\": " << result.p99LatencyUs
+        << ", \"path_cost_mean\": " << result.meanPathCost
+        << ", \"peak_rss_kb\": " << result.peakRssKb
+        << " }";
+}
+
+
+bool load_results(const std::string& filename, std::map<std::string, std::map<std::string, double>>& results)
+{
+    std::ifstream in(filename);
+    if(!in.is_open())
+    {
+        std::cerr << "ERROR: Failed to open " << filename << '\n';
+        return false;
+    }
+
+    // Each result is a line of "key": value pairs written by write_result. Results are keyed by map and size.
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(line.find("\"map\"") == std::string::npos)
+        {
+            continue;
+        }
+
+        std::string map;
+        std::map<std::string, double> metrics;
+
+        std::size_t position = 0;
+        while((position = line.find('"', position)) != std::string::npos)
+        {
+            std::size_t keyEnd = line.find('"', position + 1);
+            std::size_t colon = line.find(':', keyEnd);
+            if((keyEnd == std::string::npos) || (colon == std::string::npos))
+            {
+                break;
+            }
+
+            std::string key = line.substr(position + 1, keyEnd - position - 1);
+            std::size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            std::size_t valueEnd = line.find_first_of(",}", valueStart);
+
+            if(line[valueStart] == '"')
+            {
+                valueEnd = line.find('"', valueStart + 1);
+                map = line.substr(valueStart + 1, valueEnd - valueStart - 1);
+                ++valueEnd;
+            }
+            else
+            {
+                metrics[key] = std::atof(line.substr(valueStart, valueEnd - valueStart).c_str());
+            }
+
+            position = valueEnd;
+        }
+
+        std::ostringstream name;
+        name << map << ' ' << metrics["size_m"] << 'm';
+        results[name.str()] = metrics;
+    }
+
+    return true;
+}
+
+
+bool compare_results(const std::string& baselineFilename, const std::string& currentFilename, double tolerance)
+{
+    std::map<std::string, std::map<std::string, double>> baseline;
+    std::map<std::string, std::map<std::string, double>> current;
+    if(!load_results(baselineFilename, baseline) || !load_results(currentFilename, current))
+    {
+        return false;
+    }
+
+    printf("\nComparison against %s (tolerance %.0f%%):\n", baselineFilename.c_str(), tolerance * 100.0);
+
+    int numRegressions = 0;
+    for(auto& result : current)
+    {
+        auto baselineIt = baseline.find(result.first);
+        if(baselineIt == baseline.end())
+        {
+            printf("%-16s not in baseline\n", result.first.c_str());
+            continue;
+        }
+
+        auto& before = baselineIt->second;
+        auto& after = result.second;
+
+        if(before["paths_found"] != after["paths_found"])
+        {
+            printf("%-16s %-16s %12.0f -> %12.0f   REGRESSION\n", result.first.c_str(), "paths_found",
+                   before["paths_found"], after["paths_found"]);
+            ++numRegressions;
+        }
+
+        for(const char* metric : kComparedMetrics)
+        {
+            double change = (before[metric] > 0.0) ? (after[metric] - before[metric]) / before[metric] : 0.0;
+            bool isRegression = change > tolerance;
+            numRegressions += isRegression;
+
+            printf("%-16s %-16s %12.1f -> %12.1f %+7.1f%%%s\n",
+                   result.first.c_str(),
+                   metric,
+                   before[metric],
+                   after[metric],
+                   change * 100.0,
+                   isRegression ? "   REGRESSION" : "");
+        }
+    }
+
+    printf("%d regressions\n", numRegressions);
+    return numRegressions == 0;
+}
@@ -2,5 +2,7 @@
 #define PLANNING_PLANNING_CHANNELS_H
 
 #define EXPLORATION_STATUS_CHANNEL "EXPLORATION_STATUS"
+#define PLAN_REQUEST_CHANNEL "PLAN_REQUEST"
+#define PLAN_REPLY_CHANNEL "PLAN_REPLY"
 
-#endif // PLANNING_PLANNING_CHANNELS_H
\ No newline at end of file
+#endif // PLANNING_PLANNING_CHANNELS_H
@@ -0,0 +1,180 @@
+#include <planning/planning_server.hpp>
+#include <planning/planning_channels.h>
+#include <slam/slam_channels.h>
+#include <common/timestamp.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+
+PlanningServer::PlanningServer(lcm::LCM* lcmInstance, const MotionPlannerParams& params, int numWorkers)
+: lcmInstance_(lcmInstance)
+, numWorkers_(std::max(numWorkers, 1))
+, planner_(params)
+, plannerMapUtime_(0)
+, hasMap_(false)
+, latestMapUtime_(0)
+, shouldStop_(false)
+{
+    assert(lcmInstance_);
+
+    // Requests from different clients are unrelated, so don't reject goals near the previous one
+    planner_.setNumFrontiers(1);
+
+    planningThread_ = std::thread(&PlanningServer::runPlanner, this);
+
+    lcmInstance_->subscribe(SLAM_MAP_CHANNEL, &PlanningServer::handleMap, this);
+    lcmInstance_->subscribe(PLAN_REQUEST_CHANNEL, &PlanningServer::handleRequest, this);
+}
+
+
+PlanningServer::~PlanningServer(void)
+{
+    stop();
+}
+
+
+void PlanningServer::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> autoLock(queueLock_);
+        shouldStop_ = true;
+        requests_.clear();
+    }
+    queueCondition_.notify_all();
+
+    if(planningThread_.joinable())
+    {
+        planningThread_.join();
+    }
+}
+
+
+void PlanningServer::handleMap(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const occupancy_grid_t* map)
+{
+    // The planning thread updates the distances before it plans, so a new map never waits for searches in progress.
+    // Maps that arrive before the planning thread gets to them are replaced, since only the latest one matters.
+    auto grid = std::make_shared<OccupancyGrid>();
+    grid->fromLCM(*map);
+
+    std::lock_guard<std::mutex> autoLock(mapLock_);
+    latestMap_ = grid;
+    latestMapUtime_ = map->utime;
+}
+
+
+void PlanningServer::handleRequest(const lcm::ReceiveBuffer* rbuf,
+                                   const std::string& channel,
+                                   const plan_request_t* request)
+{
+    {
+        std::lock_guard<std::mutex> autoLock(queueLock_);
+        if(shouldStop_)
+        {
+            return;
+        }
+        requests_.push_back(*request);
+    }
+    queueCondition_.notify_one();
+}
+
+
+void PlanningServer::runPlanner(void)
+{
+    while(true)
+    {
+        // Take every waiting request, so they can be planned together
+        std::vector<plan_request_t> requests;
+        {
+            std::unique_lock<std::mutex> autoLock(queueLock_);
+            queueCondition_.wait(autoLock, [this]() { return shouldStop_ || !requests_.empty(); });
+
+            if(shouldStop_)
+            {
+                return;
+            }
+
+            requests.assign(requests_.begin(), requests_.end());
+            requests_.clear();
+        }
+
+        updateMap();
+
+        for(auto& reply : plan(requests))
+        {
+            reply.utime = utime_now();
+            lcmInstance_->publish(PLAN_REPLY_CHANNEL, &reply);
+        }
+    }
+}
+
+
+void PlanningServer::updateMap(void)
+{
+    std::shared_ptr<const OccupancyGrid> map;
+    int64_t mapUtime = 0;
+    {
+        std::lock_guard<std::mutex> autoLock(mapLock_);
+        map.swap(latestMap_);
+        mapUtime = latestMapUtime_;
+    }
+
+    if(map)
+    {
+        planner_.setMap(*map);
+        plannerMapUtime_ = mapUtime;
+        hasMap_ = true;
+    }
+}
+
+
+std::vector<plan_reply_t> PlanningServer::plan(const std::vector<plan_request_t>& requests)
+{
+    std::vector<plan_reply_t> replies(requests.size());
+    for(std::size_t n = 0; n < requests.size(); ++n)
+    {
+        replies[n].request_id = requests[n].request_id;
+        replies[n].map_utime = plannerMapUtime_;
+        replies[n].planning_time_us = 0;
+        replies[n].path.utime = requests[n].start.utime;
+        replies[n].path.path.assign(1, requests[n].start);
+        replies[n].path.path_length = replies[n].path.path.size();
+        replies[n].status = plan_reply_t::STATUS_NO_MAP;
+    }
+
+    if(!hasMap_)
+    {
+        return replies;
+    }
+
+    // A lone request can use the PathCache, which planBatch doesn't touch
+    if(requests.size() == 1)
+    {
+        int64_t startTime = utime_now();
+        replies[0].path = planner_.planPath(requests[0].start, requests[0].goal);
+        replies[0].planning_time_us = static_cast<int32_t>(utime_now() - startTime);
+    }
+    else
+    {
+        std::vector<PlanQuery> queries(requests.size());
+        for(std::size_t n = 0; n < requests.size(); ++n)
+        {
+            queries[n].start = requests[n].start;
+            queries[n].goal = requests[n].goal;
+        }
+
+        std::vector<PlanResult> results = planner_.planBatch(queries, numWorkers_);
+        for(std::size_t n = 0; n < requests.size(); ++n)
+        {
+            replies[n].path = results[n].path;
+            replies[n].planning_time_us = static_cast<int32_t>(results[n].planTimeUs);
+        }
+    }
+
+    for(auto& reply : replies)
+    {
+        reply.status = (reply.path.path_length > 1) ? plan_reply_t::STATUS_PATH_FOUND : plan_reply_t::STATUS_NO_PATH;
+    }
+
+    return replies;
+}
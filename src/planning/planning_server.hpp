@@ -0,0 +1,90 @@
+#ifndef PLANNING_PLANNING_SERVER_HPP
+#define PLANNING_PLANNING_SERVER_HPP
+
+#include <planning/motion_planner.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <lcmtypes/occupancy_grid_t.hpp>
+#include <lcmtypes/plan_request_t.hpp>
+#include <lcmtypes/plan_reply_t.hpp>
+#include <lcm/lcm-cpp.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* PlanningServer plans paths for other processes. Clients send a plan_request_t on PLAN_REQUEST_CHANNEL and get a
+* plan_reply_t with the same request id back on PLAN_REPLY_CHANNEL, so they never have to build an obstacle distance
+* grid or run a search themselves.
+*
+* The paths are planned by a MotionPlanner, so replies are the same paths planPath would find in-process with the same
+* MotionPlannerParams, in every search mode, with landmarks, shortcutting, and optimization. The planner is only used by
+* the server's planning thread. The LCM thread only keeps the latest map from SLAM_MAP_CHANNEL, which the planning
+* thread passes to MotionPlanner::setMap before answering the next requests, so only the distances around the cells
+* that changed are updated.
+*
+* Requests are queued and answered in order. A single request is answered with planPath, which reuses the
+* MotionPlanner's PathCache. When several requests are waiting, they are planned together with planBatch on up to
+* numWorkers threads.
+*
+* The LCM handlers run on the thread calling lcm::LCM::handle. Replies are published from the planning thread.
+*/
+class PlanningServer
+{
+public:
+
+    /**
+    * Constructor for PlanningServer.
+    *
+    * \param    lcmInstance             Instance of LCM to use for communication
+    * \param    params                  Parameters for the planner
+    * \param    numWorkers              Number of threads planning a batch of waiting requests (at least 1)
+    */
+    PlanningServer(lcm::LCM* lcmInstance, const MotionPlannerParams& params, int numWorkers);
+
+    /**
+    * Destructor for PlanningServer. Requests still waiting in the queue are dropped.
+    */
+    ~PlanningServer(void);
+
+    /**
+    * stop stops the planning thread after it finishes the requests it's planning. No more requests are answered.
+    */
+    void stop(void);
+
+    int numWorkers(void) const { return numWorkers_; }
+
+    // Data handlers for LCM messages
+    void handleMap(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const occupancy_grid_t* map);
+    void handleRequest(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const plan_request_t* request);
+
+private:
+
+    lcm::LCM* lcmInstance_;
+    int numWorkers_;
+
+    // Only used by the planning thread
+    MotionPlanner planner_;
+    int64_t plannerMapUtime_;               // utime of the map last passed to planner_, 0 before the first one
+    bool hasMap_;
+
+    std::mutex mapLock_;                    // guards latestMap_ and latestMapUtime_
+    std::shared_ptr<const OccupancyGrid> latestMap_;   // nullptr once passed to planner_
+    int64_t latestMapUtime_;
+
+    std::mutex queueLock_;                  // guards requests_ and shouldStop_
+    std::condition_variable queueCondition_;
+    std::deque<plan_request_t> requests_;
+    bool shouldStop_;
+
+    std::thread planningThread_;
+
+    void runPlanner(void);
+    void updateMap(void);
+    std::vector<plan_reply_t> plan(const std::vector<plan_request_t>& requests);
+};
+
+#endif // PLANNING_PLANNING_SERVER_HPP
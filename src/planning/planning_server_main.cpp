@@ -0,0 +1,78 @@
+#include <planning/planning_server.hpp>
+#include <common/getopt.h>
+#include <common/lcm_config.h>
+#include <lcm/lcm-cpp.hpp>
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv)
+{
+    // Define all command-line arguments
+    const char* kNumWorkersArg = "num-workers";
+    const char* kRobotRadiusArg = "robot-radius";
+    const char* kSearchModeArg = "search-mode";
+    const char* kTimeBudgetArg = "time-budget";
+    const char* kShortcutArg = "shortcut-paths";
+    const char* kOptimizeArg = "optimize-paths";
+
+    getopt_t *gopt = getopt_create();
+    getopt_add_bool(gopt, 'h', "help", 0, "Show this help");
+    getopt_add_int(gopt, 'w', kNumWorkersArg, "0",
+                   "Number of threads planning a batch of waiting requests. 0 uses one per core.");
+    getopt_add_double(gopt, 'r', kRobotRadiusArg, "0.2", "Radius of the robot to plan paths for (m)");
+    getopt_add_string(gopt, '\0', kSearchModeArg, "grid_astar",
+                      "Search mode: grid_astar, jump_point, hierarchical, bidirectional_astar, state_lattice, or "
+                      "anytime_astar");
+    getopt_add_int(gopt, '\0', kTimeBudgetArg, "0", "Time anytime_astar may take per request (us), or 0 for no limit");
+    getopt_add_bool(gopt, '\0', kShortcutArg, 0, "Flag indicating if paths should only keep the poses where they turn");
+    getopt_add_bool(gopt, '\0', kOptimizeArg, 0, "Flag indicating if paths should be pushed away from walls");
+
+    // If help was requested or the command line is invalid, display the help message and exit
+    if (!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help")) {
+        printf("Usage: %s [options]", argv[0]);
+        getopt_do_usage(gopt);
+        return 1;
+    }
+
+    // Convert all command-line values into program variables
+    int numWorkers = getopt_get_int(gopt, kNumWorkersArg);
+    if(numWorkers <= 0)
+    {
+        numWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    MotionPlannerParams params;
+    params.robotRadius = getopt_get_double(gopt, kRobotRadiusArg);
+    params.timeBudgetUs = getopt_get_int(gopt, kTimeBudgetArg);
+    params.shortcutPaths = getopt_get_bool(gopt, kShortcutArg);
+    params.optimizePaths = getopt_get_bool(gopt, kOptimizeArg);
+
+    const std::string modeName = getopt_get_string(gopt, kSearchModeArg);
+    if(!search_mode_from_name(modeName, params.searchMode))
+    {
+        std::cerr << "ERROR: Unknown search mode: " << modeName << '\n';
+        return 1;
+    }
+
+    signal(SIGINT, exit);
+
+    lcm::LCM lcmInstance(MULTICAST_URL);
+
+    if(!lcmInstance.good()) return 1;
+
+    PlanningServer server(&lcmInstance, params, numWorkers);
+
+    std::cout << "INFO: planning_server answering plan requests in " << modeName << " mode with up to "
+        << server.numWorkers() << " threads\n";
+
+    // Maps and requests arrive on this thread. The server plans on its own threads.
+    while(true)
+    {
+        lcmInstance.handle();
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <planning/planning_test_utils.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+
+SearchParams search_params(SearchMode mode)
+{
+    SearchParams params;
+    params.minDistanceToObstacle = 0.1;
+    params.maxDistanceWithCost = 10.0 * params.minDistanceToObstacle;
+    params.distanceCostExponent = 1.0;
+    params.mode = mode;
+    return params;
+}
+
+
+MotionPlannerParams planner_params(void)
+{
+    MotionPlannerParams params;
+    params.robotRadius = search_params().minDistanceToObstacle;
+    return params;
+}
+
+
+bool load_map(const std::string& name, OccupancyGrid& grid, std::vector<PlanQuery>& queries, bool skipOutsideGrid)
+{
+    if(!grid.loadFromFile("../data/astar/" + name + ".map"))
+    {
+        std::cerr << "ERROR: Run the planning tests from the bin/ directory.\n";
+        return false;
+    }
+
+    std::ifstream posesIn("../data/astar/" + name + "_poses.txt");
+    int numQueries = 0;
+    posesIn >> numQueries;
+
+    for(int n = 0; n < numQueries; ++n)
+    {
+        PlanQuery query;
+        bool shouldExist;
+        posesIn >> query.start.x >> query.start.y >> query.goal.x >> query.goal.y >> shouldExist;
+        query.start.theta = 0.0f;
+        query.goal.theta = 0.0f;
+        query.start.utime = 0;
+        query.goal.utime = 0;
+
+        cell_t startCell = global_position_to_grid_cell(Point<double>(query.start.x, query.start.y), grid);
+        cell_t goalCell = global_position_to_grid_cell(Point<double>(query.goal.x, query.goal.y), grid);
+        if(!skipOutsideGrid
+            || (grid.isCellInGrid(startCell.x, startCell.y) && grid.isCellInGrid(goalCell.x, goalCell.y)))
+        {
+            queries.push_back(query);
+        }
+    }
+
+    return true;
+}
+
+
+cell_t path_cell(const pose_xyt_t& pose, const ObstacleDistanceGrid& distances)
+{
+    Point<double> position = global_position_to_grid_position(Point<double>(pose.x, pose.y), distances);
+    return cell_t(std::lround(position.x), std::lround(position.y));
+}
+
+
+double path_cost(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params)
+{
+    double cost = 0.0;
+    for(std::size_t n = 1; n < path.path.size(); ++n)
+    {
+        cell_t cell = path_cell(path.path[n], distances);
+        cost += distances.metersPerCell() + obstacle_cost(distances(cell.x, cell.y), params);
+    }
+    return cost;
+}
+
+
+MotionPlanner make_planner(const OccupancyGrid& grid, const MotionPlannerParams& params)
+{
+    MotionPlanner planner(params);
+    planner.setMap(grid);
+    return planner;
+}
+
+
+std::vector<PlanQuery> random_queries(const MotionPlanner& planner, int numQueries, uint32_t seed)
+{
+    ObstacleDistanceGrid distances = planner.obstacleDistances();
+    std::mt19937 rng(seed);
+
+    auto randomPose = [&]() {
+        pose_xyt_t pose;
+        pose.utime = 0;
+        pose.theta = 0.0f;
+        do
+        {
+            cell_t cell(rng() % distances.widthInCells(), rng() % distances.heightInCells());
+            Point<double> position = grid_position_to_global_position(Point<double>(cell.x + 0.5, cell.y + 0.5),
+                                                                       distances);
+            pose.x = position.x;
+            pose.y = position.y;
+        } while(!planner.isValidGoal(pose));
+        return pose;
+    };
+
+    std::vector<PlanQuery> queries(numQueries);
+    for(auto& query : queries)
+    {
+        query.start = randomPose();
+        query.goal = randomPose();
+    }
+    return queries;
+}
@@ -0,0 +1,71 @@
+#ifndef PLANNING_PLANNING_TEST_UTILS_HPP
+#define PLANNING_PLANNING_TEST_UTILS_HPP
+
+#include <planning/astar.hpp>
+#include <planning/motion_planner.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ObstacleDistanceGrid;
+class OccupancyGrid;
+
+/*
+* Helpers shared by the planning tests, which compare the planners against each other on the data/astar maps and on
+* random queries. They are linked into each test rather than into libplanning.
+*/
+
+
+/**
+* search_params retrieves the parameters astar_test searches with, which every planner test compares against.
+*
+* \param    mode                Search mode to use
+*/
+SearchParams search_params(SearchMode mode = grid_astar);
+
+/**
+* planner_params retrieves MotionPlannerParams for a robot whose radius matches search_params.
+*/
+MotionPlannerParams planner_params(void);
+
+/**
+* load_map loads one of the maps in data/astar along with the queries in its _poses.txt file. The tests must be run
+* from the bin/ directory to find the maps.
+*
+* \param    name                Name of the map, e.g. "maze"
+* \param    grid                Loaded map (output)
+* \param    queries             Queries for the map are appended here (output)
+* \param    skipOutsideGrid     Flag indicating if queries whose start or goal is outside the grid are skipped. They
+*                               fail before any search runs.
+* \return   True if the map was loaded.
+*/
+bool load_map(const std::string& name, OccupancyGrid& grid, std::vector<PlanQuery>& queries,
+              bool skipOutsideGrid = false);
+
+/**
+* path_cell finds the cell a pose of a grid path is in. Poses after the start are placed at the corner of their cell,
+* so the position is rounded rather than truncated.
+*/
+cell_t path_cell(const pose_xyt_t& pose, const ObstacleDistanceGrid& distances);
+
+/**
+* path_cost computes the cost search_for_path assigns a grid path: each step costs one cell plus the obstacle cost of
+* the cell it enters.
+*/
+double path_cost(const robot_path_t& path, const ObstacleDistanceGrid& distances, const SearchParams& params);
+
+/**
+* make_planner creates a MotionPlanner for a map.
+*/
+MotionPlanner make_planner(const OccupancyGrid& grid, const MotionPlannerParams& params = planner_params());
+
+/**
+* random_queries creates queries between the centers of random cells that are valid goals for the planner.
+*
+* \param    planner             Planner whose map the queries are on
+* \param    numQueries          Number of queries to create
+* \param    seed                Seed of the random numbers, so each run creates the same queries
+*/
+std::vector<PlanQuery> random_queries(const MotionPlanner& planner, int numQueries, uint32_t seed);
+
+#endif // PLANNING_PLANNING_TEST_UTILS_HPP
@@ -0,0 +1,206 @@
+#include <planning/signed_distance_field.hpp>
+#include <planning/distance_transform.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+SignedDistanceField::SignedDistanceField(void)
+: width_(0)
+, height_(0)
+, metersPerCell_(0.05f)
+, cellsPerMeter_(20.0f)
+, globalOrigin_(0.0f, 0.0f)
+{
+}
+
+
+void SignedDistanceField::build(const OccupancyGrid& map)
+{
+    resetGrid(map.widthInCells(), map.heightInCells(), map.metersPerCell(), map.cellsPerMeter(),
+              map.originInGlobalFrame());
+
+    for(int y = 0; y < height_; ++y)
+    {
+        float* outsideRow = outsideSquared_.data() + static_cast<std::size_t>(y) * width_;
+        for(int x = 0; x < width_; ++x)
+        {
+            outsideRow[x] = map(x, y) < 0 ? 1.0f : 0.0f;
+        }
+    }
+
+    transformFreeCells();
+}
+
+
+void SignedDistanceField::build(const ObstacleDistanceGrid& distances)
+{
+    resetGrid(distances.widthInCells(), distances.heightInCells(), distances.metersPerCell(),
+              distances.cellsPerMeter(), distances.originInGlobalFrame());
+
+    // Only obstacle cells are at distance 0
+    for(int y = 0; y < height_; ++y)
+    {
+        float* outsideRow = outsideSquared_.data() + static_cast<std::size_t>(y) * width_;
+        for(int x = 0; x < width_; ++x)
+        {
+            outsideRow[x] = distances(x, y) > 0.0f ? 1.0f : 0.0f;
+        }
+    }
+
+    transformFreeCells();
+}
+
+
+void SignedDistanceField::resetGrid(int width,
+                                    int height,
+                                    float metersPerCell,
+                                    float cellsPerMeter,
+                                    Point<float> globalOrigin)
+{
+    width_ = width;
+    height_ = height;
+    metersPerCell_ = metersPerCell;
+    cellsPerMeter_ = cellsPerMeter;
+    globalOrigin_ = globalOrigin;
+
+    const std::size_t numCells = static_cast<std::size_t>(width_) * height_;
+    distances_.resize(numCells);
+    outsideSquared_.resize(numCells);
+    insideSquared_.resize(numCells);
+}
+
+
+void SignedDistanceField::transformFreeCells(void)
+{
+    if(distances_.empty())
+    {
+        return;
+    }
+
+    // Cells with nothing of the other kind in their column start farther away than anything in the grid
+    const float farDistance = static_cast<float>(width_ + height_);
+
+    // Column pass: the distance along the column to the nearest obstacle and free cell, found by a sweep up and a sweep
+    // down the columns. Each sweep steps a whole row at a time. Free cells start at 1 in outsideSquared_.
+    for(int x = 0; x < width_; ++x)
+    {
+        const bool isFree = outsideSquared_[x] > 0.0f;
+        outsideSquared_[x] = isFree ? farDistance : 0.0f;
+        insideSquared_[x] = isFree ? 0.0f : farDistance;
+    }
+
+    for(int y = 1; y < height_; ++y)
+    {
+        float* outsideRow = &outsideSquared_[static_cast<std::size_t>(y) * width_];
+        float* insideRow = &insideSquared_[static_cast<std::size_t>(y) * width_];
+        const float* outsideBelow = outsideRow - width_;
+        const float* insideBelow = insideRow - width_;
+
+        for(int x = 0; x < width_; ++x)
+        {
+            const bool isFree = outsideRow[x] > 0.0f;
+            outsideRow[x] = isFree ? outsideBelow[x] + 1.0f : 0.0f;
+            insideRow[x] = isFree ? 0.0f : insideBelow[x] + 1.0f;
+        }
+    }
+
+    for(int y = height_ - 2; y >= 0; --y)
+    {
+        float* outsideRow = &outsideSquared_[static_cast<std::size_t>(y) * width_];
+        float* insideRow = &insideSquared_[static_cast<std::size_t>(y) * width_];
+        const float* outsideAbove = outsideRow + width_;
+        const float* insideAbove = insideRow + width_;
+
+        for(int x = 0; x < width_; ++x)
+        {
+            outsideRow[x] = std::min(outsideRow[x], outsideAbove[x] + 1.0f);
+            insideRow[x] = std::min(insideRow[x], insideAbove[x] + 1.0f);
+        }
+    }
+
+    for(std::size_t n = 0; n < distances_.size(); ++n)
+    {
+        outsideSquared_[n] *= outsideSquared_[n];
+        insideSquared_[n] *= insideSquared_[n];
+    }
+
+    // Row pass: the lower envelope of the column distances along each row gives the squared Euclidean distance. Only
+    // one of the two distances is nonzero in each cell, so the difference of their roots is the signed distance.
+    const float maxDistance = std::sqrt(static_cast<float>(width_*width_ + height_*height_)) * metersPerCell_;
+
+    std::vector<float> outsideRow(width_);
+    std::vector<float> insideRow(width_);
+    std::vector<int> nearest(width_);
+    std::vector<int> vertices(width_);
+    std::vector<float> boundaries(width_ + 1);
+
+    for(int y = 0; y < height_; ++y)
+    {
+        const std::size_t rowStart = static_cast<std::size_t>(y) * width_;
+        squared_distance_transform(&outsideSquared_[rowStart], width_, outsideRow.data(), nearest.data(),
+                                   vertices.data(), boundaries.data());
+        squared_distance_transform(&insideSquared_[rowStart], width_, insideRow.data(), nearest.data(),
+                                   vertices.data(), boundaries.data());
+
+        float* distanceRow = &distances_[rowStart];
+        for(int x = 0; x < width_; ++x)
+        {
+            float distance = (std::sqrt(outsideRow[x]) - std::sqrt(insideRow[x])) * metersPerCell_;
+            distanceRow[x] = std::max(-maxDistance, std::min(distance, maxDistance));
+        }
+    }
+}
+
+
+float SignedDistanceField::interpolate(const Point<double>& position) const
+{
+    Point<double> gradient;
+    return interpolate(position, gradient);
+}
+
+
+float SignedDistanceField::interpolate(const Point<double>& position, Point<double>& gradient) const
+{
+    gradient = Point<double>(0.0, 0.0);
+    if(distances_.empty())
+    {
+        return 0.0f;
+    }
+
+    // Cell centers are at the middle of the cells, so measure from the center of cell (0, 0)
+    Point<double> gridPosition = global_position_to_grid_position(position, *this);
+    double u = gridPosition.x - 0.5;
+    double v = gridPosition.y - 0.5;
+
+    // Off the grid, the distance stays the same as at the border, so it has no gradient away from the border
+    const bool isInsideX = (u > 0.0) && (u < width_ - 1);
+    const bool isInsideY = (v > 0.0) && (v < height_ - 1);
+    u = std::max(0.0, std::min(u, width_ - 1.0));
+    v = std::max(0.0, std::min(v, height_ - 1.0));
+
+    const int x0 = std::min(static_cast<int>(u), std::max(width_ - 2, 0));
+    const int y0 = std::min(static_cast<int>(v), std::max(height_ - 2, 0));
+    const int x1 = std::min(x0 + 1, width_ - 1);
+    const int y1 = std::min(y0 + 1, height_ - 1);
+    const double tx = u - x0;
+    const double ty = v - y0;
+
+    const double d00 = (*this)(x0, y0);
+    const double d10 = (*this)(x1, y0);
+    const double d01 = (*this)(x0, y1);
+    const double d11 = (*this)(x1, y1);
+
+    if(isInsideX)
+    {
+        gradient.x = ((1.0 - ty)*(d10 - d00) + ty*(d11 - d01)) * cellsPerMeter_;
+    }
+    if(isInsideY)
+    {
+        gradient.y = ((1.0 - tx)*(d01 - d00) + tx*(d11 - d10)) * cellsPerMeter_;
+    }
+
+    return (1.0 - ty)*((1.0 - tx)*d00 + tx*d10) + ty*((1.0 - tx)*d01 + tx*d11);
+}
@@ -0,0 +1,105 @@
+#ifndef PLANNING_SIGNED_DISTANCE_FIELD_HPP
+#define PLANNING_SIGNED_DISTANCE_FIELD_HPP
+
+#include <common/point.hpp>
+#include <cstdint>
+#include <vector>
+
+class ObstacleDistanceGrid;
+class OccupancyGrid;
+
+/**
+* SignedDistanceField stores the signed distance to the boundary of the obstacles for each cell of an occupancy grid,
+* and interpolates it, along with its gradient, at any position in between.
+*
+*  - Obstacles are the same as for ObstacleDistanceGrid: any cell with logOdds >= 0.
+*  - Free cells have the distance in meters from their center to the center of the nearest obstacle cell, exactly as
+*    in ObstacleDistanceGrid, so the robot fits in a cell whenever its distance is more than the robot's radius.
+*  - Obstacle cells have the negated distance from their center to the center of the nearest free cell, so the
+*    distance keeps falling deeper into an obstacle, rather than stopping at 0 like ObstacleDistanceGrid's. Between a
+*    free cell and an obstacle cell, the interpolated distance crosses 0 at the boundary of the cells.
+*  - If the map has no obstacles, or no free cells, every distance is +/- the length of the grid's diagonal, rather
+*    than infinity, so the interpolation stays finite.
+*
+* Both distance transforms are found with the same separable transform as ObstacleDistanceGrid::setDistances. The
+* column pass runs a whole row of cells at a time, so its inner loops are straight runs over contiguous cells that the
+* compiler vectorizes. The row pass then runs squared_distance_transform along each row.
+*
+* interpolate interpolates bilinearly between the centers of the four cells around a position. The gradient is the
+* exact derivative of the interpolated distance, so it's continuous within each square between cell centers, and a
+* step along it always moves away from the nearest obstacles. Positions off the grid use the distances of the nearest
+* cells on the grid's border.
+*/
+class SignedDistanceField
+{
+public:
+
+    SignedDistanceField(void);
+
+    /**
+    * build finds the signed distances of every cell of an occupancy grid.
+    *
+    * \param    map             Map of the environment
+    */
+    void build(const OccupancyGrid& map);
+
+    /**
+    * build finds the signed distances of every cell of the map an ObstacleDistanceGrid was found for. Its obstacles
+    * are the cells at distance 0, which are the same as the map's, so the map itself isn't needed.
+    *
+    * \param    distances       Obstacle distances of the map
+    */
+    void build(const ObstacleDistanceGrid& distances);
+
+    // Accessors for the properties of the grid
+    int widthInCells(void) const { return width_; }
+    int heightInCells(void) const { return height_; }
+    float metersPerCell(void) const { return metersPerCell_; }
+    float cellsPerMeter(void) const { return cellsPerMeter_; }
+    Point<float> originInGlobalFrame(void) const { return globalOrigin_; }
+
+    bool isCellInGrid(int x, int y) const { return (x >= 0) && (y >= 0) && (x < width_) && (y < height_); }
+
+    /**
+    * operator() provides unchecked access to the signed distance of cell (x, y).
+    */
+    float operator()(int x, int y) const { return distances_[y*width_ + x]; }
+
+    /**
+    * interpolate finds the signed distance at a position.
+    *
+    * \param    position            Position in the global frame
+    * \return   The bilinearly interpolated signed distance at position (m).
+    */
+    float interpolate(const Point<double>& position) const;
+
+    /**
+    * interpolate finds the signed distance at a position along with its gradient.
+    *
+    * \param    position            Position in the global frame
+    * \param    gradient            (out) Gradient of the interpolated distance at position, in meters per meter
+    * \return   The bilinearly interpolated signed distance at position (m).
+    */
+    float interpolate(const Point<double>& position, Point<double>& gradient) const;
+
+private:
+
+    std::vector<float> distances_;      ///< Signed distance of each cell in meters, in row-major order
+
+    int width_;
+    int height_;
+    float metersPerCell_;
+    float cellsPerMeter_;
+    Point<float> globalOrigin_;
+
+    // Scratch space for the transform, kept between builds
+    std::vector<float> outsideSquared_;     // squared cell distance to the nearest obstacle cell
+    std::vector<float> insideSquared_;      // squared cell distance to the nearest free cell
+
+    void resetGrid(int width, int height, float metersPerCell, float cellsPerMeter, Point<float> globalOrigin);
+
+    // Finds the distances once outsideSquared_ holds 1 for each free cell and 0 for each obstacle cell
+    void transformFreeCells(void);
+};
+
+#endif // PLANNING_SIGNED_DISTANCE_FIELD_HPP
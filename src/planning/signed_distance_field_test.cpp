@@ -0,0 +1,261 @@
+#include <planning/signed_distance_field.hpp>
+#include <planning/map_generators.hpp>
+#include <planning/obstacle_distance_grid.hpp>
+#include <slam/occupancy_grid.hpp>
+#include <common/grid_utils.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*
+* The signed distance field test checks SignedDistanceField:
+*
+*   - on a small cluttered map, every cell's signed distance matches a brute force search for the nearest cell of the
+*     other kind, the free cells of an office map have the same distances as ObstacleDistanceGrid, and building the
+*     field from the ObstacleDistanceGrid gives the same distances as building it from the map,
+*   - the interpolated distance equals the cell distances at cell centers, crosses 0 at the boundary between free and
+*     obstacle cells, and its gradient matches finite differences,
+*   - the time to build the field on a large office map is printed, along with the time for ObstacleDistanceGrid.
+*/
+
+
+bool test_brute_force(void);
+bool test_interpolation(void);
+bool test_build_time(void);
+
+float brute_force_distance(int x, int y, const OccupancyGrid& map);
+
+
+int main(int argc, char** argv)
+{
+    if(test_brute_force())
+    {
+        std::cout << "PASSED: test_brute_force\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_brute_force\n";
+    }
+
+    if(test_interpolation())
+    {
+        std::cout << "PASSED: test_interpolation\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_interpolation\n";
+    }
+
+    if(test_build_time())
+    {
+        std::cout << "PASSED: test_build_time\n";
+    }
+    else
+    {
+        std::cout << "FAILED: test_build_time\n";
+    }
+
+    return 0;
+}
+
+
+bool test_brute_force(void)
+{
+    OccupancyGrid grid = generate_cluttered_grid(4.0f, 0.05f, 0.2, 1);
+    SignedDistanceField sdf;
+    sdf.build(grid);
+
+    if((sdf.widthInCells() != grid.widthInCells()) || (sdf.heightInCells() != grid.heightInCells()))
+    {
+        std::cout << "Field is " << sdf.widthInCells() << "x" << sdf.heightInCells() << " for a "
+            << grid.widthInCells() << "x" << grid.heightInCells() << " map\n";
+        return false;
+    }
+
+    for(int y = 0; y < grid.heightInCells(); ++y)
+    {
+        for(int x = 0; x < grid.widthInCells(); ++x)
+        {
+            float expected = brute_force_distance(x, y, grid);
+            if(std::abs(sdf(x, y) - expected) > 1.0e-4f)
+            {
+                std::cout << "Cell (" << x << ',' << y << ") has distance " << sdf(x, y) << " instead of " << expected
+                    << '\n';
+                return false;
+            }
+        }
+    }
+
+    OccupancyGrid officeGrid = generate_office_grid(20.0f, 0.05f, 3.0, 1);
+    sdf.build(officeGrid);
+    ObstacleDistanceGrid distances;
+    distances.setDistances(officeGrid);
+
+    for(int y = 0; y < officeGrid.heightInCells(); ++y)
+    {
+        for(int x = 0; x < officeGrid.widthInCells(); ++x)
+        {
+            if((distances(x, y) > 0.0f) && (std::abs(sdf(x, y) - distances(x, y)) > 1.0e-4f))
+            {
+                std::cout << "Free cell (" << x << ',' << y << ") has distance " << sdf(x, y) << " instead of "
+                    << distances(x, y) << " from ObstacleDistanceGrid\n";
+                return false;
+            }
+            else if((distances(x, y) == 0.0f) && (sdf(x, y) >= 0.0f))
+            {
+                std::cout << "Obstacle cell (" << x << ',' << y << ") has distance " << sdf(x, y) << '\n';
+                return false;
+            }
+        }
+    }
+
+    // MotionPlanner builds the field from its obstacle distances instead of the map
+    SignedDistanceField distancesSdf;
+    distancesSdf.build(distances);
+
+    for(int y = 0; y < officeGrid.heightInCells(); ++y)
+    {
+        for(int x = 0; x < officeGrid.widthInCells(); ++x)
+        {
+            if(distancesSdf(x, y) != sdf(x, y))
+            {
+                std::cout << "Cell (" << x << ',' << y << ") has distance " << distancesSdf(x, y) << " instead of "
+                    << sdf(x, y) << " when built from ObstacleDistanceGrid\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool test_interpolation(void)
+{
+    OccupancyGrid grid = generate_cluttered_grid(10.0f, 0.05f, 0.2, 2);
+    SignedDistanceField sdf;
+    sdf.build(grid);
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> cellDist(1.0, sdf.widthInCells() - 1.0);
+
+    for(int n = 0; n < 10000; ++n)
+    {
+        // Cell centers give back the cell distances
+        int x = rng() % sdf.widthInCells();
+        int y = rng() % sdf.heightInCells();
+        Point<double> center = grid_position_to_global_position(Point<double>(x + 0.5, y + 0.5), sdf);
+        if(std::abs(sdf.interpolate(center) - sdf(x, y)) > 1.0e-4f)
+        {
+            std::cout << "Center of cell (" << x << ',' << y << ") interpolates to " << sdf.interpolate(center)
+                << " instead of " << sdf(x, y) << '\n';
+            return false;
+        }
+
+        // Between a free cell and an obstacle cell, the distance crosses 0 at their shared edge
+        if((x + 1 < sdf.widthInCells()) && ((sdf(x, y) > 0.0f) != (sdf(x + 1, y) > 0.0f)))
+        {
+            Point<double> edge = grid_position_to_global_position(Point<double>(x + 1.0, y + 0.5), sdf);
+            double edgeDistance = sdf.interpolate(edge);
+            if(std::abs(edgeDistance) > 0.5 * std::abs(sdf(x, y) - sdf(x + 1, y)))
+            {
+                std::cout << "Edge between cells (" << x << ',' << y << ") and (" << (x + 1) << ',' << y
+                    << ") has distance " << edgeDistance << '\n';
+                return false;
+            }
+        }
+
+        // The gradient matches central differences, away from the lines through cell centers where the
+        // interpolation has kinks
+        Point<double> gridPosition(cellDist(rng), cellDist(rng));
+        double xFraction = gridPosition.x - 0.5 - std::floor(gridPosition.x - 0.5);
+        double yFraction = gridPosition.y - 0.5 - std::floor(gridPosition.y - 0.5);
+        if((xFraction < 0.01) || (xFraction > 0.99) || (yFraction < 0.01) || (yFraction > 0.99))
+        {
+            continue;
+        }
+
+        const double kStep = 1.0e-4;
+        Point<double> position = grid_position_to_global_position(gridPosition, sdf);
+        Point<double> gradient;
+        sdf.interpolate(position, gradient);
+
+        double xDerivative = (sdf.interpolate(Point<double>(position.x + kStep, position.y))
+            - sdf.interpolate(Point<double>(position.x - kStep, position.y))) / (2.0 * kStep);
+        double yDerivative = (sdf.interpolate(Point<double>(position.x, position.y + kStep))
+            - sdf.interpolate(Point<double>(position.x, position.y - kStep))) / (2.0 * kStep);
+
+        if((std::abs(gradient.x - xDerivative) > 1.0e-2) || (std::abs(gradient.y - yDerivative) > 1.0e-2))
+        {
+            std::cout << "Gradient at " << position << " is " << gradient << " instead of ("
+                << xDerivative << ',' << yDerivative << ")\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool test_build_time(void)
+{
+    OccupancyGrid grid = generate_office_grid(50.0f, 0.05f, 3.0, 1);
+
+    SignedDistanceField sdf;
+    ObstacleDistanceGrid distances;
+
+    // Allocate both grids before timing
+    sdf.build(grid);
+    distances.setDistances(grid);
+
+    const int kNumBuilds = 5;
+    auto startTime = std::chrono::steady_clock::now();
+    for(int n = 0; n < kNumBuilds; ++n)
+    {
+        sdf.build(grid);
+    }
+    auto sdfTime = std::chrono::steady_clock::now();
+    for(int n = 0; n < kNumBuilds; ++n)
+    {
+        distances.setDistances(grid);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    std::cout << "Building the signed distances of a " << grid.widthInCells() << "x" << grid.heightInCells()
+        << " office map takes " << std::chrono::duration<double, std::milli>(sdfTime - startTime).count() / kNumBuilds
+        << " ms, ObstacleDistanceGrid::setDistances takes "
+        << std::chrono::duration<double, std::milli>(endTime - sdfTime).count() / kNumBuilds << " ms\n";
+
+    // Positions off the grid keep the distance at the border
+    Point<double> corner = grid_position_to_global_position(Point<double>(0.5, 0.5), sdf);
+    Point<double> offGrid = grid_position_to_global_position(Point<double>(-10.0, 0.5), sdf);
+    Point<double> gradient;
+    float offGridDistance = sdf.interpolate(offGrid, gradient);
+    return (offGridDistance == sdf.interpolate(corner)) && (gradient.x == 0.0);
+}
+
+
+float brute_force_distance(int x, int y, const OccupancyGrid& map)
+{
+    const bool isFree = map(x, y) < 0;
+    float minDistance = std::numeric_limits<float>::infinity();
+
+    for(int otherY = 0; otherY < map.heightInCells(); ++otherY)
+    {
+        for(int otherX = 0; otherX < map.widthInCells(); ++otherX)
+        {
+            if((map(otherX, otherY) < 0) != isFree)
+            {
+                float dx = otherX - x;
+                float dy = otherY - y;
+                minDistance = std::min(minDistance, std::sqrt(dx*dx + dy*dy) * map.metersPerCell());
+            }
+        }
+    }
+
+    return isFree ? minDistance : -minDistance;
+}
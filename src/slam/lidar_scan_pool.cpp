@@ -0,0 +1,117 @@
+#include <slam/lidar_scan_pool.hpp>
+#include <algorithm>
+#include <cassert>
+
+
+LidarScanPool::LidarScanPool(std::size_t numBuffers, std::size_t raysPerScan)
+: head_(0)
+, count_(0)
+, raysPerScan_(raysPerScan)
+, numBufferAllocations_(0)
+, numArrayAllocations_(0)
+{
+    for(std::size_t n = 0; n < std::max(numBuffers, std::size_t(1)); ++n)
+    {
+        createBuffer();
+    }
+}
+
+
+lidar_t* LidarScanPool::acquire(void)
+{
+    if(free_.empty())
+    {
+        createBuffer();
+    }
+
+    lidar_t* scan = free_.back();
+    free_.pop_back();
+    return scan;
+}
+
+
+void LidarScanPool::release(lidar_t* scan)
+{
+    assert(scan);
+    assert(free_.size() < buffers_.size());
+    // free_ has capacity for every buffer, so this never allocates
+    free_.push_back(scan);
+}
+
+
+bool LidarScanPool::decode(const void* data, int size, lidar_t* scan)
+{
+    const std::size_t rangesCapacity = scan->ranges.capacity();
+    const std::size_t thetasCapacity = scan->thetas.capacity();
+    const std::size_t timesCapacity = scan->times.capacity();
+    const std::size_t intensitiesCapacity = scan->intensities.capacity();
+
+    // lidar_t::decode resizes each array in place, so the reserved capacity is reused for every scan
+    if(scan->decode(data, 0, size) < 0)
+    {
+        return false;
+    }
+
+    numArrayAllocations_ += (scan->ranges.capacity() != rangesCapacity)
+        + (scan->thetas.capacity() != thetasCapacity)
+        + (scan->times.capacity() != timesCapacity)
+        + (scan->intensities.capacity() != intensitiesCapacity);
+
+    // The generated decode leaves the arrays untouched for an empty scan, so clear them to match num_ranges
+    if(scan->num_ranges <= 0)
+    {
+        scan->num_ranges = 0;
+        scan->ranges.clear();
+        scan->thetas.clear();
+        scan->times.clear();
+        scan->intensities.clear();
+    }
+
+    return true;
+}
+
+
+void LidarScanPool::push(lidar_t* scan)
+{
+    // The queue holds one slot per buffer, so it can never overflow
+    assert(count_ < queue_.size());
+    queue_[(head_ + count_) % queue_.size()] = scan;
+    ++count_;
+}
+
+
+lidar_t* LidarScanPool::pop(void)
+{
+    assert(count_ > 0);
+    lidar_t* scan = queue_[head_];
+    head_ = (head_ + 1) % queue_.size();
+    --count_;
+    return scan;
+}
+
+
+void LidarScanPool::createBuffer(void)
+{
+    std::unique_ptr<lidar_t> scan(new lidar_t);
+    scan->utime = 0;
+    scan->num_ranges = 0;
+    scan->ranges.reserve(raysPerScan_);
+    scan->thetas.reserve(raysPerScan_);
+    scan->times.reserve(raysPerScan_);
+    scan->intensities.reserve(raysPerScan_);
+
+    free_.reserve(buffers_.size() + 1);
+    free_.push_back(scan.get());
+    buffers_.push_back(std::move(scan));
+
+    // Grow the ring so there is a slot for every buffer, unrolling the current contents to start at index 0
+    std::vector<lidar_t*> queue(buffers_.size(), nullptr);
+    for(std::size_t n = 0; n < count_; ++n)
+    {
+        queue[n] = queue_[(head_ + n) % queue_.size()];
+    }
+    queue_.swap(queue);
+    head_ = 0;
+
+    ++numBufferAllocations_;
+}
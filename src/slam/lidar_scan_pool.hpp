@@ -0,0 +1,90 @@
+#ifndef SLAM_LIDAR_SCAN_POOL_HPP
+#define SLAM_LIDAR_SCAN_POOL_HPP
+
+#include <lcmtypes/lidar_t.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+* LidarScanPool owns a set of lidar_t buffers that are recycled between the LCM thread and the SLAM thread, along with
+* the FIFO of scans waiting to be processed.
+*
+* The life of a scan is:
+*
+*   1) acquire() a free buffer on the LCM thread
+*   2) decode() the raw LCM message directly into the buffer
+*   3) push() the buffer onto the FIFO of incoming scans, or release() it if the scan is being ignored
+*   4) pop() the buffer on the SLAM thread, use it for the SLAM iteration, then release() it
+*
+* Each buffer has its arrays reserved for raysPerScan rays when created. lidar_t::decode resizes the arrays in place,
+* so once the pool has enough buffers for the number of scans in flight, no heap allocations occur. New buffers are
+* only created when every buffer is in use, which happens only if the SLAM thread falls behind the lidar.
+*
+* The allocation counters record every buffer creation and every array that had to grow during a decode. They stop
+* increasing once the pool reaches its steady state.
+*
+* LidarScanPool is not synchronized. The owner must hold a lock when calling any method other than decode.
+*/
+class LidarScanPool
+{
+public:
+
+    /**
+    * Constructor for LidarScanPool.
+    *
+    * \param    numBuffers          Number of buffers to create up front
+    * \param    raysPerScan         Number of rays to reserve in each buffer (rplidar grabs at most 720 per scan)
+    */
+    explicit LidarScanPool(std::size_t numBuffers = 8, std::size_t raysPerScan = 720);
+
+    /**
+    * acquire retrieves an unused buffer from the pool. If no buffer is free, a new one is created.
+    */
+    lidar_t* acquire(void);
+
+    /**
+    * release returns a buffer to the pool so it can be reused for a future scan.
+    */
+    void release(lidar_t* scan);
+
+    /**
+    * decode decodes an encoded lidar_t message into a buffer acquired from the pool. Any array in the buffer that needs
+    * to grow to hold the message is counted as an array allocation.
+    *
+    * \param    data                Encoded message
+    * \param    size                Number of bytes in the message
+    * \param    scan                Buffer to decode into
+    * \return   True if the message was decoded successfully.
+    */
+    bool decode(const void* data, int size, lidar_t* scan);
+
+    // FIFO of scans waiting to be processed
+    void     push(lidar_t* scan);
+    lidar_t* front(void) const { return queue_[head_]; }
+    lidar_t* pop(void);
+    bool        empty(void) const { return count_ == 0; }
+    std::size_t size(void) const  { return count_; }
+
+    // Allocation counters
+    std::size_t numBuffers(void) const          { return buffers_.size(); }
+    std::size_t numBufferAllocations(void) const { return numBufferAllocations_; }
+    std::size_t numArrayAllocations(void) const  { return numArrayAllocations_; }
+
+private:
+
+    std::vector<std::unique_ptr<lidar_t>> buffers_;     // every buffer created by the pool
+    std::vector<lidar_t*> free_;                        // buffers not currently in use
+    std::vector<lidar_t*> queue_;                       // ring buffer of scans waiting to be processed
+    std::size_t head_;                                  // index of the oldest scan in queue_
+    std::size_t count_;                                 // number of scans in queue_
+
+    std::size_t raysPerScan_;
+    std::size_t numBufferAllocations_;
+    std::atomic<std::size_t> numArrayAllocations_;     // atomic because decode runs outside the owner's lock
+
+    void createBuffer(void);
+};
+
+#endif // SLAM_LIDAR_SCAN_POOL_HPP
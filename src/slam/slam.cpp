@@ -1,6 +1,7 @@
 #include <slam/slam.hpp>
 #include <slam/slam_channels.h>
 #include <mbot/mbot_channels.h>
+#include <common/lidar_compact.hpp>
 #include <optitrack/optitrack_channels.h>
 #include <unistd.h>
 #include <cassert>
@@ -13,17 +14,20 @@ OccupancyGridSLAM::OccupancyGridSLAM(int         numParticles,
                                      bool waitForOptitrack,
                                      bool mappingOnlyMode,
                                      bool actionOnlyMode,
-                                     const std::string localizationOnlyMap)
+                                     const std::string localizationOnlyMap,
+                                     bool useCompactScans)
 : mode_(full_slam)  // default is running full SLAM, unless user specifies otherwise on the command line
 , haveInitializedPoses_(false)
 , waitingForOptitrack_(waitForOptitrack)
 , haveMap_(false)
 , numIgnoredScans_(0)
+, currentScan_(nullptr)
 , filter_(numParticles)
 , map_(10.0f, 10.0f, 0.05f) //30,30,0.1  // create a 10m x 10m grid with 0.05m cells
 , mapper_(5.0f, hitOddsIncrease, missOddsDecrease)
 , lcm_(lcmComm)
 , mapUpdateCount_(0)
+, reportedScanAllocations_(0)
 {
     // Confirm that the mode is valid -- mapping-only and localization-only are not specified
     assert(!(mappingOnlyMode && localizationOnlyMap.length() > 0));
@@ -46,10 +50,16 @@ OccupancyGridSLAM::OccupancyGridSLAM(int         numParticles,
     }
     
     currentOdometry_.utime = 0;
-    currentScan_.utime = 0;
     
-    // Laser and odometry data are always required
-    lcm_.subscribe(LIDAR_CHANNEL, &OccupancyGridSLAM::handleLaser, this);
+    // Laser and odometry data are always required. Each scan format is only read from its own channel.
+    if(useCompactScans)
+    {
+        lcm_.subscribe(LIDAR_COMPACT_CHANNEL, &OccupancyGridSLAM::handleCompactLaser, this);
+    }
+    else
+    {
+        lcm_.subscribe(LIDAR_CHANNEL, &OccupancyGridSLAM::handleLaser, this);
+    }
     lcm_.subscribe(ODOMETRY_CHANNEL, &OccupancyGridSLAM::handleOdometry, this);
     lcm_.subscribe(TRUE_POSE_CHANNEL, &OccupancyGridSLAM::handleOptitrack, this);
     
@@ -87,11 +97,52 @@ void OccupancyGridSLAM::runSLAM(void)
 
 
 // Handlers for LCM messages
-void OccupancyGridSLAM::handleLaser(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const lidar_t* scan)
+void OccupancyGridSLAM::handleLaser(const lcm::ReceiveBuffer* rbuf, const std::string& channel)
+{
+    lidar_t* scan = acquireScan();
+    
+    // Decode straight into the pooled buffer without holding the lock, as the SLAM thread doesn't know about it yet
+    bool isValidScan = scanPool_.decode(rbuf->data, rbuf->data_size, scan) && (scan->num_ranges > 0);
+    queueScan(scan, isValidScan);
+}
+
+
+void OccupancyGridSLAM::handleCompactLaser(const lcm::ReceiveBuffer* rbuf, const std::string& channel)
+{
+    // compactScan_ is only touched by the LCM thread, so its arrays are reused for every message
+    if(compactScan_.decode(rbuf->data, 0, rbuf->data_size) < 0)
+    {
+        std::cerr << "ERROR: OccupancyGridSLAM: Dropped a malformed compact laser scan.\n";
+        return;
+    }
+    
+    lidar_t* scan = acquireScan();
+    expand_lidar_scan(compactScan_, *scan);
+    queueScan(scan, scan->num_ranges > 0);
+}
+
+
+lidar_t* OccupancyGridSLAM::acquireScan(void)
+{
+    std::lock_guard<std::mutex> autoLock(dataMutex_);
+    return scanPool_.acquire();
+}
+
+
+void OccupancyGridSLAM::queueScan(lidar_t* scan, bool isValidScan)
 {
     const int kNumIgnoredForMessage = 10;   // number of scans to ignore before printing a message about odometry
 //std::cout << "laser!\n";    
     std::lock_guard<std::mutex> autoLock(dataMutex_);
+    
+    // A scan without any rays has no timestamps, so it can't be matched with odometry
+    if(!isValidScan)
+    {
+        std::cerr << "ERROR: OccupancyGridSLAM: Dropped an empty or malformed laser scan.\n";
+        scanPool_.release(scan);
+        return;
+    }
+    
     // Ignore scans until odometry data arrives -- need odometry before a scan to safely built the map
     bool haveOdom = (mode_ != mapping_only) // For full SLAM, odometry data is needed.
         && !odometryPoses_.empty() 
@@ -103,7 +154,7 @@ void OccupancyGridSLAM::handleLaser(const lcm::ReceiveBuffer* rbuf, const std::s
     // If there's appropriate odometry or pose data for this scan, then add it to the queue.
     if(haveOdom || havePose)
     {
-        incomingScans_.push_back(*scan);
+        scanPool_.push(scan);
         
         // If we showed the laser error message, then provide another message indicating that laser scans are now
         // being saved
@@ -117,6 +168,7 @@ void OccupancyGridSLAM::handleLaser(const lcm::ReceiveBuffer* rbuf, const std::s
     // Otherwise ignore it
     else
     {
+        scanPool_.release(scan);
         ++numIgnoredScans_;
     }
     
@@ -167,10 +219,10 @@ bool OccupancyGridSLAM::isReadyToUpdate(void)
     bool haveData = false;
 	    
     // If there's at least one scan to process, then check if odometry/pose information is available
-    if(!incomingScans_.empty())
+    if(!scanPool_.empty())
     {
         // Find if there's a scan that there is odometry data for
-        const lidar_t& nextScan = incomingScans_.front();
+        const lidar_t& nextScan = *scanPool_.front();
         
         // Ensure that there's a pose that exists at or after the final laser measurement to be sure that valid
         // interpolation of robot motion during the scan can be performed.
@@ -194,16 +246,18 @@ void OccupancyGridSLAM::runSLAMIteration(void)
     initializePosesIfNeeded();
     
     // Sanity check the laser data to see if rplidar_driver has lost sync
-    if(currentScan_.num_ranges > 100)//250)
+    if(currentScan_->num_ranges > 100)//250)
     {
         updateLocalization();
         updateMap();
     }
     else 
     {
-        std::cerr << "ERROR: OccupancyGridSLAM: Detected invalid laser scan with " << currentScan_.num_ranges 
+        std::cerr << "ERROR: OccupancyGridSLAM: Detected invalid laser scan with " << currentScan_->num_ranges 
             << " ranges.\n";
     }
+    
+    releaseCurrentScan();
 }
 
 
@@ -211,20 +265,38 @@ void OccupancyGridSLAM::copyDataForSLAMUpdate(void)
 {
     std::lock_guard<std::mutex> autoLock(dataMutex_);
     
-    // Copy the data needed for the new SLAM update
-    currentScan_ = incomingScans_.front();
-    incomingScans_.pop_front();
+    // Take ownership of the next scan -- it stays in its pooled buffer, so nothing is copied
+    currentScan_ = scanPool_.pop();
     
     if(mode_ == mapping_only)
     {
         // No localization is performed during mapping-only mode, so the previous pose needs to be correctly adjusted
         // here.
         previousPose_ = currentPose_;
-        currentPose_  = groundTruthPoses_.poseAt(currentScan_.times.back());
+        currentPose_  = groundTruthPoses_.poseAt(currentScan_->times.back());
     }
     else
     {
-        currentOdometry_ = odometryPoses_.poseAt(currentScan_.times.back());
+        currentOdometry_ = odometryPoses_.poseAt(currentScan_->times.back());
+    }
+}
+
+
+void OccupancyGridSLAM::releaseCurrentScan(void)
+{
+    std::lock_guard<std::mutex> autoLock(dataMutex_);
+    
+    scanPool_.release(currentScan_);
+    currentScan_ = nullptr;
+    
+    // Report whenever the pool had to allocate. After the first few scans, this should never print again.
+    std::size_t numAllocations = scanPool_.numBufferAllocations() + scanPool_.numArrayAllocations();
+    if(numAllocations != reportedScanAllocations_)
+    {
+        std::cout << "INFO: OccupancyGridSLAM: Laser scan pool has " << scanPool_.numBuffers() << " buffers after "
+            << scanPool_.numBufferAllocations() << " buffer allocations and " << scanPool_.numArrayAllocations()
+            << " array allocations.\n";
+        reportedScanAllocations_ = numAllocations;
     }
 }
 
@@ -237,10 +309,10 @@ void OccupancyGridSLAM::initializePosesIfNeeded(void)
     if(!haveInitializedPoses_)
     {
         previousPose_ = initialPose_;
-        previousPose_.utime = currentScan_.times.front();
+        previousPose_.utime = currentScan_->times.front();
         
         currentPose_ = previousPose_;
-        currentPose_.utime  = currentScan_.times.back();
+        currentPose_.utime  = currentScan_->times.back();
         haveInitializedPoses_ = true;
         
         filter_.initializeFilterAtPose(previousPose_);
@@ -259,7 +331,7 @@ void OccupancyGridSLAM::updateLocalization(void)
             currentPose_  = filter_.updateFilterActionOnly(currentOdometry_);
         }
         else{
-            currentPose_  = filter_.updateFilter(currentOdometry_, currentScan_, map_);
+            currentPose_  = filter_.updateFilter(currentOdometry_, *currentScan_, map_);
         }
         
         auto particles = filter_.particles();
@@ -276,7 +348,7 @@ void OccupancyGridSLAM::updateMap(void)
     if(mode_ != localization_only || mode_ != action_only)
     {
         // Process the map
-        mapper_.updateMap(currentScan_, currentPose_, map_);
+        mapper_.updateMap(*currentScan_, currentPose_, map_);
         haveMap_ = true;
     }
 
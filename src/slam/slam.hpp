@@ -2,15 +2,16 @@
 #define SLAM_OCCUPANCY_GRID_SLAM_HPP
 
 #include <lcmtypes/lidar_t.hpp>
+#include <lcmtypes/lidar_compact_t.hpp>
 #include <lcmtypes/odometry_t.hpp>
 #include <lcmtypes/pose_xyt_t.hpp>
 #include <slam/particle_filter.hpp>
 #include <slam/mapping.hpp>
+#include <slam/lidar_scan_pool.hpp>
 #include <common/pose_trace.hpp>
 #include <common/lcm_config.h>
 #include <slam/occupancy_grid.hpp>
 #include <lcm/lcm-cpp.hpp>
-#include <deque>
 #include <mutex>
 
 /**
@@ -18,6 +19,13 @@
 * 
 * LCM messages are assumed to be arriving asynchronously from the runSLAM thread. Synchronization
 * between the two threads is handled internally.
+* 
+* Laser scans are decoded directly into buffers from a LidarScanPool. The buffer is handed from the LCM thread to the
+* SLAM thread through the pool's queue and returned to the pool at the end of the SLAM iteration, so no copies of the
+* scan are made and no memory is allocated for scans once the pool has warmed up. Scans arrive either as lidar_t on
+* LIDAR_CHANNEL or, if useCompactScans is set, as lidar_compact_t on LIDAR_COMPACT_CHANNEL. Only one of the channels is
+* subscribed, so a driver publishing both formats doesn't feed each scan in twice. Compact scans are expanded into a
+* pooled lidar_t.
 */
 class OccupancyGridSLAM
 {
@@ -34,6 +42,7 @@ public:
     * \param    mappingOnlyMode     Flag indicating if poses are going to be arriving from elsewhere, so just update the mapping (optional, default = false, don't run mapping-only mode)
     * \param    actionOnlyMode     Flag indicating if we will run the sensor model when updating the particle filter
     * \param    localizationOnlyMap Name of the map to load for localization-only mode (optional, default = "", don't use localization-only mode)
+    * \param    useCompactScans     Flag indicating if scans are read as lidar_compact_t from LIDAR_COMPACT_CHANNEL instead of lidar_t from LIDAR_CHANNEL (optional, default = false)
     * \pre mappingOnly or localizationOnly are mutually exclusive. If mappingOnlyMode == true, then localizationOnlyMap.empty()
     *   and if !localizationOnlyMap.empty(), then mappingOnlyMode == false. They can both be empty/false for full SLAM mode.
     */
@@ -44,7 +53,8 @@ public:
                       bool waitForOptitrack,
                       bool mappingOnlyMode = false,
                       bool actionOnlyMode = false,
-                      const std::string localizationOnlyMap = std::string(""));
+                      const std::string localizationOnlyMap = std::string(""),
+                      bool useCompactScans = false);
     
     /**
     * runSLAM enters an infinite loop where SLAM will keep running as long as data is arriving.
@@ -56,7 +66,8 @@ public:
     
     
     // Handlers for LCM messages
-    void handleLaser   (const lcm::ReceiveBuffer* rbuf, const std::string& channel, const lidar_t* scan);
+    void handleLaser   (const lcm::ReceiveBuffer* rbuf, const std::string& channel);
+    void handleCompactLaser(const lcm::ReceiveBuffer* rbuf, const std::string& channel);
     void handleOdometry(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const odometry_t* odometry);
     void handlePose    (const lcm::ReceiveBuffer* rbuf, const std::string& channel, const pose_xyt_t* pose);
     void handleOptitrack(const lcm::ReceiveBuffer* rbuf, const std::string& channel, const pose_xyt_t* pose);
@@ -79,12 +90,13 @@ private:
     int  numIgnoredScans_;
     
     // Data from LCM
-    std::deque<lidar_t> incomingScans_;
+    LidarScanPool scanPool_;        // buffers for incoming scans and the queue of scans waiting for SLAM
+    lidar_compact_t compactScan_;   // decode target for compact scans -- only used by the LCM thread
     PoseTrace groundTruthPoses_;
     PoseTrace odometryPoses_;
     
     // Data being used for current SLAM iteration
-    lidar_t currentScan_;
+    lidar_t* currentScan_;          // owned by scanPool_ until it is released at the end of the iteration
     pose_xyt_t      currentOdometry_;
     
     pose_xyt_t initialPose_;
@@ -97,12 +109,16 @@ private:
     
     lcm::LCM& lcm_;
     int mapUpdateCount_;  // count so we only send the map occasionally, as it takes lots of bandwidth
+    std::size_t reportedScanAllocations_;   // allocations made by scanPool_ as of the last report
     
     std::mutex dataMutex_;
 
+    lidar_t* acquireScan      (void);
+    void queueScan            (lidar_t* scan, bool isValidScan);
     bool isReadyToUpdate      (void);
     void runSLAMIteration     (void);
     void copyDataForSLAMUpdate(void);
+    void releaseCurrentScan   (void);
     void initializePosesIfNeeded(void);
     void updateLocalization   (void);
     void updateMap            (void);
@@ -14,6 +14,7 @@ int main(int argc, char** argv)
     const char* kMappingOnlyArg = "mapping-only";
         const char* kActionOnlyArg = "action-only";
     const char* kLocalizationOnlyArg = "localization-only";
+    const char* kCompactScansArg = "compact-scans";
     
     // Handle Options
     getopt_t *gopt = getopt_create();
@@ -25,6 +26,7 @@ int main(int argc, char** argv)
     getopt_add_bool(gopt, '\0', kMappingOnlyArg, 0, "Flag indicating if mapping-only mode should be run");
     getopt_add_bool(gopt, '\0', kActionOnlyArg, 0, "Flag indicating if action-only mode should be run");
     getopt_add_string(gopt, '\0', kLocalizationOnlyArg, "", "Localization only mode should be run. Name of map to use is provided.");
+    getopt_add_bool(gopt, '\0', kCompactScansArg, 0, "Flag indicating if scans are read from LIDAR_COMPACT instead of LIDAR");
     
     if (!getopt_parse(gopt, argc, argv, 1) || getopt_get_bool(gopt, "help")) {
         printf("Usage: %s [options]", argv[0]);
@@ -39,6 +41,7 @@ int main(int argc, char** argv)
     bool mappingOnly = getopt_get_bool(gopt, kMappingOnlyArg);
     bool actionOnly = getopt_get_bool(gopt, kActionOnlyArg);
     std::string localizationMap = getopt_get_string(gopt, kLocalizationOnlyArg);
+    bool compactScans = getopt_get_bool(gopt, kCompactScansArg);
 
     signal(SIGINT, exit);  
     
@@ -51,7 +54,8 @@ int main(int argc, char** argv)
                            useOptitrack, 
                            mappingOnly,
                            actionOnly,
-                           localizationMap);
+                           localizationMap,
+                           compactScans);
     
     std::thread slamThread([&slam]() {
         slam.runSLAM();